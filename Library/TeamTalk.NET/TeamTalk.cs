@@ -201,6 +201,23 @@ namespace BearWare
         SOUNDDEVICEFEATURE_DEFAULTCOMDEVICE = 0x0020,
     }
 
+    /**
+     * @brief The resampler used when the sample rate or channels of
+     * an audio stream differ from the sound device.
+     *
+     * @see TeamTalkBase.SetResamplerType() */
+    public enum ResamplerType : uint
+    {
+        /** @brief The platform's resampler, i.e. DMO on Windows,
+         * FFmpeg or SpeexDSP depending on the build. Falls back to
+         * #BearWare.ResamplerType.RESAMPLERTYPE_POLYPHASE if the
+         * build has none of these. */
+        RESAMPLERTYPE_DEFAULT = 0,
+        /** @brief Built-in polyphase resampler which uses SIMD
+         * instructions where available. */
+        RESAMPLERTYPE_POLYPHASE = 1,
+    }
+
     /**
      * @brief A struct containing the properties of a sound device
      * for either playback or recording.
@@ -1063,7 +1080,10 @@ namespace BearWare
          * Corrects errors if there's packetloss. */
         public bool bFEC;
         /** @brief Discontinuous transmission.
-         * Enables "null" packets during silence. */
+         * Enables "null" packets during silence. The server only
+         * forwards the first of consecutive "null" packets unless the
+         * receiver subscribes with
+         * #BearWare.Subscription.SUBSCRIBE_VOICE_DTX. */
         public bool bDTX;
         /** @brief Bitrate for encoded audio. Should be between
          * #BearWare.OpusConstants.OPUS_MIN_BITRATE and
@@ -1497,6 +1517,15 @@ namespace BearWare
          * and VPX_DL_BEST_QUALITY = 0. */
         [FieldOffset(4)]
         public uint nEncodeDeadline;
+        /** @brief Number of simulcast layers to encode when used for
+         * video capture. 0 or 1 means simulcast is disabled.
+         *
+         * Each layer has half the width and height of the previous
+         * layer and a quarter of the bitrate. The server forwards a
+         * single layer to each user. Max is 3.
+         * @see Subscription.SUBSCRIBE_VIDEOCAPTURE_LOWRES */
+        [FieldOffset(8)]
+        public int nSimulcastLayers;
     }
 
     public struct WebMVP8CodecConstants
@@ -1529,7 +1558,10 @@ namespace BearWare
         /** @brief OPUS audio codec. @see OpusCodec */
         OPUS_CODEC = 3,
         /** @brief WebM video codec. @see WebMVP8Codec */
-        WEBM_VP8_CODEC = 128
+        WEBM_VP8_CODEC = 128,
+        /** @brief WebM VP9 video codec. Uses the same settings as
+         * #WEBM_VP8_CODEC, i.e. @c webm_vp8 in #VideoCodec. */
+        WEBM_VP9_CODEC = 129
     }
 
     /**
@@ -1994,6 +2026,12 @@ namespace BearWare
         public long nFilesRx;
         /** @brief The server's uptime in msec. */
         public long nUptimeMSec;
+        /** @brief Median time in usec from the server received a
+         * voice packet until it was forwarded to the receivers. */
+        public long nVoiceForwardP50USec;
+        /** @brief 95th percentile of the time in usec from the server
+         * received a voice packet until it was forwarded. */
+        public long nVoiceForwardP95USec;
     }
 
     /**
@@ -2197,6 +2235,19 @@ namespace BearWare
         /** @brief Subscribing to #BearWare.StreamType.STREAMTYPE_MEDIAFILE_VIDEO and
          * #BearWare.StreamType.STREAMTYPE_MEDIAFILE_AUDIO. */
         SUBSCRIBE_MEDIAFILE = 0x00000100,
+        /** @brief Receive lowest resolution simulcast layer of
+         * #BearWare.StreamType.STREAMTYPE_VIDEOCAPTURE. Only applies if the
+         * user's video capture is encoded with @c nSimulcastLayers.
+         * @see WebMVP8Codec */
+        SUBSCRIBE_VIDEOCAPTURE_LOWRES = 0x00000200,
+        /** @brief Receive every silent packet of
+         * #BearWare.StreamType.STREAMTYPE_VOICE when the user's Opus
+         * codec has @c bDTX enabled, e.g. when recording the user's
+         * voice stream. By default the server only forwards the first
+         * of consecutive silent packets and the receiver generates
+         * comfort noise until the user speaks again.
+         * @see OpusCodec */
+        SUBSCRIBE_VOICE_DTX = 0x00000400,
         /** @brief Intercept all user text messages sent by a
         * user. Only user-type #BearWare.UserType.USERTYPE_ADMIN can do this. */
         SUBSCRIBE_INTERCEPT_USER_MSG = 0x00010000,
@@ -2274,6 +2325,24 @@ namespace BearWare
                                                           USERSTATE_MEDIAFILE_VIDEO
     }
 
+    /** @brief The changes which have occured to a user while user
+     * events are coalesced. Used for #BearWare.TTMessage's @a nSource in
+     * #BearWare.ClientEvent.CLIENTEVENT_USER_STATECHANGE.
+     *
+     * @see TeamTalkBase.SetUserEventCoalescing() */
+    [Flags]
+    public enum UserChange : uint
+    {
+        /** @brief No changes. */
+        USERCHANGE_NONE                                 = 0x00000000,
+        /** @brief The user's @a uUserState has changed. */
+        USERCHANGE_STATE                                = 0x00000001,
+        /** @brief The server has updated the user's properties,
+         * i.e. what would otherwise have been posted as
+         * #BearWare.ClientEvent.CLIENTEVENT_CMD_USER_UPDATE. */
+        USERCHANGE_PROPERTIES                           = 0x00000002,
+    }
+
     /**
      * @brief A struct containing the properties of a user.
      * @see BearWare.UserType
@@ -2453,6 +2522,44 @@ namespace BearWare
         /** @brief Number of media file video frames dropped because user 
          * application didn't retrieve video frames in time. */
         public long nMediaFileVideoFramesDropped;
+        /** @brief Current voice playout delay in msec, i.e. the duration of
+         * voice data queued for playback. The playout delay adapts to
+         * the network jitter within the limits of BearWare.JitterConfig. */
+        public long nVoicePlayoutDelayMSec;
+        /** @brief Number of times voice playback was time-compressed
+         * (accelerated) to reduce the playout delay. */
+        public long nVoicePlayoutAccelerated;
+        /** @brief Number of times voice playback was time-stretched
+         * (expanded) to increase the playout delay or to conceal lost
+         * packets. */
+        public long nVoicePlayoutExpanded;
+        /** @brief Number of lost voice packets which were restored
+         * from forward error correction (FEC) or Deep REDundancy
+         * (DRED) data in the following packets. Only available with
+         * BearWare.Codec.OPUS_CODEC where OpusCodec.bFEC is
+         * enabled. Recovered packets are also included in @c
+         * nVoicePacketsLost. */
+        public long nVoicePacketsRecovered;
+        /** @brief Number of lost voice packets which were replaced by
+         * the decoder's packet loss concealment. */
+        public long nVoicePacketsConcealed;
+        /** @brief Median time in msec from a voice packet was
+         * received until it left the jitter buffer. Only available
+         * when TeamTalkBase.EnableLatencyTracing() is enabled. */
+        public long nVoiceBufferedP50MSec;
+        /** @brief 95th percentile of the time in msec from a voice
+         * packet was received until it left the jitter buffer. */
+        public long nVoiceBufferedP95MSec;
+        /** @brief Median time in msec from a voice packet was
+         * received until it was played by the sound device. The
+         * time spent in the sound device is an estimate. Only
+         * available when TeamTalkBase.EnableLatencyTracing() is
+         * enabled. */
+        public long nVoicePlayedP50MSec;
+        /** @brief 95th percentile of the time in msec from a voice
+         * packet was received until it was played by the sound
+         * device. */
+        public long nVoicePlayedP95MSec;
     }
 
     /** 
@@ -2991,6 +3098,30 @@ namespace BearWare
          *
          * @see TT_InitSoundInputDevice() */
         public int nSoundInputDeviceDelayMSec;
+        /** @brief Number of audio packets, video frames and desktop
+         * updates sent which had to be split into several packets to
+         * fit the path MTU.
+         * @see TeamTalkBase.QueryMaxPayload() */
+        public long nPacketsFragmented;
+        /** @brief Number of audio packets and video frames received
+         * which were reassembled from several packets. */
+        public long nPacketsReassembled;
+        /** @brief Median time in msec from voice was captured until
+         * it was encoded. The delay of the sound input device,
+         * @c nSoundInputDeviceDelayMSec, is not included. Only
+         * available when TeamTalkBase.EnableLatencyTracing() is
+         * enabled. */
+        public long nVoiceEncodedP50MSec;
+        /** @brief 95th percentile of the time in msec from voice was
+         * captured until it was encoded. */
+        public long nVoiceEncodedP95MSec;
+        /** @brief Median time in msec from voice was captured until
+         * it was sent to the server. Only available when
+         * TeamTalkBase.EnableLatencyTracing() is enabled. */
+        public long nVoiceSentP50MSec;
+        /** @brief 95th percentile of the time in msec from voice was
+         * captured until it was sent to the server. */
+        public long nVoiceSentP95MSec;
     }
 
     /** @ingroup connectivity
@@ -4436,6 +4567,27 @@ namespace BearWare
             return TTDLL.TT_GetMessage(m_ttInst, ref pMsg, ref nWaitMs);
         }
 
+        /**
+         * @brief Poll for several events in the client instance.
+         *
+         * Same as GetMessage() except that all queued events, up to
+         * the length of @c pMsgs, are retrieved in one call.
+         *
+         * @param pMsgs Array which will hold the events in the order
+         * they occured.
+         * @param nWaitMs The amount of time to wait if there are no
+         * events. If -1 the function will block until the next event
+         * occurs.
+         * @return The number of events stored in @c pMsgs.
+         * @see GetMessage() */
+        public int GetMessages(TTMessage[] pMsgs, int nWaitMs)
+        {
+            int nCount = pMsgs.Length;
+            if (!TTDLL.TT_GetMessages(m_ttInst, pMsgs, ref nCount, nWaitMs))
+                return 0;
+            return nCount;
+        }
+
         /**
          * @brief Cause client instance event thread to schedule an update
          * event.
@@ -4503,6 +4655,23 @@ namespace BearWare
             return TTDLL.TT_SetLicenseInformation(szRegName, szRegKey);
         }
 
+        /**
+         * @brief Let client instances share a fixed number of threads.
+         *
+         * Only affects client instances created after this call. Use
+         * when hosting many client instances in one process.
+         *
+         * @param nEventLoopThreads Number of threads handling network
+         * and timer events. 0 means each client instance has its own
+         * thread (default).
+         * @param nWorkerThreads Number of threads for mixing and
+         * encoding recordings. 0 means half the CPU cores (max 4).
+         * @return False if a parameter is negative. */
+        public static bool SetSharedEventLoop(int nEventLoopThreads, int nWorkerThreads)
+        {
+            return TTDLL.TT_SetSharedEventLoop(nEventLoopThreads, nWorkerThreads);
+        }
+
         /**
          * @brief Event handler for #BearWare.TTMessage.
          * 
@@ -4755,6 +4924,18 @@ namespace BearWare
         {
             return TTDLL.TT_RestartSoundSystem();
         }
+        /**
+         * @brief Select the resampler used by all client instances.
+         *
+         * Only applies to sound devices and streams which are started
+         * after this call.
+         *
+         * @param nResamplerType The resampler to use.
+         * @return False if @c nResamplerType is invalid. */
+        public static bool SetResamplerType(ResamplerType nResamplerType)
+        {
+            return TTDLL.TT_SetResamplerType(nResamplerType);
+        }
         /**
          * @brief Perform a record and playback test of specified sound
          * devices along with an audio configuration and ability to try
@@ -5033,6 +5214,19 @@ namespace BearWare
         {
             return TTDLL.TT_CloseSoundOutputDevice(m_ttInst);
         }
+        /**
+         * @brief Mix the audio of all users into a single output stream.
+         *
+         * In mixer mode all users are decoded and mixed by the callback
+         * of a single output stream instead of one output stream per
+         * user. Volume, mute and stereo settings still apply per user.
+         *
+         * @param bEnable True to enable mixer mode.
+         * @see TeamTalkBase.InitSoundOutputDevice */
+        public bool EnableSoundOutputMixer(bool bEnable)
+        {
+            return TTDLL.TT_EnableSoundOutputMixer(m_ttInst, bEnable);
+        }
         /**
          * @brief Shut down sound devices running in duplex mode.
          *
@@ -5648,6 +5842,22 @@ namespace BearWare
             return TTDLL.TT_StopRecordingMuxedAudioFileEx(m_ttInst, nChannelID);
         }
 
+        /**
+         * @brief Limit the memory used for audio waiting to be written to
+         * recordings.
+         *
+         * If the encoders of the recordings cannot keep up the
+         * recording is stalled when @c nMaxBytes is waiting to be
+         * encoded. Default is 64 MB.
+         *
+         * @param nMaxBytes Maximum number of bytes waiting to be encoded.
+         * @see StartRecordingMuxedAudioFile()
+         * @see SetUserMediaStorageDir() */
+        public bool SetRecordingMemoryLimit(int nMaxBytes)
+        {
+            return TTDLL.TT_SetRecordingMemoryLimit(m_ttInst, nMaxBytes);
+        }
+
         /**
          * @brief Start transmitting from video capture device.
          *
@@ -5843,6 +6053,27 @@ namespace BearWare
             return frm;
         }
 
+        /** @brief Extract a user's video capture frame as I420, i.e.
+         * without RGB conversion.
+         *
+         * The Y plane (@a nWidth * @a nHeight bytes) is followed by the
+         * U and V planes (each (@a nWidth+1)/2 * (@a nHeight+1)/2 bytes).
+         * Release using TeamTalkBase.ReleaseUserVideoCaptureFrame().
+         *
+         * @param nUserID The user's ID. The local user (0) is not supported.
+         * @return A #BearWare.VideoFrame with all members assigned to 0
+         * will be returned if no video frame is available. */
+        public VideoFrame AcquireUserVideoCaptureFrameI420(int nUserID)
+        {
+            IntPtr ptr = TTDLL.TT_AcquireUserVideoCaptureFrameEx(m_ttInst, nUserID, FourCC.FOURCC_I420);
+            if(ptr == IntPtr.Zero)
+                return new VideoFrame();
+
+            VideoFrame frm = (VideoFrame)Marshal.PtrToStructure(ptr, typeof(VideoFrame));
+            vidcapframes.Add(frm.frameBuffer, ptr);
+            return frm;
+        }
+
         Dictionary<IntPtr, IntPtr> vidcapframes = new Dictionary<IntPtr, IntPtr>();
 
         /** @brief Delete a user's video frame, acquired through
@@ -6601,6 +6832,43 @@ namespace BearWare
         {
             return TTDLL.TT_GetClientKeepAlive(m_ttInst, ref lpClientKeepAlive);
         }
+
+        /**
+         * @brief Merge user events within a time window.
+         *
+         * With coalescing enabled a single
+         * #BearWare.ClientEvent.CLIENTEVENT_USER_STATECHANGE is posted
+         * per changed user when @c nWindowMSec has elapsed. The
+         * #BearWare.TTMessage's @a nSource then contains the
+         * #BearWare.UserChange flags which have occured.
+         * #BearWare.ClientEvent.CLIENTEVENT_CMD_USER_UPDATE is not
+         * posted while coalescing is enabled.
+         *
+         * @param nWindowMSec Time window in msec, e.g. 50. Zero
+         * disables coalescing. */
+        public bool SetUserEventCoalescing(int nWindowMSec)
+        {
+            return TTDLL.TT_SetUserEventCoalescing(m_ttInst, nWindowMSec);
+        }
+
+        /**
+         * @brief Trace the latency of voice from capture to playout.
+         *
+         * Clocks of sender, server and receiver are not synchronized
+         * so each stage is measured by the host where it occurs. The
+         * sender's BearWare.ClientStatistics contains the time from
+         * capture until encoded and sent, the server's
+         * BearWare.ServerStatistics the time from received until
+         * forwarded and the receiver's BearWare.UserStatistics the
+         * time from received until decoded and played. The network
+         * delay is about half of @c nUdpPingTimeMs.
+         *
+         * @param bEnable Enable/disable tracing. Both reset the
+         * latency statistics. */
+        public bool EnableLatencyTracing(bool bEnable)
+        {
+            return TTDLL.TT_EnableLatencyTracing(m_ttInst, bEnable);
+        }
         /** @} */
 
         /** @addtogroup commands
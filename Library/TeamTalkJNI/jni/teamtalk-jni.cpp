@@ -97,6 +97,30 @@ extern "C" {
         return b;
     }
 
+    JNIEXPORT jint JNICALL Java_dk_bearware_TeamTalkBase_getMessages(JNIEnv* env,
+                                                                     jobject thiz,
+                                                                     jobjectArray pMsgs,
+                                                                     jint nWaitMs)
+    {
+        THROW_NULLEX(env, pMsgs, 0);
+
+        INT32 count = env->GetArrayLength(pMsgs);
+        if (count <= 0)
+            return 0;
+
+        std::vector<TTMessage> msgs(count);
+        if (TT_GetMessages(GetTTInstance(env, thiz), msgs.data(), &count, nWaitMs) == 0)
+            return 0;
+
+        for (INT32 i=0;i<count;i++)
+        {
+            jobject msg = env->GetObjectArrayElement(pMsgs, i);
+            THROW_NULLEX(env, msg, i);
+            setTTMessage(env, msgs[i], msg);
+        }
+        return count;
+    }
+
     JNIEXPORT jboolean JNICALL Java_dk_bearware_TeamTalkBase_pumpMessage(JNIEnv* env,
                                                                          jobject thiz,
                                                                          jint nClientEvent,
@@ -122,6 +146,14 @@ extern "C" {
         return TT_SetLicenseInformation(ttstr(env, szRegName), ttstr(env, szRegKey));
     }
 
+    JNIEXPORT jboolean JNICALL Java_dk_bearware_TeamTalkBase_setSharedEventLoop(JNIEnv* env,
+                                                                                jclass /*unused*/,
+                                                                                jint nEventLoopThreads,
+                                                                                jint nWorkerThreads)
+    {
+        return TT_SetSharedEventLoop(nEventLoopThreads, nWorkerThreads);
+    }
+
     JNIEXPORT jboolean JNICALL Java_dk_bearware_TeamTalkBase_getDefaultSoundDevices(JNIEnv* env,
                                                                                     jclass /*unused*/,
                                                                                     jobject lpnInputDeviceID,
@@ -196,6 +228,13 @@ extern "C" {
         return TT_RestartSoundSystem();
     }
 
+    JNIEXPORT jboolean JNICALL Java_dk_bearware_TeamTalkBase_setResamplerType(JNIEnv* /*unused*/,
+                                                                              jclass /*unused*/,
+                                                                              jint nResamplerType)
+    {
+        return TT_SetResamplerType(ResamplerType(nResamplerType));
+    }
+
     JNIEXPORT jlong JNICALL Java_dk_bearware_TeamTalkBase_startSoundLoopbackTest(JNIEnv* env,
                                                                                  jclass /*unused*/,
                                                                                  jint nInputDeviceID,
@@ -310,6 +349,13 @@ extern "C" {
         return TT_CloseSoundOutputDevice(GetTTInstance(env, thiz));
     }
 
+    JNIEXPORT jboolean JNICALL Java_dk_bearware_TeamTalkBase_enableSoundOutputMixer(JNIEnv* env,
+                                                                                    jobject thiz,
+                                                                                    jboolean bEnable)
+    {
+        return TT_EnableSoundOutputMixer(GetTTInstance(env, thiz), bEnable);
+    }
+
     JNIEXPORT jboolean JNICALL Java_dk_bearware_TeamTalkBase_closeSoundDuplexDevices(JNIEnv* env,
                                                                                      jobject thiz)
     {
@@ -589,6 +635,13 @@ extern "C" {
         return TT_StopRecordingMuxedAudioFileEx(GetTTInstance(env, thiz), nChannelID);
     }
 
+    JNIEXPORT jboolean JNICALL Java_dk_bearware_TeamTalkBase_setRecordingMemoryLimit(JNIEnv* env,
+                                                                                     jobject thiz,
+                                                                                     jint nMaxBytes)
+    {
+        return TT_SetRecordingMemoryLimit(GetTTInstance(env, thiz), nMaxBytes);
+    }
+
     JNIEXPORT jboolean JNICALL Java_dk_bearware_TeamTalkBase_startVideoCaptureTransmission(JNIEnv* env,
                                                                                            jobject thiz,
                                                                                            jobject lpVideoCodec)
@@ -671,6 +724,24 @@ extern "C" {
         return vidframe_obj;
     }
 
+    JNIEXPORT jobject JNICALL Java_dk_bearware_TeamTalkBase_acquireUserVideoCaptureFrameEx(JNIEnv* env,
+                                                                                           jobject thiz,
+                                                                                           jint nUserID,
+                                                                                           jint nFourCC)
+    {
+        VideoFrame* vidframe = TT_AcquireUserVideoCaptureFrameEx(GetTTInstance(env, thiz),
+                                                                 nUserID, FourCC(nFourCC));
+        if(vidframe == nullptr)
+            return nullptr;
+
+        jclass cls = env->FindClass("dk/bearware/VideoFrame");
+        jobject vidframe_obj = newObject(env, cls);
+        setVideoFrame(env, *vidframe, vidframe_obj);
+
+        TT_ReleaseUserVideoCaptureFrame(GetTTInstance(env, thiz), vidframe);
+        return vidframe_obj;
+    }
+
 // ReleaseUserVideoCaptureFrame()
 
     JNIEXPORT jboolean JNICALL Java_dk_bearware_TeamTalkBase_startStreamingMediaFileToChannel(JNIEnv* env,
@@ -1027,6 +1098,20 @@ extern "C" {
         return JFALSE;
     }
 
+    JNIEXPORT jboolean JNICALL Java_dk_bearware_TeamTalkBase_setUserEventCoalescing(JNIEnv* env,
+                                                                                    jobject thiz,
+                                                                                    jint nWindowMSec)
+    {
+        return TT_SetUserEventCoalescing(GetTTInstance(env, thiz), nWindowMSec);
+    }
+
+    JNIEXPORT jboolean JNICALL Java_dk_bearware_TeamTalkBase_enableLatencyTracing(JNIEnv* env,
+                                                                                  jobject thiz,
+                                                                                  jboolean bEnable)
+    {
+        return TT_EnableLatencyTracing(GetTTInstance(env, thiz), bEnable);
+    }
+
     JNIEXPORT jint JNICALL Java_dk_bearware_TeamTalkBase_doPing(JNIEnv* env,
                                                                 jobject thiz)
     {
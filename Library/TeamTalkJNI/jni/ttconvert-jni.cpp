@@ -1212,6 +1212,12 @@ void setClientStatistics(JNIEnv* env, ClientStatistics& stats, jobject lpStats)
     jfieldID fid_tcpping = env->GetFieldID(cls_stats, "nTcpPingTimeMs", "I");
     jfieldID fid_tcpsilen = env->GetFieldID(cls_stats, "nTcpServerSilenceSec", "I");
     jfieldID fid_udpsilen = env->GetFieldID(cls_stats, "nUdpServerSilenceSec", "I");
+    jfieldID fid_pktfrag = env->GetFieldID(cls_stats, "nPacketsFragmented", "J");
+    jfieldID fid_pktreasm = env->GetFieldID(cls_stats, "nPacketsReassembled", "J");
+    jfieldID fid_voiencp50 = env->GetFieldID(cls_stats, "nVoiceEncodedP50MSec", "J");
+    jfieldID fid_voiencp95 = env->GetFieldID(cls_stats, "nVoiceEncodedP95MSec", "J");
+    jfieldID fid_voisentp50 = env->GetFieldID(cls_stats, "nVoiceSentP50MSec", "J");
+    jfieldID fid_voisentp95 = env->GetFieldID(cls_stats, "nVoiceSentP95MSec", "J");
 
     assert(fid_udpsent);
     assert(fid_udprecv);
@@ -1229,6 +1235,12 @@ void setClientStatistics(JNIEnv* env, ClientStatistics& stats, jobject lpStats)
     assert(fid_tcpping);
     assert(fid_tcpsilen);
     assert(fid_udpsilen);
+    assert(fid_pktfrag);
+    assert(fid_pktreasm);
+    assert(fid_voiencp50);
+    assert(fid_voiencp95);
+    assert(fid_voisentp50);
+    assert(fid_voisentp95);
 
     env->SetLongField(lpStats, fid_udpsent, stats.nUdpBytesSent);
     env->SetLongField(lpStats, fid_udprecv, stats.nUdpBytesRecv);
@@ -1246,6 +1258,12 @@ void setClientStatistics(JNIEnv* env, ClientStatistics& stats, jobject lpStats)
     env->SetIntField(lpStats, fid_tcpping, stats.nTcpPingTimeMs);
     env->SetIntField(lpStats, fid_tcpsilen, stats.nTcpServerSilenceSec);
     env->SetIntField(lpStats, fid_udpsilen, stats.nUdpServerSilenceSec);
+    env->SetLongField(lpStats, fid_pktfrag, stats.nPacketsFragmented);
+    env->SetLongField(lpStats, fid_pktreasm, stats.nPacketsReassembled);
+    env->SetLongField(lpStats, fid_voiencp50, stats.nVoiceEncodedP50MSec);
+    env->SetLongField(lpStats, fid_voiencp95, stats.nVoiceEncodedP95MSec);
+    env->SetLongField(lpStats, fid_voisentp50, stats.nVoiceSentP50MSec);
+    env->SetLongField(lpStats, fid_voisentp95, stats.nVoiceSentP95MSec);
 }
 
 void setJitterConfig(JNIEnv* env, JitterConfig& jitterconfig, jobject lpConfig)
@@ -1453,6 +1471,8 @@ void setServerStatistics(JNIEnv* env, ServerStatistics& stats, jobject lpServerS
     jfieldID fid_desktx = env->GetFieldID(cls_srvstats, "nDesktopBytesTX", "J");
     jfieldID fid_deskrx = env->GetFieldID(cls_srvstats, "nDesktopBytesRX", "J");
     jfieldID fid_uptm = env->GetFieldID(cls_srvstats, "nUptimeMSec", "J");
+    jfieldID fid_voifwdp50 = env->GetFieldID(cls_srvstats, "nVoiceForwardP50USec", "J");
+    jfieldID fid_voifwdp95 = env->GetFieldID(cls_srvstats, "nVoiceForwardP95USec", "J");
 
     assert(fid_totaltx);
     assert(fid_totalrx);
@@ -1465,6 +1485,8 @@ void setServerStatistics(JNIEnv* env, ServerStatistics& stats, jobject lpServerS
     assert(fid_desktx);
     assert(fid_deskrx);
     assert(fid_uptm);
+    assert(fid_voifwdp50);
+    assert(fid_voifwdp95);
 
     if(conv == N2J)
     {
@@ -1479,6 +1501,8 @@ void setServerStatistics(JNIEnv* env, ServerStatistics& stats, jobject lpServerS
         env->SetLongField(lpServerStatistics, fid_desktx, stats.nDesktopBytesTX);
         env->SetLongField(lpServerStatistics, fid_deskrx, stats.nDesktopBytesRX);
         env->SetLongField(lpServerStatistics, fid_uptm, stats.nUptimeMSec);
+        env->SetLongField(lpServerStatistics, fid_voifwdp50, stats.nVoiceForwardP50USec);
+        env->SetLongField(lpServerStatistics, fid_voifwdp95, stats.nVoiceForwardP95USec);
     }
     else
     {
@@ -1494,6 +1518,8 @@ void setServerStatistics(JNIEnv* env, ServerStatistics& stats, jobject lpServerS
         stats.nDesktopBytesTX = env->GetLongField(lpServerStatistics, fid_desktx);
         stats.nDesktopBytesRX = env->GetLongField(lpServerStatistics, fid_deskrx);
         stats.nUptimeMSec = env->GetLongField(lpServerStatistics, fid_uptm);
+        stats.nVoiceForwardP50USec = env->GetLongField(lpServerStatistics, fid_voifwdp50);
+        stats.nVoiceForwardP95USec = env->GetLongField(lpServerStatistics, fid_voifwdp95);
     }
 }
 
@@ -1552,6 +1578,16 @@ void setUserStatistics(JNIEnv* env, UserStatistics& stats, jobject lpUserStatist
     jfieldID fid_mfvidflost = env->GetFieldID(cls_stats, "nMediaFileVideoFramesLost", "J");
     jfieldID fid_mfvidfdropped = env->GetFieldID(cls_stats, "nMediaFileVideoFramesDropped", "J");
 
+    jfieldID fid_voidelay = env->GetFieldID(cls_stats, "nVoicePlayoutDelayMSec", "J");
+    jfieldID fid_voiaccel = env->GetFieldID(cls_stats, "nVoicePlayoutAccelerated", "J");
+    jfieldID fid_voiexpand = env->GetFieldID(cls_stats, "nVoicePlayoutExpanded", "J");
+    jfieldID fid_voirecovered = env->GetFieldID(cls_stats, "nVoicePacketsRecovered", "J");
+    jfieldID fid_voiconcealed = env->GetFieldID(cls_stats, "nVoicePacketsConcealed", "J");
+    jfieldID fid_voibufp50 = env->GetFieldID(cls_stats, "nVoiceBufferedP50MSec", "J");
+    jfieldID fid_voibufp95 = env->GetFieldID(cls_stats, "nVoiceBufferedP95MSec", "J");
+    jfieldID fid_voiplayp50 = env->GetFieldID(cls_stats, "nVoicePlayedP50MSec", "J");
+    jfieldID fid_voiplayp95 = env->GetFieldID(cls_stats, "nVoicePlayedP95MSec", "J");
+
     assert(fid_voirx);
     assert(fid_voilost);
     assert(fid_vidrx);
@@ -1564,6 +1600,15 @@ void setUserStatistics(JNIEnv* env, UserStatistics& stats, jobject lpUserStatist
     assert(fid_mfvidftx);
     assert(fid_mfvidflost);
     assert(fid_mfvidfdropped);
+    assert(fid_voidelay);
+    assert(fid_voiaccel);
+    assert(fid_voiexpand);
+    assert(fid_voirecovered);
+    assert(fid_voiconcealed);
+    assert(fid_voibufp50);
+    assert(fid_voibufp95);
+    assert(fid_voiplayp50);
+    assert(fid_voiplayp95);
 
     env->SetLongField(lpUserStatistics, fid_voirx, stats.nVoicePacketsRecv);
     env->SetLongField(lpUserStatistics, fid_voilost, stats.nVoicePacketsLost);
@@ -1577,6 +1622,15 @@ void setUserStatistics(JNIEnv* env, UserStatistics& stats, jobject lpUserStatist
     env->SetLongField(lpUserStatistics, fid_mfvidftx, stats.nMediaFileVideoFramesRecv);
     env->SetLongField(lpUserStatistics, fid_mfvidflost, stats.nMediaFileVideoFramesLost);
     env->SetLongField(lpUserStatistics, fid_mfvidfdropped, stats.nMediaFileVideoFramesDropped);
+    env->SetLongField(lpUserStatistics, fid_voidelay, stats.nVoicePlayoutDelayMSec);
+    env->SetLongField(lpUserStatistics, fid_voiaccel, stats.nVoicePlayoutAccelerated);
+    env->SetLongField(lpUserStatistics, fid_voiexpand, stats.nVoicePlayoutExpanded);
+    env->SetLongField(lpUserStatistics, fid_voirecovered, stats.nVoicePacketsRecovered);
+    env->SetLongField(lpUserStatistics, fid_voiconcealed, stats.nVoicePacketsConcealed);
+    env->SetLongField(lpUserStatistics, fid_voibufp50, stats.nVoiceBufferedP50MSec);
+    env->SetLongField(lpUserStatistics, fid_voibufp95, stats.nVoiceBufferedP95MSec);
+    env->SetLongField(lpUserStatistics, fid_voiplayp50, stats.nVoicePlayedP50MSec);
+    env->SetLongField(lpUserStatistics, fid_voiplayp95, stats.nVoicePlayedP95MSec);
 }
 
 void setFileTransfer(JNIEnv* env, FileTransfer& filetx, jobject lpFileTransfer)
@@ -1961,7 +2015,8 @@ void setVideoCodec(JNIEnv* env, VideoCodec& codec, jobject lpVideoCodec, JConver
         env->SetIntField(lpVideoCodec, fid_codec, codec.nCodec);
         switch(codec.nCodec)
         {
-        case WEBM_VP8_CODEC : {
+        case WEBM_VP8_CODEC :
+        case WEBM_VP9_CODEC : {
             jobject webm_obj = newObject(env, cls_webm);
             assert(webm_obj);
             setWebMVP8Codec(env, codec.webm_vp8, webm_obj, conv);
@@ -1982,6 +2037,7 @@ void setVideoCodec(JNIEnv* env, VideoCodec& codec, jobject lpVideoCodec, JConver
         switch(codec.nCodec)
         {
         case WEBM_VP8_CODEC :
+        case WEBM_VP9_CODEC :
             setWebMVP8Codec(env, codec.webm_vp8, env->GetObjectField(lpVideoCodec, fid_webm), conv);
             break;
         case NO_CODEC :
@@ -1998,12 +2054,20 @@ void setWebMVP8Codec(JNIEnv* env, WebMVP8Codec& webm_vp8, jobject lpWebMVP8Codec
 {
     jclass cls = env->GetObjectClass(lpWebMVP8Codec);
     jfieldID fid_br = env->GetFieldID(cls, "nRcTargetBitrate", "I");
+    jfieldID fid_layers = env->GetFieldID(cls, "nSimulcastLayers", "I");
     assert(fid_br);
+    assert(fid_layers);
 
     if(conv == N2J)
+    {
         env->SetIntField(lpWebMVP8Codec, fid_br, webm_vp8.nRcTargetBitrate);
+        env->SetIntField(lpWebMVP8Codec, fid_layers, webm_vp8.nSimulcastLayers);
+    }
     else
+    {
         webm_vp8.nRcTargetBitrate = env->GetIntField(lpWebMVP8Codec, fid_br);
+        webm_vp8.nSimulcastLayers = env->GetIntField(lpWebMVP8Codec, fid_layers);
+    }
 }
 
 void setAbusePrevention(JNIEnv* env, AbusePrevention& abuse, jobject lpAbusePrevention, JConvert conv) {
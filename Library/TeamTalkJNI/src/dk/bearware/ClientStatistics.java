@@ -41,4 +41,10 @@ public class ClientStatistics
     public int nTcpPingTimeMs;
     public int nTcpServerSilenceSec;
     public int nUdpServerSilenceSec;
+    public long nPacketsFragmented;
+    public long nPacketsReassembled;
+    public long nVoiceEncodedP50MSec;
+    public long nVoiceEncodedP95MSec;
+    public long nVoiceSentP50MSec;
+    public long nVoiceSentP95MSec;
 }
@@ -30,4 +30,5 @@ public interface Codec
     public static final int SPEEX_VBR_CODEC             = 2;
     public static final int OPUS_CODEC                  = 3;
     public static final int WEBM_VP8_CODEC              = 128;
+    public static final int WEBM_VP9_CODEC              = 129;
 }
@@ -37,4 +37,6 @@ public class ServerStatistics
     public long nDesktopBytesRX;
 	//TODO: nUsersServed, nUsersPeak, nFilesTx, nFilesRx
     public long nUptimeMSec;
+    public long nVoiceForwardP50USec;
+    public long nVoiceForwardP95USec;
 }
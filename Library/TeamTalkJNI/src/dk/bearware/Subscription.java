@@ -34,6 +34,8 @@ public interface Subscription {
     public static final int SUBSCRIBE_DESKTOP                 = 0x00000040;
     public static final int SUBSCRIBE_DESKTOPINPUT            = 0x00000080;
     public static final int SUBSCRIBE_MEDIAFILE               = 0x00000100;
+    public static final int SUBSCRIBE_VIDEOCAPTURE_LOWRES     = 0x00000200;
+    public static final int SUBSCRIBE_VOICE_DTX               = 0x00000400;
 
     public static final int SUBSCRIBE_INTERCEPT_USER_MSG      = 0x00010000;
     public static final int SUBSCRIBE_INTERCEPT_CHANNEL_MSG   = 0x00020000;
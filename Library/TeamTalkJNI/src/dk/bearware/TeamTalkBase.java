@@ -58,6 +58,10 @@ public abstract class TeamTalkBase implements AutoCloseable
     public native boolean getMessage(TTMessage pMsg,
                                      int pnWaitMs);
 
+    // returns number of events stored in 'pMsgs'
+    public native int getMessages(TTMessage[] pMsgs,
+                                  int nWaitMs);
+
     public native boolean pumpMessage(int nClientEvent,
                                       int nIdentifier);
 
@@ -66,6 +70,9 @@ public abstract class TeamTalkBase implements AutoCloseable
     public static native boolean setLicenseInformation(String szRegName,
                                                        String szRegKey);
 
+    public static native boolean setSharedEventLoop(int nEventLoopThreads,
+                                                    int nWorkerThreads);
+
     public static native boolean getDefaultSoundDevices(IntPtr lpnInputDeviceID,
                                                         IntPtr lpnOutputDeviceID);
 
@@ -87,6 +94,8 @@ public abstract class TeamTalkBase implements AutoCloseable
 
     public static native boolean restartSoundSystem();
 
+    public static native boolean setResamplerType(int nResamplerType);
+
     public static native long startSoundLoopbackTest(int nInputDeviceID,
                                                      int nOutputDeviceID,
                                                      int nSampleRate,
@@ -131,6 +140,8 @@ public abstract class TeamTalkBase implements AutoCloseable
 
     public native boolean closeSoundOutputDevice();
 
+    public native boolean enableSoundOutputMixer(boolean bEnable);
+
     public native boolean closeSoundDuplexDevices();
 
     public native boolean setSoundDeviceEffects(SoundDeviceEffects lpSoundDeviceEffects);
@@ -215,6 +226,8 @@ public abstract class TeamTalkBase implements AutoCloseable
         return stopRecordingMuxedAudioFileEx(nChannelID);
     }
 
+    public native boolean setRecordingMemoryLimit(int nMaxBytes);
+
     public native boolean startVideoCaptureTransmission(VideoCodec lpVideoCodec);
 
     public native boolean stopVideoCaptureTransmission();
@@ -240,6 +253,8 @@ public abstract class TeamTalkBase implements AutoCloseable
 
     public native VideoFrame acquireUserVideoCaptureFrame(int nUserID);
 
+    public native VideoFrame acquireUserVideoCaptureFrameEx(int nUserID, int nFourCC);
+
 /*
     private native boolean releaseVideoCaptureFrame(int nUserID);
 */
@@ -329,6 +344,10 @@ public abstract class TeamTalkBase implements AutoCloseable
 
     public native boolean getClientKeepAlive(ClientKeepAlive lpClientKeepAlive);
 
+    public native boolean setUserEventCoalescing(int nWindowMSec);
+
+    public native boolean enableLatencyTracing(boolean bEnable);
+
     public native int doPing();
 
     public native int doLogin(String szNickname,
@@ -37,4 +37,13 @@ public class UserStatistics
     public long nMediaFileVideoFramesRecv;
     public long nMediaFileVideoFramesLost;
     public long nMediaFileVideoFramesDropped;
+    public long nVoicePlayoutDelayMSec;
+    public long nVoicePlayoutAccelerated;
+    public long nVoicePlayoutExpanded;
+    public long nVoicePacketsRecovered;
+    public long nVoicePacketsConcealed;
+    public long nVoiceBufferedP50MSec;
+    public long nVoiceBufferedP95MSec;
+    public long nVoicePlayedP50MSec;
+    public long nVoicePlayedP95MSec;
 }
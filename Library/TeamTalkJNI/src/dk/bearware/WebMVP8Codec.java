@@ -26,4 +26,5 @@ package dk.bearware;
 public class WebMVP8Codec
 {
     public int nRcTargetBitrate;
+    public int nSimulcastLayers;
 }
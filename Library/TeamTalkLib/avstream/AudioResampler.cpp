@@ -23,6 +23,7 @@
 
 #include "AudioResampler.h"
 
+#include "PolyphaseResampler.h"
 #include "myace/MyACE.h"
 
 #if defined(ENABLE_SPEEXDSP)
@@ -34,12 +35,17 @@
 #include "FFmpegResampler.h"
 #endif
 
+#include <atomic>
 #include <cassert>
 #include <cstdint>
 #include <cstring>
 
 #define ZERO_IT 0
 
+namespace {
+std::atomic<AudioResamplerType> resamplertype(AUDIORESAMPLER_DEFAULT);
+}
+
 uint32_t CalcSamples(int src_samplerate, uint32_t src_samples, int dest_samplerate)
 {
     double samples = ((double)dest_samplerate / (double)src_samplerate) * (double)src_samples;
@@ -124,6 +130,16 @@ int AudioResampler::Resample(const short* input_samples, short* output_samples)
     return outsamples;
 }
 
+AudioResamplerType GetAudioResamplerType()
+{
+    return resamplertype;
+}
+
+void SetAudioResamplerType(AudioResamplerType type)
+{
+    resamplertype = type;
+}
+
 audio_resampler_t MakeAudioResampler(const media::AudioFormat& informat,
                                      const media::AudioFormat& outformat,
                                      int input_samples_size/* = 0*/)
@@ -136,24 +152,39 @@ audio_resampler_t MakeAudioResampler(const media::AudioFormat& informat,
 
     audio_resampler_t resampler;
     bool ret = false;
+    bool const polyphase = GetAudioResamplerType() == AUDIORESAMPLER_POLYPHASE;
 #if defined(ENABLE_DMORESAMPLER)
-    auto dmo = new DMOResampler(informat, outformat, input_samples_size);
-    resampler.reset(dmo);
-    ret = dmo->Init(SAMPLEFORMAT_INT16, SAMPLEFORMAT_INT16);
-    MYTRACE(ACE_TEXT("Launched DMOResampler\n"));
+    if (!polyphase)
+    {
+        auto dmo = new DMOResampler(informat, outformat, input_samples_size);
+        resampler.reset(dmo);
+        ret = dmo->Init(SAMPLEFORMAT_INT16, SAMPLEFORMAT_INT16);
+        MYTRACE(ACE_TEXT("Launched DMOResampler\n"));
+    }
 #elif defined(ENABLE_FFMPEG)
-    auto *ffmpeg = new FFMPEGResampler(informat, outformat, input_samples_size);
-    resampler.reset(ffmpeg);
-    ret = ffmpeg->Init();
-    MYTRACE(ACE_TEXT("Launched FFMPEGResampler\n"));
+    if (!polyphase)
+    {
+        auto *ffmpeg = new FFMPEGResampler(informat, outformat, input_samples_size);
+        resampler.reset(ffmpeg);
+        ret = ffmpeg->Init();
+        MYTRACE(ACE_TEXT("Launched FFMPEGResampler\n"));
+    }
 #elif defined(ENABLE_SPEEXDSP)
-    auto spx = new SpeexResampler(informat, outformat, input_samples_size);
-    resampler.reset(spx);
-    ret = spx->Init(5);
-    MYTRACE(ACE_TEXT("Launched SpeexResampler\n"));
-#else
-#pragma message("No resampler available")
+    if (!polyphase)
+    {
+        auto spx = new SpeexResampler(informat, outformat, input_samples_size);
+        resampler.reset(spx);
+        ret = spx->Init(5);
+        MYTRACE(ACE_TEXT("Launched SpeexResampler\n"));
+    }
 #endif
+    if (!resampler)
+    {
+        auto poly = new PolyphaseResampler(informat, outformat, input_samples_size);
+        resampler.reset(poly);
+        ret = poly->Init();
+        MYTRACE(ACE_TEXT("Launched PolyphaseResampler\n"));
+    }
     if(!ret)
         resampler.reset();
 
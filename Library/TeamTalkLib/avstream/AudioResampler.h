@@ -70,6 +70,18 @@ private:
 
 using audio_resampler_t = std::shared_ptr< AudioResampler >;
 
+enum AudioResamplerType
+{
+    // Speex, FFmpeg or DMO depending on build
+    AUDIORESAMPLER_DEFAULT,
+    AUDIORESAMPLER_POLYPHASE,
+};
+
+// Backend used by MakeAudioResampler(). Falls back to
+// AUDIORESAMPLER_POLYPHASE if the build has no other resampler.
+AudioResamplerType GetAudioResamplerType();
+void SetAudioResamplerType(AudioResamplerType type);
+
 audio_resampler_t MakeAudioResampler(const media::AudioFormat& informat,
                                      const media::AudioFormat& outformat,
                                      int input_samples_size = 0);
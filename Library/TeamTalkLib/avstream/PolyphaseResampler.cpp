@@ -0,0 +1,268 @@
+/*
+ * Copyright (c) 2005-2018, BearWare.dk
+ *
+ * Contact Information:
+ *
+ * Bjoern D. Rasmussen
+ * Kirketoften 5
+ * DK-8260 Viby J
+ * Denmark
+ * Email: contact@bearware.dk
+ * Phone: +45 20 20 54 59
+ * Web: http://www.bearware.dk
+ *
+ * This source code is part of the TeamTalk SDK owned by
+ * BearWare.dk. Use of this file, or its compiled unit, requires a
+ * TeamTalk SDK License Key issued by BearWare.dk.
+ *
+ * The TeamTalk SDK License Agreement along with its Terms and
+ * Conditions are outlined in the file License.txt included with the
+ * TeamTalk SDK distribution.
+ *
+ */
+
+#include "PolyphaseResampler.h"
+
+#include "codec/AudioKernels.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <numbers>
+#include <numeric>
+
+// zero crossings of the sinc on each side at full bandwidth
+constexpr auto POLYPHASE_ZEROCROSSINGS = 16;
+// cutoff relative to the lower Nyquist frequency
+constexpr auto POLYPHASE_CUTOFF = 0.92;
+// Kaiser window beta. Stopband is about -90 dB
+constexpr auto POLYPHASE_KAISER_BETA = 8.6;
+constexpr auto POLYPHASE_MAX_PHASES = 256;
+// taps are a multiple of the widest vector register
+constexpr auto POLYPHASE_TAP_ALIGN = 16;
+// Q14 coefficients so the sum of |coef| times full scale input
+// cannot overflow the 32-bit dot product
+constexpr auto POLYPHASE_COEF_BITS = 14;
+constexpr auto POLYPHASE_COEF_ONE = 1 << POLYPHASE_COEF_BITS;
+
+namespace {
+
+double BesselI0(double x)
+{
+    double sum = 1, term = 1;
+    for (int k=1;k<50 && term > sum * 1e-12;k++)
+    {
+        term *= (x / (2 * k)) * (x / (2 * k));
+        sum += term;
+    }
+    return sum;
+}
+
+short Saturate16(int v)
+{
+    return short(std::clamp(v, -32768, 32767));
+}
+
+} // namespace
+
+PolyphaseResampler::PolyphaseResampler(const media::AudioFormat& informat,
+                                       const media::AudioFormat& outformat,
+                                       int fixed_input_samples)
+: AudioResampler(informat, outformat, fixed_input_samples)
+{
+    int const g = std::gcd(informat.samplerate, outformat.samplerate);
+    if (g > 0)
+    {
+        m_up = outformat.samplerate / g;
+        m_down = informat.samplerate / g;
+    }
+
+    // avoid growing history for fixed frame sizes
+    m_reserve = std::max(fixed_input_samples, 0);
+}
+
+bool PolyphaseResampler::Init()
+{
+    const auto& infmt = GetInputFormat();
+    const auto& outfmt = GetOutputFormat();
+    if (!infmt.IsValid() || !outfmt.IsValid() ||
+        infmt.channels > 2 || outfmt.channels > 2)
+        return false;
+
+    // mono to stereo is resampled as mono and duplicated on output
+    m_channels = std::min(infmt.channels, outfmt.channels);
+
+    DesignFilter();
+
+    int const capacity = m_taps + m_reserve;
+    for (int c=0;c<m_channels;c++)
+        m_history[c].assign(capacity, 0);
+
+    // center first output sample on the first input sample
+    m_history_len = (m_taps / 2) - 1;
+    m_index = 0;
+    m_frac = 0;
+    return true;
+}
+
+void PolyphaseResampler::DesignFilter()
+{
+    double const ratio = double(GetOutputFormat().samplerate) / GetInputFormat().samplerate;
+    double const cutoff = std::min(1.0, ratio) * POLYPHASE_CUTOFF;
+
+    m_phases = std::min(m_up, POLYPHASE_MAX_PHASES);
+    m_taps = int(std::ceil(2 * POLYPHASE_ZEROCROSSINGS / cutoff));
+    m_taps = ((m_taps + POLYPHASE_TAP_ALIGN - 1) / POLYPHASE_TAP_ALIGN) * POLYPHASE_TAP_ALIGN;
+
+    double const halfwidth = m_taps / 2.0;
+    double const i0beta = BesselI0(POLYPHASE_KAISER_BETA);
+
+    m_coefs.resize(size_t(m_phases + 1) * m_taps);
+    std::vector<double> row(m_taps);
+    for (int p=0;p<=m_phases;p++)
+    {
+        double const frac = double(p) / m_phases;
+        double sum = 0;
+        for (int j=0;j<m_taps;j++)
+        {
+            // distance from output sample to input sample 'j'
+            double const t = frac + halfwidth - 1 - j;
+            double const x = t / halfwidth;
+            double const window = std::abs(x) >= 1 ? 0 :
+                BesselI0(POLYPHASE_KAISER_BETA * std::sqrt(1 - (x * x))) / i0beta;
+            double const arg = std::numbers::pi * cutoff * t;
+            double const sinc = t == 0 ? 1 : std::sin(arg) / arg;
+            row[j] = cutoff * sinc * window;
+            sum += row[j];
+        }
+
+        // unity gain at DC for every phase after rounding
+        short* coefs = &m_coefs[size_t(p) * m_taps];
+        int total = 0;
+        for (int j=0;j<m_taps;j++)
+        {
+            coefs[j] = short(std::lround(row[j] / sum * POLYPHASE_COEF_ONE));
+            total += coefs[j];
+        }
+        auto peak = std::max_element(coefs, coefs + m_taps);
+        *peak = short(*peak + (POLYPHASE_COEF_ONE - total));
+    }
+}
+
+void PolyphaseResampler::Write(const short* input_samples, int input_samples_size)
+{
+    assert(m_channels > 0);
+    if (m_channels == 0 || input_samples_size <= 0)
+        return;
+
+    // drop history which is no longer used by the filter
+    if (m_index > 0)
+    {
+        for (int c=0;c<m_channels;c++)
+            std::memmove(m_history[c].data(), &m_history[c][m_index], (m_history_len - m_index) * sizeof(short));
+        m_history_len -= m_index;
+        m_index = 0;
+    }
+
+    size_t const needed = size_t(m_history_len) + input_samples_size;
+    if (m_history[0].size() < needed)
+    {
+        for (int c=0;c<m_channels;c++)
+            m_history[c].resize(needed);
+    }
+
+    int const inchannels = GetInputFormat().channels;
+    if (inchannels == m_channels && m_channels == 1)
+    {
+        std::memcpy(&m_history[0][m_history_len], input_samples, input_samples_size * sizeof(short));
+    }
+    else if (inchannels == m_channels)
+    {
+        AudioSplitStereo(input_samples, &m_history[0][m_history_len],
+                         &m_history[1][m_history_len], input_samples_size);
+    }
+    else
+    {
+        // stereo to mono
+        short* mono = &m_history[0][m_history_len];
+        for (int i=0;i<input_samples_size;i++)
+            mono[i] = short((int(input_samples[i*2]) + input_samples[(i*2)+1]) / 2);
+    }
+    m_history_len += input_samples_size;
+}
+
+int PolyphaseResampler::GetReadAvailable() const
+{
+    // samples until the last tap passes the end of the history
+    int64_t const remain = int64_t(m_history_len) - m_taps - m_index;
+    if (remain < 0)
+        return 0;
+    return int((((remain + 1) * m_up) - 1 - m_frac) / m_down) + 1;
+}
+
+short PolyphaseResampler::FilterSample(const short* history) const
+{
+    int64_t const pos = m_frac * m_phases;
+    int const phase = int(pos / m_up);
+    int64_t const weight = pos % m_up;
+
+    const short* coefs = &m_coefs[size_t(phase) * m_taps];
+    int64_t acc = AudioDotProduct(history, coefs, m_taps);
+    if (weight != 0)
+    {
+        // fractional phase
+        int64_t const next = AudioDotProduct(history, coefs + m_taps, m_taps);
+        acc += ((next - acc) * weight) / m_up;
+    }
+    acc += POLYPHASE_COEF_ONE / 2;
+    return Saturate16(int(acc >> POLYPHASE_COEF_BITS));
+}
+
+void PolyphaseResampler::Advance()
+{
+    m_frac += m_down;
+    m_index += int(m_frac / m_up);
+    m_frac %= m_up;
+}
+
+int PolyphaseResampler::Read(short* output_samples, int output_samples_size)
+{
+    int const outchannels = GetOutputFormat().channels;
+    int const n = std::min(output_samples_size, GetReadAvailable());
+    for (int i=0;i<n;i++)
+    {
+        if (m_channels == 1)
+        {
+            short const s = FilterSample(&m_history[0][m_index]);
+            output_samples[i * outchannels] = s;
+            if (outchannels == 2)
+                output_samples[(i * 2) + 1] = s;
+        }
+        else
+        {
+            output_samples[i * 2] = FilterSample(&m_history[0][m_index]);
+            output_samples[(i * 2) + 1] = FilterSample(&m_history[1][m_index]);
+        }
+        Advance();
+    }
+    return n;
+}
+
+int PolyphaseResampler::Resample(const short* input_samples, int input_samples_size,
+                                 short* output_samples, int output_samples_size)
+{
+    Write(input_samples, input_samples_size);
+    int const ret = Read(output_samples, output_samples_size);
+
+    // rounding of output size may leave a sample behind. Don't let
+    // it build up as delay
+    while (GetReadAvailable() > 1)
+        Advance();
+
+    if (ret == 0)
+        std::memset(output_samples, 0, PCM16_BYTES(output_samples_size, GetOutputFormat().channels));
+    else if (ret < output_samples_size)
+        FillOutput(GetOutputFormat().channels, output_samples, ret, output_samples_size);
+    return ret;
+}
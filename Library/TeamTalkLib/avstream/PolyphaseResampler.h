@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) 2005-2018, BearWare.dk
+ *
+ * Contact Information:
+ *
+ * Bjoern D. Rasmussen
+ * Kirketoften 5
+ * DK-8260 Viby J
+ * Denmark
+ * Email: contact@bearware.dk
+ * Phone: +45 20 20 54 59
+ * Web: http://www.bearware.dk
+ *
+ * This source code is part of the TeamTalk SDK owned by
+ * BearWare.dk. Use of this file, or its compiled unit, requires a
+ * TeamTalk SDK License Key issued by BearWare.dk.
+ *
+ * The TeamTalk SDK License Agreement along with its Terms and
+ * Conditions are outlined in the file License.txt included with the
+ * TeamTalk SDK distribution.
+ *
+ */
+
+#if !defined(POLYPHASERESAMPLER_H)
+#define POLYPHASERESAMPLER_H
+
+#include "AudioResampler.h"
+
+#include "codec/MediaUtil.h"
+
+#include <cstdint>
+#include <vector>
+
+// Built-in resampler using a Kaiser windowed sinc filter split into
+// polyphase rows. Any pair of sample rates is supported. Ratios which
+// need more phases than POLYPHASE_MAX_PHASES interpolate between
+// adjacent phases. The filter's inner loop is AudioDotProduct().
+//
+// Apart from growing the input history the resampler doesn't
+// allocate after construction.
+class PolyphaseResampler : public AudioResampler
+{
+public:
+    PolyphaseResampler(const PolyphaseResampler&) = delete;
+    PolyphaseResampler(const media::AudioFormat& informat, const media::AudioFormat& outformat,
+                       int fixed_input_samples = 0);
+
+    bool Init();
+
+    //return number of samples written to 'output_samples'
+    int Resample(const short* input_samples, int input_samples_size,
+                 short* output_samples, int output_samples_size) override;
+
+    // Streaming interface, i.e. queue input with Write() and get the
+    // resampled audio with Read() when GetReadAvailable() is enough.
+    void Write(const short* input_samples, int input_samples_size);
+    // Returns number of samples written to 'output_samples'
+    int Read(short* output_samples, int output_samples_size);
+    int GetReadAvailable() const;
+
+    // Delay of the filter in input samples
+    int GetDelay() const { return m_taps / 2; }
+
+private:
+    void DesignFilter();
+    short FilterSample(const short* history) const;
+    void Advance();
+
+    // output rate / input rate reduced to 'm_up' / 'm_down'
+    int m_up = 1, m_down = 1;
+    int m_phases = 0, m_taps = 0;
+    // Q14 coefficients. 'm_phases' + 1 rows of 'm_taps'
+    std::vector<short> m_coefs;
+    // input history per resampled channel
+    int m_channels = 0;
+    std::vector<short> m_history[2];
+    int m_history_len = 0;
+    int m_reserve = 0;
+    // first history sample used by next output sample and its
+    // fraction in units of 1 / 'm_up'
+    int m_index = 0;
+    int64_t m_frac = 0;
+};
+
+#endif
@@ -65,17 +65,7 @@ void MuxPlayers(const std::vector<OutputStreamer*>& players,
                                    i->framesize))
         {
             SoftVolume(*i, tmp_buffer, i->framesize, mastervol, mastermute);
-            int const samples = i->framesize * i->channels;
-            for(int p=0;p<samples;p++)
-            {
-                int const val = tmp_buffer[p] + playback[p];
-                if(val>32767)
-                    playback[p] = 32767;
-                else if(val<-32768)
-                    playback[p] = -32768;
-                else
-                    playback[p] = (short)val;
-            }
+            AudioMix(playback, tmp_buffer, i->framesize * i->channels);
         }
     }
 }
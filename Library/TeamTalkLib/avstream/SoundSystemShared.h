@@ -420,6 +420,7 @@ constexpr auto DEBUG_RESAMPLER = 0;
             assert(SameStreamProperties(*m_orgstream, streamer));
 
             const size_t reqbytes = PCM16_BYTES(streamer.framesize, streamer.channels);
+            const size_t reqsamples = size_t(streamer.framesize) * streamer.channels;
             memset(buffer, 0, reqbytes);
 
             std::lock_guard<std::recursive_mutex> g(m_mutex);
@@ -428,130 +429,67 @@ constexpr auto DEBUG_RESAMPLER = 0;
                          ACE_TEXT("--------------------- Mixer inputs %d -----------------------------\n"),
                          int(m_active_outputs.size()));
 
-            for (auto i : m_outputs)
+            // only active streams are pulled, so idle players don't
+            // add to the cost of the mixer
+            for (auto* player : m_active_outputs)
             {
-                if (m_active_outputs.find(i.first) == m_active_outputs.end())
-                    continue;
+                auto ios = m_outputs.find(player);
+                assert(ios != m_outputs.end());
+                const auto& output = ios->second;
 
                 MYTRACE_COND(DEBUG_SHAREDPLAYER_RESAMPLER,
                              ACE_TEXT("Resample source: %d samples %d channels @ %d Hz duration %d msec. Destination %p: %d samples %d channels @ %d Hz duration %d msec\n"),
                              m_orgstream->framesize, m_orgstream->channels, m_orgstream->samplerate,
                              int(PCM16_SAMPLES_DURATION(m_orgstream->framesize, m_orgstream->samplerate)),
-                             i.first, i.second->framesize, i.second->channels, i.second->samplerate,
-                             int(PCM16_SAMPLES_DURATION(i.second->framesize, i.second->samplerate)));
+                             player, output->framesize, output->channels, output->samplerate,
+                             int(PCM16_SAMPLES_DURATION(output->framesize, output->samplerate)));
+
+                int mastervol = m_sndsys->GetMasterVolume(output->sndgrpid);
+                bool mastermute = m_sndsys->IsAllMute(output->sndgrpid);
+                auto gain = output->GetMasterVolumeGain(mastermute, mastervol);
 
-                if (SameStreamProperties(*i.second, *m_orgstream))
+                if (SameStreamProperties(*output, *m_orgstream))
                 {
-                    assert(i.second->framesize == samples);
-                    i.first->StreamPlayerCb(*i.second, m_tmpbuffer.data(), samples);
-                    int mastervol = m_sndsys->GetMasterVolume(i.second->sndgrpid);
-                    bool mastermute = m_sndsys->IsAllMute(i.second->sndgrpid);
-                    SoftVolume(*i.second, m_tmpbuffer.data(), samples, mastervol, mastermute);
-                    MYTRACE_COND(DEBUG_SHAREDPLAYER_RESAMPLER, ACE_TEXT("Same stream properties. Destination: %p\n"), i.first);
+                    assert(output->framesize == samples);
+                    player->StreamPlayerCb(*output, m_tmpbuffer.data(), samples);
+                    MYTRACE_COND(DEBUG_SHAREDPLAYER_RESAMPLER, ACE_TEXT("Same stream properties. Destination: %p\n"), player);
                 }
                 else
                 {
-                    auto streamer_resam = i.second;
-                    assert(m_resamplers.find(i.first) != m_resamplers.end());
-                    auto msgq = m_resambuffers[i.first];
-                    auto resampler = m_resamplers[i.first];
-                    short* input = &m_callbackbuffers[i.first][0];
-                    int outputsamples = CalcSamples(streamer_resam->samplerate, streamer_resam->framesize, m_orgstream->samplerate);
-                    const size_t outputbytes = PCM16_BYTES(outputsamples, m_orgstream->channels);
-
-                    MYTRACE_COND(DEBUG_SHAREDPLAYER_RESAMPLER, ACE_TEXT("Duration of queue before: %d msec\n"),
-                                 int(PCM16_BYTES_DURATION(msgq->message_length(), streamer.channels,
-                                                          streamer.samplerate)));
-
-                    // fill up buffer with enough bytes to do a callback
-                    while (msgq->message_length() < reqbytes)
-                    {
-                        i.first->StreamPlayerCb(*streamer_resam, input, streamer_resam->framesize);
-                        int mastervol = m_sndsys->GetMasterVolume(streamer_resam->sndgrpid);
-                        bool mastermute = m_sndsys->IsAllMute(streamer_resam->sndgrpid);
-                        SoftVolume(*streamer_resam, input, streamer_resam->framesize, mastervol, mastermute);
-                        short* output = resampler->Resample(input);
-
-                        ACE_Message_Block* mb = nullptr;
-                        ACE_NEW_NORETURN(mb, ACE_Message_Block(outputbytes));
-                        if (mb->copy(reinterpret_cast<const char*>(output), outputbytes) < 0)
-                            mb->release();
-                        else
-                        {
-                            ACE_Time_Value tv;
-                            int ret = msgq->enqueue(mb, &tv);
-                            assert(ret >= 0);
-                            if (ret < 0)
-                            {
-                                msgq->close();
-                                mb->release();
-                            }
-                        }
-                    }
-
-                    MYTRACE_COND(DEBUG_SHAREDPLAYER_RESAMPLER, ACE_TEXT("Duration of queue after refill: %d msec. Bytes: %u\n"),
-                                 int(PCM16_BYTES_DURATION(msgq->message_length(), streamer.channels,
-                                                          streamer.samplerate)), unsigned(msgq->message_length()));
-
+                    assert(m_resamplers.find(player) != m_resamplers.end());
+                    auto& fifo = m_resambuffers[player];
+                    auto resampler = m_resamplers[player];
+                    short* input = m_callbackbuffers[player].data();
 
-                    // copy buffer to callback
-                    char* bytebuffer = reinterpret_cast<char*>(m_tmpbuffer.data());
-                    size_t copied = 0;
-                    while (copied < reqbytes)
+                    // fill up FIFO with enough samples to do a callback
+                    while (fifo.length < reqsamples)
                     {
-                        ACE_Time_Value tv;
-                        ACE_Message_Block* mb = nullptr;
-                        int ret = msgq->dequeue(mb, &tv);
-                        assert(ret >= 0);
-                        if (ret < 0)
-                        {
-                            msgq->close();
-                            break;
-                        }
-
-                        size_t const copylimit = std::min(mb->length(), reqbytes - copied);
-                        std::memcpy(bytebuffer + copied, mb->rd_ptr(), copylimit);
-                        auto *was = mb->rd_ptr();
-                        mb->rd_ptr(copylimit);
-                        assert(mb->rd_ptr() == was + copylimit);
-                        copied += copylimit;
-
-                        if (mb->length() != 0u)
-                        {
-                            assert(copied == reqbytes);
-                            int ret = msgq->enqueue_head(mb, &tv);
-                            assert(ret >= 0);
-                            if (ret < 0)
-                            {
-                                mb->release();
-                                msgq->close();
-                                break;
-                            }
-                        }
-                        else
-                        {
-                            mb->release();
-                        }
+                        player->StreamPlayerCb(*output, input, output->framesize);
+                        int outputsamples = 0;
+                        const short* resampled = resampler->Resample(input, &outputsamples);
+                        size_t const n_samples = std::min(size_t(outputsamples) * m_orgstream->channels,
+                                                          fifo.samples.size() - fifo.length);
+                        std::memcpy(&fifo.samples[fifo.length], resampled, n_samples * sizeof(short));
+                        fifo.length += n_samples;
                     }
-                    assert(copied == reqbytes);
 
-                    MYTRACE_COND(DEBUG_SHAREDPLAYER_RESAMPLER, ACE_TEXT("Duration of queue after dequeue: %d msec\n"),
-                                 int(PCM16_BYTES_DURATION(msgq->message_length(), streamer.channels,
-                                                          streamer.samplerate)));
+                    MYTRACE_COND(DEBUG_SHAREDPLAYER_RESAMPLER, ACE_TEXT("Duration of FIFO after refill: %d msec\n"),
+                                 int(PCM16_SAMPLES_DURATION(int(fifo.length) / streamer.channels, streamer.samplerate)));
 
+                    std::memcpy(m_tmpbuffer.data(), fifo.samples.data(), reqbytes);
+                    fifo.length -= reqsamples;
+                    std::memmove(fifo.samples.data(), &fifo.samples[reqsamples], fifo.length * sizeof(short));
                 }
 
+                // muted streams are still pulled so they remain in sync
+                if (gain.numerator == 0)
+                    continue;
+
+                SOFTGAIN(m_tmpbuffer.data(), m_orgstream->framesize, m_orgstream->channels,
+                         gain.numerator, gain.denominator);
+
                 // mix all active streams
-                for (size_t i=0;i<m_tmpbuffer.size();++i)
-                {
-                    int val = m_tmpbuffer[i] + buffer[i];
-                    if (val > 32767)
-                        buffer[i] = 32767;
-                    else if (val < -32768)
-                        buffer[i] = -32768;
-                    else
-                        buffer[i] = short(val);
-                }
+                AudioMix(buffer, m_tmpbuffer.data(), int(m_tmpbuffer.size()));
 
             } // for-loop - streams
 
@@ -599,9 +537,11 @@ constexpr auto DEBUG_RESAMPLER = 0;
 
             m_resamplers[player] = resampler;
             m_callbackbuffers[player].resize(size_t(streamer->channels) * streamer->framesize);
-            m_resambuffers[player] = std::make_shared<ACE_Message_Queue< ACE_NULL_SYNCH >>();
-            m_resambuffers[player]->high_water_mark(1024*1024);
-            m_resambuffers[player]->low_water_mark(1024*1024);
+            // FIFO holds a callback of the original stream plus one
+            // resampled frame so the audio callback never allocates
+            int const outputsamples = CalcSamples(streamer->samplerate, streamer->framesize, m_orgstream->samplerate);
+            m_resambuffers[player].samples.resize(size_t(m_orgstream->framesize + outputsamples + 1) * m_orgstream->channels);
+            m_resambuffers[player].length = 0;
             return true;
         }
 
@@ -647,7 +587,11 @@ constexpr auto DEBUG_RESAMPLER = 0;
         }
 
     private:
-        using msg_queue_t = std::shared_ptr< ACE_Message_Queue< ACE_NULL_SYNCH > >;
+        struct ResampleFIFO
+        {
+            std::vector<short> samples;
+            size_t length = 0;
+        };
 
         SoundSystem* m_sndsys;
         outputstreamer_t m_orgstream;
@@ -656,7 +600,7 @@ constexpr auto DEBUG_RESAMPLER = 0;
         std::set<StreamPlayer*> m_active_outputs;
         std::map<StreamPlayer*, audio_resampler_t> m_resamplers;
         std::map<StreamPlayer*, std::vector<short>> m_callbackbuffers;
-        std::map<StreamPlayer*, msg_queue_t> m_resambuffers;
+        std::map<StreamPlayer*, ResampleFIFO> m_resambuffers;
         std::recursive_mutex m_mutex;
     };
 
@@ -1323,9 +1323,11 @@ void Convert(const VideoCodec& vidcodec, teamtalk::VideoCodec& result)
     case NO_CODEC :
         break;
     case WEBM_VP8_CODEC :
-        result.codec = teamtalk::CODEC_WEBM_VP8;
+    case WEBM_VP9_CODEC :
+        result.codec = (vidcodec.nCodec == WEBM_VP9_CODEC)? teamtalk::CODEC_WEBM_VP9 : teamtalk::CODEC_WEBM_VP8;
         result.webm_vp8.rc_target_bitrate = vidcodec.webm_vp8.nRcTargetBitrate;
         result.webm_vp8.encode_deadline = vidcodec.webm_vp8.nEncodeDeadline;
+        result.webm_vp8.simulcast_layers = vidcodec.webm_vp8.nSimulcastLayers;
         break;
     }
     assert(result.codec == (teamtalk::Codec)vidcodec.nCodec);
@@ -1554,6 +1556,8 @@ void Convert(const teamtalk::ServerStats& stats, ServerStatistics& result)
     ACE_UINT64 msec = 0;
     stats.starttime.msec(msec);
     result.nUptimeMSec = msec;
+    result.nVoiceForwardP50USec = stats.voice_forward_p50_usec;
+    result.nVoiceForwardP95USec = stats.voice_forward_p95_usec;
 }
 
 void Convert(const teamtalk::TextMessage& txtmsg, TextMessage& result)
@@ -1634,7 +1638,8 @@ void Convert(const media::VideoFrame& imgframe, VideoFrame& result)
 {
     ZERO_STRUCT(result);
 
-    TTASSERT(RGB32_BYTES(imgframe.width, imgframe.height) == imgframe.frame_length);
+    TTASSERT(imgframe.fourcc != media::FOURCC_RGB32 ||
+             RGB32_BYTES(imgframe.width, imgframe.height) == imgframe.frame_length);
     result.frameBuffer = imgframe.frame;
     result.nWidth = imgframe.width;
     result.nHeight = imgframe.height;
@@ -1668,6 +1673,15 @@ void Convert(const teamtalk::ClientUserStats& stats, UserStatistics& result)
     result.nMediaFileVideoFramesRecv = stats.mediafile_video_frames_recv;
     result.nMediaFileVideoFramesLost = stats.mediafile_video_frames_lost;
     result.nMediaFileVideoFramesDropped = stats.mediafile_video_frames_dropped;
+    result.nVoicePlayoutDelayMSec = stats.voice_playout_delay_msec;
+    result.nVoicePlayoutAccelerated = stats.voice_playout_accelerated;
+    result.nVoicePlayoutExpanded = stats.voice_playout_expanded;
+    result.nVoicePacketsRecovered = stats.voicepackets_recovered;
+    result.nVoicePacketsConcealed = stats.voicepackets_concealed;
+    result.nVoiceBufferedP50MSec = stats.voice_buffered_p50_msec;
+    result.nVoiceBufferedP95MSec = stats.voice_buffered_p95_msec;
+    result.nVoicePlayedP50MSec = stats.voice_played_p50_msec;
+    result.nVoicePlayedP95MSec = stats.voice_played_p95_msec;
 }
 
 void Convert(const teamtalk::ClientStats& stats, ClientStatistics& result)
@@ -1691,6 +1705,12 @@ void Convert(const teamtalk::ClientStats& stats, ClientStatistics& result)
     result.nTcpServerSilenceSec = stats.tcp_silence_sec;
     result.nUdpServerSilenceSec = stats.udp_silence_sec;
     result.nSoundInputDeviceDelayMSec = stats.streamcapture_delay_msec;
+    result.nPacketsFragmented = stats.packets_fragmented;
+    result.nPacketsReassembled = stats.packets_reassembled;
+    result.nVoiceEncodedP50MSec = stats.voice_encoded_p50_msec;
+    result.nVoiceEncodedP95MSec = stats.voice_encoded_p95_msec;
+    result.nVoiceSentP50MSec = stats.voice_sent_p50_msec;
+    result.nVoiceSentP95MSec = stats.voice_sent_p95_msec;
 }
 
 void Convert(const ClientKeepAlive& ka, teamtalk::ClientKeepAlive& result)
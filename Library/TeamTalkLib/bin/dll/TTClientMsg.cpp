@@ -29,6 +29,7 @@
 
 #include <ace/OS_Memory.h>
 
+#include <chrono>
 #include <cstddef>
 #include <mutex>
 
@@ -38,56 +39,23 @@ constexpr size_t INTMSG_MAX_SIZE = (0x7F000000);
  * of channels, max number of users and all users are in channels, as well as
  * connect and login events */
 constexpr size_t INTMSG_SUSPEND_SIZE = ((sizeof(TTMessage) * MAX_CHANNELS) + (sizeof(TTMessage) * MAX_USERS) + (sizeof(TTMessage) * MAX_USERS) + (sizeof(TTMessage) * 100));
+// Preallocated events. Bursts beyond this go to the spill queue
+constexpr auto INTMSG_RING_SLOTS = 128;
 
 constexpr auto DEBUG_TTMSGQUEUE = 0;
 
-struct IntTTMessage
+static void InitMsg(TTMessage& msg, ClientEvent event, INT32 nSource, TTType ttType)
 {
-    ClientEvent event;
-    UINT32 nSource;
-    TTType ttType;
-    union
-    {
-        char data[1];
-        VOID* any;
-        Channel* chan;
-        User* user;
-        UserAccount* useraccount;
-        RemoteFile* remotefile;
-        TextMessage* textmessage;
-        ServerProperties* serverproperties;
-        ServerStatistics* serverstatistics;
-        FileTransfer* filetransfer;
-        ClientErrorMsg* clienterrmsg;
-        DesktopInput* desktopinput;
-        BannedUser* banneduser;
-        TTBOOL* active;
-        INT32* bytesremain;
-        INT32* stream_id;
-        INT32* payload_size;
-        MediaFileInfo* mediafileinfo;
-        StreamType* streamtype;
-        AudioInputProgress* audioinputprogress;
-        SoundDevice* sounddevice;
-    };
-};
-
-static IntTTMessage* MakeMsgBlock(ACE_Message_Block*& mb,
-                           ClientEvent event,
-                           UINT32 nSource,
-                           TTType ttType)
-{
-    int const size = TT_DBG_SIZEOF(ttType);
-    ACE_NEW_RETURN(mb, ACE_Message_Block(sizeof(IntTTMessage) + size), nullptr);
-    auto* ret = reinterpret_cast<IntTTMessage*>(mb->rd_ptr());
-    ret->event = event;
-    ret->nSource = nSource;
-    ret->ttType = ttType;
-    if(size != 0)
-        ret->any = &mb->rd_ptr()[sizeof(IntTTMessage)];
-    else
-        ret->any = nullptr;
-    return ret;
+    msg.nClientEvent = event;
+    msg.nSource = nSource;
+    msg.ttType = ttType;
+    msg.uReserved = 0;
+}
+
+// Header and the part of the union which is used
+static size_t MsgSize(const TTMessage& msg)
+{
+    return offsetof(TTMessage, data) + TT_DBG_SIZEOF(msg.ttType);
 }
 
 TTMsgQueue::TTMsgQueue()
@@ -119,62 +87,31 @@ TTMsgQueue::~TTMsgQueue()
 
 void TTMsgQueue::InitMsgQueue()
 {
+    m_ring.Reset(INTMSG_RING_SLOTS);
     m_event_queue.low_water_mark(INTMSG_MAX_SIZE);
     m_event_queue.high_water_mark(INTMSG_MAX_SIZE);
     static_assert(INTMSG_MAX_SIZE >= INTMSG_SUSPEND_SIZE, "Message queue size invalid");
 }
 
-void TTMsgQueue::EnqueueMsg(ACE_Message_Block* mb)
+void TTMsgQueue::EnqueueMsg(const TTMessage& msg)
 {
+    size_t const msgsize = MsgSize(msg);
     bool suspend = false;
     {
         std::unique_lock<std::mutex> const g(m_mutex);
 
-        size_t const old_size = m_event_queue.message_bytes();
-        if (old_size <= INTMSG_SUSPEND_SIZE &&
-            m_event_queue.message_bytes() + mb->size() > INTMSG_SUSPEND_SIZE)
+        // ring is only used when nothing has spilled, so events stay in order
+        TTMessage* slot = m_spilled == 0 ? m_ring.Back() : nullptr;
+        if (slot != nullptr)
         {
-            // submit message along with overflow message
-
-            ACE_Time_Value tv;
-            int ret = m_event_queue.enqueue(mb, &tv);
-            assert(ret >= 0);
-
-            IntTTMessage* msg = MakeMsgBlock(mb, CLIENTEVENT_INTERNAL_ERROR,
-                                             0, __CLIENTERRORMSG);
-            msg->clienterrmsg->nErrorNo = INTERR_TTMESSAGE_QUEUE_OVERFLOW;
-
-            ACE_OS::strsncpy(msg->clienterrmsg->szErrorMsg,
-                             ACE_TEXT("The internal message queue has overflowed"),
-                             TT_STRLEN);
-
-            tv = ACE_Time_Value::zero;
-            ret = m_event_queue.enqueue(mb, &tv);
-            assert(ret >= 0);
-            assert(!m_suspended);
-            if (m_suspender != nullptr)
-                m_suspended = suspend = m_suspender->CanSuspend();
-            else
-                m_suspended = suspend = true;
-
-            MYTRACE(ACE_TEXT("TTMsgQueue message queue has overflowed. Suspend: %d\n"), int(suspend));
-        }
-        else if (m_event_queue.message_bytes() + mb->size() <= INTMSG_SUSPEND_SIZE)
-        {
-            ACE_Time_Value tv;
-            int const ret = m_event_queue.enqueue(mb, &tv);
-            TTASSERT(ret >= 0);
+            ACE_OS::memcpy(slot, &msg, msgsize);
+            m_ring.Push();
         }
         else
         {
-            MBGuard const g_mb(mb);
-            if (!m_suspended && (m_suspender != nullptr) && m_suspender->CanSuspend())
-                m_suspended = suspend = true;
-
-            auto* intmsg = reinterpret_cast<IntTTMessage*>(mb->rd_ptr());
-            MYTRACE(ACE_TEXT("TTMsgQueue message queue has overflowed. Dropped ClientEvent %u. Suspend: %d\n"), intmsg->event, int(suspend));
+            suspend = SpillMsg(msg, msgsize);
         }
-        MYTRACE_COND(DEBUG_TTMSGQUEUE, ACE_TEXT("Enqueue %p: Old size: %u, Cur size: %u. Max size: %u\n"), this, old_size, m_event_queue.message_bytes());
+        m_signal.notify_one();
     }
 
     if (suspend && (m_suspender != nullptr))
@@ -188,48 +125,136 @@ void TTMsgQueue::EnqueueMsg(ACE_Message_Block* mb)
 #endif
 }
 
-TTBOOL TTMsgQueue::GetMessage(TTMessage& msg, ACE_Time_Value* tv)
+bool TTMsgQueue::SpillMsg(const TTMessage& msg, size_t msgsize)
 {
-    bool resume = false;
+    bool suspend = false;
     ACE_Message_Block* mb = nullptr;
+    ACE_NEW_RETURN(mb, ACE_Message_Block(msgsize), false);
+    ACE_OS::memcpy(mb->wr_ptr(), &msg, msgsize);
+    mb->wr_ptr(msgsize);
+
+    size_t const old_size = m_event_queue.message_bytes();
+    if (old_size <= INTMSG_SUSPEND_SIZE &&
+        m_event_queue.message_bytes() + mb->size() > INTMSG_SUSPEND_SIZE)
     {
-        if (m_event_queue.peek_dequeue_head(mb, tv) >= 0)
-        {
-            std::unique_lock<std::mutex> const g(m_mutex);
+        // submit message along with overflow message
 
-            ACE_Time_Value tvzero;
-            int const ret = m_event_queue.dequeue(mb, &tvzero);
+        ACE_Time_Value tv;
+        int ret = m_event_queue.enqueue(mb, &tv);
+        assert(ret >= 0);
+
+        TTMessage overflow;
+        InitMsg(overflow, CLIENTEVENT_INTERNAL_ERROR, 0, __CLIENTERRORMSG);
+        overflow.clienterrormsg.nErrorNo = INTERR_TTMESSAGE_QUEUE_OVERFLOW;
+
+        ACE_OS::strsncpy(overflow.clienterrormsg.szErrorMsg,
+                         ACE_TEXT("The internal message queue has overflowed"),
+                         TT_STRLEN);
+
+        size_t const overflowsize = MsgSize(overflow);
+        ACE_NEW_NORETURN(mb, ACE_Message_Block(overflowsize));
+        if (mb != nullptr)
+        {
+            ACE_OS::memcpy(mb->wr_ptr(), &overflow, overflowsize);
+            mb->wr_ptr(overflowsize);
+            tv = ACE_Time_Value::zero;
+            ret = m_event_queue.enqueue(mb, &tv);
             assert(ret >= 0);
-            if (ret < 0)
-                return FALSE;
-
-            auto* intmsg = reinterpret_cast<IntTTMessage*>(mb->rd_ptr());
-            msg.nClientEvent = intmsg->event;
-            msg.nSource = intmsg->nSource;
-            msg.ttType = intmsg->ttType;
-            int const size = TT_DBG_SIZEOF(intmsg->ttType);
-            TTASSERT(!size || intmsg->any);
-            if(size>0 && (intmsg->any != nullptr))
-                ACE_OS::memcpy(msg.data, intmsg->any, size);
-            mb->release();
-
-            MYTRACE_COND(DEBUG_TTMSGQUEUE, ACE_TEXT("Dequeue %p: Cur size: %u\n"),
-                         this, m_event_queue.message_bytes());
-
-            if (m_suspended && m_event_queue.message_bytes() <= INTMSG_SUSPEND_SIZE)
-            {
-                resume = true;
-                m_suspended = false;
-
-                MYTRACE_COND(DEBUG_TTMSGQUEUE, ACE_TEXT("TTMsgQueue message queue is resuming.\n"));
-            }
         }
+        assert(!m_suspended);
+        if (m_suspender != nullptr)
+            m_suspended = suspend = m_suspender->CanSuspend();
+        else
+            m_suspended = suspend = true;
+
+        MYTRACE(ACE_TEXT("TTMsgQueue message queue has overflowed. Suspend: %d\n"), int(suspend));
+    }
+    else if (m_event_queue.message_bytes() + mb->size() <= INTMSG_SUSPEND_SIZE)
+    {
+        ACE_Time_Value tv;
+        int const ret = m_event_queue.enqueue(mb, &tv);
+        TTASSERT(ret >= 0);
+    }
+    else
+    {
+        MBGuard const g_mb(mb);
+        if (!m_suspended && (m_suspender != nullptr) && m_suspender->CanSuspend())
+            m_suspended = suspend = true;
+
+        MYTRACE(ACE_TEXT("TTMsgQueue message queue has overflowed. Dropped ClientEvent %u. Suspend: %d\n"), msg.nClientEvent, int(suspend));
+    }
+    m_spilled = m_event_queue.message_count();
+    MYTRACE_COND(DEBUG_TTMSGQUEUE, ACE_TEXT("Spill %p: Old size: %u, Cur size: %u\n"), this, old_size, m_event_queue.message_bytes());
+    return suspend;
+}
+
+int TTMsgQueue::ReadMessages(TTMessage* msgs, int count, bool& resume)
+{
+    int n = 0;
+    // the ring holds the oldest events
+    for (TTMessage* slot = m_ring.Front(); n < count && (slot != nullptr); slot = m_ring.Front())
+    {
+        ACE_OS::memcpy(&msgs[n++], slot, MsgSize(*slot));
+        m_ring.Pop();
+    }
+
+    if (n == count || m_spilled == 0)
+        return n;
+
+    std::unique_lock<std::mutex> const g(m_mutex);
+
+    // producers cannot add to the ring while holding the lock
+    for (TTMessage* slot = m_ring.Front(); n < count && (slot != nullptr); slot = m_ring.Front())
+    {
+        ACE_OS::memcpy(&msgs[n++], slot, MsgSize(*slot));
+        m_ring.Pop();
+    }
+
+    ACE_Time_Value tvzero;
+    ACE_Message_Block* mb = nullptr;
+    while (n < count && m_event_queue.dequeue(mb, &tvzero) >= 0)
+    {
+        ACE_OS::memcpy(&msgs[n++], mb->rd_ptr(), mb->length());
+        mb->release();
+    }
+    m_spilled = m_event_queue.message_count();
+
+    MYTRACE_COND(DEBUG_TTMSGQUEUE, ACE_TEXT("Dequeue %p: Cur size: %u\n"),
+                 this, m_event_queue.message_bytes());
+
+    if (m_suspended && m_event_queue.message_bytes() <= INTMSG_SUSPEND_SIZE)
+    {
+        resume = true;
+        m_suspended = false;
+
+        MYTRACE_COND(DEBUG_TTMSGQUEUE, ACE_TEXT("TTMsgQueue message queue is resuming.\n"));
+    }
+    return n;
+}
+
+int TTMsgQueue::GetMessages(TTMessage* msgs, int count, int waitms)
+{
+    std::unique_lock<std::mutex> const gr(m_read_mutex);
+
+    bool resume = false;
+    int n = ReadMessages(msgs, count, resume);
+    if (n == 0 && waitms != 0)
+    {
+        {
+            std::unique_lock<std::mutex> g(m_mutex);
+            auto const ready = [this]() { return m_ring.Front() != nullptr || m_spilled > 0; };
+            if (waitms < 0)
+                m_signal.wait(g, ready);
+            else
+                m_signal.wait_for(g, std::chrono::milliseconds(waitms), ready);
+        }
+        n = ReadMessages(msgs, count, resume);
     }
 
     if (resume)
         m_suspender->ResumeEventHandling();
 
-    return static_cast<TTBOOL>(mb != nullptr);
+    return n;
 }
 
 void TTMsgQueue::RegisterEventSuspender(teamtalk::EventSuspender* suspender)
@@ -239,213 +264,177 @@ void TTMsgQueue::RegisterEventSuspender(teamtalk::EventSuspender* suspender)
 
 void TTMsgQueue::OnConnectSuccess()
 {
-    ACE_Message_Block* mb = nullptr;
-    IntTTMessage* msg = MakeMsgBlock(mb, CLIENTEVENT_CON_SUCCESS,
-                                     0, __NONE);
-    ACE_UNUSED_ARG(msg);
-    EnqueueMsg(mb);
+    TTMessage msg;
+    InitMsg(msg, CLIENTEVENT_CON_SUCCESS, 0, __NONE);
+    EnqueueMsg(msg);
 }
 
 void TTMsgQueue::OnConnectFailed()
 {
-    ACE_Message_Block* mb = nullptr;
-    IntTTMessage* msg = MakeMsgBlock(mb, CLIENTEVENT_CON_FAILED,
-                                     0, __NONE);
-    ACE_UNUSED_ARG(msg);
-    EnqueueMsg(mb);
+    TTMessage msg;
+    InitMsg(msg, CLIENTEVENT_CON_FAILED, 0, __NONE);
+    EnqueueMsg(msg);
 }
 
 void TTMsgQueue::OnConnectionLost()
 {
-    ACE_Message_Block* mb = nullptr;
-    IntTTMessage* msg = MakeMsgBlock(mb, CLIENTEVENT_CON_LOST,
-                                     0, __NONE);
-    ACE_UNUSED_ARG(msg);
-    EnqueueMsg(mb);
+    TTMessage msg;
+    InitMsg(msg, CLIENTEVENT_CON_LOST, 0, __NONE);
+    EnqueueMsg(msg);
 }
 
 void TTMsgQueue::OnEncryptionFailed(int sslerr, const ACE_TString& errmsg)
 {
-    ACE_Message_Block* mb = nullptr;
-    IntTTMessage* msg = MakeMsgBlock(mb, CLIENTEVENT_CON_CRYPT_ERROR,
-                                     sslerr, __CLIENTERRORMSG);
-    ACE_UNUSED_ARG(msg);
-    msg->clienterrmsg->nErrorNo = sslerr;
+    TTMessage msg;
+    InitMsg(msg, CLIENTEVENT_CON_CRYPT_ERROR, sslerr, __CLIENTERRORMSG);
+    msg.clienterrormsg.nErrorNo = sslerr;
 
-    ACE_OS::strsncpy(msg->clienterrmsg->szErrorMsg,
+    ACE_OS::strsncpy(msg.clienterrormsg.szErrorMsg,
                      errmsg.c_str(),
                      TT_STRLEN);
-    EnqueueMsg(mb);
+    EnqueueMsg(msg);
 }
 
 void TTMsgQueue::OnAccepted(int myuserid, const teamtalk::UserAccount& account)
 {
-    ACE_Message_Block* mb = nullptr;
-    IntTTMessage* msg = MakeMsgBlock(mb, CLIENTEVENT_CMD_MYSELF_LOGGEDIN,
-                                     myuserid, __USERACCOUNT);
-    Convert(account, *msg->useraccount);
-    EnqueueMsg(mb);
+    TTMessage msg;
+    InitMsg(msg, CLIENTEVENT_CMD_MYSELF_LOGGEDIN, myuserid, __USERACCOUNT);
+    Convert(account, msg.useraccount);
+    EnqueueMsg(msg);
 }
 
 void TTMsgQueue::OnLoggedOut()
 {
-    ACE_Message_Block* mb = nullptr;
-    IntTTMessage* msg = MakeMsgBlock(mb, CLIENTEVENT_CMD_MYSELF_LOGGEDOUT,
-                                     0, __NONE);
-    ACE_UNUSED_ARG(msg);
-    EnqueueMsg(mb);
+    TTMessage msg;
+    InitMsg(msg, CLIENTEVENT_CMD_MYSELF_LOGGEDOUT, 0, __NONE);
+    EnqueueMsg(msg);
 }
 
 void TTMsgQueue::OnUserLoggedIn(const teamtalk::ClientUser& user)
 {
-    ACE_Message_Block* mb = nullptr;
-    IntTTMessage* msg = MakeMsgBlock(mb, CLIENTEVENT_CMD_USER_LOGGEDIN,
-                                     0, __USER);
-    Convert(user, *msg->user);
-    EnqueueMsg(mb);
+    TTMessage msg;
+    InitMsg(msg, CLIENTEVENT_CMD_USER_LOGGEDIN, 0, __USER);
+    Convert(user, msg.user);
+    EnqueueMsg(msg);
 }
 
 void TTMsgQueue::OnUserLoggedOut(const teamtalk::ClientUser& user)
 {
-    ACE_Message_Block* mb = nullptr;
-    IntTTMessage* msg = MakeMsgBlock(mb, CLIENTEVENT_CMD_USER_LOGGEDOUT,
-                                     0, __USER);
-    Convert(user, *msg->user);
-    EnqueueMsg(mb);
+    TTMessage msg;
+    InitMsg(msg, CLIENTEVENT_CMD_USER_LOGGEDOUT, 0, __USER);
+    Convert(user, msg.user);
+    EnqueueMsg(msg);
 }
 
 void TTMsgQueue::OnUserUpdate(const teamtalk::ClientUser& user)
 {
-    ACE_Message_Block* mb = nullptr;
-    IntTTMessage* msg = MakeMsgBlock(mb, CLIENTEVENT_CMD_USER_UPDATE,
-                                     0, __USER);
-    Convert(user, *msg->user);
-    EnqueueMsg(mb);
+    TTMessage msg;
+    InitMsg(msg, CLIENTEVENT_CMD_USER_UPDATE, 0, __USER);
+    Convert(user, msg.user);
+    EnqueueMsg(msg);
 }
 
 void TTMsgQueue::OnUserJoinChannel(const teamtalk::ClientUser& user,
                                    const teamtalk::ClientChannel& chan)
 {
-    ACE_Message_Block* mb = nullptr;
-    IntTTMessage* msg = MakeMsgBlock(mb, CLIENTEVENT_CMD_USER_JOINED,
-                                     0, __USER);
-    Convert(user, *msg->user);
-    EnqueueMsg(mb);
+    TTMessage msg;
+    InitMsg(msg, CLIENTEVENT_CMD_USER_JOINED, 0, __USER);
+    Convert(user, msg.user);
+    EnqueueMsg(msg);
     ACE_UNUSED_ARG(chan);
 }
 
 void TTMsgQueue::OnUserLeftChannel(const teamtalk::ClientUser& user,
                                    const teamtalk::ClientChannel& chan)
 {
-    ACE_Message_Block* mb = nullptr;
-    IntTTMessage* msg = MakeMsgBlock(mb, CLIENTEVENT_CMD_USER_LEFT,
-                                     chan.GetChannelID(),
-                                     __USER);
-    Convert(user, *msg->user);
-    EnqueueMsg(mb);
+    TTMessage msg;
+    InitMsg(msg, CLIENTEVENT_CMD_USER_LEFT, chan.GetChannelID(), __USER);
+    Convert(user, msg.user);
+    EnqueueMsg(msg);
 }
 
 void TTMsgQueue::OnAddChannel(const teamtalk::ClientChannel& chan)
 {
-    ACE_Message_Block* mb = nullptr;
-    IntTTMessage* msg = MakeMsgBlock(mb, CLIENTEVENT_CMD_CHANNEL_NEW,
-                                     0,
-                                     __CHANNEL);
-    Convert(chan.GetChannelProp(), *msg->chan);
-    EnqueueMsg(mb);
+    TTMessage msg;
+    InitMsg(msg, CLIENTEVENT_CMD_CHANNEL_NEW, 0, __CHANNEL);
+    Convert(chan.GetChannelProp(), msg.channel);
+    EnqueueMsg(msg);
 }
 
 void TTMsgQueue::OnUpdateChannel(const teamtalk::ClientChannel& chan)
 {
-    ACE_Message_Block* mb = nullptr;
-    IntTTMessage* msg = MakeMsgBlock(mb, CLIENTEVENT_CMD_CHANNEL_UPDATE,
-                                     0,
-                                     __CHANNEL);
-    Convert(chan.GetChannelProp(), *msg->chan);
-    EnqueueMsg(mb);
+    TTMessage msg;
+    InitMsg(msg, CLIENTEVENT_CMD_CHANNEL_UPDATE, 0, __CHANNEL);
+    Convert(chan.GetChannelProp(), msg.channel);
+    EnqueueMsg(msg);
 }
 
 void TTMsgQueue::OnRemoveChannel(const teamtalk::ClientChannel& chan)
 {
-    ACE_Message_Block* mb = nullptr;
-    IntTTMessage* msg = MakeMsgBlock(mb, CLIENTEVENT_CMD_CHANNEL_REMOVE,
-                                     0,
-                                     __CHANNEL);
-    Convert(chan.GetChannelProp(), *msg->chan);
-    EnqueueMsg(mb);
+    TTMessage msg;
+    InitMsg(msg, CLIENTEVENT_CMD_CHANNEL_REMOVE, 0, __CHANNEL);
+    Convert(chan.GetChannelProp(), msg.channel);
+    EnqueueMsg(msg);
 }
 
 void TTMsgQueue::OnAddFile(const teamtalk::ClientChannel& chan,
                            const teamtalk::RemoteFile& file)
 {
-    ACE_Message_Block* mb = nullptr;
-    IntTTMessage* msg = MakeMsgBlock(mb, CLIENTEVENT_CMD_FILE_NEW,
-                                     0,
-                                     __REMOTEFILE);
-    Convert(file, *msg->remotefile);
-    EnqueueMsg(mb);
+    TTMessage msg;
+    InitMsg(msg, CLIENTEVENT_CMD_FILE_NEW, 0, __REMOTEFILE);
+    Convert(file, msg.remotefile);
+    EnqueueMsg(msg);
     ACE_UNUSED_ARG(chan);
 }
 
 void TTMsgQueue::OnRemoveFile(const teamtalk::ClientChannel& chan,
                               const teamtalk::RemoteFile& file)
 {
-    ACE_Message_Block* mb = nullptr;
-    IntTTMessage* msg = MakeMsgBlock(mb, CLIENTEVENT_CMD_FILE_REMOVE,
-                                     0,
-                                     __REMOTEFILE);
-    Convert(file, *msg->remotefile);
-    EnqueueMsg(mb);
+    TTMessage msg;
+    InitMsg(msg, CLIENTEVENT_CMD_FILE_REMOVE, 0, __REMOTEFILE);
+    Convert(file, msg.remotefile);
+    EnqueueMsg(msg);
     ACE_UNUSED_ARG(chan);
 }
 
 void TTMsgQueue::OnUserAccount(const teamtalk::UserAccount& account)
 {
-    ACE_Message_Block* mb = nullptr;
-    IntTTMessage* msg = MakeMsgBlock(mb, CLIENTEVENT_CMD_USERACCOUNT,
-                                     0,
-                                     __USERACCOUNT);
-    Convert(account, *msg->useraccount);
-    EnqueueMsg(mb);
+    TTMessage msg;
+    InitMsg(msg, CLIENTEVENT_CMD_USERACCOUNT, 0, __USERACCOUNT);
+    Convert(account, msg.useraccount);
+    EnqueueMsg(msg);
 }
 
 void TTMsgQueue::OnAddUserAccount(const teamtalk::UserAccount& account)
 {
-    ACE_Message_Block* mb = nullptr;
-    IntTTMessage* msg = MakeMsgBlock(mb, CLIENTEVENT_CMD_USERACCOUNT_NEW,
-                                     0,
-                                     __USERACCOUNT);
-    Convert(account, *msg->useraccount);
-    EnqueueMsg(mb);
+    TTMessage msg;
+    InitMsg(msg, CLIENTEVENT_CMD_USERACCOUNT_NEW, 0, __USERACCOUNT);
+    Convert(account, msg.useraccount);
+    EnqueueMsg(msg);
 }
 
 void TTMsgQueue::OnRemoveUserAccount(const ACE_TString& username)
 {
-    ACE_Message_Block* mb = nullptr;
-    IntTTMessage* msg = MakeMsgBlock(mb, CLIENTEVENT_CMD_USERACCOUNT_REMOVE,
-                                     0,
-                                     __USERACCOUNT);
-    ACE_OS::strsncpy(msg->useraccount->szUsername, username.c_str(), TT_STRLEN);
-    EnqueueMsg(mb);
+    TTMessage msg;
+    InitMsg(msg, CLIENTEVENT_CMD_USERACCOUNT_REMOVE, 0, __USERACCOUNT);
+    ACE_OS::strsncpy(msg.useraccount.szUsername, username.c_str(), TT_STRLEN);
+    EnqueueMsg(msg);
 }
 
 void TTMsgQueue::OnBannedUser(const teamtalk::BannedUser& banuser)
 {
-    ACE_Message_Block* mb = nullptr;
-    IntTTMessage* msg = MakeMsgBlock(mb, CLIENTEVENT_CMD_BANNEDUSER,
-                                     0,
-                                     __BANNEDUSER);
-    Convert(banuser, *msg->banneduser);
-    EnqueueMsg(mb);
+    TTMessage msg;
+    InitMsg(msg, CLIENTEVENT_CMD_BANNEDUSER, 0, __BANNEDUSER);
+    Convert(banuser, msg.banneduser);
+    EnqueueMsg(msg);
 }
 
 void TTMsgQueue::OnTextMessage(const teamtalk::TextMessage& textmsg)
 {
-    ACE_Message_Block* mb = nullptr;
-    IntTTMessage* msg = MakeMsgBlock(mb, CLIENTEVENT_CMD_USER_TEXTMSG,
-                                     0, __TEXTMESSAGE);
-    Convert(textmsg, *msg->textmessage);
-    EnqueueMsg(mb);
+    TTMessage msg;
+    InitMsg(msg, CLIENTEVENT_CMD_USER_TEXTMSG, 0, __TEXTMESSAGE);
+    Convert(textmsg, msg.textmessage);
+    EnqueueMsg(msg);
 }
 
 void TTMsgQueue::OnJoinedChannel(int channelid)
@@ -460,208 +449,193 @@ void TTMsgQueue::OnLeftChannel(int channelid)
 
 void TTMsgQueue::OnKicked(const teamtalk::clientuser_t& user, int channelid)
 {
-    ACE_Message_Block* mb = nullptr;
-    IntTTMessage* msg = MakeMsgBlock(mb, CLIENTEVENT_CMD_MYSELF_KICKED,
-                                     channelid, user? __USER : __NONE);
+    TTMessage msg;
+    InitMsg(msg, CLIENTEVENT_CMD_MYSELF_KICKED, channelid, user? __USER : __NONE);
     if(user)
-        Convert(*user, *msg->user);
-    EnqueueMsg(mb);
+        Convert(*user, msg.user);
+    EnqueueMsg(msg);
 }
 
 void TTMsgQueue::OnServerUpdate(const teamtalk::ServerInfo& serverinfo)
 {
-    ACE_Message_Block* mb = nullptr;
-    IntTTMessage* msg = MakeMsgBlock(mb, CLIENTEVENT_CMD_SERVER_UPDATE,
-                                     0, __SERVERPROPERTIES);
-    Convert(serverinfo, *msg->serverproperties);
-    EnqueueMsg(mb);
+    TTMessage msg;
+    InitMsg(msg, CLIENTEVENT_CMD_SERVER_UPDATE, 0, __SERVERPROPERTIES);
+    Convert(serverinfo, msg.serverproperties);
+    EnqueueMsg(msg);
 }
 
 void TTMsgQueue::OnServerStatistics(const teamtalk::ServerStats& serverstats)
 {
-    ACE_Message_Block* mb = nullptr;
-    IntTTMessage* msg = MakeMsgBlock(mb, CLIENTEVENT_CMD_SERVERSTATISTICS,
-                                     0, __SERVERSTATISTICS);
-    Convert(serverstats, *msg->serverstatistics);
-    EnqueueMsg(mb);
+    TTMessage msg;
+    InitMsg(msg, CLIENTEVENT_CMD_SERVERSTATISTICS, 0, __SERVERSTATISTICS);
+    Convert(serverstats, msg.serverstatistics);
+    EnqueueMsg(msg);
 }
 
 
 void TTMsgQueue::OnFileTransferStatus(const teamtalk::FileTransfer& transfer)
 {
-    ACE_Message_Block* mb = nullptr;
-    IntTTMessage* msg = MakeMsgBlock(mb, CLIENTEVENT_FILETRANSFER,
-                                     0, __FILETRANSFER);
-    Convert(transfer, *msg->filetransfer);
-    EnqueueMsg(mb);
+    TTMessage msg;
+    InitMsg(msg, CLIENTEVENT_FILETRANSFER, 0, __FILETRANSFER);
+    Convert(transfer, msg.filetransfer);
+    EnqueueMsg(msg);
 }
 
 void TTMsgQueue::OnCommandProcessing(int cmdid, bool begin_end)
 {
-    ACE_Message_Block* mb = nullptr;
-    IntTTMessage* msg = MakeMsgBlock(mb, CLIENTEVENT_CMD_PROCESSING,
-                                     cmdid, __TTBOOL);
-    *msg->active = static_cast<TTBOOL>(!begin_end);
-    EnqueueMsg(mb);
+    TTMessage msg;
+    InitMsg(msg, CLIENTEVENT_CMD_PROCESSING, cmdid, __TTBOOL);
+    msg.bActive = static_cast<TTBOOL>(!begin_end);
+    EnqueueMsg(msg);
 }
 
 void TTMsgQueue::OnCommandError(int cmdid, int err_num, const ACE_TString& msg_)
 {
-    ACE_Message_Block* mb = nullptr;
-    IntTTMessage* msg = MakeMsgBlock(mb, CLIENTEVENT_CMD_ERROR,
-                                     cmdid, __CLIENTERRORMSG);
-    msg->clienterrmsg->nErrorNo = err_num;
-    ACE_OS::strsncpy(msg->clienterrmsg->szErrorMsg, msg_.c_str(), TT_STRLEN);
-    EnqueueMsg(mb);
+    TTMessage msg;
+    InitMsg(msg, CLIENTEVENT_CMD_ERROR, cmdid, __CLIENTERRORMSG);
+    msg.clienterrormsg.nErrorNo = err_num;
+    ACE_OS::strsncpy(msg.clienterrormsg.szErrorMsg, msg_.c_str(), TT_STRLEN);
+    EnqueueMsg(msg);
 }
 
 void TTMsgQueue::OnCommandSuccess(int cmdid)
 {
-    ACE_Message_Block* mb = nullptr;
-    IntTTMessage* msg = MakeMsgBlock(mb, CLIENTEVENT_CMD_SUCCESS,
-                                     cmdid, __NONE);
-    EnqueueMsg(mb);
-    ACE_UNUSED_ARG(msg);
+    TTMessage msg;
+    InitMsg(msg, CLIENTEVENT_CMD_SUCCESS, cmdid, __NONE);
+    EnqueueMsg(msg);
 }
 
 void TTMsgQueue::OnInternalError(int errorno, const ACE_TString& msg_)
 {
-    ACE_Message_Block* mb = nullptr;
-    IntTTMessage* msg = MakeMsgBlock(mb, CLIENTEVENT_INTERNAL_ERROR,
-                                     0, __CLIENTERRORMSG);
-    msg->clienterrmsg->nErrorNo = errorno;
-    ACE_OS::strsncpy(msg->clienterrmsg->szErrorMsg, msg_.c_str(), TT_STRLEN);
-    EnqueueMsg(mb);
+    TTMessage msg;
+    InitMsg(msg, CLIENTEVENT_INTERNAL_ERROR, 0, __CLIENTERRORMSG);
+    msg.clienterrormsg.nErrorNo = errorno;
+    ACE_OS::strsncpy(msg.clienterrormsg.szErrorMsg, msg_.c_str(), TT_STRLEN);
+    EnqueueMsg(msg);
 }
 
 void TTMsgQueue::OnVoiceActivated(bool enabled)
 {
-    ACE_Message_Block* mb = nullptr;
-    IntTTMessage* msg = MakeMsgBlock(mb, CLIENTEVENT_VOICE_ACTIVATION,
-                                     0, __TTBOOL);
-    *msg->active = static_cast<TTBOOL>(enabled);
-    EnqueueMsg(mb);
+    TTMessage msg;
+    InitMsg(msg, CLIENTEVENT_VOICE_ACTIVATION, 0, __TTBOOL);
+    msg.bActive = static_cast<TTBOOL>(enabled);
+    EnqueueMsg(msg);
 }
 
 void TTMsgQueue::OnUserFirstStreamVoicePacket(const teamtalk::ClientUser& user, int streamid)
 {
-    ACE_Message_Block* mb = nullptr;
-    IntTTMessage* msg = MakeMsgBlock(mb, CLIENTEVENT_USER_FIRSTVOICESTREAMPACKET,
-        streamid, __USER);
-    Convert(user, *msg->user);
-    EnqueueMsg(mb);
+    TTMessage msg;
+    InitMsg(msg, CLIENTEVENT_USER_FIRSTVOICESTREAMPACKET, streamid, __USER);
+    Convert(user, msg.user);
+    EnqueueMsg(msg);
 }
 
 void TTMsgQueue::OnUserStateChange(const teamtalk::ClientUser& user)
 {
-    ACE_Message_Block* mb = nullptr;
-    IntTTMessage* msg = MakeMsgBlock(mb, CLIENTEVENT_USER_STATECHANGE,
-                                     0, __USER);
-    Convert(user, *msg->user);
-    EnqueueMsg(mb);
+    TTMessage msg;
+    InitMsg(msg, CLIENTEVENT_USER_STATECHANGE, 0, __USER);
+    Convert(user, msg.user);
+    EnqueueMsg(msg);
+}
+
+void TTMsgQueue::OnUserChanged(const teamtalk::ClientUser& user, uint32_t changes)
+{
+    TTMessage msg;
+    InitMsg(msg, CLIENTEVENT_USER_STATECHANGE, INT32(changes), __USER);
+    Convert(user, msg.user);
+    EnqueueMsg(msg);
 }
 
 void TTMsgQueue::OnUserVideoCaptureFrame(int userid, int stream_id)
 {
-    ACE_Message_Block* mb = nullptr;
-    IntTTMessage* msg = MakeMsgBlock(mb, CLIENTEVENT_USER_VIDEOCAPTURE,
-                                     userid, __INT32);
-    *msg->stream_id = stream_id;
-    EnqueueMsg(mb);
+    TTMessage msg;
+    InitMsg(msg, CLIENTEVENT_USER_VIDEOCAPTURE, userid, __INT32);
+    msg.nStreamID = stream_id;
+    EnqueueMsg(msg);
 }
 
 void TTMsgQueue::OnUserMediaFileVideoFrame(int userid, int stream_id)
 {
-    ACE_Message_Block* mb = nullptr;
-    IntTTMessage* msg = MakeMsgBlock(mb, CLIENTEVENT_USER_MEDIAFILE_VIDEO,
-                                     userid, __INT32);
-    *msg->stream_id = stream_id;
-    EnqueueMsg(mb);
+    TTMessage msg;
+    InitMsg(msg, CLIENTEVENT_USER_MEDIAFILE_VIDEO, userid, __INT32);
+    msg.nStreamID = stream_id;
+    EnqueueMsg(msg);
 }
 
 void TTMsgQueue::OnDesktopTransferUpdate(int session_id, int remain_bytes)
 {
-    ACE_Message_Block* mb = nullptr;
-    IntTTMessage* msg = MakeMsgBlock(mb, CLIENTEVENT_DESKTOPWINDOW_TRANSFER,
-                                     session_id, __INT32);
-    *msg->bytesremain = remain_bytes;
-    EnqueueMsg(mb);
+    TTMessage msg;
+    InitMsg(msg, CLIENTEVENT_DESKTOPWINDOW_TRANSFER, session_id, __INT32);
+    msg.nBytesRemain = remain_bytes;
+    EnqueueMsg(msg);
 }
 
 void TTMsgQueue::OnUserDesktopWindow(int userid, int session_id)
 {
-    ACE_Message_Block* mb = nullptr;
-    IntTTMessage* msg = MakeMsgBlock(mb, CLIENTEVENT_USER_DESKTOPWINDOW,
-                                     userid, __INT32);
-    *msg->stream_id = session_id;
-    EnqueueMsg(mb);
+    TTMessage msg;
+    InitMsg(msg, CLIENTEVENT_USER_DESKTOPWINDOW, userid, __INT32);
+    msg.nStreamID = session_id;
+    EnqueueMsg(msg);
 }
 
 void TTMsgQueue::OnUserDesktopCursor(int src_userid, const teamtalk::DesktopInput& input)
 {
-    ACE_Message_Block* mb = nullptr;
-    IntTTMessage* msg = MakeMsgBlock(mb, CLIENTEVENT_USER_DESKTOPCURSOR,
-                                     src_userid, __DESKTOPINPUT);
-    Convert(input, *msg->desktopinput);
-    EnqueueMsg(mb);
+    TTMessage msg;
+    InitMsg(msg, CLIENTEVENT_USER_DESKTOPCURSOR, src_userid, __DESKTOPINPUT);
+    Convert(input, msg.desktopinput);
+    EnqueueMsg(msg);
 }
 
 void TTMsgQueue::OnUserDesktopInput(int src_userid, const teamtalk::DesktopInput& input)
 {
-    ACE_Message_Block* mb = nullptr;
-    IntTTMessage* msg = MakeMsgBlock(mb, CLIENTEVENT_USER_DESKTOPINPUT,
-                                     src_userid, __DESKTOPINPUT);
-    Convert(input, *msg->desktopinput);
-    EnqueueMsg(mb);
+    TTMessage msg;
+    InitMsg(msg, CLIENTEVENT_USER_DESKTOPINPUT, src_userid, __DESKTOPINPUT);
+    Convert(input, msg.desktopinput);
+    EnqueueMsg(msg);
 }
 
 void TTMsgQueue::OnChannelStreamMediaFile(const MediaFileProp& mfp,
                                           teamtalk::MediaFileStatus status)
 {
-    ACE_Message_Block* mb = nullptr;
-    IntTTMessage* msg = MakeMsgBlock(mb, CLIENTEVENT_STREAM_MEDIAFILE,
-                                     0, __MEDIAFILEINFO);
-    Convert(mfp, *msg->mediafileinfo);
-    msg->mediafileinfo->nStatus = (MediaFileStatus)status;
-    EnqueueMsg(mb);
+    TTMessage msg;
+    InitMsg(msg, CLIENTEVENT_STREAM_MEDIAFILE, 0, __MEDIAFILEINFO);
+    Convert(mfp, msg.mediafileinfo);
+    msg.mediafileinfo.nStatus = (MediaFileStatus)status;
+    EnqueueMsg(msg);
 }
 
 void TTMsgQueue::OnLocalMediaFilePlayback(int sessionid, const MediaFileProp& mfp,
                                           teamtalk::MediaFileStatus status)
 {
-    ACE_Message_Block* mb = nullptr;
-    IntTTMessage* msg = MakeMsgBlock(mb, CLIENTEVENT_LOCAL_MEDIAFILE,
-        sessionid, __MEDIAFILEINFO);
-    Convert(mfp, *msg->mediafileinfo);
-    msg->mediafileinfo->nStatus = (MediaFileStatus)status;
-    EnqueueMsg(mb);
+    TTMessage msg;
+    InitMsg(msg, CLIENTEVENT_LOCAL_MEDIAFILE, sessionid, __MEDIAFILEINFO);
+    Convert(mfp, msg.mediafileinfo);
+    msg.mediafileinfo.nStatus = (MediaFileStatus)status;
+    EnqueueMsg(msg);
 }
 
 void TTMsgQueue::OnAudioInputStatus(int voicestreamid, const AudioInputStatus& ais)
 {
-    ACE_Message_Block* mb = nullptr;
-    IntTTMessage* msg = MakeMsgBlock(mb, CLIENTEVENT_AUDIOINPUT,
-                                     voicestreamid, __AUDIOINPUTPROGRESS);
-    Convert(ais, *msg->audioinputprogress);
-    EnqueueMsg(mb);
+    TTMessage msg;
+    InitMsg(msg, CLIENTEVENT_AUDIOINPUT, voicestreamid, __AUDIOINPUTPROGRESS);
+    Convert(ais, msg.audioinputprogress);
+    EnqueueMsg(msg);
 }
 
 void TTMsgQueue::OnUserAudioBlock(int userid, teamtalk::StreamTypes sts)
 {
-    ACE_Message_Block* mb = nullptr;
-    IntTTMessage* msg = MakeMsgBlock(mb, CLIENTEVENT_USER_AUDIOBLOCK,
-                                     userid, __STREAMTYPE);
-    *msg->streamtype = (StreamType)sts;
-    EnqueueMsg(mb);
+    TTMessage msg;
+    InitMsg(msg, CLIENTEVENT_USER_AUDIOBLOCK, userid, __STREAMTYPE);
+    msg.nStreamType = (StreamType)sts;
+    EnqueueMsg(msg);
 }
 
 void TTMsgQueue::OnMTUQueryComplete(int payload_size)
 {
-    ACE_Message_Block* mb = nullptr;
-    IntTTMessage* msg = MakeMsgBlock(mb, CLIENTEVENT_CON_MAX_PAYLOAD_UPDATED,
-                                     0, __INT32);
-    *msg->payload_size = payload_size;
-    EnqueueMsg(mb);
+    TTMessage msg;
+    InitMsg(msg, CLIENTEVENT_CON_MAX_PAYLOAD_UPDATED, 0, __INT32);
+    msg.nPayloadSize = payload_size;
+    EnqueueMsg(msg);
 }
 
 //VoiceLogListener
@@ -669,40 +643,36 @@ void TTMsgQueue::OnMediaFileStatus(int userid,
                                    teamtalk::MediaFileStatus status,
                                    const teamtalk::VoiceLogFile& vlog)
 {
-    ACE_Message_Block* mb = nullptr;
-    IntTTMessage* msg = MakeMsgBlock(mb, CLIENTEVENT_USER_RECORD_MEDIAFILE,
-                                     userid, __MEDIAFILEINFO);
-    Convert(status, vlog, *msg->mediafileinfo);
-    EnqueueMsg(mb);
+    TTMessage msg;
+    InitMsg(msg, CLIENTEVENT_USER_RECORD_MEDIAFILE, userid, __MEDIAFILEINFO);
+    Convert(status, vlog, msg.mediafileinfo);
+    EnqueueMsg(msg);
 }
 
 /* HotKeyListener events */
 #if defined(WIN32)
 void TTMsgQueue::OnHotKeyActive(int hotkeyid)
 {
-    ACE_Message_Block* mb;
-    IntTTMessage* msg = MakeMsgBlock(mb, CLIENTEVENT_HOTKEY,
-                                     hotkeyid, __TTBOOL);
-    *msg->active = TRUE;
-    EnqueueMsg(mb);
+    TTMessage msg;
+    InitMsg(msg, CLIENTEVENT_HOTKEY, hotkeyid, __TTBOOL);
+    msg.bActive = TRUE;
+    EnqueueMsg(msg);
 }
 
 void TTMsgQueue::OnHotKeyInactive(int hotkeyid)
 {
-    ACE_Message_Block* mb;
-    IntTTMessage* msg = MakeMsgBlock(mb, CLIENTEVENT_HOTKEY,
-                                     hotkeyid, __TTBOOL);
-    *msg->active = FALSE;
-    EnqueueMsg(mb);
+    TTMessage msg;
+    InitMsg(msg, CLIENTEVENT_HOTKEY, hotkeyid, __TTBOOL);
+    msg.bActive = FALSE;
+    EnqueueMsg(msg);
 }
 
 void TTMsgQueue::OnKeyDown(UINT nVK)
 {
-    ACE_Message_Block* mb;
-    IntTTMessage* msg = MakeMsgBlock(mb, CLIENTEVENT_HOTKEY_TEST,
-                                    nVK, __TTBOOL);
-    *msg->active = TRUE;
-    EnqueueMsg(mb);
+    TTMessage msg;
+    InitMsg(msg, CLIENTEVENT_HOTKEY_TEST, nVK, __TTBOOL);
+    msg.bActive = TRUE;
+    EnqueueMsg(msg);
 
     if(m_hKeyWnd)
     {
@@ -712,11 +682,10 @@ void TTMsgQueue::OnKeyDown(UINT nVK)
 
 void TTMsgQueue::OnKeyUp(UINT nVK)
 {
-    ACE_Message_Block* mb;
-    IntTTMessage* msg = MakeMsgBlock(mb, CLIENTEVENT_HOTKEY_TEST,
-                                    nVK, __TTBOOL);
-    *msg->active = FALSE;
-    EnqueueMsg(mb);
+    TTMessage msg;
+    InitMsg(msg, CLIENTEVENT_HOTKEY_TEST, nVK, __TTBOOL);
+    msg.bActive = FALSE;
+    EnqueueMsg(msg);
 
     if(m_hKeyWnd)
     {
@@ -732,35 +701,34 @@ void TTMsgQueue::AudioDeviceChange(AudioDevEvent event, const LPCWSTR& name, con
     ACE_OS::strsncpy(snd.szDeviceName, name, TT_STRLEN);
     ACE_OS::strsncpy(snd.szDeviceID, id, TT_STRLEN);
 
-    ACE_Message_Block* mb = nullptr;
-    IntTTMessage* msg = nullptr;
+    TTMessage msg;
     switch (event)
     {
     case AUDIODEVICE_ADD :
-        msg = MakeMsgBlock(mb, CLIENTEVENT_SOUNDDEVICE_ADDED, 0, __SOUNDDEVICE);
+        InitMsg(msg, CLIENTEVENT_SOUNDDEVICE_ADDED, 0, __SOUNDDEVICE);
         break;
     case AUDIODEVICE_REMOVE :
-        msg = MakeMsgBlock(mb, CLIENTEVENT_SOUNDDEVICE_REMOVED, 0, __SOUNDDEVICE);
+        InitMsg(msg, CLIENTEVENT_SOUNDDEVICE_REMOVED, 0, __SOUNDDEVICE);
         break;
     case AUDIODEVICE_UNPLUGGED:
-        msg = MakeMsgBlock(mb, CLIENTEVENT_SOUNDDEVICE_UNPLUGGED, 0, __SOUNDDEVICE);
+        InitMsg(msg, CLIENTEVENT_SOUNDDEVICE_UNPLUGGED, 0, __SOUNDDEVICE);
         break;
     case AUDIODEVICE_NEW_DEFAULT_INPUT :
-        msg = MakeMsgBlock(mb, CLIENTEVENT_SOUNDDEVICE_NEW_DEFAULT_INPUT, 0, __SOUNDDEVICE);
+        InitMsg(msg, CLIENTEVENT_SOUNDDEVICE_NEW_DEFAULT_INPUT, 0, __SOUNDDEVICE);
         break;
     case AUDIODEVICE_NEW_DEFAULT_OUTPUT :
-        msg = MakeMsgBlock(mb, CLIENTEVENT_SOUNDDEVICE_NEW_DEFAULT_OUTPUT, 0, __SOUNDDEVICE);
+        InitMsg(msg, CLIENTEVENT_SOUNDDEVICE_NEW_DEFAULT_OUTPUT, 0, __SOUNDDEVICE);
         break;
     case AUDIODEVICE_NEW_DEFAULT_INPUT_COMDEVICE:
-        msg = MakeMsgBlock(mb, CLIENTEVENT_SOUNDDEVICE_NEW_DEFAULT_INPUT_COMDEVICE, 0, __SOUNDDEVICE);
+        InitMsg(msg, CLIENTEVENT_SOUNDDEVICE_NEW_DEFAULT_INPUT_COMDEVICE, 0, __SOUNDDEVICE);
         break;
     case AUDIODEVICE_NEW_DEFAULT_OUTPUT_COMDEVICE:
-        msg = MakeMsgBlock(mb, CLIENTEVENT_SOUNDDEVICE_NEW_DEFAULT_OUTPUT_COMDEVICE, 0, __SOUNDDEVICE);
+        InitMsg(msg, CLIENTEVENT_SOUNDDEVICE_NEW_DEFAULT_OUTPUT_COMDEVICE, 0, __SOUNDDEVICE);
         break;
     }
 
-    *msg->sounddevice = snd;
-    EnqueueMsg(mb);
+    msg.sounddevice = snd;
+    EnqueueMsg(msg);
 }
 
 #endif /* WIN32 */
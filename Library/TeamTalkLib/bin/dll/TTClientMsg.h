@@ -30,6 +30,7 @@
 #include "avstream/AudioInputStreamer.h"
 #include "avstream/MediaStreamer.h"
 #include "myace/MyACE.h"
+#include "mystd/MyStd.h"
 #include "teamtalk/Common.h"
 #include "teamtalk/client/Client.h"
 #include "teamtalk/client/ClientChannel.h"
@@ -46,6 +47,8 @@
 #include <ace/Message_Block.h>
 #include <ace/Time_Value.h>
 
+#include <atomic>
+#include <condition_variable>
 #include <mutex>
 
 class TTMsgQueue
@@ -54,10 +57,20 @@ class TTMsgQueue
     , public HotKeyListener
 #endif
 {
+    // Events are copied into preallocated slots. Producers are
+    // serialized by 'm_mutex' but the consumer only takes it when
+    // events have spilled or when it waits
+    SPSCRing<TTMessage> m_ring;
+    // events which didn't fit in 'm_ring'. The ring isn't used
+    // until this is empty again so events stay in order
     msg_queue_t m_event_queue;
+    std::atomic<size_t> m_spilled{0};
     teamtalk::EventSuspender* m_suspender;
     bool m_suspended = false;
     std::mutex m_mutex;
+    std::condition_variable m_signal;
+    // serializes callers of GetMessages()
+    std::mutex m_read_mutex;
 #if defined(WIN32)
     HWND m_hKeyWnd;
     HWND m_hWnd;
@@ -65,7 +78,10 @@ class TTMsgQueue
     UINT m_EventHKeyWndMsg;
 #endif
     void InitMsgQueue();
-    void EnqueueMsg(ACE_Message_Block* mb);
+    void EnqueueMsg(const TTMessage& msg);
+    // return true if event handling should be suspended
+    bool SpillMsg(const TTMessage& msg, size_t msgsize);
+    int ReadMessages(TTMessage* msgs, int count, bool& resume);
 
 public:
     TTMsgQueue();
@@ -76,7 +92,9 @@ public:
 #endif
     ~TTMsgQueue() override;
 
-    TTBOOL GetMessage(TTMessage& msg, ACE_Time_Value* tv);
+    // Copy up to 'count' events to 'msgs'. If there are no events
+    // then wait 'waitms' msec (-1 means forever). Returns events copied
+    int GetMessages(TTMessage* msgs, int count, int waitms);
 
     TTBOOL IsSuspended() const { return static_cast<TTBOOL>(m_suspended); }
 
@@ -136,6 +154,7 @@ public:
 
     void OnUserFirstStreamVoicePacket(const teamtalk::ClientUser& user, int streamid) override;
     void OnUserStateChange(const teamtalk::ClientUser& user) override;
+    void OnUserChanged(const teamtalk::ClientUser& user, uint32_t changes) override;
     void OnUserVideoCaptureFrame(int userid, int stream_id) override;
     void OnUserMediaFileVideoFrame(int userid, int stream_id) override;
 
@@ -27,6 +27,7 @@
 #include "Convert.h"
 #include "TTClientMsg.h"
 
+#include "avstream/AudioResampler.h"
 #include "avstream/MediaStreamer.h"
 #include "avstream/SoundLoopback.h"
 #include "avstream/SoundSystem.h"
@@ -108,6 +109,10 @@ extern ACE_TString g_lpszRegName;
 extern ACE_TString g_lpszRegKey;
 extern bool g_LicenseValid;
 
+// threads shared by new instances, see TT_SetSharedEventLoop()
+static teamtalk::ClientSharedPools shared_pools;
+static std::mutex shared_pools_mutex;
+
 struct ClientInstance
 {
     std::shared_ptr<TTMsgQueue> eventhandler;
@@ -230,7 +235,12 @@ struct ClientInstance
 #endif
         
         eventhandler.reset(eh);
-        clientnode = std::make_shared<ClientNode>(ACE_TEXT( TEAMTALK_VERSION ), eh);
+        teamtalk::ClientSharedPools shared;
+        {
+            std::lock_guard<std::mutex> const g(shared_pools_mutex);
+            shared = shared_pools;
+        }
+        clientnode = std::make_shared<ClientNode>(ACE_TEXT( TEAMTALK_VERSION ), eh, shared);
 
 #if defined(WIN32)
         RegisterAudioDeviceChange(eh, std::bind(&TTMsgQueue::AudioDeviceChange, eh, _1, _2, _3), true);
@@ -415,6 +425,27 @@ TEAMTALKDLL_API TTInstance* TT_InitTeamTalkPoll(void)
     return inst.get();
 }
 
+TEAMTALKDLL_API TTBOOL TT_SetSharedEventLoop(IN INT32 nEventLoopThreads,
+                                             IN INT32 nWorkerThreads)
+{
+    if (nEventLoopThreads < 0 || nWorkerThreads < 0)
+        return FALSE;
+
+    teamtalk::ClientSharedPools pools;
+    if (nEventLoopThreads > 0)
+    {
+        pools.eventloops = std::make_shared<teamtalk::ReactorPool>(nEventLoopThreads);
+        pools.encoders = std::make_shared<teamtalk::EncodePool>(nWorkerThreads);
+        pools.timers = std::make_shared<teamtalk::ReactorPool>(pools.encoders->GetWorkersCount());
+        pools.decoders = std::make_shared<teamtalk::AudioDecodePool>();
+    }
+
+    // existing instances keep the threads they were created with
+    std::lock_guard<std::mutex> const g(shared_pools_mutex);
+    shared_pools = pools;
+    return TRUE;
+}
+
 TEAMTALKDLL_API TTBOOL TT_CloseTeamTalk(IN TTInstance* lpTTInstance)
 {
     auto inst = GetClient(lpTTInstance);
@@ -552,6 +583,20 @@ TEAMTALKDLL_API TTBOOL TT_RestartSoundSystem(void)
     return static_cast<TTBOOL>(soundsystem::GetInstance()->RestartSoundSystem());
 }
 
+TEAMTALKDLL_API TTBOOL TT_SetResamplerType(IN ResamplerType nResamplerType)
+{
+    switch (nResamplerType)
+    {
+    case RESAMPLERTYPE_DEFAULT :
+        SetAudioResamplerType(AUDIORESAMPLER_DEFAULT);
+        return TRUE;
+    case RESAMPLERTYPE_POLYPHASE :
+        SetAudioResamplerType(AUDIORESAMPLER_POLYPHASE);
+        return TRUE;
+    }
+    return FALSE;
+}
+
 TEAMTALKDLL_API TTSoundLoop* TT_StartSoundLoopbackTest(IN INT32 nInputDeviceID, 
                                                        IN INT32 nOutputDeviceID,
                                                        IN INT32 nSampleRate,
@@ -774,6 +819,14 @@ TEAMTALKDLL_API TTBOOL TT_CloseSoundOutputDevice(IN TTInstance* lpTTInstance)
     return static_cast<TTBOOL>(clientnode->CloseSoundOutputDevice());
 }
 
+TEAMTALKDLL_API TTBOOL TT_EnableSoundOutputMixer(IN TTInstance* lpTTInstance,
+                                                 IN TTBOOL bEnable)
+{
+    clientnode_t clientnode;
+    GET_CLIENTNODE_RET(clientnode, lpTTInstance, FALSE);
+    return static_cast<TTBOOL>(clientnode->EnableSoundOutputMixer(bEnable != FALSE));
+}
+
 TEAMTALKDLL_API TTBOOL TT_CloseSoundDuplexDevices(IN TTInstance* lpTTInstance)
 {
     clientnode_t clientnode;
@@ -1060,6 +1113,15 @@ TEAMTALKDLL_API TTBOOL TT_StopRecordingMuxedAudioFileEx(IN TTInstance* lpTTInsta
     return TRUE;
 }
 
+TEAMTALKDLL_API TTBOOL TT_SetRecordingMemoryLimit(IN TTInstance* lpTTInstance,
+                                                  IN INT32 nMaxBytes)
+{
+    clientnode_t clientnode;
+    GET_CLIENTNODE_RET(clientnode, lpTTInstance, FALSE);
+
+    return static_cast<TTBOOL>(clientnode->SetRecordingMemoryLimit(nMaxBytes));
+}
+
 TEAMTALKDLL_API TTBOOL TT_StartVideoCaptureTransmission(IN TTInstance* lpTTInstance,
                                                         IN const VideoCodec* lpVideoCodec)
 {
@@ -1234,6 +1296,13 @@ TEAMTALKDLL_API TTBOOL TT_PaintVideoFrameEx(IN HDC hDC,
 
 TEAMTALKDLL_API VideoFrame* TT_AcquireUserVideoCaptureFrame(IN TTInstance* lpTTInstance,
                                                             IN INT32 nUserID)
+{
+    return TT_AcquireUserVideoCaptureFrameEx(lpTTInstance, nUserID, FOURCC_RGB32);
+}
+
+TEAMTALKDLL_API VideoFrame* TT_AcquireUserVideoCaptureFrameEx(IN TTInstance* lpTTInstance,
+                                                              IN INT32 nUserID,
+                                                              IN FourCC nFourCC)
 {
     clientnode_t clientnode;
     GET_CLIENTNODE_RET(clientnode, lpTTInstance, FALSE);
@@ -1244,8 +1313,21 @@ TEAMTALKDLL_API VideoFrame* TT_AcquireUserVideoCaptureFrame(IN TTInstance* lpTTI
 
     ACE_Message_Block* mb = nullptr;
 
+    switch (nFourCC)
+    {
+    case FOURCC_RGB32 :
+    case FOURCC_I420 :
+        break;
+    default :
+        return nullptr;
+    }
+
     if(nUserID == 0)
     {
+        //local video capture frames are always RGB32
+        if (nFourCC != FOURCC_RGB32)
+            return nullptr;
+
         mb = clientnode->AcquireVideoCaptureFrame();
         if(mb == nullptr)
             return nullptr;
@@ -1257,7 +1339,7 @@ TEAMTALKDLL_API VideoFrame* TT_AcquireUserVideoCaptureFrame(IN TTInstance* lpTTI
         if(!user)
             return nullptr;
         g.release(); //don't hold lock while decoding
-        mb = user->GetVideoCaptureFrame();
+        mb = user->GetVideoCaptureFrame(media::FourCC(nFourCC));
         g.acquire();
     }
 
@@ -1421,6 +1503,29 @@ TEAMTALKDLL_API TTBOOL TT_SetClientKeepAlive(IN TTInstance* lpTTInstance,
     return TRUE;
 }
 
+TEAMTALKDLL_API TTBOOL TT_SetUserEventCoalescing(IN TTInstance* lpTTInstance,
+                                                 IN INT32 nWindowMSec)
+{
+    clientnode_t clientnode;
+    GET_CLIENTNODE_RET(clientnode, lpTTInstance, FALSE);
+
+    if (nWindowMSec < 0)
+        return FALSE;
+
+    clientnode->SetUserEventCoalescing(ToTimeValue(nWindowMSec));
+    return TRUE;
+}
+
+TEAMTALKDLL_API TTBOOL TT_EnableLatencyTracing(IN TTInstance* lpTTInstance,
+                                               IN TTBOOL bEnable)
+{
+    clientnode_t clientnode;
+    GET_CLIENTNODE_RET(clientnode, lpTTInstance, FALSE);
+
+    clientnode->SetLatencyTracing(bEnable != FALSE);
+    return TRUE;
+}
+
 TEAMTALKDLL_API TTBOOL TT_GetClientKeepAlive(IN TTInstance* lpTTInstance,
                                              OUT ClientKeepAlive* lpClientKeepAlive)
 {
@@ -3688,18 +3793,35 @@ TEAMTALKDLL_API TTBOOL TT_GetMessage(IN TTInstance* lpTTInstance,
     auto inst = GetClient(lpTTInstance);
     if(inst && (pMsg != nullptr))
     {
-        if((pnWaitMs != nullptr) && *pnWaitMs != -1)
-        {
-            ACE_Time_Value tv(*pnWaitMs/1000, (*pnWaitMs % 1000) * 1000);
-            tv += ACE_OS::gettimeofday();
-            return inst->eventhandler->GetMessage(*pMsg, &tv);
-        }
-
-        return inst->eventhandler->GetMessage(*pMsg, nullptr);
+        int const waitms = (pnWaitMs == nullptr || *pnWaitMs == -1) ? -1 : std::max(*pnWaitMs, 0);
+        return static_cast<TTBOOL>(inst->eventhandler->GetMessages(pMsg, 1, waitms) > 0);
     }
     return FALSE;
 }
 
+TEAMTALKDLL_API TTBOOL TT_GetMessages(IN TTInstance* lpTTInstance,
+                                      OUT TTMessage* pMsgs,
+                                      IN OUT INT32* pnCount,
+                                      IN INT32 nWaitMSec)
+{
+    if (pMsgs == nullptr || pnCount == nullptr || *pnCount <= 0)
+        return FALSE;
+
+    if (!g_LicenseValid)
+    {
+        *pnCount = 1;
+        return TT_GetMessage(lpTTInstance, pMsgs, &nWaitMSec);
+    }
+
+    auto inst = GetClient(lpTTInstance);
+    if (!inst)
+        return FALSE;
+
+    int const waitms = nWaitMSec == -1 ? -1 : std::max(nWaitMSec, 0);
+    *pnCount = inst->eventhandler->GetMessages(pMsgs, *pnCount, waitms);
+    return static_cast<TTBOOL>(*pnCount > 0);
+}
+
 TEAMTALKDLL_API TTBOOL TT_PumpMessage(IN TTInstance* lpTTInstance,
                                       IN ClientEvent nEvent,
                                       IN INT32 nIdentifier)
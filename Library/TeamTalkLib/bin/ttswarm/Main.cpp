@@ -0,0 +1,464 @@
+/*
+ * Copyright (c) 2005-2018, BearWare.dk
+ *
+ * Contact Information:
+ *
+ * Bjoern D. Rasmussen
+ * Kirketoften 5
+ * DK-8260 Viby J
+ * Denmark
+ * Email: contact@bearware.dk
+ * Phone: +45 20 20 54 59
+ * Web: http://www.bearware.dk
+ *
+ * This source code is part of the TeamTalk SDK owned by
+ * BearWare.dk. Use of this file, or its compiled unit, requires a
+ * TeamTalk SDK License Key issued by BearWare.dk.
+ *
+ * The TeamTalk SDK License Agreement along with its Terms and
+ * Conditions are outlined in the file License.txt included with the
+ * TeamTalk SDK distribution.
+ *
+ */
+
+// ttswarm runs a TeamTalk server in-process and connects a swarm of
+// protocol level clients to it. The clients log in, join channels,
+// churn between channels and transmit synthetic voice, video and
+// desktop packets. The report shows forwarding throughput, server CPU
+// time and latency percentiles so server changes can be compared at
+// realistic scale.
+
+#include "SwarmClient.h"
+#include "SwarmStats.h"
+
+#include "TeamTalkDefs.h"
+#include "bin/ttsrv/AppInfo.h"
+#include "bin/ttsrv/ServerConfig.h"
+#include "bin/ttsrv/ServerGuard.h"
+#include "bin/ttsrv/ServerXML.h"
+#include "myace/MyACE.h"
+#include "teamtalk/server/ServerNode.h"
+
+#include <ace/High_Res_Timer.h>
+#include <ace/Init_ACE.h>
+#include <ace/Select_Reactor.h>
+#include <ace/Timer_Heap.h>
+#if defined(ACE_HAS_EVENT_POLL) || defined(ACE_HAS_DEV_POLL)
+#include <ace/Dev_Poll_Reactor.h>
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#if defined(WIN32)
+#undef CreateFile
+#endif
+
+using namespace std;
+using namespace teamtalk;
+
+#define SWARM_XML_FILE "ttswarm.xml"
+
+struct SwarmOptions
+{
+    int clients = 1000;
+    int channels = 0;
+    int workers = 0;
+    double voice = 0.1, video = 0.02, desktop = 0.01;
+    double churn = 0.5;
+    int ramp = 200;
+    int duration = 30;
+    int report = 5;
+    int tcpport = 11333, udpport = 11333;
+    bool select = false;
+    bool viewall = false;
+    bool verbose = false;
+};
+
+struct ReactorThread
+{
+    ACE_Reactor* reactor = nullptr;
+    ThreadCPUClock cpu;
+};
+
+static ACE_THR_FUNC_RETURN RunReactor(void* arg)
+{
+    auto* rt = static_cast<ReactorThread*>(arg);
+    rt->cpu.Attach();
+    return EventLoop(rt->reactor);
+}
+
+static void PrintCommandArgs()
+{
+    cout << "Usage: ttswarm [OPTIONS]" << endl;
+    cout << endl;
+    cout << "  -clients [number]  Number of clients to connect (default 1000)." << endl;
+    cout << "  -channels [number] Number of channels (default clients / 20)." << endl;
+    cout << "  -workers [number]  Number of client threads (default clients / 400)." << endl;
+    cout << "  -voice [ratio]     Share of clients transmitting voice (default 0.1)." << endl;
+    cout << "  -video [ratio]     Share of clients transmitting video (default 0.02)." << endl;
+    cout << "  -desktop [ratio]   Share of clients transmitting desktop (default 0.01)." << endl;
+    cout << "  -churn [number]    Channel switches per client per minute (default 0.5)." << endl;
+    cout << "  -ramp [number]     Connections per second (default 200)." << endl;
+    cout << "  -duration [sec]    Measurement time after ramp-up (default 30)." << endl;
+    cout << "  -report [sec]      Seconds between interim reports (default 5)." << endl;
+    cout << "  -tcpport [port]    Server TCP port (default 11333)." << endl;
+    cout << "  -udpport [port]    Server UDP port (default 11333)." << endl;
+    cout << "  -select            Use select reactor for server like " << TEAMTALK_NAME << "." << endl;
+    cout << "  -viewall           Clients see all users, i.e. O(n^2) notifications." << endl;
+    cout << "  -verbose           Show server log." << endl;
+}
+
+static bool ParseArguments(int argc, ACE_TCHAR* argv[], SwarmOptions& opts)
+{
+    std::map<ACE_TString,ACE_TString> args;
+
+    for(int i=1;i<argc;i++)
+    {
+        ACE_TString const str(argv[i]);
+        if (str == ACE_TEXT("-select") || str == ACE_TEXT("-viewall") ||
+            str == ACE_TEXT("-verbose") || str == ACE_TEXT("-h") ||
+            str == ACE_TEXT("--help"))
+        {
+            args[str] = ACE_TEXT("");
+            continue;
+        }
+        if(i+1 >= argc)
+        {
+            cerr << "Missing option for parameter " << str << endl;
+            return false;
+        }
+        args[str] = argv[++i];
+    }
+
+    if (args.contains(ACE_TEXT("-h")) || args.contains(ACE_TEXT("--help")))
+    {
+        PrintCommandArgs();
+        return false;
+    }
+
+    for (const auto& a : args)
+    {
+        const ACE_TString& name = a.first;
+        const ACE_TCHAR* value = a.second.c_str();
+        if (name == ACE_TEXT("-clients"))
+            opts.clients = int(String2I(value));
+        else if (name == ACE_TEXT("-channels"))
+            opts.channels = int(String2I(value));
+        else if (name == ACE_TEXT("-workers"))
+            opts.workers = int(String2I(value));
+        else if (name == ACE_TEXT("-voice"))
+            opts.voice = ACE_OS::strtod(value, nullptr);
+        else if (name == ACE_TEXT("-video"))
+            opts.video = ACE_OS::strtod(value, nullptr);
+        else if (name == ACE_TEXT("-desktop"))
+            opts.desktop = ACE_OS::strtod(value, nullptr);
+        else if (name == ACE_TEXT("-churn"))
+            opts.churn = ACE_OS::strtod(value, nullptr);
+        else if (name == ACE_TEXT("-ramp"))
+            opts.ramp = int(String2I(value));
+        else if (name == ACE_TEXT("-duration"))
+            opts.duration = int(String2I(value));
+        else if (name == ACE_TEXT("-report"))
+            opts.report = int(String2I(value));
+        else if (name == ACE_TEXT("-tcpport"))
+            opts.tcpport = int(String2I(value));
+        else if (name == ACE_TEXT("-udpport"))
+            opts.udpport = int(String2I(value));
+        else if (name == ACE_TEXT("-select"))
+            opts.select = true;
+        else if (name == ACE_TEXT("-viewall"))
+            opts.viewall = true;
+        else if (name == ACE_TEXT("-verbose"))
+            opts.verbose = true;
+        else
+        {
+            cerr << "Unknown parameter " << name << endl;
+            PrintCommandArgs();
+            return false;
+        }
+    }
+
+    if (opts.clients <= 0)
+    {
+        cerr << "Number of clients must be positive" << endl;
+        return false;
+    }
+    if (opts.channels <= 0)
+        opts.channels = std::max(1, opts.clients / 20);
+    if (opts.workers <= 0)
+        opts.workers = std::clamp(opts.clients / 400, 1, std::max(1, int(std::thread::hardware_concurrency())));
+    opts.report = std::max(opts.report, 1);
+    return true;
+}
+
+struct SwarmSample
+{
+    int64_t time = 0;
+    int64_t server_cpu = 0;
+    int64_t server_packets_sent = 0;
+    SwarmStats stats;
+};
+
+static void PrintReport(const char* title, const SwarmSample& from, const SwarmSample& to,
+                        int users_inchannel)
+{
+    double const secs = std::max(double(to.time - from.time) / 1000000.0, 0.001);
+    double const cpu = double(to.server_cpu - from.server_cpu) / 1000000.0;
+    const SwarmStats& s = to.stats;
+
+    int64_t rx = 0, tx = 0;
+    for (int m=0;m<SWARMMEDIA_COUNT;m++)
+    {
+        rx += s.packets_received[m] - from.stats.packets_received[m];
+        tx += s.packets_sent[m] - from.stats.packets_sent[m];
+    }
+
+    printf("%s: %d users in channel, %.0f pkt/s sent, %.0f pkt/s forwarded (server %.0f pkt/s)\n",
+           title, users_inchannel, double(tx) / secs, double(rx) / secs,
+           double(to.server_packets_sent - from.server_packets_sent) / secs);
+    printf("  server CPU %.1f%%, %.1f%% per 1000 users\n", 100.0 * cpu / secs,
+           users_inchannel > 0 ? 100.0 * cpu / secs * 1000.0 / users_inchannel : 0.0);
+
+    // latency histograms are reset when the measurement starts, so
+    // percentiles are always since then
+    for (int m=0;m<SWARMMEDIA_COUNT;m++)
+    {
+        const LatencyHistogram& h = s.forward_latency[m];
+        if (h.Count() == 0)
+            continue;
+        printf("  %-9s latency p50 %6.2f ms, p99 %6.2f ms, max %6.2f ms\n",
+               GetSwarmMediaName(SwarmMedia(m)), h.Percentile(0.5) / 1000.0,
+               h.Percentile(0.99) / 1000.0, h.Max() / 1000.0);
+    }
+    for (int c=0;c<SWARMCMD_COUNT;c++)
+    {
+        const LatencyHistogram& h = s.command_rtt[c];
+        if (h.Count() == 0)
+            continue;
+        printf("  %-9s RTT     p50 %6.2f ms, p99 %6.2f ms, max %6.2f ms\n",
+               GetSwarmCommandName(SwarmCommand(c)), h.Percentile(0.5) / 1000.0,
+               h.Percentile(0.99) / 1000.0, h.Max() / 1000.0);
+    }
+    printf("  %lld command errors, %lld rejoins\n",
+           (long long)s.command_errors, (long long)s.rejoins);
+    fflush(stdout);
+}
+
+int ACE_TMAIN(int argc, ACE_TCHAR* argv[])
+{
+    SwarmOptions opts;
+    if (!ParseArguments(argc, argv, opts))
+        return EXIT_FAILURE;
+
+    ACE::init();
+
+    //avoid SIGPIPE
+    ACE_Sig_Action no_sigpipe ((ACE_SignalHandler) SIG_IGN);
+    ACE_Sig_Action original_action;
+    no_sigpipe.register_action (SIGPIPE, &original_action);
+
+    ACE::set_handle_limit(-1);
+
+    if (!opts.verbose)
+        ACE_LOG_MSG->clr_flags(ACE_Log_Msg::STDERR);
+
+    ACE_Timer_Heap timerheap;
+    timerheap.set_time_policy(&ACE_High_Res_Timer::gettimeofday_hr);
+    std::unique_ptr<ACE_Reactor_Impl> reactorimpl;
+    const char* reactorname = "select";
+#if defined(ACE_HAS_EVENT_POLL) || defined(ACE_HAS_DEV_POLL)
+    // select is limited by FD_SETSIZE
+    if (!opts.select)
+    {
+        reactorimpl = std::make_unique<ACE_Dev_Poll_Reactor>(opts.clients + 64, true, nullptr, &timerheap);
+        reactorname = "poll";
+    }
+#endif
+    if (!reactorimpl)
+        reactorimpl = std::make_unique<ACE_Select_Reactor>(nullptr, &timerheap);
+    ACE_Reactor tcpReactor(reactorimpl.get());
+    ACE_Reactor udpReactor;
+
+    ServerXML xmlSettings(TEAMTALK_XML_ROOTNAME);
+    if (!xmlSettings.CreateFile(SWARM_XML_FILE))
+    {
+        cerr << "Failed to create " << SWARM_XML_FILE << endl;
+        return EXIT_FAILURE;
+    }
+
+    UserAccount account;
+    account.username = ACE_TEXT("swarm");
+    account.passwd = ACE_TEXT("swarm");
+    account.usertype = USERTYPE_DEFAULT;
+    account.userrights = USERRIGHT_DEFAULT;
+    if (!opts.viewall)
+        account.userrights &= ~USERRIGHT_VIEW_ALL_USERS;
+    xmlSettings.AddNewUser(account);
+
+    ServerGuard srvguard(xmlSettings);
+    ServerNode servernode(ACE_TEXT( TEAMTALK_VERSION ), &tcpReactor, &tcpReactor, &udpReactor, &srvguard);
+
+    ServerSettings prop = servernode.GetServerProperties();
+    statchannels_t channels;
+    if (!ReadServerProperties(xmlSettings, prop, channels))
+    {
+        cerr << "Failed to read server properties" << endl;
+        return EXIT_FAILURE;
+    }
+
+    prop.filesroot.clear();
+    prop.maxusers = opts.clients + 10;
+    prop.max_logins_per_ipaddr = 0;
+    prop.logindelay = 0;
+    prop.logevents = SERVERLOGEVENT_NONE;
+    prop.tcpaddrs = { ACE_INET_Addr(u_short(opts.tcpport), ACE_TEXT("127.0.0.1")) };
+    prop.udpaddrs = { ACE_INET_Addr(u_short(opts.udpport), ACE_TEXT("127.0.0.1")) };
+
+    if (!ConfigureServer(servernode, prop, channels))
+    {
+        cerr << "Failed to configure server" << endl;
+        return EXIT_FAILURE;
+    }
+
+    SwarmConfig config;
+    config.tcpaddr = prop.tcpaddrs.front();
+    config.udpaddr = prop.udpaddrs.front();
+    config.username = account.username;
+    config.password = account.passwd;
+    config.voice_ratio = opts.voice;
+    config.video_ratio = opts.video;
+    config.desktop_ratio = opts.desktop;
+    config.churn_per_min = opts.churn;
+    config.ramp_per_sec = std::max(1, opts.ramp / opts.workers);
+
+    {
+        GUARD_OBJ(&servernode, servernode.Lock());
+        serverchannel_t root = servernode.GetRootChannel();
+        for (int i=0;i<opts.channels;i++)
+        {
+            ChannelProp chanprop;
+            chanprop.channelid = 2 + i;
+            chanprop.parentid = root->GetChannelID();
+            chanprop.name = ACE_TEXT("Swarm ") + I2String(i);
+            chanprop.chantype = CHANNEL_PERMANENT;
+            chanprop.audiocodec = root->GetAudioCodec();
+            chanprop.audiocfg = root->GetAudioConfig();
+            if (servernode.MakeChannel(chanprop).errorno != TT_CMDERR_SUCCESS)
+            {
+                cerr << "Failed to create channel #" << chanprop.channelid << endl;
+                return EXIT_FAILURE;
+            }
+            config.channelids.push_back(chanprop.channelid);
+        }
+    }
+
+    if (!servernode.StartServer(false, SERVER_WELCOME))
+    {
+        cerr << "Failed to start server on TCP port " << opts.tcpport
+             << " and UDP port " << opts.udpport << endl;
+        return EXIT_FAILURE;
+    }
+
+    ReactorThread tcpthread, udpthread;
+    tcpthread.reactor = &tcpReactor;
+    udpthread.reactor = &udpReactor;
+    ACE_Thread_Manager::instance()->spawn(RunReactor, &tcpthread);
+    ACE_Thread_Manager::instance()->spawn(RunReactor, &udpthread);
+    SyncReactor(tcpReactor);
+    SyncReactor(udpReactor);
+
+    printf("%d clients in %d workers, %d channels, %s reactor\n",
+           opts.clients, opts.workers, opts.channels, reactorname);
+
+    std::vector< std::unique_ptr<SwarmWorker> > workers;
+    for (int w=0;w<opts.workers;w++)
+    {
+        int const first = opts.clients * w / opts.workers;
+        int const last = opts.clients * (w + 1) / opts.workers;
+        workers.push_back(std::make_unique<SwarmWorker>(config, first, last - first, unsigned(w + 1)));
+    }
+    for (auto& w : workers)
+        w->Start();
+
+    auto usersInChannel = [&workers]()
+    {
+        int n = 0;
+        for (auto& w : workers)
+            n += w->GetClientsCount(SwarmClient::SWARM_INCHANNEL);
+        return n;
+    };
+
+    auto sample = [&]()
+    {
+        SwarmSample s;
+        s.time = SwarmClock();
+        s.server_cpu = tcpthread.cpu.GetCPUTimeUsec() + udpthread.cpu.GetCPUTimeUsec();
+        {
+            GUARD_OBJ(&servernode, servernode.Lock());
+            s.server_packets_sent = servernode.GetServerStats().packets_sent;
+        }
+        for (auto& w : workers)
+            s.stats.Merge(w->GetStats());
+        return s;
+    };
+
+    // ramp up. Give up if clients stop making progress
+    int64_t const ramp_start = SwarmClock();
+    int inchannel = 0, last_inchannel = -1;
+    int64_t last_progress = ramp_start;
+    while ((inchannel = usersInChannel()) < opts.clients)
+    {
+        if (inchannel != last_inchannel)
+        {
+            last_inchannel = inchannel;
+            last_progress = SwarmClock();
+        }
+        else if (SwarmClock() - last_progress > 10000000)
+            break;
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+    printf("Ramp-up: %d of %d clients in channel after %.1f sec\n", inchannel, opts.clients,
+           double(SwarmClock() - ramp_start) / 1000000.0);
+
+    for (auto& w : workers)
+        w->ResetStats();
+
+    SwarmSample const start = sample();
+    SwarmSample prev = start;
+    int64_t const end = start.time + (int64_t(opts.duration) * 1000000);
+    while (SwarmClock() < end)
+    {
+        std::this_thread::sleep_for(std::chrono::seconds(std::min<int64_t>(opts.report, std::max<int64_t>((end - SwarmClock()) / 1000000, 1))));
+        SwarmSample const now = sample();
+        PrintReport("Interval", prev, now, usersInChannel());
+        prev = now;
+    }
+    PrintReport("Total", start, sample(), usersInChannel());
+
+    for (auto& w : workers)
+        w->Stop();
+    workers.clear();
+
+    tcpReactor.end_reactor_event_loop();
+    udpReactor.end_reactor_event_loop();
+    ACE_Thread_Manager::instance()->wait();
+
+    tcpReactor.owner(ACE_OS::thr_self());
+    udpReactor.owner(ACE_OS::thr_self());
+    servernode.StopServer();
+
+    udpReactor.close();
+    tcpReactor.close();
+
+    ACE::fini();
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,716 @@
+/*
+ * Copyright (c) 2005-2018, BearWare.dk
+ *
+ * Contact Information:
+ *
+ * Bjoern D. Rasmussen
+ * Kirketoften 5
+ * DK-8260 Viby J
+ * Denmark
+ * Email: contact@bearware.dk
+ * Phone: +45 20 20 54 59
+ * Web: http://www.bearware.dk
+ *
+ * This source code is part of the TeamTalk SDK owned by
+ * BearWare.dk. Use of this file, or its compiled unit, requires a
+ * TeamTalk SDK License Key issued by BearWare.dk.
+ *
+ * The TeamTalk SDK License Agreement along with its Terms and
+ * Conditions are outlined in the file License.txt included with the
+ * TeamTalk SDK distribution.
+ *
+ */
+
+#include "SwarmClient.h"
+
+#include "TeamTalkDefs.h"
+#include "myace/MyACE.h"
+#include "teamtalk/Common.h"
+
+#include <ace/OS_NS_errno.h>
+#include <ace/SOCK_Connector.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <set>
+
+using namespace teamtalk;
+
+// Opus at 32 kbit/s with 40 msec per packet
+constexpr auto SWARM_VOICE_INTERVAL_USEC = 40000;
+constexpr auto SWARM_VOICE_BYTES = 160;
+// VP8 320x240 at 15 fps and 256 kbit/s
+constexpr auto SWARM_VIDEO_INTERVAL_USEC = 66667;
+constexpr auto SWARM_VIDEO_BYTES = 2133;
+constexpr auto SWARM_VIDEO_FRAGMENT_BYTES = 1000;
+constexpr uint16_t SWARM_VIDEO_WIDTH = 320;
+constexpr uint16_t SWARM_VIDEO_HEIGHT = 240;
+// one updated block per second
+constexpr auto SWARM_DESKTOP_INTERVAL_USEC = 1000000;
+constexpr auto SWARM_DESKTOP_BYTES = 1000;
+constexpr uint16_t SWARM_DESKTOP_WIDTH = 64;
+constexpr uint16_t SWARM_DESKTOP_HEIGHT = 64;
+
+constexpr auto SWARM_HELLO_INTERVAL_USEC = 1000000;
+constexpr auto SWARM_KEEPALIVE_INTERVAL_USEC = 10000000;
+constexpr auto SWARM_RETRY_USEC = 1000000;
+constexpr auto SWARM_TICK_USEC = 10000;
+constexpr auto SWARM_UDP_RCVBUF = 256 * 1024;
+// max datagrams read per poll so a busy socket doesn't starve the rest
+constexpr auto SWARM_UDP_BATCH = 32;
+constexpr auto SWARM_STAMP_BYTES = int(sizeof(int64_t));
+
+#define GEN_NEXT_ID(id) (++(id) == 0 ? ++(id) : (id))
+
+namespace {
+
+int64_t NextInterval(int64_t next, int64_t interval, int64_t now)
+{
+    next += interval;
+    // don't burst to catch up after a stall
+    if (next < now)
+        next = now + interval;
+    return next;
+}
+
+#if defined(WIN32)
+SOCKET PollHandle(ACE_HANDLE h) { return reinterpret_cast<SOCKET>(h); }
+int PollSockets(pollfd* fds, size_t n, int msec) { return ::WSAPoll(fds, ULONG(n), msec); }
+#else
+int PollHandle(ACE_HANDLE h) { return h; }
+int PollSockets(pollfd* fds, size_t n, int msec) { return ::poll(fds, nfds_t(n), msec); }
+#endif
+
+} // namespace
+
+SwarmClient::SwarmClient(SwarmWorker& worker, int index, const SwarmConfig& config, std::mt19937& rng)
+    : m_worker(worker)
+    , m_config(config)
+    , m_rng(rng)
+    , m_index(index)
+{
+    std::uniform_real_distribution<double> share(0.0, 1.0);
+    m_tx_voice = share(m_rng) < m_config.voice_ratio;
+    m_tx_video = share(m_rng) < m_config.video_ratio;
+    m_tx_desktop = share(m_rng) < m_config.desktop_ratio;
+
+    m_payload.resize(std::max({SWARM_VOICE_BYTES, SWARM_VIDEO_BYTES, SWARM_DESKTOP_BYTES}));
+    std::uniform_int_distribution<int> byte(0, 255);
+    for (auto& b : m_payload)
+        b = char(byte(m_rng));
+}
+
+SwarmClient::~SwarmClient()
+{
+    m_stream.close();
+    m_dgram.close();
+}
+
+bool SwarmClient::Connect()
+{
+    assert(m_state == SWARM_DISCONNECTED);
+
+    ACE_SOCK_Connector connector;
+    ACE_Time_Value timeout(5, 0);
+    if (connector.connect(m_stream, m_config.tcpaddr, &timeout) < 0)
+    {
+        m_state = SWARM_FAILED;
+        return false;
+    }
+
+    ACE_INET_Addr const localaddr(u_short(0), m_config.udpaddr.get_host_addr());
+    if (m_dgram.open(localaddr, m_config.udpaddr.get_type()) < 0)
+    {
+        m_stream.close();
+        m_state = SWARM_FAILED;
+        return false;
+    }
+
+    int rcvbuf = SWARM_UDP_RCVBUF;
+    m_dgram.set_option(SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+    m_stream.enable(ACE_NONBLOCK);
+    m_dgram.enable(ACE_NONBLOCK);
+
+    m_state = SWARM_CONNECTED;
+    m_worker.Repoll();
+    return true;
+}
+
+void SwarmClient::Disconnect()
+{
+    if (m_stream.get_handle() != ACE_INVALID_HANDLE)
+        m_stream.close();
+    if (m_dgram.get_handle() != ACE_INVALID_HANDLE)
+        m_dgram.close();
+
+    if (m_state != SWARM_FAILED)
+        m_state = SWARM_DISCONNECTED;
+    m_userid = m_chanid = 0;
+    m_udp_ready = false;
+    m_pending.clear();
+    m_recvbuffer.clear();
+    m_worker.Repoll();
+}
+
+bool SwarmClient::HandleTcpInput()
+{
+    char buf[0x4000];
+    ssize_t const n = m_stream.recv(buf, sizeof(buf));
+    if (n == 0)
+        return false;
+    if (n < 0)
+        return errno == EWOULDBLOCK;
+
+    m_recvbuffer.append(buf, n);
+    ACE_CString cmd;
+    ACE_CString remain;
+    while (GetCmdLine(m_recvbuffer, cmd, remain))
+    {
+        ProcessCommand(cmd);
+        m_recvbuffer = remain;
+    }
+    return true;
+}
+
+void SwarmClient::ProcessCommand(const ACE_CString& cmdline)
+{
+    ACE_CString tmp_cmd;
+    if (!GetCmd(cmdline, tmp_cmd))
+        return;
+
+    ACE_TString const cmd = Utf8ToUnicode(tmp_cmd.c_str());
+
+    // the swarm only tracks command replies so skip parsing the rest,
+    // e.g. 'adduser' and 'joined' notifications
+    if (cmd != SERVER_BEGINCMD && cmd != SERVER_ENDCMD &&
+        cmd != SERVER_ERROR && cmd != SERVER_WELCOME)
+        return;
+
+    mstrings_t properties;
+    if (ExtractProperties(Utf8ToUnicode(cmdline.c_str()), properties) < 0)
+        return;
+
+    if (cmd == SERVER_WELCOME)
+    {
+        GetProperty(properties, TT_USERID, m_userid);
+        m_next_hello = m_next_keepalive = SwarmClock();
+        DoLogin();
+    }
+    else if (cmd == SERVER_BEGINCMD)
+    {
+        m_current_cmdid = 0;
+        m_current_error = false;
+        GetProperty(properties, TT_CMDID, m_current_cmdid);
+    }
+    else if (cmd == SERVER_ERROR)
+    {
+        m_current_error = true;
+    }
+    else if (cmd == SERVER_ENDCMD)
+    {
+        int cmdid = 0;
+        GetProperty(properties, TT_CMDID, cmdid);
+        HandleEndCmd(cmdid);
+        m_current_cmdid = 0;
+        m_current_error = false;
+    }
+}
+
+void SwarmClient::HandleEndCmd(int cmdid)
+{
+    auto i = m_pending.find(cmdid);
+    if (i == m_pending.end())
+        return;
+
+    auto const pending = i->second;
+    m_pending.erase(i);
+
+    int64_t const now = SwarmClock();
+    SwarmStats& stats = m_worker.Stats();
+    if (m_current_error)
+        stats.command_errors++;
+    else
+        stats.command_rtt[pending.type].Add(now - pending.sent);
+
+    switch (pending.type)
+    {
+    case SWARMCMD_LOGIN :
+        if (m_current_error)
+        {
+            m_state = SWARM_FAILED;
+            Disconnect();
+            break;
+        }
+        m_state = SWARM_LOGGEDIN;
+        DoJoin();
+        break;
+    case SWARMCMD_JOIN :
+        if (m_current_error)
+        {
+            m_state = SWARM_LOGGEDIN;
+            m_next_retry = now + SWARM_RETRY_USEC;
+            break;
+        }
+        m_state = SWARM_INCHANNEL;
+        m_chanid = m_join_chanid;
+        m_next_churn = NextChurn(now);
+
+        // new streams in new channel
+        m_streamid = uint8_t((m_streamid % 255) + 1);
+        m_desktop_session = uint8_t((m_desktop_session % 255) + 1);
+        m_desktop_started = false;
+        {
+            // spread transmitters across the interval
+            std::uniform_int_distribution<int64_t> phase(0, SWARM_VOICE_INTERVAL_USEC);
+            m_next_voice = now + phase(m_rng);
+            m_next_video = now + phase(m_rng);
+            m_next_desktop = now + phase(m_rng);
+        }
+
+        if (int const peer = m_worker.GetRandomPeer(m_userid))
+            DoSubscribe(peer);
+        break;
+    case SWARMCMD_LEAVE :
+        m_chanid = 0;
+        m_state = SWARM_LOGGEDIN;
+        stats.rejoins++;
+        DoJoin();
+        break;
+    case SWARMCMD_SUBSCRIBE :
+    case SWARMCMD_COUNT :
+        break;
+    }
+}
+
+int SwarmClient::SendCommand(ACE_TString command, SwarmCommand cmdtype)
+{
+    int const cmdid = GEN_NEXT_ID(m_cmdid_counter);
+    AppendProperty(TT_CMDID, cmdid, command);
+    command += EOL;
+
+    m_pending[cmdid] = { cmdtype, SwarmClock() };
+
+    ACE_CString const data = UnicodeToUtf8(command.c_str());
+    if (m_stream.send_n(data.c_str(), data.length()) < 0)
+        return 0;
+    return cmdid;
+}
+
+void SwarmClient::SendPacket(const FieldPacket& packet)
+{
+    int buffers = 0;
+    const iovec* vv = packet.GetPacket(buffers);
+    m_dgram.send(vv, buffers, m_config.udpaddr);
+}
+
+void SwarmClient::DoLogin()
+{
+    ACE_TString command = CLIENT_LOGIN;
+    AppendProperty(TT_NICKNAME, ACE_TString(ACE_TEXT("Swarm #")) + I2String(m_index), command);
+    AppendProperty(TT_USERNAME, m_config.username, command);
+    AppendProperty(TT_PASSWORD, m_config.password, command);
+    AppendProperty(TT_CLIENTNAME, ACE_TString(ACE_TEXT("ttswarm")), command);
+    AppendProperty(TT_PROTOCOL, ACE_TString(TEAMTALK_PROTOCOL_VERSION), command);
+    AppendProperty(TT_VERSION, ACE_TString(ACE_TEXT(TEAMTALK_VERSION)), command);
+    SendCommand(command, SWARMCMD_LOGIN);
+    m_state = SWARM_LOGGINGIN;
+}
+
+void SwarmClient::DoJoin()
+{
+    if (m_config.channelids.empty())
+        return;
+
+    std::uniform_int_distribution<size_t> pick(0, m_config.channelids.size() - 1);
+    m_join_chanid = m_config.channelids[pick(m_rng)];
+
+    ACE_TString command = CLIENT_JOINCHANNEL;
+    AppendProperty(TT_CHANNELID, m_join_chanid, command);
+    AppendProperty(TT_PASSWORD, ACE_TString(), command);
+    SendCommand(command, SWARMCMD_JOIN);
+    m_state = SWARM_JOINING;
+}
+
+void SwarmClient::DoLeave()
+{
+    ACE_TString const command = CLIENT_LEAVECHANNEL;
+    SendCommand(command, SWARMCMD_LEAVE);
+    m_state = SWARM_LEAVING;
+}
+
+void SwarmClient::DoSubscribe(int userid)
+{
+    ACE_TString command = CLIENT_SUBSCRIBE;
+    AppendProperty(TT_USERID, userid, command);
+    AppendProperty(TT_LOCALSUBSCRIPTIONS, SUBSCRIBE_PEER_DEFAULT, command);
+    SendCommand(command, SWARMCMD_SUBSCRIBE);
+}
+
+int64_t SwarmClient::NextChurn(int64_t now)
+{
+    if (m_config.churn_per_min <= 0)
+        return 0;
+
+    std::exponential_distribution<double> wait(m_config.churn_per_min / 60e6);
+    return now + int64_t(wait(m_rng));
+}
+
+const char* SwarmClient::StampPayload(int64_t now, int size, int stride)
+{
+    assert(size <= int(m_payload.size()));
+    for (int offset=0;offset + SWARM_STAMP_BYTES <= size;offset += stride)
+        std::memcpy(&m_payload[offset], &now, SWARM_STAMP_BYTES);
+    return m_payload.data();
+}
+
+void SwarmClient::Tick(int64_t now)
+{
+    if (m_userid == 0)
+        return;
+
+    if (!m_udp_ready && now >= m_next_hello)
+    {
+        SendPacket(HelloPacket(uint16_t(m_userid), GETTIMESTAMP()));
+        m_next_hello = now + SWARM_HELLO_INTERVAL_USEC;
+    }
+
+    if (now >= m_next_keepalive)
+    {
+        ACE_CString const ping = UnicodeToUtf8(ACE_TString(CLIENT_KEEPALIVE EOL).c_str());
+        m_stream.send_n(ping.c_str(), ping.length());
+        if (m_udp_ready)
+            SendPacket(KeepAlivePacket(uint16_t(m_userid), GETTIMESTAMP()));
+        m_next_keepalive = now + SWARM_KEEPALIVE_INTERVAL_USEC;
+    }
+
+    switch (m_state)
+    {
+    case SWARM_LOGGEDIN :
+        if (m_next_retry != 0 && now >= m_next_retry)
+        {
+            m_next_retry = 0;
+            DoJoin();
+        }
+        break;
+    case SWARM_INCHANNEL :
+        if (!m_udp_ready)
+            break;
+        if (m_tx_voice && now >= m_next_voice)
+        {
+            SendVoice(now);
+            m_next_voice = NextInterval(m_next_voice, SWARM_VOICE_INTERVAL_USEC, now);
+        }
+        if (m_tx_video && now >= m_next_video)
+        {
+            SendVideo(now);
+            m_next_video = NextInterval(m_next_video, SWARM_VIDEO_INTERVAL_USEC, now);
+        }
+        if (m_tx_desktop && now >= m_next_desktop)
+        {
+            SendDesktop(now);
+            m_next_desktop = NextInterval(m_next_desktop, SWARM_DESKTOP_INTERVAL_USEC, now);
+        }
+        if (m_next_churn != 0 && now >= m_next_churn)
+            DoLeave();
+        break;
+    default :
+        break;
+    }
+}
+
+void SwarmClient::SendVoice(int64_t now)
+{
+    static const std::vector<uint16_t> framesizes = { SWARM_VOICE_BYTES };
+    VoicePacket pkt(PACKET_KIND_VOICE, uint16_t(m_userid), GETTIMESTAMP(),
+                    m_streamid, m_voice_pktno++,
+                    StampPayload(now, SWARM_VOICE_BYTES, SWARM_VOICE_BYTES),
+                    SWARM_VOICE_BYTES, framesizes);
+    pkt.SetChannel(uint16_t(m_chanid));
+    SendPacket(pkt);
+    m_worker.Stats().packets_sent[SWARMMEDIA_VOICE]++;
+}
+
+void SwarmClient::SendVideo(int64_t now)
+{
+    // every fragment carries a stamp so all forwarded packets are measured
+    const char* data = StampPayload(now, SWARM_VIDEO_BYTES, SWARM_VIDEO_FRAGMENT_BYTES);
+    uint16_t const width = SWARM_VIDEO_WIDTH, height = SWARM_VIDEO_HEIGHT;
+    uint32_t const packet_no = m_video_pktno++;
+    uint32_t const tm = GETTIMESTAMP();
+    auto const fragcnt = uint16_t((SWARM_VIDEO_BYTES + SWARM_VIDEO_FRAGMENT_BYTES - 1) / SWARM_VIDEO_FRAGMENT_BYTES);
+
+    for (uint16_t f=0;f<fragcnt;f++)
+    {
+        int const offset = f * SWARM_VIDEO_FRAGMENT_BYTES;
+        auto const len = uint16_t(std::min(SWARM_VIDEO_FRAGMENT_BYTES, SWARM_VIDEO_BYTES - offset));
+        if (f == 0)
+        {
+            VideoCapturePacket pkt(PACKET_KIND_VIDEO, uint16_t(m_userid), tm, m_streamid,
+                                   packet_no, &width, &height, data, len, fragcnt);
+            pkt.SetChannel(uint16_t(m_chanid));
+            SendPacket(pkt);
+        }
+        else
+        {
+            VideoCapturePacket pkt(PACKET_KIND_VIDEO, uint16_t(m_userid), tm, m_streamid,
+                                   packet_no, data + offset, len, f);
+            pkt.SetChannel(uint16_t(m_chanid));
+            SendPacket(pkt);
+        }
+        m_worker.Stats().packets_sent[SWARMMEDIA_VIDEO]++;
+    }
+}
+
+void SwarmClient::SendDesktop(int64_t now)
+{
+    map_block_t blocks;
+    blocks[0].block_data = StampPayload(now, SWARM_DESKTOP_BYTES, SWARM_DESKTOP_BYTES);
+    blocks[0].block_size = SWARM_DESKTOP_BYTES;
+    block_frags_t const fragments;
+    mmap_dup_blocks_t const dup_blocks;
+
+    // the update time identifies the update so it must increase
+    uint32_t tm = GETTIMESTAMP();
+    if (m_desktop_started && !W32_GT(tm, m_desktop_time))
+        tm = m_desktop_time + 1;
+    m_desktop_time = tm;
+
+    std::unique_ptr<DesktopPacket> pkt;
+    if (m_desktop_started)
+    {
+        pkt = std::make_unique<DesktopPacket>(uint16_t(m_userid), tm, m_desktop_session,
+                                              0, 1, blocks, fragments, dup_blocks);
+    }
+    else
+    {
+        pkt = std::make_unique<DesktopPacket>(uint16_t(m_userid), tm, m_desktop_session,
+                                              SWARM_DESKTOP_WIDTH, SWARM_DESKTOP_HEIGHT,
+                                              uint8_t(BMP_RGB32), 0, 1, blocks, fragments,
+                                              dup_blocks);
+        m_desktop_started = true;
+    }
+    pkt->SetChannel(uint16_t(m_chanid));
+    SendPacket(*pkt);
+    m_worker.Stats().packets_sent[SWARMMEDIA_DESKTOP]++;
+}
+
+void SwarmClient::HandleUdpInput()
+{
+    char buf[0x10000];
+    ACE_INET_Addr addr;
+    for (int i=0;i<SWARM_UDP_BATCH;i++)
+    {
+        ssize_t const n = m_dgram.recv(buf, sizeof(buf), addr);
+        if (n <= 0)
+            break;
+
+        FieldPacket const packet(buf, uint16_t(n));
+        if (!packet.ValidatePacket())
+            continue;
+
+        switch (packet.GetKind())
+        {
+        case PACKET_KIND_HELLO :
+            m_udp_ready = true;
+            break;
+        case PACKET_KIND_VOICE :
+        {
+            VoicePacket const audpkt(buf, uint16_t(n));
+            uint16_t len = 0;
+            const char* enc = audpkt.GetEncodedAudio(len);
+            ReceivedMedia(SWARMMEDIA_VOICE, enc, len);
+            break;
+        }
+        case PACKET_KIND_VIDEO :
+        {
+            VideoCapturePacket const vidpkt(buf, uint16_t(n));
+            uint16_t len = 0;
+            const char* enc = vidpkt.GetEncodedData(len);
+            ReceivedMedia(SWARMMEDIA_VIDEO, enc, len);
+            break;
+        }
+        case PACKET_KIND_DESKTOP :
+            ReceivedDesktop(DesktopPacket(buf, uint16_t(n)));
+            break;
+        default :
+            break;
+        }
+    }
+}
+
+void SwarmClient::ReceivedMedia(SwarmMedia media, const char* payload, int len)
+{
+    if (payload == nullptr || len < SWARM_STAMP_BYTES)
+        return;
+
+    int64_t sent = 0;
+    std::memcpy(&sent, payload, SWARM_STAMP_BYTES);
+
+    SwarmStats& stats = m_worker.Stats();
+    stats.packets_received[media]++;
+    stats.forward_latency[media].Add(SwarmClock() - sent);
+}
+
+void SwarmClient::ReceivedDesktop(const DesktopPacket& packet)
+{
+    map_block_t blocks;
+    if (packet.GetBlocks(blocks) && blocks.contains(0))
+        ReceivedMedia(SWARMMEDIA_DESKTOP, blocks[0].block_data, blocks[0].block_size);
+
+    // server retransmits until the update is acknowledged
+    if (m_chanid == 0)
+        return;
+
+    std::set<uint16_t> const acked = { packet.GetPacketIndex() };
+    DesktopAckPacket ack(uint16_t(m_userid), GETTIMESTAMP(), packet.GetSrcUserID(),
+                         packet.GetSessionID(), packet.GetTime(), acked, packet_range_t());
+    ack.SetChannel(uint16_t(m_chanid));
+    SendPacket(ack);
+}
+
+SwarmWorker::SwarmWorker(const SwarmConfig& config, int first_index, int clients_count, unsigned seed)
+    : m_config(config)
+    , m_rng(seed)
+{
+    for (int i=0;i<clients_count;i++)
+        m_clients.push_back(std::make_unique<SwarmClient>(*this, first_index + i, config, m_rng));
+}
+
+SwarmWorker::~SwarmWorker()
+{
+    Stop();
+}
+
+void SwarmWorker::Start()
+{
+    assert(!m_thread.joinable());
+    m_stop = false;
+    m_thread = std::thread(&SwarmWorker::Run, this);
+}
+
+void SwarmWorker::Stop()
+{
+    m_stop = true;
+    if (m_thread.joinable())
+        m_thread.join();
+}
+
+SwarmStats SwarmWorker::GetStats()
+{
+    std::lock_guard<std::mutex> const g(m_mutex);
+    return m_stats;
+}
+
+void SwarmWorker::ResetStats()
+{
+    std::lock_guard<std::mutex> const g(m_mutex);
+    m_stats = SwarmStats();
+}
+
+int SwarmWorker::GetClientsCount(SwarmClient::State state)
+{
+    std::lock_guard<std::mutex> const g(m_mutex);
+    return int(std::count_if(m_clients.begin(), m_clients.end(),
+                             [state](const auto& c) { return c->GetState() == state; }));
+}
+
+int SwarmWorker::GetRandomPeer(int except_userid)
+{
+    if (m_clients.empty())
+        return 0;
+
+    std::uniform_int_distribution<size_t> pick(0, m_clients.size() - 1);
+    for (int i=0;i<8;i++)
+    {
+        int const userid = m_clients[pick(m_rng)]->GetUserID();
+        if (userid != 0 && userid != except_userid)
+            return userid;
+    }
+    return 0;
+}
+
+void SwarmWorker::BuildPollSet()
+{
+    m_pollfds.clear();
+    m_pollclients.clear();
+    for (auto& c : m_clients)
+    {
+        if (c->GetTcpHandle() == ACE_INVALID_HANDLE)
+            continue;
+
+        for (ACE_HANDLE h : { c->GetTcpHandle(), c->GetUdpHandle() })
+        {
+            pollfd pfd = {};
+            pfd.fd = PollHandle(h);
+            pfd.events = POLLIN;
+            m_pollfds.push_back(pfd);
+            m_pollclients.push_back(c.get());
+        }
+    }
+    m_repoll = false;
+}
+
+void SwarmWorker::Run()
+{
+    int64_t const connect_interval = 1000000 / std::max(m_config.ramp_per_sec, 1);
+    int64_t next_connect = SwarmClock();
+    int64_t next_tick = next_connect;
+
+    while (!m_stop)
+    {
+        if (m_repoll)
+            BuildPollSet();
+
+        int64_t now = SwarmClock();
+        int const timeout_msec = int(std::clamp<int64_t>((next_tick - now) / 1000, 0, SWARM_TICK_USEC / 1000));
+        int ready = 0;
+        if (m_pollfds.empty())
+            std::this_thread::sleep_for(std::chrono::milliseconds(timeout_msec));
+        else
+            ready = PollSockets(m_pollfds.data(), m_pollfds.size(), timeout_msec);
+
+        std::lock_guard<std::mutex> const g(m_mutex);
+
+        for (size_t i=0;i<m_pollfds.size() && ready > 0;i++)
+        {
+            if (m_pollfds[i].revents == 0)
+                continue;
+            ready--;
+
+            SwarmClient* client = m_pollclients[i];
+            // closed by an earlier event
+            if (m_pollfds[i].fd != PollHandle(client->GetTcpHandle()) &&
+                m_pollfds[i].fd != PollHandle(client->GetUdpHandle()))
+                continue;
+
+            if (m_pollfds[i].fd == PollHandle(client->GetTcpHandle()))
+            {
+                if (!client->HandleTcpInput())
+                    client->Disconnect();
+            }
+            else
+            {
+                client->HandleUdpInput();
+            }
+        }
+
+        now = SwarmClock();
+        while (m_connected < m_clients.size() && now >= next_connect)
+        {
+            m_clients[m_connected++]->Connect();
+            next_connect += connect_interval;
+        }
+
+        if (now >= next_tick)
+        {
+            for (auto& c : m_clients)
+                c->Tick(now);
+            next_tick = NextInterval(next_tick, SWARM_TICK_USEC, now);
+        }
+    }
+
+    std::lock_guard<std::mutex> const g(m_mutex);
+    for (auto& c : m_clients)
+        c->Disconnect();
+}
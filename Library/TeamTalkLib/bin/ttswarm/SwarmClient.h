@@ -0,0 +1,212 @@
+/*
+ * Copyright (c) 2005-2018, BearWare.dk
+ *
+ * Contact Information:
+ *
+ * Bjoern D. Rasmussen
+ * Kirketoften 5
+ * DK-8260 Viby J
+ * Denmark
+ * Email: contact@bearware.dk
+ * Phone: +45 20 20 54 59
+ * Web: http://www.bearware.dk
+ *
+ * This source code is part of the TeamTalk SDK owned by
+ * BearWare.dk. Use of this file, or its compiled unit, requires a
+ * TeamTalk SDK License Key issued by BearWare.dk.
+ *
+ * The TeamTalk SDK License Agreement along with its Terms and
+ * Conditions are outlined in the file License.txt included with the
+ * TeamTalk SDK distribution.
+ *
+ */
+
+#if !defined(SWARMCLIENT_H)
+#define SWARMCLIENT_H
+
+#include "SwarmStats.h"
+
+#include "mystd/MyStd.h"
+#include "teamtalk/Commands.h"
+#include "teamtalk/PacketLayout.h"
+
+#include <ace/INET_Addr.h>
+#include <ace/SOCK_Dgram.h>
+#include <ace/SOCK_Stream.h>
+#include <ace/SString.h>
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+#if defined(WIN32)
+#include <winsock2.h>
+#else
+#include <poll.h>
+#endif
+
+namespace teamtalk {
+
+    struct SwarmConfig
+    {
+        ACE_INET_Addr tcpaddr, udpaddr;
+        ACE_TString username, password;
+        std::vector<int> channelids;
+        // share of clients transmitting each media type
+        double voice_ratio = 0.1;
+        double video_ratio = 0.02;
+        double desktop_ratio = 0.01;
+        // average number of channel switches per client per minute
+        double churn_per_min = 0.5;
+        // new connections per second per worker
+        int ramp_per_sec = 100;
+    };
+
+    class SwarmWorker;
+
+    // Protocol level client, i.e. a TCP connection for commands and a
+    // UDP socket for media. Media is not encoded. Packets carry payloads
+    // of typical size for the codec with the send time in the first
+    // bytes so the receiver can measure forward latency.
+    class SwarmClient : NonCopyable
+    {
+    public:
+        enum State
+        {
+            SWARM_DISCONNECTED,
+            SWARM_CONNECTED,
+            SWARM_LOGGINGIN,
+            SWARM_LOGGEDIN,
+            SWARM_JOINING,
+            SWARM_INCHANNEL,
+            SWARM_LEAVING,
+            SWARM_FAILED,
+        };
+
+        SwarmClient(SwarmWorker& worker, int index, const SwarmConfig& config, std::mt19937& rng);
+        ~SwarmClient();
+
+        bool Connect();
+        void Disconnect();
+
+        State GetState() const { return m_state; }
+        int GetUserID() const { return m_userid; }
+        ACE_HANDLE GetTcpHandle() const { return m_stream.get_handle(); }
+        ACE_HANDLE GetUdpHandle() const { return m_dgram.get_handle(); }
+
+        // return false if connection was closed
+        bool HandleTcpInput();
+        void HandleUdpInput();
+        void Tick(int64_t now);
+
+    private:
+        void ProcessCommand(const ACE_CString& cmdline);
+        void HandleEndCmd(int cmdid);
+        int SendCommand(ACE_TString command, SwarmCommand cmdtype);
+        void SendPacket(const FieldPacket& packet);
+
+        void DoLogin();
+        void DoJoin();
+        void DoLeave();
+        void DoSubscribe(int userid);
+
+        void SendVoice(int64_t now);
+        void SendVideo(int64_t now);
+        void SendDesktop(int64_t now);
+        void ReceivedMedia(SwarmMedia media, const char* payload, int len);
+        void ReceivedDesktop(const DesktopPacket& packet);
+
+        int64_t NextChurn(int64_t now);
+        // write 'now' stamp every 'stride' bytes of the first 'size'
+        // bytes of the filler payload
+        const char* StampPayload(int64_t now, int size, int stride);
+
+        SwarmWorker& m_worker;
+        const SwarmConfig& m_config;
+        std::mt19937& m_rng;
+        int const m_index;
+        State m_state = SWARM_DISCONNECTED;
+
+        ACE_SOCK_Stream m_stream;
+        ACE_SOCK_Dgram m_dgram;
+        ACE_CString m_recvbuffer;
+        std::vector<char> m_payload;
+
+        int m_userid = 0;
+        int m_chanid = 0, m_join_chanid = 0;
+        bool m_udp_ready = false;
+
+        int m_cmdid_counter = 0;
+        int m_current_cmdid = 0;
+        bool m_current_error = false;
+        struct PendingCommand
+        {
+            SwarmCommand type;
+            int64_t sent;
+        };
+        std::map<int, PendingCommand> m_pending;
+
+        bool m_tx_voice = false, m_tx_video = false, m_tx_desktop = false;
+        int64_t m_next_voice = 0, m_next_video = 0, m_next_desktop = 0;
+        int64_t m_next_hello = 0, m_next_keepalive = 0, m_next_churn = 0;
+        int64_t m_next_retry = 0;
+        uint8_t m_streamid = 0;
+        uint16_t m_voice_pktno = 0;
+        uint32_t m_video_pktno = 0;
+        uint8_t m_desktop_session = 0;
+        bool m_desktop_started = false;
+        uint32_t m_desktop_time = 0;
+    };
+
+    // Runs a group of clients in a single thread which polls all
+    // their sockets, so a worker isn't bound by FD_SETSIZE.
+    class SwarmWorker : NonCopyable
+    {
+    public:
+        SwarmWorker(const SwarmConfig& config, int first_index, int clients_count, unsigned seed);
+        ~SwarmWorker();
+
+        void Start();
+        void Stop();
+
+        // Counters since last ResetStats()
+        SwarmStats GetStats();
+        void ResetStats();
+
+        int GetClientsCount(SwarmClient::State state);
+
+        // Stats are only accessed by worker thread while it holds the lock
+        SwarmStats& Stats() { return m_stats; }
+        // Random user ID of another client in this worker, 0 if none
+        int GetRandomPeer(int except_userid);
+        void Repoll() { m_repoll = true; }
+
+    private:
+        void Run();
+        void BuildPollSet();
+
+        const SwarmConfig& m_config;
+        std::mt19937 m_rng;
+        std::vector< std::unique_ptr<SwarmClient> > m_clients;
+        size_t m_connected = 0;
+
+        std::vector<pollfd> m_pollfds;
+        // 'm_pollfds' index -> client
+        std::vector<SwarmClient*> m_pollclients;
+        bool m_repoll = true;
+
+        std::thread m_thread;
+        std::atomic<bool> m_stop{false};
+
+        std::mutex m_mutex;
+        SwarmStats m_stats;
+    };
+
+} // namespace teamtalk
+
+#endif
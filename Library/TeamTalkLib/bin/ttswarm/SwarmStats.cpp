@@ -0,0 +1,141 @@
+/*
+ * Copyright (c) 2005-2018, BearWare.dk
+ *
+ * Contact Information:
+ *
+ * Bjoern D. Rasmussen
+ * Kirketoften 5
+ * DK-8260 Viby J
+ * Denmark
+ * Email: contact@bearware.dk
+ * Phone: +45 20 20 54 59
+ * Web: http://www.bearware.dk
+ *
+ * This source code is part of the TeamTalk SDK owned by
+ * BearWare.dk. Use of this file, or its compiled unit, requires a
+ * TeamTalk SDK License Key issued by BearWare.dk.
+ *
+ * The TeamTalk SDK License Agreement along with its Terms and
+ * Conditions are outlined in the file License.txt included with the
+ * TeamTalk SDK distribution.
+ *
+ */
+
+#include "SwarmStats.h"
+
+#include <cassert>
+#include <chrono>
+
+#if !defined(WIN32) && !defined(__APPLE__)
+#include <pthread.h>
+#endif
+
+namespace teamtalk {
+
+int64_t SwarmClock()
+{
+    using namespace std::chrono;
+    return duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+const char* GetSwarmMediaName(SwarmMedia media)
+{
+    switch (media)
+    {
+    case SWARMMEDIA_VOICE :
+        return "voice";
+    case SWARMMEDIA_VIDEO :
+        return "video";
+    case SWARMMEDIA_DESKTOP :
+        return "desktop";
+    case SWARMMEDIA_COUNT :
+        break;
+    }
+    return "";
+}
+
+const char* GetSwarmCommandName(SwarmCommand cmd)
+{
+    switch (cmd)
+    {
+    case SWARMCMD_LOGIN :
+        return "login";
+    case SWARMCMD_JOIN :
+        return "join";
+    case SWARMCMD_LEAVE :
+        return "leave";
+    case SWARMCMD_SUBSCRIBE :
+        return "subscribe";
+    case SWARMCMD_COUNT :
+        break;
+    }
+    return "";
+}
+
+void SwarmStats::Merge(const SwarmStats& other)
+{
+    for (int m=0;m<SWARMMEDIA_COUNT;m++)
+    {
+        packets_sent[m] += other.packets_sent[m];
+        packets_received[m] += other.packets_received[m];
+        forward_latency[m].Merge(other.forward_latency[m]);
+    }
+    for (int c=0;c<SWARMCMD_COUNT;c++)
+        command_rtt[c].Merge(other.command_rtt[c]);
+    command_errors += other.command_errors;
+    rejoins += other.rejoins;
+}
+
+ThreadCPUClock::~ThreadCPUClock()
+{
+#if defined(WIN32)
+    if (m_thread)
+        ::CloseHandle(m_thread);
+#endif
+}
+
+void ThreadCPUClock::Attach()
+{
+#if defined(WIN32)
+    assert(m_thread == nullptr);
+    ::DuplicateHandle(::GetCurrentProcess(), ::GetCurrentThread(),
+                      ::GetCurrentProcess(), &m_thread, 0, FALSE,
+                      DUPLICATE_SAME_ACCESS);
+#elif defined(__APPLE__)
+    m_thread = pthread_mach_thread_np(pthread_self());
+#else
+    m_attached = pthread_getcpuclockid(pthread_self(), &m_clock) == 0;
+#endif
+}
+
+int64_t ThreadCPUClock::GetCPUTimeUsec() const
+{
+#if defined(WIN32)
+    FILETIME creation, exit, kernel, user;
+    if (!m_thread || !::GetThreadTimes(m_thread, &creation, &exit, &kernel, &user))
+        return -1;
+    ULARGE_INTEGER k, u;
+    k.LowPart = kernel.dwLowDateTime;
+    k.HighPart = kernel.dwHighDateTime;
+    u.LowPart = user.dwLowDateTime;
+    u.HighPart = user.dwHighDateTime;
+    // 100 nsec units
+    return int64_t((k.QuadPart + u.QuadPart) / 10);
+#elif defined(__APPLE__)
+    if (m_thread == MACH_PORT_NULL)
+        return -1;
+    thread_basic_info_data_t info;
+    mach_msg_type_number_t count = THREAD_BASIC_INFO_COUNT;
+    if (thread_info(m_thread, THREAD_BASIC_INFO, reinterpret_cast<thread_info_t>(&info), &count) != KERN_SUCCESS)
+        return -1;
+    return ((int64_t(info.user_time.seconds) + info.system_time.seconds) * 1000000) +
+        info.user_time.microseconds + info.system_time.microseconds;
+#else
+    timespec ts = {};
+    if (!m_attached || clock_gettime(m_clock, &ts) != 0)
+        return -1;
+    return (int64_t(ts.tv_sec) * 1000000) + (ts.tv_nsec / 1000);
+#endif
+}
+
+} // namespace teamtalk
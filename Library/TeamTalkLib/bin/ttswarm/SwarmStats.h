@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) 2005-2018, BearWare.dk
+ *
+ * Contact Information:
+ *
+ * Bjoern D. Rasmussen
+ * Kirketoften 5
+ * DK-8260 Viby J
+ * Denmark
+ * Email: contact@bearware.dk
+ * Phone: +45 20 20 54 59
+ * Web: http://www.bearware.dk
+ *
+ * This source code is part of the TeamTalk SDK owned by
+ * BearWare.dk. Use of this file, or its compiled unit, requires a
+ * TeamTalk SDK License Key issued by BearWare.dk.
+ *
+ * The TeamTalk SDK License Agreement along with its Terms and
+ * Conditions are outlined in the file License.txt included with the
+ * TeamTalk SDK distribution.
+ *
+ */
+
+#if !defined(SWARMSTATS_H)
+#define SWARMSTATS_H
+
+#include "teamtalk/LatencyHistogram.h"
+
+#include <array>
+#include <cstdint>
+
+#if defined(WIN32)
+#include <ace/OS_NS_Thread.h>
+#elif defined(__APPLE__)
+#include <mach/mach.h>
+#else
+#include <ctime>
+#endif
+
+namespace teamtalk {
+
+    // Microseconds on a clock shared by all threads in the process
+    int64_t SwarmClock();
+
+    enum SwarmMedia
+    {
+        SWARMMEDIA_VOICE,
+        SWARMMEDIA_VIDEO,
+        SWARMMEDIA_DESKTOP,
+        SWARMMEDIA_COUNT
+    };
+
+    enum SwarmCommand
+    {
+        SWARMCMD_LOGIN,
+        SWARMCMD_JOIN,
+        SWARMCMD_LEAVE,
+        SWARMCMD_SUBSCRIBE,
+        SWARMCMD_COUNT
+    };
+
+    const char* GetSwarmMediaName(SwarmMedia media);
+    const char* GetSwarmCommandName(SwarmCommand cmd);
+
+    struct SwarmStats
+    {
+        std::array<int64_t, SWARMMEDIA_COUNT> packets_sent = {};
+        std::array<int64_t, SWARMMEDIA_COUNT> packets_received = {};
+        // time from client send until another client received it
+        std::array<LatencyHistogram, SWARMMEDIA_COUNT> forward_latency;
+        // time from command sent until 'end' reply
+        std::array<LatencyHistogram, SWARMCMD_COUNT> command_rtt;
+        int64_t command_errors = 0;
+        int64_t rejoins = 0;
+
+        void Merge(const SwarmStats& other);
+    };
+
+    // CPU time used by a single thread. Attach() must be called from
+    // the thread to measure, after that any thread can read it.
+    class ThreadCPUClock
+    {
+    public:
+        ThreadCPUClock() = default;
+        ThreadCPUClock(const ThreadCPUClock&) = delete;
+        ~ThreadCPUClock();
+
+        void Attach();
+        // returns -1 if not attached or unsupported
+        int64_t GetCPUTimeUsec() const;
+
+    private:
+#if defined(WIN32)
+        HANDLE m_thread = nullptr;
+#elif defined(__APPLE__)
+        mach_port_t m_thread = MACH_PORT_NULL;
+#else
+        clockid_t m_clock = {};
+        bool m_attached = false;
+#endif
+    };
+
+} // namespace teamtalk
+
+#endif
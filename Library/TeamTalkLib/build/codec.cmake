@@ -1,7 +1,9 @@
 include (ttlib)
 
-set (CODEC_SOURCES ${TEAMTALKLIB_ROOT}/codec/MediaUtil.cpp)
-set (CODEC_HEADERS ${TEAMTALKLIB_ROOT}/codec/MediaUtil.h)
+set (CODEC_SOURCES ${TEAMTALKLIB_ROOT}/codec/MediaUtil.cpp
+  ${TEAMTALKLIB_ROOT}/codec/AudioKernels.cpp)
+set (CODEC_HEADERS ${TEAMTALKLIB_ROOT}/codec/MediaUtil.h
+  ${TEAMTALKLIB_ROOT}/codec/AudioKernels.h)
 
 if (FEATURE_SPEEX)
   include (speex)
@@ -31,6 +31,7 @@ set (TTCLIENT_LINK_FLAGS
 set (TTCLIENT_HEADERS
   ${TEAMTALKLIB_ROOT}/TeamTalkDefs.h
   ${TEAMTALKLIB_ROOT}/avstream/AudioResampler.h
+  ${TEAMTALKLIB_ROOT}/avstream/PolyphaseResampler.h
   ${TEAMTALKLIB_ROOT}/avstream/VideoCapture.h
   ${TEAMTALKLIB_ROOT}/codec/BmpFile.h
   ${TEAMTALKLIB_ROOT}/codec/WaveFile.h
@@ -45,6 +46,7 @@ set (TTCLIENT_HEADERS
   ${TEAMTALKLIB_ROOT}/teamtalk/Commands.h
   ${TEAMTALKLIB_ROOT}/teamtalk/Common.h
   ${TEAMTALKLIB_ROOT}/teamtalk/DesktopSession.h
+  ${TEAMTALKLIB_ROOT}/teamtalk/LatencyHistogram.h
   ${TEAMTALKLIB_ROOT}/teamtalk/Log.h
   ${TEAMTALKLIB_ROOT}/teamtalk/PacketHandler.h
   ${TEAMTALKLIB_ROOT}/teamtalk/PacketHelper.h
@@ -54,6 +56,7 @@ set (TTCLIENT_HEADERS
   ${TEAMTALKLIB_ROOT}/teamtalk/User.h
   ${TEAMTALKLIB_ROOT}/teamtalk/client/AudioContainer.h
   ${TEAMTALKLIB_ROOT}/teamtalk/client/AudioThread.h
+  ${TEAMTALKLIB_ROOT}/teamtalk/client/BandwidthEstimator.h
   ${TEAMTALKLIB_ROOT}/teamtalk/client/ClientChannel.h
   ${TEAMTALKLIB_ROOT}/teamtalk/client/Client.h
   ${TEAMTALKLIB_ROOT}/teamtalk/client/ClientNode.h
@@ -63,6 +66,8 @@ set (TTCLIENT_HEADERS
   ${TEAMTALKLIB_ROOT}/teamtalk/client/StreamPlayers.h
   ${TEAMTALKLIB_ROOT}/teamtalk/client/VideoThread.h
   ${TEAMTALKLIB_ROOT}/teamtalk/client/VoiceLogger.h
+  ${TEAMTALKLIB_ROOT}/teamtalk/client/EncodePool.h
+  ${TEAMTALKLIB_ROOT}/teamtalk/client/ReactorPool.h
   ${TEAMTALKLIB_ROOT}/teamtalk/client/AudioMuxer.h
   ${TEAMTALKLIB_ROOT}/teamtalk/client/DesktopShare.h
   ${TEAMTALKLIB_ROOT}/teamtalk/PacketLayout.inl )
@@ -73,6 +78,7 @@ set ( TTCLIENT_SOURCES
   ${TEAMTALKLIB_ROOT}/myace/TimerHandler.cpp
   ${TEAMTALKLIB_ROOT}/mystd/MyStd.cpp
   ${TEAMTALKLIB_ROOT}/avstream/AudioResampler.cpp
+  ${TEAMTALKLIB_ROOT}/avstream/PolyphaseResampler.cpp
   ${TEAMTALKLIB_ROOT}/avstream/VideoCapture.cpp
   ${TEAMTALKLIB_ROOT}/codec/BmpFile.cpp
   ${TEAMTALKLIB_ROOT}/codec/WaveFile.cpp
@@ -82,6 +88,7 @@ set ( TTCLIENT_SOURCES
   ${TEAMTALKLIB_ROOT}/teamtalk/Commands.cpp
   ${TEAMTALKLIB_ROOT}/teamtalk/Common.cpp
   ${TEAMTALKLIB_ROOT}/teamtalk/DesktopSession.cpp
+  ${TEAMTALKLIB_ROOT}/teamtalk/LatencyHistogram.cpp
   ${TEAMTALKLIB_ROOT}/teamtalk/PacketHandler.cpp
   ${TEAMTALKLIB_ROOT}/teamtalk/PacketHelper.cpp
   ${TEAMTALKLIB_ROOT}/teamtalk/PacketLayout.cpp
@@ -90,6 +97,7 @@ set ( TTCLIENT_SOURCES
   ${TEAMTALKLIB_ROOT}/teamtalk/User.cpp
   ${TEAMTALKLIB_ROOT}/teamtalk/client/AudioContainer.cpp
   ${TEAMTALKLIB_ROOT}/teamtalk/client/AudioThread.cpp
+  ${TEAMTALKLIB_ROOT}/teamtalk/client/BandwidthEstimator.cpp
   ${TEAMTALKLIB_ROOT}/teamtalk/client/ClientChannel.cpp
   ${TEAMTALKLIB_ROOT}/teamtalk/client/ClientNode.cpp
   ${TEAMTALKLIB_ROOT}/teamtalk/client/ClientNodeBase.cpp
@@ -98,6 +106,8 @@ set ( TTCLIENT_SOURCES
   ${TEAMTALKLIB_ROOT}/teamtalk/client/StreamPlayers.cpp
   ${TEAMTALKLIB_ROOT}/teamtalk/client/VideoThread.cpp
   ${TEAMTALKLIB_ROOT}/teamtalk/client/VoiceLogger.cpp
+  ${TEAMTALKLIB_ROOT}/teamtalk/client/EncodePool.cpp
+  ${TEAMTALKLIB_ROOT}/teamtalk/client/ReactorPool.cpp
   ${TEAMTALKLIB_ROOT}/teamtalk/client/AudioMuxer.cpp
   ${TEAMTALKLIB_ROOT}/teamtalk/client/DesktopShare.cpp)
 
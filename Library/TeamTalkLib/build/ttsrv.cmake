@@ -32,3 +32,25 @@ set (TTSRV_HEADERS
   ${TEAMTALKLIB_ROOT}/bin/ttsrv/UPnP.h
   ${TEAMTALKLIB_ROOT}/settings/Settings.h)
 
+set (TTSWARM_SOURCES
+  ${TTSRVLIB_SOURCES}
+  ${TEAMTALKLIB_ROOT}/bin/ttsrv/ServerConfig.cpp
+  ${TEAMTALKLIB_ROOT}/bin/ttsrv/ServerGuard.cpp
+  ${TEAMTALKLIB_ROOT}/bin/ttsrv/ServerUtil.cpp
+  ${TEAMTALKLIB_ROOT}/bin/ttsrv/ServerXML.cpp
+  ${TEAMTALKLIB_ROOT}/settings/Settings.cpp
+  ${TEAMTALKLIB_ROOT}/bin/ttswarm/SwarmClient.cpp
+  ${TEAMTALKLIB_ROOT}/bin/ttswarm/SwarmStats.cpp
+  ${TEAMTALKLIB_ROOT}/bin/ttswarm/Main.cpp)
+
+set (TTSWARM_HEADERS
+  ${TTSRVLIB_HEADERS}
+  ${TEAMTALKLIB_ROOT}/bin/ttsrv/AppInfo.h
+  ${TEAMTALKLIB_ROOT}/bin/ttsrv/ServerConfig.h
+  ${TEAMTALKLIB_ROOT}/bin/ttsrv/ServerGuard.h
+  ${TEAMTALKLIB_ROOT}/bin/ttsrv/ServerUtil.h
+  ${TEAMTALKLIB_ROOT}/bin/ttsrv/ServerXML.h
+  ${TEAMTALKLIB_ROOT}/settings/Settings.h
+  ${TEAMTALKLIB_ROOT}/bin/ttswarm/SwarmClient.h
+  ${TEAMTALKLIB_ROOT}/bin/ttswarm/SwarmStats.h)
+
@@ -18,6 +18,7 @@ set (TTSRVLIB_HEADERS
   ${TEAMTALKLIB_ROOT}/teamtalk/Commands.h
   ${TEAMTALKLIB_ROOT}/teamtalk/Common.h
   ${TEAMTALKLIB_ROOT}/teamtalk/DesktopSession.h
+  ${TEAMTALKLIB_ROOT}/teamtalk/LatencyHistogram.h
   ${TEAMTALKLIB_ROOT}/teamtalk/Log.h
   ${TEAMTALKLIB_ROOT}/teamtalk/PacketHandler.h
   ${TEAMTALKLIB_ROOT}/teamtalk/PacketHelper.h
@@ -42,6 +43,7 @@ set (TTSRVLIB_SOURCES
   ${TEAMTALKLIB_ROOT}/teamtalk/Commands.cpp
   ${TEAMTALKLIB_ROOT}/teamtalk/Common.cpp
   ${TEAMTALKLIB_ROOT}/teamtalk/DesktopSession.cpp
+  ${TEAMTALKLIB_ROOT}/teamtalk/LatencyHistogram.cpp
   ${TEAMTALKLIB_ROOT}/teamtalk/PacketHandler.cpp
   ${TEAMTALKLIB_ROOT}/teamtalk/PacketHelper.cpp
   ${TEAMTALKLIB_ROOT}/teamtalk/PacketLayout.cpp
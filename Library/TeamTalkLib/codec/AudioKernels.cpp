@@ -0,0 +1,497 @@
+/*
+ * Copyright (c) 2005-2018, BearWare.dk
+ *
+ * Contact Information:
+ *
+ * Bjoern D. Rasmussen
+ * Kirketoften 5
+ * DK-8260 Viby J
+ * Denmark
+ * Email: contact@bearware.dk
+ * Phone: +45 20 20 54 59
+ * Web: http://www.bearware.dk
+ *
+ * This source code is part of the TeamTalk SDK owned by
+ * BearWare.dk. Use of this file, or its compiled unit, requires a
+ * TeamTalk SDK License Key issued by BearWare.dk.
+ *
+ * The TeamTalk SDK License Agreement along with its Terms and
+ * Conditions are outlined in the file License.txt included with the
+ * TeamTalk SDK distribution.
+ *
+ */
+
+#include "AudioKernels.h"
+
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define AUDIOKERNELS_SSE2
+#include <emmintrin.h>
+#endif
+
+#if defined(AUDIOKERNELS_SSE2) && (defined(__GNUC__) || defined(_MSC_VER))
+#define AUDIOKERNELS_AVX2
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define AVX2_TARGET
+#else
+#define AVX2_TARGET __attribute__((target("avx2")))
+#endif
+#endif
+
+#if defined(__ARM_NEON) || defined(_M_ARM64)
+#define AUDIOKERNELS_NEON
+#include <arm_neon.h>
+#endif
+
+namespace {
+
+inline short Saturate16(int v)
+{
+    if (v > 32767)
+        return 32767;
+    if (v < -32768)
+        return -32768;
+    return short(v);
+}
+
+// Scalar kernels are the reference and also handle the samples
+// which don't fill a vector register
+
+void MixScalar(short* dst, const short* src, int n)
+{
+    for (int i=0;i<n;i++)
+        dst[i] = Saturate16(int(dst[i]) + src[i]);
+}
+
+void GainScalar(short* buffer, int n, float factor)
+{
+    for (int i=0;i<n;i++)
+        buffer[i] = Saturate16(int(buffer[i] * factor));
+}
+
+void SplitStereoScalar(const short* input, short* left, short* right, int frames)
+{
+    for (int i=0;i<frames;i++)
+    {
+        left[i] = input[i*2];
+        right[i] = input[(i*2)+1];
+    }
+}
+
+void MergeStereoScalar(const short* left, const short* right, short* output, int frames)
+{
+    for (int i=0;i<frames;i++)
+    {
+        output[i*2] = left[i];
+        output[(i*2)+1] = right[i];
+    }
+}
+
+void MonoToStereoScalar(short* buffer, int frames)
+{
+    for (int i=frames-1;i>=0;i--)
+    {
+        buffer[(i*2)+1] = buffer[i];
+        buffer[i*2] = buffer[i];
+    }
+}
+
+int DotProductScalar(const short* a, const short* b, int n)
+{
+    // wrap like the 32 bit vector accumulators
+    uint32_t sum = 0;
+    for (int i=0;i<n;i++)
+        sum += uint32_t(int(a[i]) * b[i]);
+    return int(sum);
+}
+
+#if defined(AUDIOKERNELS_SSE2)
+
+void MixSSE2(short* dst, const short* src, int n)
+{
+    int i = 0;
+    for (;i+8<=n;i+=8)
+    {
+        __m128i const a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+        __m128i const b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_adds_epi16(a, b));
+    }
+    MixScalar(dst + i, src + i, n - i);
+}
+
+void GainSSE2(short* buffer, int n, float factor)
+{
+    __m128 const f = _mm_set1_ps(factor);
+    int i = 0;
+    for (;i+8<=n;i+=8)
+    {
+        __m128i const x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(buffer + i));
+        // sign extend to 32 bit
+        __m128i const lo = _mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16);
+        __m128i const hi = _mm_srai_epi32(_mm_unpackhi_epi16(x, x), 16);
+        // truncate like the int-cast of the scalar version
+        __m128i const vlo = _mm_cvttps_epi32(_mm_mul_ps(_mm_cvtepi32_ps(lo), f));
+        __m128i const vhi = _mm_cvttps_epi32(_mm_mul_ps(_mm_cvtepi32_ps(hi), f));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(buffer + i), _mm_packs_epi32(vlo, vhi));
+    }
+    GainScalar(buffer + i, n - i, factor);
+}
+
+void SplitStereoSSE2(const short* input, short* left, short* right, int frames)
+{
+    int i = 0;
+    for (;i+8<=frames;i+=8)
+    {
+        __m128i const a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + (i*2)));
+        __m128i const b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + (i*2) + 8));
+        // left channel is the low 16 bits of each 32 bit frame
+        __m128i const la = _mm_srai_epi32(_mm_slli_epi32(a, 16), 16);
+        __m128i const lb = _mm_srai_epi32(_mm_slli_epi32(b, 16), 16);
+        __m128i const ra = _mm_srai_epi32(a, 16);
+        __m128i const rb = _mm_srai_epi32(b, 16);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(left + i), _mm_packs_epi32(la, lb));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(right + i), _mm_packs_epi32(ra, rb));
+    }
+    SplitStereoScalar(input + (i*2), left + i, right + i, frames - i);
+}
+
+void MergeStereoSSE2(const short* left, const short* right, short* output, int frames)
+{
+    int i = 0;
+    for (;i+8<=frames;i+=8)
+    {
+        __m128i const l = _mm_loadu_si128(reinterpret_cast<const __m128i*>(left + i));
+        __m128i const r = _mm_loadu_si128(reinterpret_cast<const __m128i*>(right + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(output + (i*2)), _mm_unpacklo_epi16(l, r));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(output + (i*2) + 8), _mm_unpackhi_epi16(l, r));
+    }
+    MergeStereoScalar(left + i, right + i, output + (i*2), frames - i);
+}
+
+void MonoToStereoSSE2(short* buffer, int frames)
+{
+    // work backwards so output never overwrites unread input
+    int const head = frames % 8;
+    for (int i=frames-8;i>=head;i-=8)
+    {
+        __m128i const x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(buffer + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(buffer + (i*2) + 8), _mm_unpackhi_epi16(x, x));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(buffer + (i*2)), _mm_unpacklo_epi16(x, x));
+    }
+    MonoToStereoScalar(buffer, head);
+}
+
+int DotProductSSE2(const short* a, const short* b, int n)
+{
+    __m128i sum = _mm_setzero_si128();
+    int i = 0;
+    for (;i+8<=n;i+=8)
+    {
+        __m128i const x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+        __m128i const y = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+        sum = _mm_add_epi32(sum, _mm_madd_epi16(x, y));
+    }
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+    return int(uint32_t(_mm_cvtsi128_si32(sum)) + uint32_t(DotProductScalar(a + i, b + i, n - i)));
+}
+
+#endif /* AUDIOKERNELS_SSE2 */
+
+#if defined(AUDIOKERNELS_AVX2)
+
+AVX2_TARGET void MixAVX2(short* dst, const short* src, int n)
+{
+    int i = 0;
+    for (;i+16<=n;i+=16)
+    {
+        __m256i const a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i));
+        __m256i const b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_adds_epi16(a, b));
+    }
+    MixScalar(dst + i, src + i, n - i);
+}
+
+AVX2_TARGET void GainAVX2(short* buffer, int n, float factor)
+{
+    __m256 const f = _mm256_set1_ps(factor);
+    int i = 0;
+    for (;i+16<=n;i+=16)
+    {
+        __m256i const x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(buffer + i));
+        __m256i const lo = _mm256_cvtepi16_epi32(_mm256_castsi256_si128(x));
+        __m256i const hi = _mm256_cvtepi16_epi32(_mm256_extracti128_si256(x, 1));
+        __m256i const vlo = _mm256_cvttps_epi32(_mm256_mul_ps(_mm256_cvtepi32_ps(lo), f));
+        __m256i const vhi = _mm256_cvttps_epi32(_mm256_mul_ps(_mm256_cvtepi32_ps(hi), f));
+        // packs works per 128 bit lane so restore sample order
+        __m256i const packed = _mm256_packs_epi32(vlo, vhi);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(buffer + i),
+                            _mm256_permute4x64_epi64(packed, 0xD8));
+    }
+    GainScalar(buffer + i, n - i, factor);
+}
+
+AVX2_TARGET int DotProductAVX2(const short* a, const short* b, int n)
+{
+    __m256i sum = _mm256_setzero_si256();
+    int i = 0;
+    for (;i+16<=n;i+=16)
+    {
+        __m256i const x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+        __m256i const y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+        sum = _mm256_add_epi32(sum, _mm256_madd_epi16(x, y));
+    }
+    __m128i s = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, _MM_SHUFFLE(1, 0, 3, 2)));
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, _MM_SHUFFLE(2, 3, 0, 1)));
+    return int(uint32_t(_mm_cvtsi128_si32(s)) + uint32_t(DotProductSSE2(a + i, b + i, n - i)));
+}
+
+bool CpuHasAVX2()
+{
+#if defined(_MSC_VER)
+    int regs[4] = {};
+    __cpuid(regs, 0);
+    if (regs[0] < 7)
+        return false;
+    __cpuid(regs, 1);
+    // OS must save YMM registers (OSXSAVE and XCR0 bits 1-2)
+    bool const osxsave = (regs[2] & (1 << 27)) != 0;
+    if (!osxsave || (_xgetbv(0) & 0x6) != 0x6)
+        return false;
+    __cpuidex(regs, 7, 0);
+    return (regs[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") != 0;
+#endif
+}
+
+#endif /* AUDIOKERNELS_AVX2 */
+
+#if defined(AUDIOKERNELS_NEON)
+
+void MixNEON(short* dst, const short* src, int n)
+{
+    int i = 0;
+    for (;i+8<=n;i+=8)
+        vst1q_s16(dst + i, vqaddq_s16(vld1q_s16(dst + i), vld1q_s16(src + i)));
+    MixScalar(dst + i, src + i, n - i);
+}
+
+void GainNEON(short* buffer, int n, float factor)
+{
+    int i = 0;
+    for (;i+8<=n;i+=8)
+    {
+        int16x8_t const x = vld1q_s16(buffer + i);
+        float32x4_t const flo = vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(x))), factor);
+        float32x4_t const fhi = vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(x))), factor);
+        // vcvtq_s32_f32 truncates towards zero like the int-cast
+        vst1q_s16(buffer + i, vcombine_s16(vqmovn_s32(vcvtq_s32_f32(flo)),
+                                           vqmovn_s32(vcvtq_s32_f32(fhi))));
+    }
+    GainScalar(buffer + i, n - i, factor);
+}
+
+void SplitStereoNEON(const short* input, short* left, short* right, int frames)
+{
+    int i = 0;
+    for (;i+8<=frames;i+=8)
+    {
+        int16x8x2_t const lr = vld2q_s16(input + (i*2));
+        vst1q_s16(left + i, lr.val[0]);
+        vst1q_s16(right + i, lr.val[1]);
+    }
+    SplitStereoScalar(input + (i*2), left + i, right + i, frames - i);
+}
+
+void MergeStereoNEON(const short* left, const short* right, short* output, int frames)
+{
+    int i = 0;
+    for (;i+8<=frames;i+=8)
+    {
+        int16x8x2_t lr;
+        lr.val[0] = vld1q_s16(left + i);
+        lr.val[1] = vld1q_s16(right + i);
+        vst2q_s16(output + (i*2), lr);
+    }
+    MergeStereoScalar(left + i, right + i, output + (i*2), frames - i);
+}
+
+void MonoToStereoNEON(short* buffer, int frames)
+{
+    // work backwards so output never overwrites unread input
+    int const head = frames % 8;
+    for (int i=frames-8;i>=head;i-=8)
+    {
+        int16x8x2_t lr;
+        lr.val[0] = lr.val[1] = vld1q_s16(buffer + i);
+        vst2q_s16(buffer + (i*2), lr);
+    }
+    MonoToStereoScalar(buffer, head);
+}
+
+int DotProductNEON(const short* a, const short* b, int n)
+{
+    int32x4_t sum = vdupq_n_s32(0);
+    int i = 0;
+    for (;i+8<=n;i+=8)
+    {
+        int16x8_t const x = vld1q_s16(a + i);
+        int16x8_t const y = vld1q_s16(b + i);
+        sum = vmlal_s16(sum, vget_low_s16(x), vget_low_s16(y));
+        sum = vmlal_s16(sum, vget_high_s16(x), vget_high_s16(y));
+    }
+    uint32x4_t const usum = vreinterpretq_u32_s32(sum);
+    uint32_t const total = vgetq_lane_u32(usum, 0) + vgetq_lane_u32(usum, 1) +
+        vgetq_lane_u32(usum, 2) + vgetq_lane_u32(usum, 3);
+    return int(total + uint32_t(DotProductScalar(a + i, b + i, n - i)));
+}
+
+#endif /* AUDIOKERNELS_NEON */
+
+struct AudioKernels
+{
+    AudioKernelISA isa;
+    void (*mix)(short* dst, const short* src, int n);
+    void (*gain)(short* buffer, int n, float factor);
+    void (*split)(const short* input, short* left, short* right, int frames);
+    void (*merge)(const short* left, const short* right, short* output, int frames);
+    void (*monotostereo)(short* buffer, int frames);
+    int (*dot)(const short* a, const short* b, int n);
+};
+
+constexpr AudioKernels SCALAR_KERNELS = { AUDIOKERNEL_SCALAR, MixScalar, GainScalar,
+                                          SplitStereoScalar, MergeStereoScalar, MonoToStereoScalar,
+                                          DotProductScalar };
+#if defined(AUDIOKERNELS_SSE2)
+constexpr AudioKernels SSE2_KERNELS = { AUDIOKERNEL_SSE2, MixSSE2, GainSSE2,
+                                        SplitStereoSSE2, MergeStereoSSE2, MonoToStereoSSE2,
+                                        DotProductSSE2 };
+#endif
+#if defined(AUDIOKERNELS_AVX2)
+// stereo (de)interleaving is memory bound so SSE2 is used
+constexpr AudioKernels AVX2_KERNELS = { AUDIOKERNEL_AVX2, MixAVX2, GainAVX2,
+                                        SplitStereoSSE2, MergeStereoSSE2, MonoToStereoSSE2,
+                                        DotProductAVX2 };
+#endif
+#if defined(AUDIOKERNELS_NEON)
+constexpr AudioKernels NEON_KERNELS = { AUDIOKERNEL_NEON, MixNEON, GainNEON,
+                                        SplitStereoNEON, MergeStereoNEON, MonoToStereoNEON,
+                                        DotProductNEON };
+#endif
+
+const AudioKernels* FindKernels(AudioKernelISA isa)
+{
+    switch (isa)
+    {
+    case AUDIOKERNEL_SCALAR :
+        return &SCALAR_KERNELS;
+    case AUDIOKERNEL_SSE2 :
+#if defined(AUDIOKERNELS_SSE2)
+        return &SSE2_KERNELS;
+#else
+        break;
+#endif
+    case AUDIOKERNEL_AVX2 :
+#if defined(AUDIOKERNELS_AVX2)
+        if (CpuHasAVX2())
+            return &AVX2_KERNELS;
+#endif
+        break;
+    case AUDIOKERNEL_NEON :
+#if defined(AUDIOKERNELS_NEON)
+        return &NEON_KERNELS;
+#else
+        break;
+#endif
+    }
+    return nullptr;
+}
+
+const AudioKernels* BestKernels()
+{
+    for (auto isa : { AUDIOKERNEL_AVX2, AUDIOKERNEL_NEON, AUDIOKERNEL_SSE2 })
+    {
+        const AudioKernels* k = FindKernels(isa);
+        if (k != nullptr)
+            return k;
+    }
+    return &SCALAR_KERNELS;
+}
+
+std::atomic<const AudioKernels*>& Kernels()
+{
+    static std::atomic<const AudioKernels*> kernels(BestKernels());
+    return kernels;
+}
+
+} // namespace
+
+AudioKernelISA GetAudioKernelISA()
+{
+    return Kernels().load()->isa;
+}
+
+bool SetAudioKernelISA(AudioKernelISA isa)
+{
+    const AudioKernels* k = FindKernels(isa);
+    if (k == nullptr)
+        return false;
+    Kernels() = k;
+    return true;
+}
+
+const char* GetAudioKernelISAName(AudioKernelISA isa)
+{
+    switch (isa)
+    {
+    case AUDIOKERNEL_SCALAR : return "Scalar";
+    case AUDIOKERNEL_SSE2 : return "SSE2";
+    case AUDIOKERNEL_AVX2 : return "AVX2";
+    case AUDIOKERNEL_NEON : return "NEON";
+    }
+    return "Unknown";
+}
+
+void AudioMix(short* dst, const short* src, int n)
+{
+    assert(n >= 0);
+    Kernels().load(std::memory_order_relaxed)->mix(dst, src, n);
+}
+
+void AudioGain(short* buffer, int n, float factor)
+{
+    assert(n >= 0);
+    Kernels().load(std::memory_order_relaxed)->gain(buffer, n, factor);
+}
+
+void AudioSplitStereo(const short* input, short* left, short* right, int frames)
+{
+    assert(frames >= 0);
+    Kernels().load(std::memory_order_relaxed)->split(input, left, right, frames);
+}
+
+void AudioMergeStereo(const short* left, const short* right, short* output, int frames)
+{
+    assert(frames >= 0);
+    Kernels().load(std::memory_order_relaxed)->merge(left, right, output, frames);
+}
+
+void AudioMonoToStereo(short* buffer, int frames)
+{
+    assert(frames >= 0);
+    Kernels().load(std::memory_order_relaxed)->monotostereo(buffer, frames);
+}
+
+int AudioDotProduct(const short* a, const short* b, int n)
+{
+    assert(n >= 0);
+    return Kernels().load(std::memory_order_relaxed)->dot(a, b, n);
+}
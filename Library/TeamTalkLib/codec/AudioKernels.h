@@ -0,0 +1,59 @@
+/*
+ * Copyright (c) 2005-2018, BearWare.dk
+ *
+ * Contact Information:
+ *
+ * Bjoern D. Rasmussen
+ * Kirketoften 5
+ * DK-8260 Viby J
+ * Denmark
+ * Email: contact@bearware.dk
+ * Phone: +45 20 20 54 59
+ * Web: http://www.bearware.dk
+ *
+ * This source code is part of the TeamTalk SDK owned by
+ * BearWare.dk. Use of this file, or its compiled unit, requires a
+ * TeamTalk SDK License Key issued by BearWare.dk.
+ *
+ * The TeamTalk SDK License Agreement along with its Terms and
+ * Conditions are outlined in the file License.txt included with the
+ * TeamTalk SDK distribution.
+ *
+ */
+
+#ifndef AUDIOKERNELS_H
+#define AUDIOKERNELS_H
+
+// PCM16 kernels used in the audio callbacks for mixing and gain. The
+// instruction set is selected at runtime from what the CPU supports.
+// All instruction sets produce bit-exact results.
+
+enum AudioKernelISA
+{
+    AUDIOKERNEL_SCALAR,
+    AUDIOKERNEL_SSE2,
+    AUDIOKERNEL_AVX2,
+    AUDIOKERNEL_NEON,
+};
+
+// Instruction set currently used by the kernels
+AudioKernelISA GetAudioKernelISA();
+// Returns false if 'isa' is not supported by this CPU or build
+bool SetAudioKernelISA(AudioKernelISA isa);
+const char* GetAudioKernelISAName(AudioKernelISA isa);
+
+// dst[i] = saturate(dst[i] + src[i]) for 'n' samples
+void AudioMix(short* dst, const short* src, int n);
+// buffer[i] = saturate(int(buffer[i] * factor)) for 'n' samples
+void AudioGain(short* buffer, int n, float factor);
+// Deinterleave 'frames' stereo samples
+void AudioSplitStereo(const short* input, short* left, short* right, int frames);
+// Interleave 'frames' samples into stereo
+void AudioMergeStereo(const short* left, const short* right, short* output, int frames);
+// Duplicate 'frames' mono samples into stereo in place, i.e. 'buffer'
+// must hold 2 * frames samples
+void AudioMonoToStereo(short* buffer, int frames);
+// Sum of a[i] * b[i] for 'n' samples. Result wraps at 32 bits
+int AudioDotProduct(const short* a, const short* b, int n);
+
+#endif
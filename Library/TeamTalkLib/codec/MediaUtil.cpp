@@ -23,12 +23,18 @@
 
 #include "MediaUtil.h"
 
+#include <ace/Lock_Adapter_T.h>
+#include <ace/Malloc_Allocator.h>
 #include <ace/Message_Block.h>
 #include <ace/OS_Memory.h>
+#include <ace/Recursive_Thread_Mutex.h>
+#include <ace/Time_Value.h>
 
 #include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <cmath>
+#include <cstring>
 #include <numbers>
 
 namespace media {
@@ -66,20 +72,14 @@ void SplitStereo(const short* input_buffer, int input_samples,
     left_chan.resize(input_samples);
     right_chan.resize(input_samples);
 
-    for(int i=0;i<input_samples;i++)
-        left_chan[i] = input_buffer[i*2];
-    for(int i=0;i<input_samples;i++)
-        right_chan[i] = input_buffer[(i*2)+1];
+    AudioSplitStereo(input_buffer, left_chan.data(), right_chan.data(), input_samples);
 }
 
 void MergeStereo(const std::vector<short>& left_chan, 
                  const std::vector<short>& right_chan,
                  short* output_buffer, int output_samples)
 {
-    for(int i=0;i<output_samples;i++)
-        output_buffer[i*2] = left_chan[i];
-    for(int i=0;i<output_samples;i++)
-        output_buffer[(i*2)+1] = right_chan[i];
+    AudioMergeStereo(left_chan.data(), right_chan.data(), output_buffer, output_samples);
 }
 
 void SelectStereo(StereoMask stereo, short* buffer, int samples)
@@ -106,6 +106,113 @@ void SelectStereo(StereoMask stereo, short* buffer, int samples)
     }
 }
 
+namespace {
+// Required normalized correlation between two consecutive pitch
+// periods before they are merged or repeated
+constexpr auto TIMESTRETCH_MIN_CORRELATION = 0.5;
+// Average amplitude below which audio is considered silence and can
+// be stretched without a pitch match
+constexpr auto TIMESTRETCH_SILENCE_LEVEL = 64;
+
+// Find period 'P' where x[0..P) best matches x[P..2P). Channels are
+// mixed for the search.
+int FindPitchPeriod(const std::vector<short>& buffer, int channels,
+                    int min_period, int max_period, double& correlation)
+{
+    int const samples = int(buffer.size()) / channels;
+    max_period = std::min(max_period, samples / 2);
+    correlation = 0;
+    if (min_period <= 0 || max_period < min_period)
+        return 0;
+
+    auto mono = [&](int i)
+    {
+        int v = 0;
+        for (int c=0;c<channels;c++)
+            v += buffer[(i * channels) + c];
+        return double(v) / channels;
+    };
+
+    // silence can be stretched by any amount
+    double level = 0;
+    for (int i=0;i<2*max_period;i++)
+        level += std::abs(mono(i));
+    if (level / (2 * max_period) < TIMESTRETCH_SILENCE_LEVEL)
+    {
+        correlation = 1;
+        return max_period;
+    }
+
+    // skip samples in correlation to bound cost at high sample rates
+    int const step = std::max(1, min_period / 20);
+    int best_period = 0;
+    for (int p=min_period;p<=max_period;p++)
+    {
+        double xy = 0, xx = 0, yy = 0;
+        for (int i=0;i<p;i+=step)
+        {
+            double const x = mono(i), y = mono(i + p);
+            xy += x * y;
+            xx += x * x;
+            yy += y * y;
+        }
+        if (xx <= 0 || yy <= 0)
+            continue;
+        double const corr = xy / std::sqrt(xx * yy);
+        if (corr > correlation)
+        {
+            correlation = corr;
+            best_period = p;
+        }
+    }
+    return best_period;
+}
+} // namespace
+
+int AudioAccelerate(std::vector<short>& buffer, int channels, int min_period, int max_period)
+{
+    double corr;
+    int const period = FindPitchPeriod(buffer, channels, min_period, max_period, corr);
+    if (period == 0 || corr < TIMESTRETCH_MIN_CORRELATION)
+        return 0;
+
+    // cross-fade x[0..P) into x[P..2P) and drop the second period
+    for (int i=0;i<period;i++)
+    {
+        for (int c=0;c<channels;c++)
+        {
+            int const a = buffer[(i * channels) + c];
+            int const b = buffer[((i + period) * channels) + c];
+            buffer[(i * channels) + c] = short(a + ((b - a) * i / period));
+        }
+    }
+    buffer.erase(buffer.begin() + (period * channels), buffer.begin() + (2 * period * channels));
+    return period;
+}
+
+int AudioExpand(std::vector<short>& buffer, int channels, int min_period, int max_period)
+{
+    double corr;
+    int const period = FindPitchPeriod(buffer, channels, min_period, max_period, corr);
+    if (period == 0 || corr < TIMESTRETCH_MIN_CORRELATION)
+        return 0;
+
+    // insert a period after x[0..P) which cross-fades from x[P..2P)
+    // back to x[0..P) so x[P..] continues seamlessly
+    std::vector<short> repeat(size_t(period) * channels);
+    for (int i=0;i<period;i++)
+    {
+        for (int c=0;c<channels;c++)
+        {
+            int const a = buffer[((i + period) * channels) + c];
+            int const b = buffer[(i * channels) + c];
+            repeat[(i * channels) + c] = short(a + ((b - a) * i / period));
+        }
+    }
+    buffer.insert(buffer.begin() + (period * channels), repeat.begin(), repeat.end());
+    return period;
+}
+
 StereoMask ToStereoMask(bool muteleft, bool muteright)
 {
     StereoMask stereo = STEREO_BOTH;
@@ -153,6 +260,181 @@ media::VideoFrame* VideoFrameFromMsgBlock(ACE_Message_Block* mb)
     return frm;
 }
 
+// Data block allocator which also holds the blocks' lock. Every data
+// block holds a reference so the lock stays valid until the last
+// block is freed, also if the pool is destroyed first.
+class VideoFramePool::BlockLock : public ACE_New_Allocator
+{
+public:
+    // recursive since reference_count() and duplicate() also lock
+    ACE_Lock_Adapter<ACE_Recursive_Thread_Mutex> lock;
+
+    void* malloc(size_t nbytes) override
+    {
+        void* ptr = ACE_New_Allocator::malloc(nbytes);
+        if (ptr != nullptr)
+            ++m_refs;
+        return ptr;
+    }
+    void free(void* ptr) override
+    {
+        ACE_New_Allocator::free(ptr);
+        Unref();
+    }
+    void Unref()
+    {
+        if (--m_refs == 0)
+            delete this;
+    }
+private:
+    std::atomic<int> m_refs{1}; // pool's reference
+};
+
+VideoFramePool::VideoFramePool(size_t max_frames)
+    : m_lock(new BlockLock())
+    , m_max_frames(max_frames)
+{
+}
+
+VideoFramePool::~VideoFramePool()
+{
+    Clear();
+    m_lock->Unref();
+}
+
+ACE_Message_Block* VideoFramePool::Acquire(media::VideoFrame& frm)
+{
+    assert(frm.frame_length);
+
+    // message blocks can be released by application while pool
+    // is looking for free blocks
+    ACE_GUARD_RETURN(ACE_Lock, g, m_lock->lock, nullptr);
+
+    size_t const bytes = sizeof(frm) + frm.frame_length;
+    ACE_Message_Block* mb = nullptr;
+    for (auto i = m_blocks.begin(); i != m_blocks.end() && (mb == nullptr);)
+    {
+        if ((*i)->reference_count() > 1)
+        {
+            ++i;
+        }
+        else if ((*i)->size() != bytes)
+        {
+            // resolution changed
+            (*i)->release();
+            i = m_blocks.erase(i);
+        }
+        else
+        {
+            mb = *i;
+        }
+    }
+
+    if (mb == nullptr)
+    {
+        if (m_blocks.size() >= m_max_frames)
+            return VideoFrameInMsgBlock(frm);
+
+        ACE_NEW_RETURN(mb, ACE_Message_Block(bytes, ACE_Message_Block::MB_DATA,
+                                             nullptr, nullptr, nullptr,
+                                             &m_lock->lock,
+                                             ACE_DEFAULT_MESSAGE_BLOCK_PRIORITY,
+                                             ACE_Time_Value::zero,
+                                             ACE_Time_Value::max_time,
+                                             m_lock), nullptr);
+        m_blocks.push_back(mb);
+    }
+
+    mb->reset();
+    frm.frame = &mb->rd_ptr()[sizeof(frm)];
+    mb->copy(reinterpret_cast<const char*> (&frm), sizeof(frm));
+    return mb->duplicate();
+}
+
+ACE_Message_Block* VideoFramePool::Copy(const media::VideoFrame& frm)
+{
+    assert(frm.frame);
+    media::VideoFrame tmp = frm;
+    ACE_Message_Block* mb = Acquire(tmp);
+    if (mb != nullptr)
+        std::memcpy(tmp.frame, frm.frame, frm.frame_length);
+    return mb;
+}
+
+void VideoFramePool::Clear()
+{
+    for (auto* mb : m_blocks)
+        mb->release();
+    m_blocks.clear();
+}
+
+static void HalfSizePlane(const uint8_t* src, int src_stride, int bpp,
+                          uint8_t* dst, int dst_w, int dst_h)
+{
+    for (int y=0;y<dst_h;++y)
+    {
+        const uint8_t* row0 = &src[(y * 2) * src_stride];
+        const uint8_t* row1 = row0 + src_stride;
+        for (int x=0;x<dst_w;++x)
+        {
+            for (int c=0;c<bpp;++c)
+            {
+                int const i = (x * 2 * bpp) + c;
+                int const sum = row0[i] + row0[i + bpp] + row1[i] + row1[i + bpp];
+                *dst++ = uint8_t((sum + 2) / 4);
+            }
+        }
+    }
+}
+
+media::VideoFrame VideoFrameHalfSize(const media::VideoFrame& frm, std::vector<char>& buf)
+{
+    // keep dimensions even so I420 chroma planes divide evenly
+    int const w = (frm.width / 2) & ~1, h = (frm.height / 2) & ~1;
+    if (w <= 0 || h <= 0)
+        return {};
+
+    const auto* src = reinterpret_cast<const uint8_t*>(frm.frame);
+    switch (frm.fourcc)
+    {
+    case media::FOURCC_RGB32 :
+    {
+        assert(frm.frame_length >= RGB32_BYTES(frm.width, frm.height));
+        buf.resize(RGB32_BYTES(w, h));
+        HalfSizePlane(src, frm.width * 4, 4,
+                      reinterpret_cast<uint8_t*>(buf.data()), w, h);
+        break;
+    }
+    case media::FOURCC_I420 :
+    {
+        int const src_cw = (frm.width + 1) / 2, src_ch = (frm.height + 1) / 2;
+        assert(frm.frame_length >= frm.width * frm.height + 2 * src_cw * src_ch);
+        buf.resize((w * h) + (2 * (w / 2) * (h / 2)));
+        auto* dst = reinterpret_cast<uint8_t*>(buf.data());
+        // Y plane
+        HalfSizePlane(src, frm.width, 1, dst, w, h);
+        src += frm.width * frm.height;
+        dst += w * h;
+        // U and V planes
+        for (int p=0;p<2;++p)
+        {
+            HalfSizePlane(src, src_cw, 1, dst, w / 2, h / 2);
+            src += src_cw * src_ch;
+            dst += (w / 2) * (h / 2);
+        }
+        break;
+    }
+    default :
+        return {};
+    }
+
+    media::VideoFrame result(buf.data(), int(buf.size()), w, h, frm.fourcc, frm.top_down);
+    result.key_frame = frm.key_frame;
+    result.stream_id = frm.stream_id;
+    result.timestamp = frm.timestamp;
+    return result;
+}
+
 ACE_Message_Block* AudioFrameToMsgBlock(const media::AudioFrame& frame, bool skip_copy)
 {
     ACE_Message_Block* mb = nullptr;
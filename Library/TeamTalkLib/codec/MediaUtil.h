@@ -24,6 +24,7 @@
 #ifndef MEDIAUTIL_H
 #define MEDIAUTIL_H
 
+#include "AudioKernels.h"
 #include "mystd/MyStd.h"
 
 #include <ace/Message_Block.h>
@@ -263,6 +264,37 @@ ACE_Message_Block* VideoFrameInMsgBlock(media::VideoFrame& frm,
 ACE_Message_Block* VideoFrameToMsgBlock(const media::VideoFrame& frm,
                                         ACE_Message_Block::ACE_Message_Type mb_type = ACE_Message_Block::MB_DATA);
 media::VideoFrame* VideoFrameFromMsgBlock(ACE_Message_Block* mb);
+// Recycles ACE_Message_Blocks holding a media::VideoFrame and its
+// image data. A block is reused once all references returned by
+// Acquire() have been released. Acquire() must not be called
+// concurrently.
+class VideoFramePool : private NonCopyable
+{
+public:
+    explicit VideoFramePool(size_t max_frames = 4);
+    ~VideoFramePool();
+
+    // Same as VideoFrameInMsgBlock() but message block is taken from
+    // pool. Call release() on returned message block when done.
+    ACE_Message_Block* Acquire(media::VideoFrame& frm);
+    // Same as VideoFrameToMsgBlock() but message block is taken from pool.
+    ACE_Message_Block* Copy(const media::VideoFrame& frm);
+
+    void Clear();
+
+private:
+    // Lock of the pool's message blocks. Outlives the pool until
+    // application has released all blocks.
+    class BlockLock;
+    BlockLock* m_lock;
+    std::vector<ACE_Message_Block*> m_blocks;
+    size_t m_max_frames;
+};
+
+// Reduce width and height of 'frm' by half using a 2x2 box
+// filter. Only FOURCC_RGB32 and FOURCC_I420 are supported. Returned
+// frame points to 'buf' and is invalid if 'frm' is unsupported.
+media::VideoFrame VideoFrameHalfSize(const media::VideoFrame& frm, std::vector<char>& buf);
 
 ACE_Message_Block* AudioFrameToMsgBlock(const media::AudioFrame& frame, bool skip_copy = false);
 media::AudioFrame* AudioFrameFromMsgBlock(ACE_Message_Block* mb);
@@ -290,6 +322,14 @@ StereoMask ToStereoMask(bool muteleft, bool muteright);
 
 void SelectStereo(StereoMask stereo, short* buffer, int samples);
 
+// Time-stretching of interleaved PCM16 by overlap-add of one pitch
+// period (WSOLA). The period is searched in [min_period, max_period]
+// samples and limited to half of 'buffer'. Returns number of samples
+// per channel removed/inserted or 0 if 'buffer' is not periodic
+// enough for an inaudible change.
+int AudioAccelerate(std::vector<short>& buffer, int channels, int min_period, int max_period);
+int AudioExpand(std::vector<short>& buffer, int channels, int min_period, int max_period);
+
 // returns new sample_index
 int GenerateTone(media::AudioFrame& audblock, int sample_index, int tone_freq,
                  double volume = 8000, bool mute_left = false, bool mute_right = false);
@@ -302,42 +342,7 @@ constexpr int GAIN_MIN = 0;
     if ((gain_numerator) == (gain_denominator))                     \
         break;                                                  \
     float factor = float(gain_numerator) / float(gain_denominator);   \
-    int samples_total = (channels) * (n_samples);               \
-    short* samplesbuffer = inputsamples;                        \
-    if(samples_total % 4 == 0)                                  \
-    {                                                           \
-        int v[4];                                               \
-        for(int i=0;i<samples_total;i+=4)                       \
-        {                                                       \
-            v[0] = (int)(samplesbuffer[i] * factor);            \
-            v[1] = (int)(samplesbuffer[i+1] * factor);          \
-            v[2] = (int)(samplesbuffer[i+2] * factor);          \
-            v[3] = (int)(samplesbuffer[i+3] * factor);          \
-            if(v[0] > 32767) v[0] = 32767;                      \
-            else if (v[0] < -32768) v[0] = -32768;              \
-            if(v[1] > 32767) v[1] = 32767;                      \
-            else if (v[1] < -32768) v[1] = -32768;              \
-            if(v[2] > 32767) v[2] = 32767;                      \
-            else if (v[2] < -32768) v[2] = -32768;              \
-            if(v[3] > 32767) v[3] = 32767;                      \
-            else if (v[3] < -32768) v[3] = -32768;              \
-            samplesbuffer[i] = (short)v[0];                     \
-            samplesbuffer[i+1] = (short)v[1];                   \
-            samplesbuffer[i+2] = (short)v[2];                   \
-            samplesbuffer[i+3] = (short)v[3];                   \
-        }                                                       \
-    }                                                           \
-    else                                                        \
-    {                                                           \
-        int v;                                                  \
-        for(int i=0;i<samples_total;i++)                        \
-        {                                                       \
-            v = (int)(samplesbuffer[i] * factor);               \
-            if(v > 32767) v = 32767;                            \
-            else if (v < -32768) v = -32768;                    \
-            samplesbuffer[i] = (short)v;                        \
-        }                                                       \
-    }                                                           \
+    AudioGain(inputsamples, (channels) * (n_samples), factor);  \
 } while(0)
 
 
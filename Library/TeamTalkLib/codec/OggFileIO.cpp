@@ -24,6 +24,7 @@
 #include "OggFileIO.h"
 
 #include <cassert>
+#include <cstdint>
 
 OggOutput::OggOutput()
     : m_os()
@@ -815,6 +816,7 @@ void OpusFile::Close()
     m_oggin.Close();
 
     m_last_granule_pos = m_granule_pos = m_packet_no = 0;
+    m_last_toc = -1;
     m_header = {};
 }
 
@@ -828,8 +830,70 @@ int OpusFile::GetChannels() const
     return m_header.channels;
 }
 
+namespace {
+
+// Duration of a frame at 48 kHz from config in TOC byte (RFC 6716,
+// section 3.1)
+int OpusTOCFrameSamples(int toc)
+{
+    int const config = toc >> 3;
+    if (config < 12) // SILK
+    {
+        const int durations[] = {480, 960, 1920, 2880};
+        return durations[config & 3];
+    }
+    if (config < 16) // Hybrid
+        return (config & 1) ? 960 : 480;
+    return 120 << (config & 3); // CELT
+}
+
+}
+
+int OpusFile::WriteLost(int framesize, bool last)
+{
+    int const samples48k = framesize * 48000 / m_header.input_sample_rate;
+    int const stereo = m_header.channels == 2 ? 0x04 : 0;
+
+    // keep mode and bandwidth of previous packet if its frame
+    // duration fits, otherwise CELT fullband (SILK wideband for 40
+    // and 60 msec)
+    int config = -1;
+    if (m_last_toc >= 0 && samples48k % OpusTOCFrameSamples(m_last_toc) == 0)
+        config = m_last_toc >> 3;
+    else if (samples48k % 960 == 0 && samples48k > 2880)
+        config = 31; // multiple 20 msec frames
+    else
+    {
+        for (int c : {28, 29, 30, 31, 10, 11})
+        {
+            if (OpusTOCFrameSamples(c << 3) == samples48k)
+                config = c;
+        }
+    }
+    assert(config >= 0);
+    if (config < 0)
+        return -1;
+
+    // one frame (code 0) or several CBR frames (code 3). Empty frames
+    // are decoded using packet loss concealment
+    uint8_t packet[2];
+    int const frames = samples48k / OpusTOCFrameSamples(config << 3);
+    packet[0] = uint8_t((config << 3) | stereo | (frames == 1 ? 0 : 3));
+    packet[1] = uint8_t(frames);
+
+    int const toc = m_last_toc;
+    int const ret = WriteEncoded(reinterpret_cast<const char*>(packet), frames == 1 ? 1 : 2, framesize, last);
+    m_last_toc = toc;
+    return ret;
+}
+
 int OpusFile::WriteEncoded(const char* enc_data, int enc_len, int framesize, bool last)
 {
+    if (enc_data == nullptr || enc_len <= 0)
+        return WriteLost(framesize, last);
+
+    m_last_toc = uint8_t(enc_data[0]);
+
     ogg_packet op = {};
     op.packet = reinterpret_cast<unsigned char*>(const_cast<char*>(enc_data));
     op.bytes = enc_len;
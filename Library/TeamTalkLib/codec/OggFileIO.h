@@ -201,7 +201,13 @@ public:
     int GetSampleRate() const;
     int GetChannels() const;
 
+    // Write an encoded Opus packet of 'framesize' samples. An empty
+    // packet is written as a lost packet, see WriteLost()
     int WriteEncoded(const char* enc_data, int enc_len, int framesize, bool last);
+    // Write an Opus packet with empty frames in place of a lost packet
+    // of 'framesize' samples. The decoder conceals it and the granule
+    // position stays correct.
+    int WriteLost(int framesize, bool last);
 
     const unsigned char* ReadEncoded(int& bytes, ogg_int64_t* sampleduration = nullptr);
 
@@ -218,6 +224,8 @@ private:
 
     // for encoding
     ogg_int64_t m_granule_pos, m_packet_no;
+    // TOC byte of most recent packet. Used for lost packets
+    int m_last_toc = -1;
     // for decoding
     ogg_int64_t m_last_granule_pos;
 };
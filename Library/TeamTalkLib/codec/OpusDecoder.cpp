@@ -23,6 +23,7 @@
 
 #include "OpusDecoder.h"
 
+#include <algorithm>
 #include <cassert>
 
 OpusDecode::OpusDecode()
@@ -43,6 +44,13 @@ bool OpusDecode::Open(int sample_rate, int channels)
     int err = 0;
     m_decoder = opus_decoder_create(sample_rate, channels, &err);
     assert(err == 0);
+
+#if defined(OPUS_SET_DRED_DURATION_REQUEST)
+    // OPUS_UNIMPLEMENTED if libopus is built without DRED
+    m_samplerate = sample_rate;
+    m_dred_decoder = opus_dred_decoder_create(&err);
+    m_dred = opus_dred_alloc(&err);
+#endif
     return m_decoder != nullptr;
 }
 
@@ -51,6 +59,15 @@ void OpusDecode::Close()
     if(m_decoder != nullptr)
         opus_decoder_destroy(m_decoder);
     m_decoder = nullptr;
+
+#if defined(OPUS_SET_DRED_DURATION_REQUEST)
+    if (m_dred_decoder != nullptr)
+        opus_dred_decoder_destroy(m_dred_decoder);
+    m_dred_decoder = nullptr;
+    if (m_dred != nullptr)
+        opus_dred_free(m_dred);
+    m_dred = nullptr;
+#endif
 }
 
 void OpusDecode::Reset()
@@ -72,3 +89,38 @@ int OpusDecode::Decode(const char* input_buffer, int input_bufsize,
                        (input_buffer != nullptr)?input_bufsize:0, output_buffer, 
                        output_samples, (input_buffer != nullptr)?0:1);
 }
+
+int OpusDecode::DecodeFEC(const char* input_buffer, int input_bufsize,
+                          short* output_buffer, int output_samples)
+{
+    assert(m_decoder);
+    assert(input_buffer);
+    assert(output_buffer);
+    return opus_decode(m_decoder,
+                       reinterpret_cast<const unsigned char*>(input_buffer),
+                       input_bufsize, output_buffer, output_samples, 1);
+}
+
+#if defined(OPUS_SET_DRED_DURATION_REQUEST)
+int OpusDecode::ParseDRED(const char* input_buffer, int input_bufsize, int max_samples)
+{
+    assert(m_decoder);
+    assert(input_buffer);
+    if (m_dred_decoder == nullptr || m_dred == nullptr)
+        return 0;
+
+    int dred_end = 0;
+    int const ret = opus_dred_parse(m_dred_decoder, m_dred,
+                                    reinterpret_cast<const unsigned char*>(input_buffer),
+                                    input_bufsize, max_samples, m_samplerate, &dred_end, 0);
+    return std::max(ret, 0);
+}
+
+int OpusDecode::DecodeDRED(int offset, short* output_buffer, int output_samples)
+{
+    assert(m_decoder);
+    assert(m_dred);
+    assert(output_buffer);
+    return opus_decoder_dred_decode(m_decoder, m_dred, offset, output_buffer, output_samples);
+}
+#endif
@@ -39,9 +39,29 @@ public:
 
     int Decode(const char* input_buffer, int input_bufsize, 
                short* output_buffer, int output_samples);
+    // Decode the previous (lost) frame from the in-band FEC data of
+    // 'input_buffer'. Falls back to loss concealment if 'input_buffer'
+    // has no FEC data.
+    int DecodeFEC(const char* input_buffer, int input_bufsize,
+                  short* output_buffer, int output_samples);
+
+#if defined(OPUS_SET_DRED_DURATION_REQUEST) /* Opus 1.5 */
+    // Parse the Deep REDundancy (DRED) of 'input_buffer'. Returns the
+    // number of samples before 'input_buffer' which can be recovered
+    // (0 if libopus is built without DRED).
+    int ParseDRED(const char* input_buffer, int input_bufsize, int max_samples);
+    // Decode audio 'offset' samples before the start of the packet
+    // passed to ParseDRED()
+    int DecodeDRED(int offset, short* output_buffer, int output_samples);
+#endif
 
 private:
     OpusDecoder* m_decoder;
+#if defined(OPUS_SET_DRED_DURATION_REQUEST)
+    OpusDREDDecoder* m_dred_decoder = nullptr;
+    OpusDRED* m_dred = nullptr;
+    int m_samplerate = 0;
+#endif
 };
 
 #endif
@@ -119,6 +119,30 @@ bool OpusEncode::SetFEC(bool enable)
     return err == 0;
 }
 
+bool OpusEncode::SetPacketLoss(int percent)
+{
+    assert(m_encoder);
+    if(m_encoder == nullptr)
+        return false;
+
+    int const err = opus_encoder_ctl(m_encoder, OPUS_SET_PACKET_LOSS_PERC(percent));
+    assert(err == 0);
+    return err == 0;
+}
+
+#if defined(OPUS_SET_DRED_DURATION_REQUEST)
+bool OpusEncode::SetDRED(int msec)
+{
+    assert(m_encoder);
+    if(m_encoder == nullptr)
+        return false;
+
+    // duration is in 10 msec units
+    int const err = opus_encoder_ctl(m_encoder, OPUS_SET_DRED_DURATION(msec / 10));
+    return err == 0;
+}
+#endif
+
 bool OpusEncode::SetBitrate(int bitrate)
 {
     assert(m_encoder);
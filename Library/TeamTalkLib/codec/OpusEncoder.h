@@ -45,6 +45,15 @@ public:
     bool SetVBR(bool enable);
     bool SetVBRConstraint(bool enable);
     bool SetDTX(bool enable);
+    // Expected packet loss in percent. Controls how much in-band FEC
+    // the encoder adds when FEC is enabled.
+    bool SetPacketLoss(int percent);
+#if defined(OPUS_SET_DRED_DURATION_REQUEST) /* Opus 1.5 */
+    // Max duration of Deep REDundancy (DRED) to add to packets. Like
+    // in-band FEC the amount depends on SetPacketLoss(). Fails if
+    // libopus is built without DRED.
+    bool SetDRED(int msec);
+#endif
 
     int Encode(const short* input_buffer, int input_samples,
                char* output_buffer, int output_bufsize);
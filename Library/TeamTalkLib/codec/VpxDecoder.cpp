@@ -25,12 +25,16 @@
 
 #include <vpx/vp8dx.h>
 
+#include <algorithm>
 #include <cassert>
 #include <cstddef>
 #include <cstdint>
 #include <cstring>
+#include <thread>
 
-#define dec_interface vpx_codec_vp8_dx()
+// VP9 decodes tile columns (min. 256 pixels wide) in parallel so
+// threads beyond the number of tile columns are idle
+constexpr auto VPXDECODER_MAX_THREADS = 8;
 
 static void I420toRGB32(vpx_image_t* img, uint8_t* outbuf, int outlen);
 
@@ -46,7 +50,7 @@ VpxDecoder::~VpxDecoder()
     Close();
 }
 
-bool VpxDecoder::Open(int width, int height)
+bool VpxDecoder::Open(int width, int height, bool vp9)
 {
     int const flags = 0;
     vpx_codec_err_t ret;
@@ -55,8 +59,15 @@ bool VpxDecoder::Open(int width, int height)
         return false;
     
     m_cfg.threads = 0;
+    if (vp9)
+    {
+        int const cores = std::max(int(std::thread::hardware_concurrency()), 1);
+        m_cfg.threads = std::clamp(std::min(width / 256, cores), 1, VPXDECODER_MAX_THREADS);
+    }
     m_cfg.w = width;
     m_cfg.h = height;
+    m_vp9 = vp9;
+    vpx_codec_iface_t* dec_interface = vp9 ? vpx_codec_vp9_dx() : vpx_codec_vp8_dx();
     ret = vpx_codec_dec_init(&m_codec, dec_interface, &m_cfg, flags);
     assert(ret == VPX_CODEC_OK);
     return ret == VPX_CODEC_OK;
@@ -109,6 +120,29 @@ bool VpxDecoder::GetRGB32Image(char* outbuf, int buflen)
     return img != nullptr;
 }
 
+bool VpxDecoder::GetI420Image(char* outbuf, int buflen)
+{
+    vpx_image_t* img = GetVpxImage();
+    if (img == nullptr)
+        return false;
+
+    assert(img->fmt == VPX_IMG_FMT_I420);
+    int const cw = int(img->d_w + 1) / 2, ch = int(img->d_h + 1) / 2;
+    // resolution changed since 'buflen' was calculated
+    if (int(img->d_w * img->d_h) + 2 * cw * ch != buflen)
+        return false;
+
+    auto* dst = reinterpret_cast<uint8_t*>(outbuf);
+    for (unsigned y=0;y<img->d_h;++y, dst += img->d_w)
+        memcpy(dst, img->planes[VPX_PLANE_Y] + (y * img->stride[VPX_PLANE_Y]), img->d_w);
+    for (int p : {VPX_PLANE_U, VPX_PLANE_V})
+    {
+        for (int y=0;y<ch;++y, dst += cw)
+            memcpy(dst, img->planes[p] + (y * img->stride[p]), cw);
+    }
+    return true;
+}
+
 media::VideoFrame VpxDecoder::GetImage()
 {
     vpx_image_t* img = GetVpxImage();
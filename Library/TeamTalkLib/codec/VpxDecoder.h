@@ -39,18 +39,22 @@ public:
     VpxDecoder();
     ~VpxDecoder();
 
-    bool Open(int width, int height);
+    bool Open(int width, int height, bool vp9 = false);
     void Close();
 
     int PushDecoder(const char* frame_data, int frame_len);
     bool GetRGB32Image(char* outbuf, int buflen);
+    // Y, U and V planes stored contiguously without padding
+    bool GetI420Image(char* outbuf, int buflen);
     media::VideoFrame GetImage();
     const vpx_codec_dec_cfg_t& GetConfig() const { return m_cfg; }
+    bool IsVP9() const { return m_vp9; }
 
 private:
     vpx_image_t* GetVpxImage();
     vpx_codec_ctx_t m_codec;
     vpx_codec_dec_cfg_t m_cfg;
     vpx_codec_iter_t m_iter;
+    bool m_vp9 = false;
 };
 #endif
@@ -27,11 +27,11 @@
 
 #include <vpx/vp8cx.h>
 
+#include <algorithm>
 #include <cassert>
 #include <cstddef>
 #include <cstring>
-
-#define enc_interface vpx_codec_vp8_cx()
+#include <thread>
 
 static void RGB32toYUV420P(const unsigned char * rgb,
                     unsigned char * yuv,
@@ -52,11 +52,13 @@ VpxEncoder::~VpxEncoder()
     Close();
 }
 
-bool VpxEncoder::Open(int width, int height, int target_bitrate, int fps)
+bool VpxEncoder::Open(int width, int height, int target_bitrate, int fps, bool vp9)
 {
     if(m_codec.iface != nullptr)
         return false;
 
+    vpx_codec_iface_t* enc_interface = vp9 ? vpx_codec_vp9_cx() : vpx_codec_vp8_cx();
+
     vpx_codec_err_t ret;
     ret = vpx_codec_enc_config_default(enc_interface, &m_cfg, 0);
     assert(ret == VPX_CODEC_OK);
@@ -66,7 +68,14 @@ bool VpxEncoder::Open(int width, int height, int target_bitrate, int fps)
     m_cfg.g_w = width;
     m_cfg.g_h = height;
     m_cfg.g_error_resilient = VPX_ERROR_RESILIENT_DEFAULT;
-    m_cfg.g_threads = 4;
+    // VP9 only makes use of 'g_threads' if the frame is split into
+    // tile columns (min. 256 pixels wide) and rows are encoded in
+    // parallel.
+    int tile_columns_log2 = 0;
+    while (vp9 && (256 << (tile_columns_log2 + 1)) <= width && tile_columns_log2 < 2)
+        tile_columns_log2++;
+    int const cores = std::max(int(std::thread::hardware_concurrency()), 1);
+    m_cfg.g_threads = std::min(vp9 ? 1 << tile_columns_log2 : 4, cores);
     if(target_bitrate != 0)
         m_cfg.rc_target_bitrate = target_bitrate;
     m_cfg.g_timebase.num = 1;
@@ -74,7 +83,17 @@ bool VpxEncoder::Open(int width, int height, int target_bitrate, int fps)
 
     ret = vpx_codec_enc_init(&m_codec, enc_interface, &m_cfg, 0);
     assert(ret == VPX_CODEC_OK);
-    return ret == VPX_CODEC_OK;
+    if (ret != VPX_CODEC_OK)
+        return false;
+
+    if (vp9)
+    {
+        vpx_codec_control(&m_codec, VP9E_SET_TILE_COLUMNS, tile_columns_log2);
+        vpx_codec_control(&m_codec, VP9E_SET_ROW_MT, 1);
+        // cyclic refresh is recommended for real-time streams
+        vpx_codec_control(&m_codec, VP9E_SET_AQ_MODE, 3);
+    }
+    return true;
 }
 
 void VpxEncoder::Close()
@@ -86,16 +105,20 @@ void VpxEncoder::Close()
     m_frame_index = 0;
 }
 
-bool VpxEncoder::Update(int  /*target_bitrate*/)
+bool VpxEncoder::Update(int target_bitrate)
 {
     if (m_codec.iface == nullptr)
         return false;
 
+    if (target_bitrate != 0)
+        m_cfg.rc_target_bitrate = target_bitrate;
+
     return vpx_codec_enc_config_set(&m_codec, &m_cfg) == VPX_CODEC_OK;
 }
 
 vpx_codec_err_t VpxEncoder::Encode(const char* imgbuf, vpx_img_fmt fmt, int stride,
-                                   bool bottom_up, unsigned long  /*tm*/, int enc_deadline)
+                                   bool bottom_up, unsigned long  /*tm*/, int enc_deadline,
+                                   bool force_key_frame)
 {
     vpx_codec_err_t ret;
     vpx_image_t* img = nullptr;
@@ -117,7 +140,7 @@ vpx_codec_err_t VpxEncoder::Encode(const char* imgbuf, vpx_img_fmt fmt, int stri
     }
 
     ret = vpx_codec_encode(&m_codec, img, m_frame_index++, 1 /*duration*/,
-        0, enc_deadline);
+        (force_key_frame ? VPX_EFLAG_FORCE_KF : 0), enc_deadline);
     assert(ret == VPX_CODEC_OK);
     vpx_img_free(img);
 
@@ -125,7 +148,8 @@ vpx_codec_err_t VpxEncoder::Encode(const char* imgbuf, vpx_img_fmt fmt, int stri
 }
 
 vpx_codec_err_t VpxEncoder::EncodeRGB32(const char* imgbuf, int imglen, bool bottom_up_bmp,
-                                        unsigned long /* tm */, int enc_deadline)
+                                        unsigned long /* tm */, int enc_deadline,
+                                        bool force_key_frame)
 {
     vpx_codec_err_t ret;
     vpx_image_t* img = nullptr;
@@ -138,7 +162,7 @@ vpx_codec_err_t VpxEncoder::EncodeRGB32(const char* imgbuf, int imglen, bool bot
                    img->img_data, 4, static_cast<unsigned char>(bottom_up_bmp), m_cfg.g_w, m_cfg.g_h);
 
     ret = vpx_codec_encode(&m_codec, img, m_frame_index++, 1 /*duration*/, 
-                           0, enc_deadline);
+                           (force_key_frame ? VPX_EFLAG_FORCE_KF : 0), enc_deadline);
     assert(ret == VPX_CODEC_OK);
     vpx_img_free(img);
 
@@ -146,6 +170,12 @@ vpx_codec_err_t VpxEncoder::EncodeRGB32(const char* imgbuf, int imglen, bool bot
 }
 
 const char* VpxEncoder::GetEncodedData(int& len)
+{
+    bool key_frame;
+    return GetEncodedData(len, key_frame);
+}
+
+const char* VpxEncoder::GetEncodedData(int& len, bool& key_frame)
 {
     const vpx_codec_cx_pkt_t *pkt = nullptr;
     assert(m_codec.iface);
@@ -156,6 +186,7 @@ const char* VpxEncoder::GetEncodedData(int& len)
         {
         case VPX_CODEC_CX_FRAME_PKT :
             len = int(pkt->data.frame.sz);
+            key_frame = (pkt->data.frame.flags & VPX_FRAME_IS_KEY) != 0;
             return reinterpret_cast<const char*>(pkt->data.frame.buf);
         break;
         case VPX_CODEC_STATS_PKT :
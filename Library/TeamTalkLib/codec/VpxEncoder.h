@@ -38,17 +38,20 @@ public:
     VpxEncoder();
     ~VpxEncoder();
 
-    bool Open(int width, int height, int target_bitrate, int fps);
+    bool Open(int width, int height, int target_bitrate, int fps, bool vp9 = false);
     void Close();
     bool Update(int target_bitrate);
 
     vpx_codec_err_t Encode(const char* imgbuf, vpx_img_fmt fmt, int stride,
-                           bool bottom_up, unsigned long tm, int enc_deadline);
+                           bool bottom_up, unsigned long tm, int enc_deadline,
+                           bool force_key_frame = false);
 
     vpx_codec_err_t EncodeRGB32(const char* imgbuf, int imglen, bool bottom_up_bmp,
-                                unsigned long tm, int enc_deadline);
+                                unsigned long tm, int enc_deadline,
+                                bool force_key_frame = false);
 
     const char* GetEncodedData(int& len);
+    const char* GetEncodedData(int& len, bool& key_frame);
 
 private:
     vpx_codec_ctx_t m_codec;
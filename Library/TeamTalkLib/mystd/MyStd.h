@@ -24,6 +24,8 @@
 #if !defined(MYSTD_H)
 #define MYSTD_H
 
+#include <atomic>
+#include <cstddef>
 #include <cstdint>
 #include <regex>
 #include <string>
@@ -64,5 +66,64 @@ struct Rational
     bool IsOne() const { return numerator == denominator; }
 };
 
+// Lock-free ring of preallocated slots for one producer and one
+// consumer thread. The producer fills Back() and calls Push(). The
+// consumer reads Front() and calls Pop().
+template <typename T>
+class SPSCRing : NonCopyable
+{
+public:
+    SPSCRing() = default;
+    // Not thread-safe. Only call before producer and consumer start
+    void Reset(size_t capacity, const T& slot = T())
+    {
+        m_slots.assign(capacity + 1, slot);
+        m_read = 0;
+        m_write = 0;
+    }
+
+    // Slot to fill or nullptr if ring is full
+    T* Back()
+    {
+        size_t const w = m_write.load(std::memory_order_relaxed);
+        if (m_slots.empty() || Next(w) == m_read.load(std::memory_order_acquire))
+            return nullptr;
+        return &m_slots[w];
+    }
+    void Push()
+    {
+        size_t const w = m_write.load(std::memory_order_relaxed);
+        m_write.store(Next(w), std::memory_order_release);
+    }
+
+    // Oldest filled slot or nullptr if ring is empty
+    T* Front()
+    {
+        size_t const r = m_read.load(std::memory_order_relaxed);
+        if (r == m_write.load(std::memory_order_acquire))
+            return nullptr;
+        return &m_slots[r];
+    }
+    void Pop()
+    {
+        size_t const r = m_read.load(std::memory_order_relaxed);
+        m_read.store(Next(r), std::memory_order_release);
+    }
+
+    size_t Size() const
+    {
+        size_t const w = m_write.load(std::memory_order_acquire);
+        size_t const r = m_read.load(std::memory_order_acquire);
+        return m_slots.empty() ? 0 : (w + m_slots.size() - r) % m_slots.size();
+    }
+    size_t Capacity() const { return m_slots.empty() ? 0 : m_slots.size() - 1; }
+
+private:
+    size_t Next(size_t i) const { return (i + 1) % m_slots.size(); }
+
+    std::vector<T> m_slots;
+    std::atomic<size_t> m_read{0}, m_write{0};
+};
+
 #endif
 
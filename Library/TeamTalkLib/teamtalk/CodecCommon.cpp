@@ -83,6 +83,7 @@ namespace teamtalk
                 return false;
             return true;
         case CODEC_WEBM_VP8 :
+        case CODEC_WEBM_VP9 :
             break;
         }
         return false;
@@ -100,6 +101,7 @@ namespace teamtalk
             return codec.opus.samplerate;
         case CODEC_NO_CODEC :
         case CODEC_WEBM_VP8 :
+        case CODEC_WEBM_VP9 :
             break;
         }
         return 0;
@@ -119,6 +121,7 @@ namespace teamtalk
             return codec.opus.frame_size * codec.opus.frames_per_packet;
         case CODEC_NO_CODEC :
         case CODEC_WEBM_VP8 :
+        case CODEC_WEBM_VP9 :
             break;
         }
         return 0;
@@ -158,6 +161,7 @@ namespace teamtalk
             return codec.opus.channels;
         case CODEC_NO_CODEC :
         case CODEC_WEBM_VP8 :
+        case CODEC_WEBM_VP9 :
             break;
         }
         return 0;
@@ -175,6 +179,7 @@ namespace teamtalk
             return codec.opus.frame_size;
         case CODEC_NO_CODEC :
         case CODEC_WEBM_VP8 :
+        case CODEC_WEBM_VP9 :
             break;
         }
         return 0;
@@ -192,6 +197,7 @@ namespace teamtalk
             return codec.opus.frames_per_packet;
         case CODEC_NO_CODEC :
         case CODEC_WEBM_VP8 :
+        case CODEC_WEBM_VP9 :
             break;
         }
         return 0;
@@ -205,6 +211,7 @@ namespace teamtalk
             return GetAudioCodecVBRMode(codec) || codec.opus.dtx;
         case CODEC_NO_CODEC :
         case CODEC_WEBM_VP8 :
+        case CODEC_WEBM_VP9 :
         case CODEC_SPEEX_VBR :
         case CODEC_SPEEX :
             break;
@@ -223,6 +230,7 @@ namespace teamtalk
         case CODEC_SPEEX :
         case CODEC_NO_CODEC :
         case CODEC_WEBM_VP8 :
+        case CODEC_WEBM_VP9 :
             break;
         }
         return false;
@@ -238,6 +246,7 @@ namespace teamtalk
             return codec.speex_vbr.sim_stereo;
         case CODEC_NO_CODEC :
         case CODEC_WEBM_VP8 :
+        case CODEC_WEBM_VP9 :
         case CODEC_OPUS :
             break;
         }
@@ -339,6 +348,7 @@ namespace teamtalk
         case CODEC_OPUS :
             return codec.opus.bitrate;
         case CODEC_WEBM_VP8 :
+        case CODEC_WEBM_VP9 :
         case CODEC_NO_CODEC :
             break;
         } /* codec switch */
@@ -383,6 +393,7 @@ namespace teamtalk
             return codec.speex_vbr.bandmode;
         case CODEC_NO_CODEC :
         case CODEC_WEBM_VP8 :
+        case CODEC_WEBM_VP9 :
         case CODEC_OPUS :
             break;
         }
@@ -399,6 +410,7 @@ namespace teamtalk
             return (int)codec.speex_vbr.vbr_quality;
         case CODEC_NO_CODEC :
         case CODEC_WEBM_VP8 :
+        case CODEC_WEBM_VP9 :
         case CODEC_OPUS :
             break;
         }
@@ -480,11 +492,43 @@ namespace teamtalk
                 break;
             case CODEC_NO_CODEC :
             case CODEC_WEBM_VP8 :
+            case CODEC_WEBM_VP9 :
                 break;
             }
         }
         return false;
     }
 
+    uint8_t GetVideoPacketCodec(const VideoCodec& codec)
+    {
+        // VP8 is implied when VideoPacket has no codec field so
+        // older clients can still decode VP8 streams.
+        switch (codec.codec)
+        {
+        case CODEC_WEBM_VP9 :
+            return uint8_t(codec.codec);
+        case CODEC_WEBM_VP8 :
+        case CODEC_NO_CODEC :
+        case CODEC_SPEEX :
+        case CODEC_SPEEX_VBR :
+        case CODEC_OPUS :
+            break;
+        }
+        return 0;
+    }
+
+    Codec GetVideoCodecFromPacket(uint8_t vidcodec)
+    {
+        switch (vidcodec)
+        {
+        case 0 :
+        case CODEC_WEBM_VP8 :
+            return CODEC_WEBM_VP8;
+        case CODEC_WEBM_VP9 :
+            return CODEC_WEBM_VP9;
+        }
+        return CODEC_NO_CODEC;
+    }
+
 } // namespace teamtalk
 
@@ -58,6 +58,10 @@ namespace teamtalk
     int GetSpeexSamplesCount(int bandmode, int framecount);
 
     bool AudioCodecConvertBug(const ACE_TString& streamprotocol, const AudioCodec& codec);
+
+    // codec value for VideoPacket (0 = VP8)
+    uint8_t GetVideoPacketCodec(const VideoCodec& codec);
+    Codec GetVideoCodecFromPacket(uint8_t vidcodec);
 } // namespace teamtalk
 
 #endif
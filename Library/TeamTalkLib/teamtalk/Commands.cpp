@@ -322,6 +322,7 @@ namespace teamtalk {
                 codec.opus.frames_per_packet = 1;
             return true;
         case CODEC_WEBM_VP8 :
+        case CODEC_WEBM_VP9 :
             break;
         }
         return false;
@@ -34,7 +34,7 @@
 #include <set>
 #include <vector>
 
-#define TEAMTALK_PROTOCOL_VERSION ACE_TEXT("5.14")
+#define TEAMTALK_PROTOCOL_VERSION ACE_TEXT("5.15")
 
 /* parameter names */
 #define TT_USERID ACE_TEXT("userid")
@@ -144,6 +144,9 @@
 #define TT_TRANSFERKEY ACE_TEXT("filetxkey") // v5.13
 #define TT_BANOWNER ACE_TEXT("owner") // v5.13
 #define TT_LASTLOGINTIME ACE_TEXT("lastlogin") // v5.14
+#define TT_MIGRATETOKEN ACE_TEXT("migratetoken") // v5.15
+#define TT_VOICEFWDP50 ACE_TEXT("voicefwdp50") // v5.15
+#define TT_VOICEFWDP95 ACE_TEXT("voicefwdp95") // v5.15
 
 //    Client ---> Server
 //    -------------------------
@@ -215,6 +218,7 @@
 #define SERVER_QUIT ACE_TEXT("quit")
 #define SERVER_COMMAND_OK ACE_TEXT("ok")
 #define SERVER_STATS ACE_TEXT("stats")
+#define SERVER_MIGRATETOKEN ACE_TEXT("migratetoken") // v5.15
 
 //command termination. If changed change PrepareString
 #define EOL ACE_TEXT("\r\n")
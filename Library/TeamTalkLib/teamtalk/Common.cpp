@@ -159,6 +159,18 @@ namespace teamtalk
         return result;
     }
 
+    bool IsOpusDTX(const std::vector<uint16_t>& enc_frame_sizes)
+    {
+        if (enc_frame_sizes.empty())
+            return false;
+        for (uint16_t const s : enc_frame_sizes)
+        {
+            if (s > OPUS_DTX_FRAMESIZE)
+                return false;
+        }
+        return true;
+    }
+
     int AFFToMP3Bitrate(AudioFileFormat aff)
     {
         switch(aff)
@@ -131,6 +131,9 @@ namespace teamtalk {
 
         int userspeak = 0;
         int usersservered = 0;
+        //usec from voice packet received until forwarded
+        ACE_INT64 voice_forward_p50_usec = 0;
+        ACE_INT64 voice_forward_p95_usec = 0;
         //uptime
         ACE_Time_Value starttime;
         
@@ -347,6 +350,7 @@ namespace teamtalk {
         CODEC_SPEEX_VBR                 = 2,
         CODEC_OPUS                      = 3,
         CODEC_WEBM_VP8                  = 128,
+        CODEC_WEBM_VP9                  = 129,
     };
 
     struct SpeexCodec
@@ -411,6 +415,7 @@ namespace teamtalk {
             case CODEC_NO_CODEC :
                 return codec == ch.codec;
             case CODEC_WEBM_VP8 :
+            case CODEC_WEBM_VP9 :
                 return false;
             }
             return false;
@@ -488,14 +493,24 @@ namespace teamtalk {
     {
         int rc_target_bitrate; /* 0 = 256 kbit/sec */
         unsigned long encode_deadline; /* 0 = VPX_DL_BEST_QUALITY */
+        int simulcast_layers; /* 0 or 1 = no simulcast, max VIDEO_SIMULCAST_LAYERS_MAX */
     };
 
+    /* Each simulcast layer has half the width and height of the
+     * previous layer. Layer 0 is full resolution. */
+    constexpr auto VIDEO_SIMULCAST_LAYERS_MAX = 3;
+
+    /* A video receiver requests a key frame at most once per
+     * interval. The video sender ignores key frame requests if it
+     * produced a key frame within half of the interval. */
+    constexpr auto VIDEO_KEYFRAME_REQUEST_MSEC = 1000;
+
     struct VideoCodec
     {
         Codec codec{CODEC_NO_CODEC};
         union
         {
-            WebMVP8Codec webm_vp8;
+            WebMVP8Codec webm_vp8; /* also used by CODEC_WEBM_VP9 */
         };
         VideoCodec() : webm_vp8()
         {
@@ -634,8 +649,15 @@ namespace teamtalk {
         ACE_UINT32 keycode = -1;
         KeyStateMask keystate = KEYSTATE_NONE;
         DesktopInput() = default;
+        //mouse move without key press/release
+        bool IsMouseMove() const { return keycode == ACE_UINT32(-1) && keystate == KEYSTATE_NONE; }
     };
 
+    //the latest cursor position is sent at most every
+    //DESKTOPCURSOR_INTERVAL_MSEC. The server forwards at most twice
+    //this rate and holds back the latest position until then
+    constexpr auto DESKTOPCURSOR_INTERVAL_MSEC = 25;
+
     /* Remember to updated DLL header file when modifying this */
     enum AudioFileFormat
     {
@@ -679,6 +701,10 @@ namespace teamtalk {
         SUBSCRIBE_DESKTOP                               = 0x00000040,
         SUBSCRIBE_DESKTOPINPUT                          = 0x00000080,
         SUBSCRIBE_MEDIAFILE                             = 0x00000100,
+        /* modifier for SUBSCRIBE_VIDEOCAPTURE, forward lowest simulcast layer */
+        SUBSCRIBE_VIDEOCAPTURE_LOWRES                   = 0x00000200,
+        /* modifier for SUBSCRIBE_VOICE, forward silent Opus DTX packets */
+        SUBSCRIBE_VOICE_DTX                             = 0x00000400,
 
         SUBSCRIBE_ALL                                   = 0x000001FF,
 
@@ -711,6 +737,13 @@ namespace teamtalk {
     std::vector<uint16_t> ConvertFrameSizes(const std::vector<int>& in);
     int SumFrameSizes(const std::vector<int>& in);
 
+    /* Opus DTX emits frames of 2 bytes or less during silence */
+    constexpr auto OPUS_DTX_FRAMESIZE = 2;
+    /* true if all frames of an Opus packet are DTX frames */
+    bool IsOpusDTX(const std::vector<uint16_t>& enc_frame_sizes);
+    /* Opus Deep REDundancy (DRED) added when in-band FEC is enabled */
+    constexpr auto OPUS_DRED_MSEC = 100;
+
 constexpr auto TRANSMITUSERS_FREEFORALL = 0xFFF;
 
 constexpr auto PACKETNO_GEQ(uint16_t a, uint16_t b) { return ((int16_t)((a)-(b)) >= 0); }
@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) 2005-2018, BearWare.dk
+ *
+ * Contact Information:
+ *
+ * Bjoern D. Rasmussen
+ * Kirketoften 5
+ * DK-8260 Viby J
+ * Denmark
+ * Email: contact@bearware.dk
+ * Phone: +45 20 20 54 59
+ * Web: http://www.bearware.dk
+ *
+ * This source code is part of the TeamTalk SDK owned by
+ * BearWare.dk. Use of this file, or its compiled unit, requires a
+ * TeamTalk SDK License Key issued by BearWare.dk.
+ *
+ * The TeamTalk SDK License Agreement along with its Terms and
+ * Conditions are outlined in the file License.txt included with the
+ * TeamTalk SDK distribution.
+ *
+ */
+
+#include "LatencyHistogram.h"
+
+#include <algorithm>
+#include <bit>
+
+namespace teamtalk {
+
+int LatencyHistogram::Bucket(int64_t usec)
+{
+    auto const v = uint64_t(std::max<int64_t>(usec, 0));
+    if (v < SUBBUCKETS)
+        return int(v);
+
+    int const exponent = std::bit_width(v) - 1;
+    int const shift = exponent - SUBBUCKET_BITS;
+    int const sub = int(v >> shift) & (SUBBUCKETS - 1);
+    return std::min(((shift + 1) * SUBBUCKETS) + sub, BUCKETS - 1);
+}
+
+int64_t LatencyHistogram::BucketValue(int bucket)
+{
+    if (bucket < SUBBUCKETS)
+        return bucket;
+
+    int const shift = (bucket / SUBBUCKETS) - 1;
+    int const sub = bucket % SUBBUCKETS;
+    int64_t const low = int64_t(SUBBUCKETS + sub) << shift;
+    // middle of bucket
+    return low + ((int64_t(1) << shift) / 2);
+}
+
+void LatencyHistogram::Add(int64_t usec)
+{
+    m_buckets[Bucket(usec)]++;
+    m_count++;
+    m_max = std::max(m_max, usec);
+}
+
+void LatencyHistogram::Merge(const LatencyHistogram& other)
+{
+    for (size_t i=0;i<m_buckets.size();i++)
+        m_buckets[i] += other.m_buckets[i];
+    m_count += other.m_count;
+    m_max = std::max(m_max, other.m_max);
+}
+
+void LatencyHistogram::Reset()
+{
+    m_buckets.fill(0);
+    m_count = m_max = 0;
+}
+
+int64_t LatencyHistogram::Percentile(double p) const
+{
+    if (m_count == 0)
+        return 0;
+
+    auto const rank = int64_t(std::clamp(p, 0.0, 1.0) * double(m_count - 1));
+    int64_t seen = 0;
+    for (int i=0;i<BUCKETS;i++)
+    {
+        seen += m_buckets[i];
+        if (seen > rank)
+            return std::min(BucketValue(i), m_max);
+    }
+    return m_max;
+}
+
+} // namespace teamtalk
@@ -0,0 +1,61 @@
+/*
+ * Copyright (c) 2005-2018, BearWare.dk
+ *
+ * Contact Information:
+ *
+ * Bjoern D. Rasmussen
+ * Kirketoften 5
+ * DK-8260 Viby J
+ * Denmark
+ * Email: contact@bearware.dk
+ * Phone: +45 20 20 54 59
+ * Web: http://www.bearware.dk
+ *
+ * This source code is part of the TeamTalk SDK owned by
+ * BearWare.dk. Use of this file, or its compiled unit, requires a
+ * TeamTalk SDK License Key issued by BearWare.dk.
+ *
+ * The TeamTalk SDK License Agreement along with its Terms and
+ * Conditions are outlined in the file License.txt included with the
+ * TeamTalk SDK distribution.
+ *
+ */
+
+#if !defined(LATENCYHISTOGRAM_H)
+#define LATENCYHISTOGRAM_H
+
+#include <array>
+#include <cstdint>
+
+namespace teamtalk {
+
+    // Log-linear histogram of microsecond values. Values below 16 usec
+    // have their own bucket, above that each power of two is split in
+    // 16 buckets, i.e. percentiles are within about 3%.
+    class LatencyHistogram
+    {
+    public:
+        void Add(int64_t usec);
+        void Merge(const LatencyHistogram& other);
+        void Reset();
+
+        int64_t Count() const { return m_count; }
+        int64_t Max() const { return m_max; }
+        // 'p' in range [0..1]. Returns 0 if empty
+        int64_t Percentile(double p) const;
+
+    private:
+        static constexpr int SUBBUCKET_BITS = 4;
+        static constexpr int SUBBUCKETS = 1 << SUBBUCKET_BITS;
+        static constexpr int BUCKETS = SUBBUCKETS * 40;
+
+        static int Bucket(int64_t usec);
+        static int64_t BucketValue(int bucket);
+
+        std::array<int64_t, BUCKETS> m_buckets = {};
+        int64_t m_count = 0, m_max = 0;
+    };
+
+} // namespace teamtalk
+
+#endif
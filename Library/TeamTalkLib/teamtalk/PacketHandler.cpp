@@ -250,6 +250,12 @@ int ToIPTOSValue(const FieldPacket& p)
     case PACKET_KIND_DESKTOPINPUT_ACK :
     case PACKET_KIND_DESKTOPINPUT_ACK_CRYPT :
         return IP_TOS_SIGNALING;
+
+    case PACKET_KIND_VIDEO_FEEDBACK :
+    case PACKET_KIND_VIDEO_FEEDBACK_CRYPT :
+    case PACKET_KIND_RECEIVER_REPORT :
+    case PACKET_KIND_RECEIVER_REPORT_CRYPT :
+        return IP_TOS_SIGNALING;
     }
     return IP_TOS_IGNORE;
 }
@@ -281,7 +281,9 @@ videopackets_t BuildVideoPackets(uint8_t kind,
                                  uint16_t* width,
                                  uint16_t* height,
                                  const char* enc_data,
-                                 uint32_t enc_len)
+                                 uint32_t enc_len,
+                                 uint8_t vidcodec,
+                                 uint8_t simulcast)
 {
     videopackets_t result;
     uint16_t fragno = 0;
@@ -299,7 +301,7 @@ videopackets_t BuildVideoPackets(uint8_t kind,
         VideoPacket* vp = nullptr;
         ACE_NEW_RETURN(vp, VideoPacket(kind, src_userid, time, streamid, 
                                        packet_no, width, height, payload_ptr,
-                                       max_chunk_size, fragcnt),
+                                       max_chunk_size, fragcnt, vidcodec, simulcast),
                        result);
         if(vp != nullptr)
             result.push_back(vp);
@@ -309,7 +311,7 @@ videopackets_t BuildVideoPackets(uint8_t kind,
             payload_ptr += max_chunk_size;
             ACE_NEW_NORETURN(vp, VideoPacket(kind, src_userid, time, streamid, 
                                              packet_no, payload_ptr,
-                                             max_chunk_size, fragno));
+                                             max_chunk_size, fragno, simulcast));
             if(vp != nullptr)
                 result.push_back(vp);
             else
@@ -324,7 +326,7 @@ videopackets_t BuildVideoPackets(uint8_t kind,
         auto const remaining = (uint16_t)(enc_len - ((fragcnt - 1) * max_chunk_size));
         ACE_NEW_NORETURN(vp, VideoPacket(kind, src_userid, time, streamid, 
                                          packet_no, payload_ptr, 
-                                         remaining, fragno));
+                                         remaining, fragno, simulcast));
         if(vp != nullptr)
             result.push_back(vp);
         else
@@ -340,7 +342,7 @@ videopackets_t BuildVideoPackets(uint8_t kind,
         VideoPacket* vp = nullptr;
         ACE_NEW_NORETURN(vp, VideoPacket(kind, src_userid, time, streamid, 
                                          packet_no, width, height, enc_data,
-                                         enc_len));
+                                         enc_len, vidcodec, simulcast));
         if(vp != nullptr)
             result.push_back(vp);
     }
@@ -413,6 +415,68 @@ bool ReassembleVideoPackets(const video_fragments_t& fragments,
     return true;
 }
 
+constexpr auto VIDEO_HISTORY_PACKETS_MAX = 512;
+
+void VideoPacketHistory::AddVideoPackets(const videopackets_t& packets)
+{
+    for (auto* p : packets)
+    {
+        int layer = 0, layers = 0;
+        bool key_frame = false;
+        p->GetSimulcast(layer, layers, key_frame);
+        if (layer >= int(m_layers.size()))
+            continue;
+
+        sent_packets_t& sent = m_layers[layer];
+        VideoPacket* copy = nullptr;
+        ACE_NEW(copy, VideoPacket(*p));
+        sent[p->GetPacketNo()][p->GetFragmentNo()] = videopacket_t(copy);
+
+        while (sent.size() > 1 &&
+               (sent.size() > VIDEO_HISTORY_PACKETS_MAX ||
+                W32_LT(sent.begin()->second.begin()->second->GetTime() + m_history_msec, p->GetTime())))
+        {
+            sent.erase(sent.begin());
+        }
+    }
+}
+
+videopackets_t VideoPacketHistory::GetVideoPackets(int layer, const video_nacks_t& nacks,
+                                                   uint16_t dest_userid) const
+{
+    videopackets_t result;
+    if (layer < 0 || layer >= int(m_layers.size()))
+        return result;
+
+    const sent_packets_t& sent = m_layers[layer];
+    for (const auto& nack : nacks)
+    {
+        auto const ii = sent.find(nack.first);
+        if (ii == sent.end())
+            continue;
+
+        for (const auto& frag : ii->second)
+        {
+            //no fragments means the entire packet
+            if (nack.second.empty() || nack.second.contains(frag.first))
+            {
+                VideoPacket* copy = nullptr;
+                ACE_NEW_RETURN(copy, VideoPacket(*frag.second), result);
+                //other receivers already have the packet
+                copy->ChangeDestUser(dest_userid);
+                result.push_back(copy);
+            }
+        }
+    }
+    return result;
+}
+
+void VideoPacketHistory::Reset()
+{
+    for (auto& sent : m_layers)
+        sent.clear();
+}
+
 void UpdateBlocksCRC(const map_blocks_t& blocks,
                      const std::set<uint16_t>& dirty_blocks,
                      map_block_crc_t& block_crcs,
@@ -1267,4 +1331,18 @@ DesktopNakTransmitter::DesktopNakTransmitter(uint8_t session_id, uint32_t upd_ti
 {
 }
 
+void CoalesceDesktopInput(std::vector<DesktopInput>& inputs,
+                          const std::vector<DesktopInput>& new_inputs)
+{
+    for (const auto& input : new_inputs)
+    {
+        //key events must be kept in order so only a mouse move
+        //directly following another mouse move can be replaced
+        if (!inputs.empty() && inputs.back().IsMouseMove() && input.IsMouseMove())
+            inputs.back() = input;
+        else
+            inputs.push_back(input);
+    }
+}
+
 } //namespace teamtalk
@@ -29,6 +29,7 @@
 
 #include <ace/Time_Value.h>
 
+#include <array>
 #include <cstdint>
 #include <set>
 #include <cstddef>
@@ -71,7 +72,9 @@ namespace teamtalk {
                                      uint16_t* width,
                                      uint16_t* height,
                                      const char* enc_data,
-                                     uint32_t enc_len);
+                                     uint32_t enc_len,
+                                     uint8_t vidcodec = 0,
+                                     uint8_t simulcast = 0);
 
     //fragno -> VideoPacket
     using video_fragments_t = std::map<uint16_t, videopacket_t>;
@@ -79,6 +82,30 @@ namespace teamtalk {
                                 const VideoPacket& packet,
                                 std::vector<char>& enc_frame);
 
+    //Recently sent video packets which can be retransmitted when a
+    //receiver reports them missing
+    class VideoPacketHistory
+    {
+    public:
+        explicit VideoPacketHistory(uint32_t history_msec) : m_history_msec(history_msec) {}
+
+        //stores a copy of 'packets' and discards packets older than
+        //'history_msec'
+        void AddVideoPackets(const videopackets_t& packets);
+        //returns copies of packets in 'nacks' addressed only to
+        //'dest_userid'. Caller takes ownership
+        videopackets_t GetVideoPackets(int layer, const video_nacks_t& nacks,
+                                       uint16_t dest_userid) const;
+        void Reset();
+
+    private:
+        //packetno -> video fragments (sorted by UINT32 wrap)
+        using sent_packets_t = std::map<uint32_t, video_fragments_t, W32LessComp>;
+        //each simulcast layer has its own packet sequence
+        std::array<sent_packets_t, VIDEO_SIMULCAST_LAYERS_MAX> m_layers;
+        uint32_t m_history_msec;
+    };
+
     /** Desktop packets **/
     using map_blocks_t = std::map< uint16_t, std::vector<char> >;
     using desktoppackets_t = std::list< desktoppacket_t >;
@@ -221,5 +248,10 @@ namespace teamtalk {
 
     ACE_Time_Value GetDesktopPacketRTxTimeout(int udp_pingtime);
 
+    //append 'new_inputs' to 'inputs'. Consecutive mouse moves are
+    //merged so only the latest position is sent
+    void CoalesceDesktopInput(std::vector<DesktopInput>& inputs,
+                              const std::vector<DesktopInput>& new_inputs);
+
 } // namespace teamtalk
 #endif
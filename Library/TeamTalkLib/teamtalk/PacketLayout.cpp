@@ -25,6 +25,7 @@
 
 #include "Common.h"
 
+#include <algorithm>
 #include <utility>
 #include <vector>
 #include <cstdint>
@@ -268,6 +269,25 @@ namespace teamtalk
         assert(GetDestUserID() == userid);
     }
 
+    void FieldPacket::ChangeDestUser(uint16_t userid)
+    {
+        assert(m_cleanup);
+        assert(m_iovec.size());
+        if(GetHdrType() != PACKETHDR_DEST_USER)
+        {
+            //header must be in its own buffer
+            assert(m_iovec[0].iov_len == TT_CHANNEL_HEADER_SIZE);
+            uint8_t* packet_hdr = nullptr;
+            ACE_NEW(packet_hdr, uint8_t[TT_USER_HEADER_SIZE]);
+            memcpy(packet_hdr, m_iovec[0].iov_base, TT_CHANNEL_HEADER_SIZE);
+            packet_hdr[PACKET_INDEX_KIND] |= PACKET_MASK_DEST_USER_SET;
+            delete [] reinterpret_cast<uint8_t*>(m_iovec[0].iov_base);
+            m_iovec[0].iov_base = reinterpret_cast<char*>(packet_hdr);
+            m_iovec[0].iov_len = TT_USER_HEADER_SIZE;
+        }
+        SetDestUser(userid);
+    }
+
     void FieldPacket::SetChannel(uint16_t channelid)
     {
         assert(channelid);
@@ -334,6 +354,61 @@ namespace teamtalk
         return pos == size;
     }
 
+    bool FieldIndex::Build(const char* packet, uint16_t packet_size)
+    {
+        m_packet = nullptr;
+        m_packet_size = 0;
+        m_offsets.fill(0);
+
+        if (packet == nullptr || packet_size < TT_CHANNEL_HEADER_SIZE)
+            return false;
+
+        const auto* ptr = reinterpret_cast<const uint8_t*>(packet);
+        int pos = PACKET_INDEX_FIELDS_DEST_CHANNEL;
+        if ((ptr[PACKET_INDEX_DEST_USER_SET] & PACKET_MASK_DEST_USER_SET) != 0u)
+            pos = PACKET_INDEX_FIELDS_DEST_USER_SET;
+
+        if (packet_size < pos)
+            return false;
+        if (packet_size > pos && pos + FIELDVALUE_PREFIX >= packet_size)
+            return false;
+
+        while (pos < packet_size)
+        {
+            if (pos + FIELDVALUE_PREFIX > packet_size)
+                return false;
+            uint16_t const fieldtype = READFIELD_TYPE(&ptr[pos]);
+            if (m_offsets[fieldtype] == 0)
+                m_offsets[fieldtype] = uint16_t(pos);
+            pos += FIELDVALUE_PREFIX + READFIELD_SIZE(&ptr[pos]);
+        }
+        if (pos != packet_size)
+            return false;
+
+        m_packet = ptr;
+        m_packet_size = packet_size;
+        return true;
+    }
+
+    const uint8_t* FieldIndex::Find(uint8_t fieldtype) const
+    {
+        assert(m_packet);
+        if (fieldtype >= m_offsets.size() || m_offsets[fieldtype] == 0)
+            return nullptr;
+
+        //same bounds check as FINDFIELD_TYPE()
+        const uint8_t* field = &m_packet[m_offsets[fieldtype]];
+        if (field + READFIELD_SIZE(field) >= m_packet + m_packet_size)
+            return nullptr;
+        return field;
+    }
+
+    void FieldPacket::SetFieldIndex(const FieldIndex* index)
+    {
+        assert(index == nullptr || (m_iovec.size() == 1 && m_iovec[0].iov_base == index->GetPacket()));
+        m_fieldindex = index;
+    }
+
     void FieldPacket::Init(PacketHdrType hdr_type, uint8_t kind, uint16_t src_userid, uint32_t time)
     {
         m_iovec.reserve(16);
@@ -459,6 +534,9 @@ namespace teamtalk
 
     uint8_t* FieldPacket::FindFieldNonConst(uint8_t fieldtype) const
     {
+        if (m_fieldindex != nullptr)
+            return const_cast<uint8_t*>(m_fieldindex->Find(fieldtype));
+
         uint8_t* ptr = nullptr;
         if(!m_iovec.empty())
         {
@@ -493,13 +571,15 @@ namespace teamtalk
         return nullptr;
     }
 
-    HelloPacket::HelloPacket(uint16_t src_userid, uint32_t time) 
+    HelloPacket::HelloPacket(uint16_t src_userid, uint32_t time, int64_t migrate_token)
         : FieldPacket(PACKETHDR_CHANNEL_ONLY, PACKET_KIND_HELLO, src_userid, time)
     {
         std::vector<uint8_t> protocol(1);
         protocol[0] = TEAMTALK_PACKET_PROTOCOL;
 
-        int const alloc_size = int(FIELDVALUE_PREFIX + protocol.size()); //FIELDTYPE_PAYLOAD
+        int alloc_size = int(FIELDVALUE_PREFIX + protocol.size()); //FIELDTYPE_PAYLOAD
+        if (migrate_token != 0)
+            alloc_size += FIELDVALUE_PREFIX + sizeof(migrate_token);
 
         uint8_t* data_buf = nullptr;
         ACE_NEW(data_buf, uint8_t[alloc_size]);
@@ -509,6 +589,8 @@ namespace teamtalk
         v.iov_base = reinterpret_cast<char*>(data_buf);
 
         ptr = WRITEFIELD_DATA(ptr, FIELDTYPE_PROTOCOL, protocol.data(), protocol.size());
+        if (migrate_token != 0)
+            ptr = WRITEFIELD_VALUE_I64(ptr, FIELDTYPE_MIGRATE_TOKEN, migrate_token);
 
         v.iov_len = (u_long)(ptr - reinterpret_cast<const uint8_t*>(v.iov_base));
         assert(v.iov_len == alloc_size);
@@ -529,6 +611,18 @@ namespace teamtalk
         return 0;
     }
 
+    int64_t HelloPacket::GetMigrateToken() const
+    {
+        int64_t token = 0;
+        const uint8_t* ptr = FindField(FIELDTYPE_MIGRATE_TOKEN);
+        if((ptr != nullptr) && READFIELD_SIZE(ptr) >= sizeof(token))
+        {
+            ptr = READFIELD_DATAPTR(ptr);
+            GET_INT64_PTR(ptr, token);
+        }
+        return token;
+    }
+
     /* KeepAlivePacket */
 
     KeepAlivePacket::KeepAlivePacket(uint16_t src_userid, uint32_t time, 
@@ -820,6 +914,19 @@ namespace teamtalk
             FindField(FIELDTYPE_STREAMID_PKTNUM_AND_FRAGCNT) != nullptr;
     }
 
+    bool AudioPacket::IsOpusDTX() const
+    {
+        if (HasFragments())
+            return false;
+        if (HasFrameSizes())
+            return teamtalk::IsOpusDTX(GetEncodedFrameSizes());
+
+        uint16_t enc_len = 0;
+        if (GetEncodedAudio(enc_len) == nullptr)
+            return false;
+        return teamtalk::IsOpusDTX(std::vector<uint16_t>(1, enc_len));
+    }
+
     VideoPacket::VideoPacket(const VideoPacket& p)
          
     = default;
@@ -838,14 +945,16 @@ namespace teamtalk
     VideoPacket::VideoPacket(uint8_t kind, uint16_t src_userid, uint32_t time, 
                              uint8_t stream_id, uint32_t packet_no, 
                              const uint16_t* width, const uint16_t* height,
-                             const char* enc_data, uint16_t enc_len) 
+                             const char* enc_data, uint16_t enc_len,
+                             uint8_t vidcodec, uint8_t simulcast) 
         : FieldPacket(PACKETHDR_CHANNEL_ONLY, kind, src_userid, time)
     {
         //CryptPacket will become incompatible if m_iovec[1] doesn't contain 
         //the part which needs to be encrypted
         assert(m_iovec.size() == 1);
 
-        Init(kind, stream_id, packet_no, width, height, enc_data, enc_len, nullptr, nullptr);
+        Init(kind, stream_id, packet_no, width, height, enc_data, enc_len, nullptr, nullptr,
+             vidcodec, simulcast);
 
         assert(m_iovec.size() == 2); //CryptPacket compatibility
     }
@@ -854,7 +963,8 @@ namespace teamtalk
                              uint8_t stream_id, uint32_t packet_no, 
                              const uint16_t* width, const uint16_t* height,
                              const char* enc_data, uint16_t enc_len, 
-                             const uint16_t fragmentcnt) 
+                             const uint16_t fragmentcnt, uint8_t vidcodec,
+                             uint8_t simulcast) 
         : FieldPacket(PACKETHDR_CHANNEL_ONLY, kind, src_userid, time)
     {
         //CryptPacket will become incompatible if m_iovec[1] doesn't contain 
@@ -862,7 +972,7 @@ namespace teamtalk
         assert(m_iovec.size() == 1);
 
         Init(kind, stream_id, packet_no, width, height, enc_data, enc_len, 
-             nullptr, &fragmentcnt);
+             nullptr, &fragmentcnt, vidcodec, simulcast);
 
         assert(m_iovec.size() == 2); //CryptPacket compatibility
     }
@@ -870,14 +980,15 @@ namespace teamtalk
     VideoPacket::VideoPacket(uint8_t kind, uint16_t src_userid, uint32_t time,
                              uint8_t stream_id, uint32_t packet_no, 
                              const char* enc_data, uint16_t enc_len, 
-                             uint16_t fragmentno)
+                             uint16_t fragmentno, uint8_t simulcast)
         : FieldPacket(PACKETHDR_CHANNEL_ONLY, kind, src_userid, time)
     {
         //CryptPacket will become incompatible if m_iovec[1] doesn't contain 
         //the part which needs to be encrypted
         assert(m_iovec.size() == 1);
 
-        Init(kind, stream_id, packet_no, nullptr, nullptr, enc_data, enc_len, &fragmentno, nullptr);
+        Init(kind, stream_id, packet_no, nullptr, nullptr, enc_data, enc_len, &fragmentno, nullptr,
+             0, simulcast);
 
         assert(m_iovec.size() == 2); //CryptPacket compatibility
     }
@@ -885,7 +996,8 @@ namespace teamtalk
     uint8_t* VideoPacket::Init(uint8_t  /*kind*/, uint8_t stream_id, uint32_t packet_no,
                                const uint16_t* width, const uint16_t* height,
                                const char* enc_data, uint16_t enc_len, 
-                               const uint16_t* fragmentno, const uint16_t* fragmentcnt)
+                               const uint16_t* fragmentno, const uint16_t* fragmentcnt,
+                               uint8_t vidcodec, uint8_t simulcast)
     {
         assert(FindField(FIELDTYPE_STREAMID_PKTNUM_VIDINFO) == nullptr);
         assert(FindField(FIELDTYPE_STREAMID_PKTNUM_FRAGCNT_VIDINFO) == nullptr);
@@ -931,7 +1043,15 @@ namespace teamtalk
             assert(!width && !height);
         }
 
-        int const alloc_size = FIELDVALUE_PREFIX + field_size + FIELDVALUE_PREFIX + enc_len;
+        //codec is only written along with video info (width/height)
+        assert(vidcodec == 0 || (width && height));
+        bool const write_codec = vidcodec != 0 && (width != nullptr);
+
+        int alloc_size = FIELDVALUE_PREFIX + field_size + FIELDVALUE_PREFIX + enc_len;
+        if (write_codec)
+            alloc_size += FIELDVALUE_PREFIX + sizeof(uint8_t);
+        if (simulcast != 0)
+            alloc_size += FIELDVALUE_PREFIX + sizeof(uint8_t);
 
         uint8_t* data_buf = nullptr;
         ACE_NEW_RETURN(data_buf, uint8_t[alloc_size], nullptr);
@@ -980,6 +1100,10 @@ namespace teamtalk
         }
 
         ptr = WRITEFIELD_DATA(ptr, field_type, field.data(), field_size);
+        if (write_codec)
+            ptr = WRITEFIELD_VALUE_U8(ptr, FIELDTYPE_VIDCODEC, vidcodec);
+        if (simulcast != 0)
+            ptr = WRITEFIELD_VALUE_U8(ptr, FIELDTYPE_SIMULCAST, simulcast);
         ptr = WRITEFIELD_DATA(ptr, FIELDTYPE_ENCDATA, enc_data, enc_len);
 
         //int x = ptr - reinterpret_cast<const uint8_t*>(v.iov_base) ;
@@ -1142,6 +1266,26 @@ namespace teamtalk
         return GetStreamID(0, 0, 0, &width, &height) != 0;
     }
 
+    uint8_t VideoPacket::GetVideoCodec() const
+    {
+        const uint8_t* ptr = FindField(FIELDTYPE_VIDCODEC);
+        if(ptr == nullptr || READFIELD_SIZE(ptr) < sizeof(uint8_t))
+            return 0;
+        return GET_UINT8(READFIELD_DATAPTR(ptr));
+    }
+
+    bool VideoPacket::GetSimulcast(int& layer, int& layers, bool& key_frame) const
+    {
+        const uint8_t* ptr = FindField(FIELDTYPE_SIMULCAST);
+        if(ptr == nullptr || READFIELD_SIZE(ptr) < sizeof(uint8_t))
+            return false;
+        uint8_t const info = GET_UINT8(READFIELD_DATAPTR(ptr));
+        layer = info & 0xF;
+        layers = (info >> 4) & 0x7;
+        key_frame = (info & 0x80) != 0;
+        return true;
+    }
+
     const char* VideoPacket::GetEncodedData(uint16_t& packet_bytes) const
     {
         const uint8_t* ptr = FindField(FIELDTYPE_ENCDATA);
@@ -2384,5 +2528,298 @@ namespace teamtalk
         return packetno;
     }
 
-} // namespace teamtalk
+    VideoFeedbackPacket::VideoFeedbackPacket(uint16_t src_userid, uint32_t time,
+                                             uint16_t dest_userid, uint8_t stream_id,
+                                             int layer, bool keyframe_request,
+                                             const video_nacks_t& nacks)
+                                             : FieldPacket(PACKETHDR_DEST_USER,
+                                                           PACKET_KIND_VIDEO_FEEDBACK,
+                                                           src_userid, time)
+    {
+        int alloc_size = 0;
+
+        //FIELDTYPE_STREAMID_LAYER_KEYFRAME
+        int const info_size = sizeof(uint8_t) + sizeof(uint8_t) + sizeof(uint8_t);
+        alloc_size += FIELDVALUE_PREFIX + info_size;
+
+        //FIELDTYPE_NACKS
+        int nacks_count = 0;
+        for (const auto& n : nacks)
+            nacks_count += std::max(int(n.second.size()), 1);
+        nacks_count = std::min(nacks_count, int(NACKS_MAX));
+        int const nack_size = int(sizeof(uint32_t) + sizeof(uint16_t));
+        if (nacks_count != 0)
+            alloc_size += FIELDVALUE_PREFIX + (nack_size * nacks_count);
+
+        uint8_t* data_buf = nullptr;
+        ACE_NEW(data_buf, uint8_t[alloc_size]);
+
+        uint8_t* data_ptr = data_buf;
+        iovec v;
+        v.iov_base = reinterpret_cast<char*>(data_buf);
+        v.iov_len = alloc_size;
+
+        data_ptr = WRITEFIELD_TYPE(data_ptr, FIELDTYPE_STREAMID_LAYER_KEYFRAME, info_size);
+        data_ptr = SET_UINT8_PTR(data_ptr, stream_id);
+        data_ptr = SET_UINT8_PTR(data_ptr, layer);
+        data_ptr = SET_UINT8_PTR(data_ptr, (keyframe_request ? 1 : 0));
+
+        if (nacks_count != 0)
+        {
+            data_ptr = WRITEFIELD_TYPE(data_ptr, FIELDTYPE_NACKS, nack_size * nacks_count);
+            for (auto i = nacks.begin(); i != nacks.end() && nacks_count > 0; ++i)
+            {
+                if (i->second.empty())
+                {
+                    data_ptr = SET_UINT32_PTR(data_ptr, i->first);
+                    data_ptr = SET_UINT16_PTR(data_ptr, VideoPacket::INVALID_FRAGMENT_NO);
+                    --nacks_count;
+                }
+                for (auto f = i->second.begin(); f != i->second.end() && nacks_count > 0; ++f)
+                {
+                    data_ptr = SET_UINT32_PTR(data_ptr, i->first);
+                    data_ptr = SET_UINT16_PTR(data_ptr, *f);
+                    --nacks_count;
+                }
+            }
+        }
+        assert(data_ptr == data_buf + alloc_size);
+
+        m_iovec.push_back(v);
+#ifdef ENABLE_ENCRYPTION
+        m_crypt_sections.insert(uint8_t(m_iovec.size())-1);
+#endif
+        SetDestUser(dest_userid);
+    }
+
+    VideoFeedbackPacket::VideoFeedbackPacket(const VideoFeedbackPacket& packet)
+        : VideoFeedbackPacket(packet.GetSrcUserID(), packet.GetTime(),
+                              packet.GetDestUserID(), packet.GetStreamID(),
+                              packet.GetLayer(), packet.GetKeyFrameRequest(),
+                              packet.GetNacks())
+    {
+        SetChannel(packet.GetChannel());
+    }
+
+    bool VideoFeedbackPacket::GetStreamInfo(uint8_t* stream_id, int* layer,
+                                            bool* keyframe_request) const
+    {
+        const uint8_t* ptr = FindField(FIELDTYPE_STREAMID_LAYER_KEYFRAME);
+        if(ptr == nullptr)
+            return false;
+
+        uint16_t const field_size = READFIELD_SIZE(ptr);
+        if(field_size < sizeof(uint8_t) + sizeof(uint8_t) + sizeof(uint8_t))
+            return false;
+
+        const uint8_t* field_ptr = READFIELD_DATAPTR(ptr);
+        if (stream_id != nullptr)
+            *stream_id = GET_UINT8(field_ptr);
+        field_ptr += 1;
+        if (layer != nullptr)
+            *layer = GET_UINT8(field_ptr);
+        field_ptr += 1;
+        if (keyframe_request != nullptr)
+            *keyframe_request = GET_UINT8(field_ptr) != 0;
+        return true;
+    }
+
+    uint8_t VideoFeedbackPacket::GetStreamID() const
+    {
+        uint8_t stream_id = 0;
+        GetStreamInfo(&stream_id, nullptr, nullptr);
+        return stream_id;
+    }
+
+    int VideoFeedbackPacket::GetLayer() const
+    {
+        int layer = 0;
+        GetStreamInfo(nullptr, &layer, nullptr);
+        return layer;
+    }
+
+    bool VideoFeedbackPacket::GetKeyFrameRequest() const
+    {
+        bool keyframe_request = false;
+        GetStreamInfo(nullptr, nullptr, &keyframe_request);
+        return keyframe_request;
+    }
+
+    video_nacks_t VideoFeedbackPacket::GetNacks() const
+    {
+        video_nacks_t nacks;
+        const uint8_t* ptr = FindField(FIELDTYPE_NACKS);
+        if(ptr == nullptr)
+            return nacks;
+
+        uint16_t const field_size = READFIELD_SIZE(ptr);
+        const uint8_t* field_ptr = READFIELD_DATAPTR(ptr);
+        int const nack_size = int(sizeof(uint32_t) + sizeof(uint16_t));
+        for (int i=0;i<field_size / nack_size;++i)
+        {
+            uint32_t const packet_no = GET_UINT32(field_ptr);
+            field_ptr += sizeof(uint32_t);
+            uint16_t const fragno = GET_UINT16(field_ptr);
+            field_ptr += sizeof(uint16_t);
+            if (fragno == VideoPacket::INVALID_FRAGMENT_NO)
+                nacks[packet_no];
+            else
+                nacks[packet_no].insert(fragno);
+        }
+        return nacks;
+    }
+
+    ReceiverReportPacket::ReceiverReportPacket(uint16_t src_userid, uint32_t time,
+                                               uint16_t dest_userid, uint8_t stream_id,
+                                               uint16_t packets_recv, uint16_t packets_lost)
+        : ReceiverReportPacket(src_userid, time, dest_userid,
+                               ReceiverReport{stream_id, packets_recv, packets_lost})
+    {
+    }
+
+    ReceiverReportPacket::ReceiverReportPacket(uint16_t src_userid, uint32_t time,
+                                               uint16_t dest_userid, const ReceiverReport& report)
+                                               : FieldPacket(PACKETHDR_DEST_USER,
+                                                             PACKET_KIND_RECEIVER_REPORT,
+                                                             src_userid, time)
+    {
+        //FIELDTYPE_AUDIO_LOSS is always present for older clients
+        int const loss_size = sizeof(uint8_t) + sizeof(uint16_t) + sizeof(uint16_t);
+        int alloc_size = FIELDVALUE_PREFIX + loss_size;
+
+        //FIELDTYPE_AUDIO_DELAY
+        int const delay_size = sizeof(uint16_t) + sizeof(int16_t);
+        if (report.stream_id != 0)
+            alloc_size += FIELDVALUE_PREFIX + delay_size;
+
+        //FIELDTYPE_VIDEO_LOSS
+        int const video_size = sizeof(uint8_t) + sizeof(uint16_t) + sizeof(uint16_t) + sizeof(int16_t);
+        if (report.video_stream_id != 0)
+            alloc_size += FIELDVALUE_PREFIX + video_size;
+
+        uint8_t* data_buf = nullptr;
+        ACE_NEW(data_buf, uint8_t[alloc_size]);
+
+        uint8_t* data_ptr = data_buf;
+        iovec v;
+        v.iov_base = reinterpret_cast<char*>(data_buf);
+        v.iov_len = alloc_size;
+
+        data_ptr = WRITEFIELD_TYPE(data_ptr, FIELDTYPE_AUDIO_LOSS, loss_size);
+        data_ptr = SET_UINT8_PTR(data_ptr, report.stream_id);
+        data_ptr = SET_UINT16_PTR(data_ptr, report.packets_recv);
+        data_ptr = SET_UINT16_PTR(data_ptr, report.packets_lost);
+
+        if (report.stream_id != 0)
+        {
+            data_ptr = WRITEFIELD_TYPE(data_ptr, FIELDTYPE_AUDIO_DELAY, delay_size);
+            data_ptr = SET_UINT16_PTR(data_ptr, report.jitter_msec);
+            data_ptr = SET_UINT16_PTR(data_ptr, uint16_t(report.delay_gradient_msec));
+        }
+
+        if (report.video_stream_id != 0)
+        {
+            data_ptr = WRITEFIELD_TYPE(data_ptr, FIELDTYPE_VIDEO_LOSS, video_size);
+            data_ptr = SET_UINT8_PTR(data_ptr, report.video_stream_id);
+            data_ptr = SET_UINT16_PTR(data_ptr, report.video_frames_recv);
+            data_ptr = SET_UINT16_PTR(data_ptr, report.video_frames_lost);
+            data_ptr = SET_UINT16_PTR(data_ptr, uint16_t(report.video_delay_gradient_msec));
+        }
+        assert(data_ptr == data_buf + alloc_size);
 
+        m_iovec.push_back(v);
+#ifdef ENABLE_ENCRYPTION
+        m_crypt_sections.insert(uint8_t(m_iovec.size())-1);
+#endif
+        SetDestUser(dest_userid);
+    }
+
+    ReceiverReportPacket::ReceiverReportPacket(const ReceiverReportPacket& packet)
+        : ReceiverReportPacket(packet.GetSrcUserID(), packet.GetTime(),
+                               packet.GetDestUserID(), packet.GetReport())
+    {
+        SetChannel(packet.GetChannel());
+    }
+
+    bool ReceiverReportPacket::GetAudioLoss(uint8_t* stream_id, uint16_t* packets_recv,
+                                            uint16_t* packets_lost) const
+    {
+        const uint8_t* ptr = FindField(FIELDTYPE_AUDIO_LOSS);
+        if(ptr == nullptr)
+            return false;
+
+        uint16_t const field_size = READFIELD_SIZE(ptr);
+        if(field_size < sizeof(uint8_t) + sizeof(uint16_t) + sizeof(uint16_t))
+            return false;
+
+        const uint8_t* field_ptr = READFIELD_DATAPTR(ptr);
+        if (stream_id != nullptr)
+            *stream_id = GET_UINT8(field_ptr);
+        field_ptr += sizeof(uint8_t);
+        if (packets_recv != nullptr)
+            *packets_recv = GET_UINT16(field_ptr);
+        field_ptr += sizeof(uint16_t);
+        if (packets_lost != nullptr)
+            *packets_lost = GET_UINT16(field_ptr);
+        return true;
+    }
+
+    uint8_t ReceiverReportPacket::GetStreamID() const
+    {
+        uint8_t stream_id = 0;
+        GetAudioLoss(&stream_id, nullptr, nullptr);
+        return stream_id;
+    }
+
+    uint16_t ReceiverReportPacket::GetPacketsRecv() const
+    {
+        uint16_t packets_recv = 0;
+        GetAudioLoss(nullptr, &packets_recv, nullptr);
+        return packets_recv;
+    }
+
+    uint16_t ReceiverReportPacket::GetPacketsLost() const
+    {
+        uint16_t packets_lost = 0;
+        GetAudioLoss(nullptr, nullptr, &packets_lost);
+        return packets_lost;
+    }
+
+    int ReceiverReportPacket::GetLossPercent() const
+    {
+        int const recv = GetPacketsRecv(), lost = GetPacketsLost();
+        if (recv + lost == 0)
+            return 0;
+        return lost * 100 / (recv + lost);
+    }
+
+    ReceiverReport ReceiverReportPacket::GetReport() const
+    {
+        ReceiverReport report;
+        GetAudioLoss(&report.stream_id, &report.packets_recv, &report.packets_lost);
+
+        const uint8_t* ptr = FindField(FIELDTYPE_AUDIO_DELAY);
+        if (ptr != nullptr && READFIELD_SIZE(ptr) >= sizeof(uint16_t) + sizeof(int16_t))
+        {
+            const uint8_t* field_ptr = READFIELD_DATAPTR(ptr);
+            report.jitter_msec = GET_UINT16(field_ptr);
+            field_ptr += sizeof(uint16_t);
+            report.delay_gradient_msec = int16_t(GET_UINT16(field_ptr));
+        }
+
+        ptr = FindField(FIELDTYPE_VIDEO_LOSS);
+        if (ptr != nullptr && READFIELD_SIZE(ptr) >= sizeof(uint8_t) + sizeof(uint16_t) + sizeof(uint16_t) + sizeof(int16_t))
+        {
+            const uint8_t* field_ptr = READFIELD_DATAPTR(ptr);
+            report.video_stream_id = GET_UINT8(field_ptr);
+            field_ptr += sizeof(uint8_t);
+            report.video_frames_recv = GET_UINT16(field_ptr);
+            field_ptr += sizeof(uint16_t);
+            report.video_frames_lost = GET_UINT16(field_ptr);
+            field_ptr += sizeof(uint16_t);
+            report.video_delay_gradient_msec = int16_t(GET_UINT16(field_ptr));
+        }
+        return report;
+    }
+
+} // namespace teamtalk
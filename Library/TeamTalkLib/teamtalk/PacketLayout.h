@@ -486,6 +486,12 @@ constexpr uint8_t* FINDFIELD_TYPE(uint8_t* buf, FIELDTYPE fieldtype, T2 buf_size
         PACKET_KIND_DESKTOPINPUT_ACK                = 21,
         PACKET_KIND_DESKTOPINPUT_ACK_CRYPT          = 22,
 
+        PACKET_KIND_VIDEO_FEEDBACK                  = 23,
+        PACKET_KIND_VIDEO_FEEDBACK_CRYPT            = 24,
+
+        PACKET_KIND_RECEIVER_REPORT                 = 25,
+        PACKET_KIND_RECEIVER_REPORT_CRYPT           = 26,
+
         /* When adding new packet types, then remember to 
          * update PacketQueue::RemoveChannelPackets() 
          * for none channel specific packet kinds */
@@ -526,6 +532,25 @@ constexpr auto TT_MAX_HEADER_SIZE = 10;
 
 constexpr auto MAX_FIELD_SIZE = 0xFFF;
 constexpr auto MAX_ENC_FRAMESIZE = 0xFFF /* 12 bits */;
+constexpr auto FIELDTYPE_COUNT = 16 /* 4 bits */;
+
+    // Location of the first field of each type in a received
+    // packet. Built in a single pass which also validates the packet
+    // so FieldPacket::FindField() doesn't have to scan the packet.
+    class FieldIndex
+    {
+    public:
+        // Same checks as FieldPacket::ValidatePacket()
+        bool Build(const char* packet, uint16_t packet_size);
+        const uint8_t* Find(uint8_t fieldtype) const;
+        const char* GetPacket() const { return reinterpret_cast<const char*>(m_packet); }
+
+    private:
+        const uint8_t* m_packet = nullptr;
+        uint16_t m_packet_size = 0;
+        // offset of field in 'm_packet', 0 = not found
+        std::array<uint16_t, FIELDTYPE_COUNT> m_offsets = {};
+    };
 
     class FieldPacket
     {
@@ -552,10 +577,18 @@ constexpr auto MAX_ENC_FRAMESIZE = 0xFFF /* 12 bits */;
         void SetChannel(uint16_t channelid);
         //requires TT_USER_HEADER_SIZE header type
         void SetDestUser(uint16_t userid);
+        //change TT_CHANNEL_HEADER_SIZE header to TT_USER_HEADER_SIZE
+        //so server only forwards packet to 'userid'. Requires a packet
+        //which owns its buffers, e.g. a copy
+        void ChangeDestUser(uint16_t userid);
 
         const iovec* GetPacket(int& buffers) const;
         uint16_t GetPacketSize() const;
         bool ValidatePacket() const;
+        // Look up fields in 'index' instead of scanning the
+        // packet. 'index' must be built from the buffer this packet
+        // was constructed from and must outlive this packet.
+        void SetFieldIndex(const FieldIndex* index);
 
 #ifdef ENABLE_ENCRYPTION
         const std::set<uint8_t>& GetCryptSections() const { return m_crypt_sections; }
@@ -577,6 +610,8 @@ constexpr auto MAX_ENC_FRAMESIZE = 0xFFF /* 12 bits */;
         const uint8_t* FindField(uint8_t fieldtype) const;
         std::vector<iovec> m_iovec;
         bool m_cleanup = false;
+        //not copied since copies have their own buffers
+        const FieldIndex* m_fieldindex = nullptr;
 #ifdef ENABLE_ENCRYPTION
         //Holds which part of 'm_iovec' should be encrypted by 'CryptPacket'
         std::set<uint8_t> m_crypt_sections;
@@ -588,16 +623,22 @@ constexpr auto MAX_ENC_FRAMESIZE = 0xFFF /* 12 bits */;
     class HelloPacket : public FieldPacket
     {
     public:
-        HelloPacket(uint16_t src_userid, uint32_t time);
+        HelloPacket(uint16_t src_userid, uint32_t time)
+            : HelloPacket(src_userid, time, 0) { }
+        //'migrate_token' != 0 lets server accept hello from a new
+        //IP-address after client changed network
+        HelloPacket(uint16_t src_userid, uint32_t time, int64_t migrate_token);
         HelloPacket(const char* packet, uint16_t packet_size)
             : FieldPacket(packet, packet_size) { }
         uint8_t GetProtocol() const;
+        int64_t GetMigrateToken() const;
 
     private:
         enum : uint8_t
         {
             /* FIELDTYPE must NOT conflict with parent class packet */
             FIELDTYPE_PROTOCOL = FIELDTYPE_LAST+1, //uint16_t
+            FIELDTYPE_MIGRATE_TOKEN,               //int64_t
             /* New fields here to be compatible */
         };
     };
@@ -714,6 +755,8 @@ constexpr auto MAX_ENC_FRAMESIZE = 0xFFF /* 12 bits */;
         std::vector<uint16_t> GetEncodedFrameSizes() const;
         bool HasFragments() const;
         bool HasFrameSizes() const { return FindField(FIELDTYPE_ENCFRAMESIZES) != nullptr; }
+        //all encoded frames are Opus DTX frames, i.e. silence
+        bool IsOpusDTX() const;
 
     private:
         void InitCommon(uint8_t stream_id, uint16_t packet_no, 
@@ -737,7 +780,8 @@ constexpr auto MAX_ENC_FRAMESIZE = 0xFFF /* 12 bits */;
         uint8_t* Init(uint8_t kind, uint8_t stream_id, uint32_t packet_no,
                    const uint16_t* width, const uint16_t* height,
                    const char* enc_data, uint16_t enc_len, 
-                   const uint16_t* fragmentno, const uint16_t* fragmentcnt);
+                   const uint16_t* fragmentno, const uint16_t* fragmentcnt,
+                   uint8_t vidcodec, uint8_t simulcast);
     public:
         VideoPacket(const VideoPacket& p); //copy constructor
         VideoPacket(const FieldPacket& p);
@@ -746,24 +790,27 @@ constexpr auto MAX_ENC_FRAMESIZE = 0xFFF /* 12 bits */;
                     iovec& decrypt_fields)
                     : FieldPacket(kind, crypt_pkt, decrypt_fields){}
 
-        //build complete video packet
+        //build complete video packet. 'vidcodec' = 0 implies VP8.
+        //'simulcast' = 0 implies no simulcast, see SimulcastInfo()
         VideoPacket(uint8_t kind, uint16_t src_userid, uint32_t time, 
                     uint8_t stream_id, uint32_t packet_no, 
                     const uint16_t* width, const uint16_t* height,
-                    const char* enc_data, uint16_t enc_len);
+                    const char* enc_data, uint16_t enc_len,
+                    uint8_t vidcodec = 0, uint8_t simulcast = 0);
 
-        //build fragmented video packet
+        //build fragmented video packet. 'vidcodec' = 0 implies VP8
         VideoPacket(uint8_t kind, uint16_t src_userid, uint32_t time,
                     uint8_t stream_id, uint32_t packet_no, 
                     const uint16_t* width, const uint16_t* height,
                     const char* enc_data, uint16_t enc_len, 
-                    uint16_t fragmentcnt);
+                    uint16_t fragmentcnt, uint8_t vidcodec = 0,
+                    uint8_t simulcast = 0);
 
         //build fragment video packet
         VideoPacket(uint8_t kind, uint16_t src_userid, uint32_t time,
                     uint8_t stream_id, uint32_t packet_no, 
                     const char* enc_data, uint16_t enc_len, 
-                    uint16_t fragmentno);
+                    uint16_t fragmentno, uint8_t simulcast = 0);
 
         uint8_t GetStreamID() const { return GetStreamID(nullptr); }
 
@@ -777,6 +824,16 @@ constexpr auto MAX_ENC_FRAMESIZE = 0xFFF /* 12 bits */;
         static constexpr uint16_t INVALID_FRAGMENT_NO = 0xFFFF;
 
         bool GetVideoInfo(uint16_t& width, uint16_t& height) const;
+        //returns 0 if not specified (VP8)
+        uint8_t GetVideoCodec() const;
+
+        //FIELDTYPE_SIMULCAST value. Every fragment carries it.
+        static constexpr uint8_t SimulcastInfo(int layer, int layers, bool key_frame)
+        {
+            return uint8_t((layer & 0xF) | ((layers & 0x7) << 4) | (key_frame ? 0x80 : 0));
+        }
+        //returns false if video stream is not simulcast
+        bool GetSimulcast(int& layer, int& layers, bool& key_frame) const;
 
         const char* GetEncodedData(uint16_t& packet_bytes) const;
 
@@ -789,6 +846,8 @@ constexpr auto MAX_ENC_FRAMESIZE = 0xFFF /* 12 bits */;
             FIELDTYPE_STREAMID_PKTNUM_FRAGCNT, /* Fragmented packet with frag_count, implies frag no = 0, [uint8_t,uint32_t,uint16_t] */
             FIELDTYPE_STREAMID_PKTNUM_FRAGNO, /* Fragment of packet with frag_no. [uint8_t,uint32_t,uint16_t] */
             FIELDTYPE_ENCDATA, /* Encoded video data. [Array-char...] */
+            FIELDTYPE_VIDCODEC, /* Only with VIDINFO, absent means VP8. [uint8_t] */
+            FIELDTYPE_SIMULCAST, /* Layer, layer count and key frame flag. [uint8_t] */
             /* New fields here to be compatible */
         };
     };
@@ -1123,6 +1182,115 @@ constexpr auto MAX_ENC_FRAMESIZE = 0xFFF /* 12 bits */;
         };
     };
 
+    //packet no -> missing fragments. VideoPacket::INVALID_FRAGMENT_NO
+    //means the entire video packet is missing
+    using video_nacks_t = std::map< uint32_t, std::set<uint16_t>, W32LessComp >;
+
+    /* Creates PACKET_KIND_VIDEO_FEEDBACK. Sent by receiver of a video
+     * stream to the video sender to request a key frame and/or
+     * retransmission of lost video packets. */
+    class VideoFeedbackPacket : public FieldPacket
+    {
+    public:
+        VideoFeedbackPacket(uint16_t src_userid, uint32_t time, 
+                            uint16_t dest_userid, uint8_t stream_id,
+                            int layer, bool keyframe_request,
+                            const video_nacks_t& nacks);
+
+        VideoFeedbackPacket(uint8_t kind, const FieldPacket& crypt_pkt,
+                            iovec& decrypt_fields)
+                            : FieldPacket(kind, crypt_pkt, decrypt_fields){}
+
+        VideoFeedbackPacket(const char* packet, uint16_t packet_size)
+            : FieldPacket(packet, packet_size) { }
+
+        VideoFeedbackPacket(const VideoFeedbackPacket& packet);
+
+        uint8_t GetStreamID() const;
+        //simulcast layer being received
+        int GetLayer() const;
+        bool GetKeyFrameRequest() const;
+        video_nacks_t GetNacks() const;
+
+        //max number of missing fragments in a single packet
+        static constexpr int NACKS_MAX = 64;
+
+    private:
+        bool GetStreamInfo(uint8_t* stream_id, int* layer, bool* keyframe_request) const;
+
+        enum : uint8_t
+        {
+            //[streamid(uint8_t), layer(uint8_t), keyframe(uint8_t)]
+            FIELDTYPE_STREAMID_LAYER_KEYFRAME = FIELDTYPE_LAST+1,
+            //[packetno(uint32_t), fragno(uint16_t)]...
+            FIELDTYPE_NACKS,
+        };
+    };
+
+    struct ReceiverReport
+    {
+        //voice stream, 0 = no voice report
+        uint8_t stream_id = 0;
+        //voice packets received and lost since previous report
+        uint16_t packets_recv = 0, packets_lost = 0;
+        //interarrival jitter of voice packets
+        uint16_t jitter_msec = 0;
+        //change in one-way delay of voice packets since previous report
+        int16_t delay_gradient_msec = 0;
+        //video capture stream, 0 = no video report
+        uint8_t video_stream_id = 0;
+        //video frames received and lost since previous report
+        uint16_t video_frames_recv = 0, video_frames_lost = 0;
+        int16_t video_delay_gradient_msec = 0;
+    };
+
+    /* Creates PACKET_KIND_RECEIVER_REPORT. Sent periodically by
+     * receiver of a voice or video stream to the sender so the sender
+     * can adapt its encoder to the packet loss and delay seen by
+     * receivers. */
+    class ReceiverReportPacket : public FieldPacket
+    {
+    public:
+        ReceiverReportPacket(uint16_t src_userid, uint32_t time,
+                             uint16_t dest_userid, uint8_t stream_id,
+                             uint16_t packets_recv, uint16_t packets_lost);
+
+        ReceiverReportPacket(uint16_t src_userid, uint32_t time,
+                             uint16_t dest_userid, const ReceiverReport& report);
+
+        ReceiverReportPacket(uint8_t kind, const FieldPacket& crypt_pkt,
+                             iovec& decrypt_fields)
+                             : FieldPacket(kind, crypt_pkt, decrypt_fields){}
+
+        ReceiverReportPacket(const char* packet, uint16_t packet_size)
+            : FieldPacket(packet, packet_size) { }
+
+        ReceiverReportPacket(const ReceiverReportPacket& packet);
+
+        uint8_t GetStreamID() const;
+        //voice packets received and lost since previous report
+        uint16_t GetPacketsRecv() const;
+        uint16_t GetPacketsLost() const;
+        //loss in percent of packets expected
+        int GetLossPercent() const;
+        //absent fields are zero
+        ReceiverReport GetReport() const;
+
+    private:
+        bool GetAudioLoss(uint8_t* stream_id, uint16_t* packets_recv,
+                          uint16_t* packets_lost) const;
+
+        enum : uint8_t
+        {
+            //[streamid(uint8_t), recv(uint16_t), lost(uint16_t)]
+            FIELDTYPE_AUDIO_LOSS = FIELDTYPE_LAST+1,
+            //[jitter(uint16_t), delay gradient(int16_t)]
+            FIELDTYPE_AUDIO_DELAY,
+            //[streamid(uint8_t), recv(uint16_t), lost(uint16_t), delay gradient(int16_t)]
+            FIELDTYPE_VIDEO_LOSS,
+        };
+    };
+
 
 #if defined(ENABLE_ENCRYPTION)
 
@@ -1163,6 +1331,10 @@ constexpr auto MAX_ENC_FRAMESIZE = 0xFFF /* 12 bits */;
     using CryptDesktopInputPacket = CryptPacket<DesktopInputPacket, PACKET_KIND_DESKTOPINPUT_CRYPT, PACKET_KIND_DESKTOPINPUT>;
 
     using CryptDesktopInputAckPacket = CryptPacket<DesktopInputAckPacket, PACKET_KIND_DESKTOPINPUT_ACK_CRYPT, PACKET_KIND_DESKTOPINPUT_ACK>;
+
+    using CryptVideoFeedbackPacket = CryptPacket<VideoFeedbackPacket, PACKET_KIND_VIDEO_FEEDBACK_CRYPT, PACKET_KIND_VIDEO_FEEDBACK>;
+
+    using CryptReceiverReportPacket = CryptPacket<ReceiverReportPacket, PACKET_KIND_RECEIVER_REPORT_CRYPT, PACKET_KIND_RECEIVER_REPORT>;
     
 #endif
 } // namespace teamtalk
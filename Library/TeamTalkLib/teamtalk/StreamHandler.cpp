@@ -122,7 +122,11 @@ void CryptStreamHandler::reactor(ACE_Reactor *reactor)
 
 void CryptStreamHandler::SSLReset(ACE_Reactor *reactor)
 {
-    ACE_SSL_Context* ctx = SSLContext(reactor);
+    SSLReset(SSLContext(reactor));
+}
+
+void CryptStreamHandler::SSLReset(ACE_SSL_Context* ctx)
+{
     peer_.ReinitSSL(ctx);
 
     SSL_CTX* sslctx = ctx->context();
@@ -284,6 +284,9 @@ public:
 
     void reactor(ACE_Reactor *reactor) override;
 
+    // Use 'ctx' instead of the context registered for the reactor
+    void SSLReset(ACE_SSL_Context* ctx);
+
 protected:
     void SSLReset(ACE_Reactor *reactor);
     int ProcessSSL(SSL* ssl);
@@ -30,10 +30,13 @@
 
 #include <algorithm>
 #include <cstring>
-#include <set>
 #include <utility>
 
 constexpr auto DEBUG_AUDIOMUXER = 0;
+// muxed audio collected before encoding on EncodePool
+constexpr auto ENCODE_BATCH_MSEC = 200;
+// users times stream types which can be muxed at the same time
+constexpr auto MUXSOURCES_MAX = 1024;
 
 using namespace teamtalk;
 
@@ -54,14 +57,27 @@ static teamtalk::StreamType GetStreamType(uint32_t key)
     return teamtalk::StreamType(key & 0xffff);
 }
 
-AudioMuxer::AudioMuxer(teamtalk::StreamTypes sts)
-    : m_streamtypes(sts)
+AudioMuxer::MuxSource::~MuxSource()
 {
+    if (remainder != nullptr)
+        remainder->release();
+}
+
+AudioMuxer::AudioMuxer(teamtalk::StreamTypes sts, teamtalk::EncodePool* encodepool/* = nullptr*/,
+                       teamtalk::ReactorPool* timers/* = nullptr*/)
+    : m_timerpool(timers)
+    , m_streamtypes(sts)
+    , m_encodepool(encodepool)
+{
+    if (m_encodepool)
+        m_encode_strand = m_encodepool->NewStrand();
 }
 
 AudioMuxer::~AudioMuxer()
 {
     StopThread();
+    // files are closed by destructors so encoder must be done
+    DrainEncoder();
     MYTRACE(ACE_TEXT("~AudioMuxer()\n"));
 }
 
@@ -77,8 +93,8 @@ bool AudioMuxer::StartThread(const media::AudioInputFormat& fmt)
 {
     TTASSERT(m_inputformat == media::AudioInputFormat());
 
-    TTASSERT(!m_thread);
-    if (m_thread)
+    TTASSERT(!m_thread && !m_timer_reactor);
+    if (m_thread || m_timer_reactor)
         return false;
 
     //mux interval
@@ -94,15 +110,36 @@ bool AudioMuxer::StartThread(const media::AudioInputFormat& fmt)
     m_sample_no = 0;
     m_last_flush_time = GETTIMESTAMP();
 
+    {
+        std::unique_lock<std::shared_mutex> const g(m_sources_lock);
+        m_sources.resize(MUXSOURCES_MAX);
+        m_sources_count = 0;
+        m_accept_audio = true;
+    }
+
     MYTRACE(ACE_TEXT("Starting AudioMuxer with sample rate %d, channels %d and callback %d\n"),
             fmt.fmt.samplerate, fmt.fmt.channels, fmt.samples);
 
+    if (m_timerpool)
+    {
+        m_timer_reactor = m_timerpool->Acquire();
+        m_timerhandler = std::make_unique<TimerHandler>(*this, 577);
+        m_timerid = m_timer_reactor->schedule_timer(m_timerhandler.get(), nullptr, m_mux_interval, m_mux_interval);
+        TTASSERT(m_timerid >= 0);
+        return true;
+    }
+
     m_thread = std::make_shared<std::thread>(&AudioMuxer::Run, this);
     return true;
 }
 
 void AudioMuxer::StopThread()
 {
+    {
+        std::unique_lock<std::shared_mutex> const g(m_sources_lock);
+        m_accept_audio = false;
+    }
+
     if (m_thread)
     {
         int ret = 0;
@@ -115,15 +152,32 @@ void AudioMuxer::StopThread()
         m_reactor.reset_reactor_event_loop();
     }
 
-    m_inputformat = media::AudioInputFormat();
-    m_usermux_queue.clear();
-    m_usermux_progress.clear();
-    m_preprocess_queue.Reset();
-    while (!m_preprocess_block.empty())
+    if (m_timer_reactor)
+    {
+        // the reactor lock is held while the timer runs so when
+        // cancelled this thread takes over as the mux thread
+        if (m_timerid >= 0)
+        {
+            int const ret = m_timer_reactor->cancel_timer(m_timerid);
+            TTASSERT(ret >= 0);
+        }
+        m_timerid = -1;
+        m_timerpool->Release(m_timer_reactor);
+        m_timer_reactor = nullptr;
+        m_timerhandler.reset();
+
+        //flush remaining data
+        ProcessAudioQueues(true);
+    }
+
     {
-        m_preprocess_block.begin()->second->release();
-        m_preprocess_block.erase(m_preprocess_block.begin());
+        std::unique_lock<std::shared_mutex> const g(m_sources_lock);
+        m_sources.clear();
+        m_sources_count = 0;
     }
+
+    m_inputformat = media::AudioInputFormat();
+    m_preprocess_queue.Reset();
 }
 
 bool AudioMuxer::RegisterMuxCallback(const media::AudioInputFormat& fmt,
@@ -271,6 +325,8 @@ void AudioMuxer::CloseFile()
     if (!m_muxcallback)
         StopThread();
 
+    DrainEncoder();
+
 #if defined(ENABLE_OPUSFILE)
     if (m_opusfile)
     {
@@ -305,10 +361,6 @@ bool AudioMuxer::QueueUserAudio(int userid, teamtalk::StreamType st,
 {
     TTASSERT((frm.input_buffer == nullptr && frm.input_samples == 0) || (frm.input_buffer && frm.input_samples));
 
-    //if thread isn't running just ignore
-    if (!m_thread)
-        return false;
-
     // check that this stream type has been selected for muxing
     if ((m_streamtypes & st) == teamtalk::STREAMTYPE_NONE)
         return false;
@@ -316,21 +368,35 @@ bool AudioMuxer::QueueUserAudio(int userid, teamtalk::StreamType st,
     // media::AudioFrame.userdata must contain StreamType
     assert(frm.userdata == st || frm.userdata == teamtalk::STREAMTYPE_NONE);
 
-    int const key = GenKey(userid, st);
+    uint32_t const key = GenKey(userid, st);
 
-    std::unique_lock<std::recursive_mutex> const g(m_mutex1_preprocess);
-    
-    if (!m_preprocess_queue.Exists(userid, st))
+    std::shared_lock<std::shared_mutex> sg(m_sources_lock);
+
+    //if thread isn't running just ignore
+    if (!m_accept_audio)
+        return false;
+
+    MuxSource* source = FindMuxSource(key);
+    if (source == nullptr)
     {
-        MYTRACE_COND(DEBUG_AUDIOMUXER, ACE_TEXT("Adding audio source #%d, streamtype: 0x%x\n"),
-            GetUserID(key), GetStreamType(key));
-        m_preprocess_queue.AddAudioSource(userid, st, m_inputformat.fmt);
+        sg.unlock();
+        {
+            std::unique_lock<std::shared_mutex> const g(m_sources_lock);
+            if (m_accept_audio && FindMuxSource(key) == nullptr)
+                AddMuxSource(key);
+        }
+        sg.lock();
 
-        // allocate queue so muxer will wait for audio source to provide enough samples
-        std::unique_lock<std::recursive_mutex> const g(m_mutex2_mux);
-        GetMuxQueue(key);
+        if (!m_accept_audio)
+            return false;
+        source = FindMuxSource(key);
+        if (source == nullptr)
+            return false;
     }
 
+    // only contended if several threads queue audio for same source
+    std::lock_guard<std::mutex> const pg(source->producer_lock);
+
     MYTRACE_COND(DEBUG_AUDIOMUXER, ACE_TEXT("Queueing #%d streamtype: 0x%x sample index %u\n"),
                  GetUserID(key), GetStreamType(key), frm.sample_no);
     if (!m_preprocess_queue.AddAudio(userid, st, frm))
@@ -338,144 +404,150 @@ bool AudioMuxer::QueueUserAudio(int userid, teamtalk::StreamType st,
         MYTRACE_COND(DEBUG_AUDIOMUXER, ACE_TEXT("AudioMuxer failed to queue resample audio from #%d streamtype 0x%x. Resetting.\n"),
             userid, st);
         m_preprocess_queue.RemoveAudioSource(userid, st);
+        m_preprocess_queue.AddAudioSource(userid, st, m_inputformat.fmt);
+        if (source->remainder != nullptr)
+        {
+            source->remainder->release();
+            source->remainder = nullptr;
+        }
 
         // clear as mux source
-        std::unique_lock<std::recursive_mutex> const g(m_mutex2_mux);
-        SubmitMuxAudioFrame(key, media::AudioFrame());
+        SubmitMuxAudioFrame(*source, media::AudioFrame());
+        return true;
     }
 
+    if (frm.input_samples > 0)
+        source->waiting = true;
+
+    SubmitPreprocessQueue(*source);
     return true;
 }
 
-AudioMuxer::message_queue_t AudioMuxer::GetMuxQueue(int key)
+AudioMuxer::MuxSource* AudioMuxer::FindMuxSource(uint32_t key)
 {
-    auto const ii = m_usermux_queue.find(key);
-    if (ii == m_usermux_queue.end())
+    int const count = m_sources_count;
+    for (int i=0;i<count;i++)
     {
-        // setup audio buffer queue for user prior to mixing streams
-        int const msec = m_inputformat.GetDurationMSec();
-        assert(msec > 0);
-
-        // Set mux buffer to 1 second as maximum.
-        //
-        // If 'm_preprocess_queue' contains more than 1 second of audio
-        // then it will cause the AudioMuxer to overflow its buffer.
-        // Therefore the transmit-interval must never exceed 1 second.
-        int MUXBUFFER_MAX = media::AudioInputFormat(m_inputformat.fmt,
-                                                    m_inputformat.fmt.samplerate).GetBytes();
-        int const n_frames = (m_mux_interval.msec() / msec) + 1;
-        MUXBUFFER_MAX += sizeof(media::AudioFrame) * n_frames;
-
-        m_usermux_queue[key] = std::make_shared<ACE_Message_Queue<ACE_MT_SYNCH>>();
-        auto q = m_usermux_queue[key];
+        if (m_sources[i]->key == key)
+            return m_sources[i].get();
+    }
+    return nullptr;
+}
 
-        q->high_water_mark(MUXBUFFER_MAX);
-        q->low_water_mark(MUXBUFFER_MAX);
+AudioMuxer::MuxSource* AudioMuxer::AddMuxSource(uint32_t key)
+{
+    int const count = m_sources_count;
+    if (count >= int(m_sources.size()))
+    {
+        MYTRACE(ACE_TEXT("AudioMuxer cannot add more than %d audio sources\n"), count);
+        return nullptr;
     }
 
-    return m_usermux_queue[key];
+    MYTRACE_COND(DEBUG_AUDIOMUXER, ACE_TEXT("Adding audio source #%d, streamtype: 0x%x\n"),
+                 GetUserID(key), GetStreamType(key));
+
+    // Set mux buffer to 1 second as maximum.
+    //
+    // If 'm_preprocess_queue' contains more than 1 second of audio
+    // then it will cause the AudioMuxer to overflow its buffer.
+    // Therefore the transmit-interval must never exceed 1 second.
+    int const msec = m_inputformat.GetDurationMSec();
+    assert(msec > 0);
+    int const n_frames = (1000 / msec) + (m_mux_interval.msec() / msec) + 1;
+
+    auto source = std::make_unique<MuxSource>();
+    source->key = key;
+    MuxSlot slot;
+    slot.buffer.resize(m_inputformat.GetTotalSamples());
+    source->ring.Reset(n_frames, slot);
+
+    m_preprocess_queue.AddAudioSource(GetUserID(key), GetStreamType(key), m_inputformat.fmt);
+
+    m_sources[count] = std::move(source);
+    m_sources_count = count + 1;
+    return m_sources[count].get();
 }
 
-int AudioMuxer::SubmitMuxAudioFrame(int key, const media::AudioFrame& frm)
+bool AudioMuxer::SubmitMuxAudioFrame(MuxSource& source, const media::AudioFrame& frm)
 {
     assert((m_inputformat.fmt == frm.inputfmt && m_inputformat.samples == frm.input_samples) || frm.input_samples == 0);
 
-    // MYTRACE(ACE_TEXT("Add audio from #%d to audiomuxer %p. Offset %u. Samples %d\n"),
-    //         userid, this, sample_no, n_samples);
-
-    message_queue_t const q = GetMuxQueue(key);
-
-    MYTRACE_COND(DEBUG_AUDIOMUXER, ACE_TEXT("Buffer size for user #%d, streamtype 0x%x, %d/%d bytes\n"),
-                 GetUserID(key), GetStreamType(key), int(q->message_length()), int(q->high_water_mark()));
-
-    ACE_Message_Block* mb = AudioFrameToMsgBlock(frm);
-
-    ACE_Time_Value tm;
-    if (q->enqueue(mb, &tm) < 0)
+    MuxSlot* slot = source.ring.Back();
+    if (slot == nullptr)
     {
-        MYTRACE_COND(DEBUG_AUDIOMUXER, ACE_TEXT("Buffer full for user #%d streamtype 0x%x, sampleindex %u, is last: %s. Dropping queue containing %d msec, %u/%u bytes\n"),
-                GetUserID(key), GetStreamType(key), frm.sample_no, (frm.input_samples == 0 ? ACE_TEXT("true"):ACE_TEXT("false")),
-                q->message_count() * m_inputformat.GetDurationMSec(), unsigned(q->message_bytes()), unsigned(q->high_water_mark()));
-        q->flush();
-        TTASSERT(q->message_count() == 0);
-        //insert after flush, so it will appear as a new stream
-        tm = ACE_Time_Value::zero;
-        if (q->enqueue(mb, &tm) < 0)
-        {
-            mb->release();
-            m_usermux_queue.erase(key);
-        }
-        //clear sample no tracker
-        m_usermux_progress.erase(key);
+        // mux thread has fallen behind. Muxer ends the stream when
+        // it has emptied 'ring'
+        source.overflow = true;
+        MYTRACE_COND(DEBUG_AUDIOMUXER, ACE_TEXT("Buffer full for user #%d streamtype 0x%x, sampleindex %u, is last: %s. Dropping %d msec\n"),
+                GetUserID(source.key), GetStreamType(source.key), frm.sample_no, (frm.input_samples == 0 ? ACE_TEXT("true"):ACE_TEXT("false")),
+                m_inputformat.GetDurationMSec());
+        return false;
     }
-    else
+
+    slot->samples = frm.input_samples;
+    slot->sample_no = frm.sample_no;
+    slot->sts = frm.userdata;
+    if (frm.input_samples > 0)
     {
-        MYTRACE_COND(DEBUG_AUDIOMUXER, ACE_TEXT("Submitted #%d streamtype: 0x%x from sample index %u, samples %d\n"),
-                     GetUserID(key), GetStreamType(key), frm.sample_no, frm.input_samples);
+        TTASSERT(int(slot->buffer.size()) == m_inputformat.GetTotalSamples());
+        std::memcpy(slot->buffer.data(), frm.input_buffer, slot->buffer.size() * sizeof(short));
     }
-    return int(q->message_count());
+    source.ring.Push();
+
+    MYTRACE_COND(DEBUG_AUDIOMUXER, ACE_TEXT("Submitted #%d streamtype: 0x%x from sample index %u, samples %d\n"),
+                 GetUserID(source.key), GetStreamType(source.key), frm.sample_no, frm.input_samples);
+    return true;
 }
 
-void AudioMuxer::SubmitPreprocessQueue()
+void AudioMuxer::SubmitPreprocessQueue(MuxSource& source)
 {
-    std::vector<int> keys;
-    // store keys since we erase 'm_usermux_queue' elements during processing
-    auto ii = m_usermux_queue.begin();
-    for (;ii != m_usermux_queue.end();++ii)
-        keys.push_back(ii->first);
+    int const userid = GetUserID(source.key);
+    teamtalk::StreamType const st = GetStreamType(source.key);
 
-    for (auto key : keys)
+    // extract all AudioFrames from user w. StreamType starting with
+    // the one in 'source.remainder'
+    std::vector<ACE_Message_Block*> mbs;
+    if (source.remainder != nullptr)
     {
-        int const userid = GetUserID(key);
-        teamtalk::StreamType const st = GetStreamType(key);
-
-        // extract all AudioFrames from user w. StreamType starting with
-        // the one in 'm_userresample_block'
-        std::vector<ACE_Message_Block*> mbs;
-        if (m_preprocess_block.contains(key))
-        {
-            MYTRACE_COND(DEBUG_AUDIOMUXER, ACE_TEXT("Resuming #%d streamtype: 0x%x from sample index %u\n"),
-                         userid, st, media::AudioFrame(m_preprocess_block[key]).sample_no);
-            mbs.push_back(m_preprocess_block[key]);
-        }
-        m_preprocess_block.erase(key);
+        MYTRACE_COND(DEBUG_AUDIOMUXER, ACE_TEXT("Resuming #%d streamtype: 0x%x from sample index %u\n"),
+                     userid, st, media::AudioFrame(source.remainder).sample_no);
+        mbs.push_back(source.remainder);
+        source.remainder = nullptr;
+    }
 
-        ACE_Message_Block* mb = nullptr;
-        while ((mb = m_preprocess_queue.AcquireAudioFrame(userid, st)) != nullptr)
-        {
-            mbs.push_back(mb);
-            MYTRACE_COND(DEBUG_AUDIOMUXER, ACE_TEXT("Dequeued #%d streamtype: 0x%x sample index %u\n"),
-                GetUserID(key), GetStreamType(key), media::AudioFrame(mb).sample_no);
-        }
+    ACE_Message_Block* mb = nullptr;
+    while ((mb = m_preprocess_queue.AcquireAudioFrame(userid, st)) != nullptr)
+    {
+        mbs.push_back(mb);
+        MYTRACE_COND(DEBUG_AUDIOMUXER, ACE_TEXT("Dequeued #%d streamtype: 0x%x sample index %u\n"),
+            userid, st, media::AudioFrame(mb).sample_no);
+    }
 
-        // Submit as many "mux-ready" frames as possible
-        while ((mb = BuildMuxAudioFrame(mbs)) != nullptr)
-        {
-            MBGuard const g(mb);
-            media::AudioFrame const frm(mb);
-            MYTRACE_COND(DEBUG_AUDIOMUXER, ACE_TEXT("Submitting #%d streamtype: 0x%x from sample index %u\n"),
-                         userid, st, frm.sample_no);
-            SubmitMuxAudioFrame(key, frm);
-        }
+    // Submit as many "mux-ready" frames as possible
+    while ((mb = BuildMuxAudioFrame(mbs)) != nullptr)
+    {
+        MBGuard const g(mb);
+        media::AudioFrame frm(mb);
+        MYTRACE_COND(DEBUG_AUDIOMUXER, ACE_TEXT("Submitting #%d streamtype: 0x%x from sample index %u\n"),
+                     userid, st, frm.sample_no);
+        frm.ApplyGain();
+        SubmitMuxAudioFrame(source, frm);
+    }
 
-        // If any AudioBlocks remain then store one AudioFrame in 'm_userresample_block'
-        if (mbs.size() == 1)
-        {
-            m_preprocess_block[key] = mbs[0];
-            mbs.clear();
-            MYTRACE_COND(DEBUG_AUDIOMUXER, ACE_TEXT("Store #%d streamtype: 0x%x from sample index %u\n"),
-                         userid, st, media::AudioFrame(m_preprocess_block[key]).sample_no);
-        }
-        else if (mbs.size() > 1)
-        {
-            mb = AudioFramesMerge(mbs);
-            for (auto *m : mbs)
-                m->release();
-            mbs.clear();
-            m_preprocess_block[key] = mb;
-            MYTRACE_COND(DEBUG_AUDIOMUXER, ACE_TEXT("Store jumbo #%d streamtype: 0x%x from sample index %u\n"),
-                         userid, st, media::AudioFrame(m_preprocess_block[key]).sample_no);
-        }
+    // If any AudioBlocks remain then store one AudioFrame in 'source.remainder'
+    if (mbs.size() == 1)
+    {
+        source.remainder = mbs[0];
+        MYTRACE_COND(DEBUG_AUDIOMUXER, ACE_TEXT("Store #%d streamtype: 0x%x from sample index %u\n"),
+                     userid, st, media::AudioFrame(source.remainder).sample_no);
+    }
+    else if (mbs.size() > 1)
+    {
+        source.remainder = AudioFramesMerge(mbs);
+        for (auto *m : mbs)
+            m->release();
+        MYTRACE_COND(DEBUG_AUDIOMUXER, ACE_TEXT("Store jumbo #%d streamtype: 0x%x from sample index %u\n"),
+                     userid, st, media::AudioFrame(source.remainder).sample_no);
     }
 }
 
@@ -507,7 +579,7 @@ ACE_Message_Block* AudioMuxer::BuildMuxAudioFrame(std::vector<ACE_Message_Block*
 void AudioMuxer::SetMuxInterval(int msec)
 {
     // must be set prior to thread start
-    assert(!m_thread);
+    assert(!m_thread && !m_timer_reactor);
 
     int cbmsec = m_inputformat.IsValid() ? m_inputformat.GetDurationMSec() : 0;
     cbmsec = std::max(msec, cbmsec);
@@ -549,18 +621,17 @@ void AudioMuxer::ProcessAudioQueues(bool flush)
     ACE_UINT32 const now = GETTIMESTAMP();
     ACE_UINT32 const diff = now - m_last_flush_time;
 
-    // store the list of active sources prior to mux
-    std::vector<int> oldkeys;
+    // sources which have queued audio must be waited for
+    int const count = m_sources_count;
+    for (int i=0;i<count;i++)
     {
-        // 'm_mutex1_preprocess' protects 'm_mutex2_mux'
-        std::unique_lock<std::recursive_mutex> const g(m_mutex1_preprocess);
-
-        auto ii = m_usermux_queue.begin();
-        for (; ii != m_usermux_queue.end(); ++ii)
-            oldkeys.push_back(ii->first);
-
-        // empty preprocess queue
-        SubmitPreprocessQueue();
+        MuxSource& source = *m_sources[i];
+        if (!source.active && (source.waiting.exchange(false) || source.ring.Front() != nullptr))
+        {
+            MYTRACE_COND(DEBUG_AUDIOMUXER, ACE_TEXT("Activated audio source #%d, streamtype: 0x%x\n"),
+                         GetUserID(source.key), GetStreamType(source.key));
+            source.active = true;
+        }
     }
 
     int const cb_msec = m_inputformat.GetDurationMSec();
@@ -575,25 +646,23 @@ void AudioMuxer::ProcessAudioQueues(bool flush)
     while(cb_count != 0)
     {
         StreamTypes sts = STREAMTYPE_NONE;
+        if(CanMuxUserAudio())
+            sts = MuxUserAudio(); //write muxed audio
+        else
         {
-            std::unique_lock<std::recursive_mutex> const g(m_mutex2_mux);
-
-            if(CanMuxUserAudio())
-                sts = MuxUserAudio(); //write muxed audio
-            else
+            bool const anyactive = std::any_of(m_sources.begin(), m_sources.begin() + count,
+                                               [](const std::unique_ptr<MuxSource>& s) { return s->active; });
+            if (!anyactive)
             {
-                if (m_usermux_queue.empty())
-                {
-                    //write silence
-                    short const zero = 0;
-                    m_muxed_buffer.assign(m_muxed_buffer.size(), zero);
-                    //MYTRACE(ACE_TEXT("No audio to mux at %u. Writing %d msec silence\n"),
-                    //        now, cb_msec);
-                }
-                else //no data has arrived in time
-                    break;
+                //write silence
+                short const zero = 0;
+                m_muxed_buffer.assign(m_muxed_buffer.size(), zero);
+                //MYTRACE(ACE_TEXT("No audio to mux at %u. Writing %d msec silence\n"),
+                //        now, cb_msec);
             }
-        } // scope so we don't hold lock during callback
+            else //no data has arrived in time
+                break;
+        }
 
         WriteAudio(cb_samples, sts);
         cb_count--;
@@ -603,16 +672,12 @@ void AudioMuxer::ProcessAudioQueues(bool flush)
     {
         while (true)
         {
-            StreamTypes sts = STREAMTYPE_NONE;
-            {
-                std::unique_lock<std::recursive_mutex> const g(m_mutex2_mux);
-                RemoveEmptyMuxUsers();
+            RemoveEmptyMuxUsers();
 
-                if (CanMuxUserAudio())
-                    sts = MuxUserAudio();
-                else
-                    break;
-            }
+            if (!CanMuxUserAudio())
+                break;
+
+            StreamTypes const sts = MuxUserAudio();
             WriteAudio(cb_samples, sts);
         }
     }
@@ -620,34 +685,7 @@ void AudioMuxer::ProcessAudioQueues(bool flush)
     // MYTRACE(ACE_TEXT("Queued %d msec at %u\n"), (cb_count * cb_msec) - remain_msec, now);
     m_last_flush_time = now - ((cb_count * cb_msec) + remain_msec);
 
-    // 'm_mutex1_preprocess' protects 'm_mutex2_mux'
-    std::unique_lock<std::recursive_mutex> const g(m_mutex1_preprocess);
-
-    // still active audio sources
-    std::set<int> newkeys;
-    auto ii = m_usermux_queue.begin();
-    for (; ii != m_usermux_queue.end(); ++ii)
-        newkeys.insert(ii->first);
-    
-    // clear dead audio sources
-    for (auto key : oldkeys)
-    {
-        if (!newkeys.contains(key))
-        {
-            if (m_preprocess_queue.IsEmpty(GetUserID(key), GetStreamType(key)))
-            {
-                m_preprocess_queue.RemoveAudioSource(GetUserID(key), GetStreamType(key));
-                MYTRACE_COND(DEBUG_AUDIOMUXER, ACE_TEXT("Removed audio source #%d, streamtype: 0x%x\n"),
-                             GetUserID(key), GetStreamType(key));
-            }
-            else
-            {
-                // More audio maybe have been submitted to 'm_preprocess_queue'
-                // so we must ensure that 'key' still exists in 'm_usermux_queue'.
-                GetMuxQueue(key);
-            }
-        }
-    }
+    RemoveIdleSources();
 
     if (m_tickcallback)
         m_tickcallback(m_streamtypes, m_sample_no);
@@ -655,161 +693,184 @@ void AudioMuxer::ProcessAudioQueues(bool flush)
 
 bool AudioMuxer::CanMuxUserAudio()
 {
-    auto ii = m_usermux_queue.begin();
-    while(ii != m_usermux_queue.end())
+    bool anyactive = false;
+    int const count = m_sources_count;
+    for (int i=0;i<count;i++)
     {
-        if(ii->second->is_empty())
+        MuxSource& source = *m_sources[i];
+        if (!source.active)
+            continue;
+
+        if (source.ring.Front() == nullptr && source.overflow.exchange(false))
+        {
+            MYTRACE_COND(DEBUG_AUDIOMUXER, ACE_TEXT("Clearing #%d streamtype 0x%x after overflow\n"),
+                         GetUserID(source.key), GetStreamType(source.key));
+            DeactivateSource(source);
+            continue;
+        }
+
+        if (source.ring.Front() == nullptr)
         {
-            MYTRACE_COND(DEBUG_AUDIOMUXER && m_usermux_progress.find(ii->first) != m_usermux_progress.end(),
+            MYTRACE_COND(DEBUG_AUDIOMUXER && source.has_progress,
                          ACE_TEXT("User #%d has submitted no audio to AudioMuxer. Delaying muxer...\n"),
-                         GetUserID(ii->first));
-            MYTRACE_COND(DEBUG_AUDIOMUXER && m_usermux_progress.find(ii->first) == m_usermux_progress.end(),
-                         ACE_TEXT("User #%d has submitted no audio to AudioMuxer. No sample no available\n"), GetUserID(ii->first));
+                         GetUserID(source.key));
+            MYTRACE_COND(DEBUG_AUDIOMUXER && !source.has_progress,
+                         ACE_TEXT("User #%d has submitted no audio to AudioMuxer. No sample no available\n"), GetUserID(source.key));
             return false;
         }
-        ii++;
+        anyactive = true;
     }
 
-    return !m_usermux_queue.empty();
+    return anyactive;
 }
 
 void AudioMuxer::RemoveEmptyMuxUsers()
 {
     // get rid of users who haven't supplied data in time for
     // flush
-    for (auto i = m_usermux_queue.begin();i != m_usermux_queue.end();++i)
+    int const count = m_sources_count;
+    for (int i=0;i<count;i++)
     {
-        if (i->second->is_empty())
+        MuxSource& source = *m_sources[i];
+        if (!source.active)
+            continue;
+
+        if (source.ring.Front() == nullptr)
         {
-            MYTRACE_COND(DEBUG_AUDIOMUXER, ACE_TEXT("AudioMuxer removed empty audio queue for #%d\n"), GetUserID(i->first));
-            SubmitMuxAudioFrame(i->first, media::AudioFrame());
+            MYTRACE_COND(DEBUG_AUDIOMUXER, ACE_TEXT("AudioMuxer removed empty audio queue for #%d\n"), GetUserID(source.key));
+            DeactivateSource(source);
         }
         else
         {
             MYTRACE_COND(DEBUG_AUDIOMUXER, ACE_TEXT("AudioMuxer still has audio queue for #%d. Items: %d\n"),
-                    GetUserID(i->first), int(i->second->message_count()));
+                    GetUserID(source.key), int(source.ring.Size()));
+        }
+    }
+}
+
+void AudioMuxer::DeactivateSource(MuxSource& source)
+{
+    source.active = false;
+    source.has_progress = false;
+    source.waiting = false;
+}
+
+bool AudioMuxer::IsIdleSource(MuxSource& source)
+{
+    return !source.active && !source.waiting && source.ring.Front() == nullptr;
+}
+
+void AudioMuxer::RemoveIdleSources()
+{
+    int count = m_sources_count;
+    bool const anyidle = std::any_of(m_sources.begin(), m_sources.begin() + count,
+                                     [](const std::unique_ptr<MuxSource>& s) { return IsIdleSource(*s); });
+    if (!anyidle)
+        return;
+
+    // producers cannot touch a source while the lock is exclusive and
+    // this is the mux thread so no one else is reading 'm_sources'
+    std::unique_lock<std::shared_mutex> const g(m_sources_lock);
+    count = m_sources_count;
+    for (int i=0;i<count;)
+    {
+        MuxSource& source = *m_sources[i];
+        int const userid = GetUserID(source.key);
+        teamtalk::StreamType const st = GetStreamType(source.key);
+        if (!IsIdleSource(source) || !m_preprocess_queue.IsEmpty(userid, st))
+        {
+            ++i;
+            continue;
         }
+
+        MYTRACE_COND(DEBUG_AUDIOMUXER, ACE_TEXT("Removed audio source #%d, streamtype: 0x%x\n"),
+                     userid, st);
+        m_preprocess_queue.RemoveAudioSource(userid, st);
+        // swap with last so the first 'm_sources_count' stay in use
+        m_sources[i] = std::move(m_sources[count - 1]);
+        m_sources[count - 1].reset();
+        --count;
     }
+    m_sources_count = count;
 }
 
 teamtalk::StreamTypes AudioMuxer::MuxUserAudio()
 {
-    TTASSERT(!m_usermux_queue.empty());
     TTASSERT(!m_muxed_buffer.empty());
+    TTASSERT(int(m_muxed_buffer.size()) == m_inputformat.GetTotalSamples());
 
     const int SAMPLES = m_inputformat.samples;
     StreamTypes sts = STREAMTYPE_NONE;
-    std::vector<ACE_Message_Block*> audio_blocks;
-    auto ii = m_usermux_queue.begin();
-    while(ii != m_usermux_queue.end())
+    int muxed = 0;
+    int const count = m_sources_count;
+    for (int i=0;i<count;i++)
     {
-        ACE_Message_Block* mb = nullptr;
-        ACE_Time_Value tm;
-        if (ii->second->dequeue(mb, &tm) >= 0)
+        MuxSource& source = *m_sources[i];
+        if (!source.active)
+            continue;
+
+        MuxSlot* slot = source.ring.Front();
+        if (slot == nullptr)
         {
-            media::AudioFrame frm(mb);
+            //Something is wrong. There should be data for all users otherwise
+            //CanMuxUserAudio() should have returned false.
+            TTASSERT(0);
+            DeactivateSource(source);
+            continue;
+        }
 
-            //ensure it's the AudioMuxBlock we're expecting
-            auto const ui = m_usermux_progress.find(ii->first);
-            if(ui != m_usermux_progress.end() && frm.input_samples > 0)
-            {
-                MYTRACE_COND(frm.sample_no != ui->second + SAMPLES,
-                             ACE_TEXT("Unexpected sample no for #%d streamtype %u. Found sample index %u. Should be %u\n"),
-                             GetUserID(ii->first), GetStreamType(ii->first), frm.sample_no, ui->second + SAMPLES);
-
-                if (frm.sample_no != ui->second + SAMPLES)
-                {
-                    // Sample index is out of sync. Mark stream as ended so
-                    // muxer can start over.
-                    frm = media::AudioFrame();
-                }
-            }
+        bool ended = slot->samples == 0;
 
-            MYTRACE_COND(DEBUG_AUDIOMUXER && ui != m_usermux_progress.end(),
-                         ACE_TEXT("Processing/muxing #%d streamtype 0x%x sampleindex: %u\n"),
-                         GetUserID(ii->first), GetStreamType(ii->first), frm.sample_no);
+        //ensure it's the frame we're expecting
+        if (!ended && source.has_progress)
+        {
+            MYTRACE_COND(slot->sample_no != source.progress + SAMPLES,
+                         ACE_TEXT("Unexpected sample no for #%d streamtype %u. Found sample index %u. Should be %u\n"),
+                         GetUserID(source.key), GetStreamType(source.key), slot->sample_no, source.progress + SAMPLES);
 
-            if (frm.input_samples == 0)
-            {
-                MYTRACE_COND(DEBUG_AUDIOMUXER, ACE_TEXT("Clearing #%d streamtype 0x%x, sampleindex %u\n"),
-                             GetUserID(ii->first), GetStreamType(ii->first), frm.sample_no);
+            // Sample index is out of sync. Mark stream as ended so
+            // muxer can start over.
+            ended = slot->sample_no != source.progress + SAMPLES;
+        }
 
-                // remove expected sample-offset for next run
-                m_usermux_progress.erase(ii->first);
+        if (ended)
+        {
+            MYTRACE_COND(DEBUG_AUDIOMUXER, ACE_TEXT("Clearing #%d streamtype 0x%x, sampleindex %u\n"),
+                         GetUserID(source.key), GetStreamType(source.key), slot->sample_no);
 
-                //stream ended from user
-                if (m_usermux_queue[ii->first]->is_empty())
-                    m_usermux_queue.erase(ii++);
+            // remove expected sample-offset for next run
+            source.has_progress = false;
+            source.ring.Pop();
 
-                mb->release();
-            }
-            else
-            {
-                MYTRACE_COND(DEBUG_AUDIOMUXER, ACE_TEXT("Adding #%d streamtype 0x%x, sampleindex %u\n"),
-                             GetUserID(ii->first), GetStreamType(ii->first), frm.sample_no);
-                m_usermux_progress[ii->first] = frm.sample_no;
-                audio_blocks.push_back(mb);
-                // 'userdata' contains StreamType. May be STREAMTYPE_NONE if silence frame was
-                // submitted (e.g. after stopped-talking)
-                sts |= frm.userdata;
-                ++ii;
-            }
+            //stream ended from user
+            if (source.ring.Front() == nullptr)
+                DeactivateSource(source);
+            continue;
         }
+
+        MYTRACE_COND(DEBUG_AUDIOMUXER, ACE_TEXT("Adding #%d streamtype 0x%x, sampleindex %u\n"),
+                     GetUserID(source.key), GetStreamType(source.key), slot->sample_no);
+        source.has_progress = true;
+        source.progress = slot->sample_no;
+
+        //this is where we mux if there's more than one user
+        if (muxed == 0)
+            std::memcpy(m_muxed_buffer.data(), slot->buffer.data(), m_muxed_buffer.size() * sizeof(short));
         else
-        {
-            //Something is wrong. There should be data for all users otherwise
-            //CanMuxUserAudio() should have returned false.
-            TTASSERT(0);
-            m_usermux_queue.clear();
-            m_usermux_progress.clear();
-            for(auto & audio_block : audio_blocks)
-                audio_block->release();
-            return STREAMTYPE_NONE;
-        }
-    }
+            AudioMix(m_muxed_buffer.data(), slot->buffer.data(), int(m_muxed_buffer.size()));
+        ++muxed;
 
-    TTASSERT(int(m_muxed_buffer.size()) == m_inputformat.GetTotalSamples());
+        // 'sts' contains StreamType. May be STREAMTYPE_NONE if silence frame was
+        // submitted (e.g. after stopped-talking)
+        sts |= slot->sts;
+        source.ring.Pop();
+    }
 
-    if(audio_blocks.empty())
+    if (muxed == 0)
     {
         short const zero = 0;
         m_muxed_buffer.assign(m_muxed_buffer.size(), zero);
     }
-    else
-    {
-        media::AudioFrame frm(audio_blocks[0]);
-        frm.ApplyGain();
-        TTASSERT(frm.input_samples);
-        TTASSERT(frm.input_samples == m_inputformat.samples);
-        TTASSERT(frm.inputfmt == m_inputformat.fmt);
-        TTASSERT(int(m_muxed_buffer.size()) == m_inputformat.GetTotalSamples());
-        m_muxed_buffer.assign(frm.input_buffer, frm.input_buffer + m_muxed_buffer.size());
-
-        //this is where we mux if there's more than one user
-        if(audio_blocks.size()>1)
-        {
-            for(size_t a=1;a<audio_blocks.size();a++)
-            {
-                media::AudioFrame mfrm(audio_blocks[a]);
-                mfrm.ApplyGain();
-                TTASSERT(mfrm.input_buffer);
-                TTASSERT(mfrm.input_samples == m_inputformat.samples);
-                for(size_t i=0;i<m_muxed_buffer.size();i++)
-                {
-                    int const val = int(m_muxed_buffer[i]) + mfrm.input_buffer[i];
-                    if(val > 32767)
-                        m_muxed_buffer[i] = 32767;
-                    else if(val < -32768)
-                        m_muxed_buffer[i] = -32768;
-                    else
-                        m_muxed_buffer[i] = val;
-                }
-            }
-        }
-
-        for(auto & audio_block : audio_blocks)
-            audio_block->release();
-    }
 
     return sts;
 }
@@ -823,13 +884,36 @@ void AudioMuxer::WriteAudio(int cb_samples, teamtalk::StreamTypes sts)
         m_muxcallback(m_streamtypes, frame);
     }
 
+    if (m_encodepool && FileActive())
+    {
+        std::lock_guard<std::mutex> const g(m_mutex3_encode);
+        size_t const n = size_t(cb_samples) * m_inputformat.fmt.channels;
+        m_encode_batch.insert(m_encode_batch.end(), m_muxed_buffer.begin(), m_muxed_buffer.begin() + n);
+
+        int const batch_samples = int(m_encode_batch.size()) / m_inputformat.fmt.channels;
+        if (PCM16_SAMPLES_DURATION(batch_samples, m_inputformat.fmt.samplerate) >= ENCODE_BATCH_MSEC)
+            SubmitEncodeBatch();
+    }
+    else
+    {
+        EncodeAudio(m_muxed_buffer.data(), cb_samples);
+    }
+
+    m_sample_no += cb_samples;
+}
+
+void AudioMuxer::EncodeAudio(const short* buffer, int samples)
+{
+    size_t const cbsize = m_inputformat.GetTotalSamples();
+    ACE_UNUSED_ARG(cbsize);
+
 #if defined(ENABLE_SPEEXFILE)
     if(m_speexfile && (m_inputformat.samples != 0))
     {
         int ret = 0;
-        for(int i=0;i<cb_samples / m_inputformat.samples && ret >= 0;i++)
+        for(int i=0;i<samples / m_inputformat.samples && ret >= 0;i++)
         {
-            ret = m_speexfile->Encode(&m_muxed_buffer[size_t(i) * m_inputformat.GetTotalSamples()]);
+            ret = m_speexfile->Encode(&buffer[i * cbsize]);
         }
     }
 #endif
@@ -838,26 +922,58 @@ void AudioMuxer::WriteAudio(int cb_samples, teamtalk::StreamTypes sts)
     if(m_opusfile && (m_inputformat.samples != 0))
     {
         int ret = 0;
-        for(int i=0;i<cb_samples/m_inputformat.samples && ret >= 0;i++)
-            ret = m_opusfile->Encode(&m_muxed_buffer[ size_t(i) * m_inputformat.GetTotalSamples()], m_inputformat.samples, false);
+        for(int i=0;i<samples/m_inputformat.samples && ret >= 0;i++)
+            ret = m_opusfile->Encode(&buffer[i * cbsize], m_inputformat.samples, false);
     }
 #endif
 
 #if defined(ENABLE_MEDIAFOUNDATION)
     if(m_mp3encoder && m_inputformat.samples)
     {
+        media::AudioFrame frame(m_inputformat.fmt, const_cast<short*>(buffer), samples);
         m_mp3encoder->ProcessAudioEncoder(frame, true);
     }
 #endif
 
     if(m_wavefile)
-        m_wavefile->AppendSamples(m_muxed_buffer.data(), cb_samples);
+        m_wavefile->AppendSamples(buffer, samples);
+}
 
-    m_sample_no += cb_samples;
+void AudioMuxer::SubmitEncodeBatch()
+{
+    if (m_encode_batch.empty())
+        return;
+
+    int const samples = int(m_encode_batch.size()) / m_inputformat.fmt.channels;
+    size_t const bytes = m_encode_batch.size() * sizeof(short);
+    auto batch = std::make_shared< std::vector<short> >(std::move(m_encode_batch));
+    m_encode_batch.clear();
+    m_encode_batch.reserve(batch->size());
+
+    m_encodepool->Submit(m_encode_strand, [this, batch, samples]()
+    {
+        EncodeAudio(batch->data(), samples);
+    }, bytes);
 }
 
-ChannelAudioMuxer::ChannelAudioMuxer()
-= default;
+void AudioMuxer::DrainEncoder()
+{
+    if (!m_encodepool)
+        return;
+
+    {
+        std::lock_guard<std::mutex> const g(m_mutex3_encode);
+        SubmitEncodeBatch();
+    }
+    m_encodepool->Drain(m_encode_strand);
+}
+
+ChannelAudioMuxer::ChannelAudioMuxer(teamtalk::EncodePool* encodepool/* = nullptr*/,
+                                     teamtalk::ReactorPool* timers/* = nullptr*/)
+: m_encodepool(encodepool)
+, m_timerpool(timers)
+{
+}
 
 ChannelAudioMuxer::~ChannelAudioMuxer()
 {
@@ -874,7 +990,7 @@ bool ChannelAudioMuxer::SaveFile(int channelid, const teamtalk::AudioCodec& code
     if (m_muxers.contains(channelid))
         return false;
 
-    audiomuxer_t const muxer(new AudioMuxer(sts));
+    audiomuxer_t const muxer(new AudioMuxer(sts, m_encodepool, m_timerpool));
     bool const ret = muxer->SaveFile(codec, filename, aff);
     if (!ret)
         return false;
@@ -25,6 +25,8 @@
 #define AUDIOMUXER_H
 
 #include "AudioContainer.h"
+#include "EncodePool.h"
+#include "ReactorPool.h"
 
 #include "codec/MediaUtil.h"
 #include "codec/WaveFile.h"
@@ -49,16 +51,17 @@
 #endif /* ENABLE_OGG */
 
 #include <ace/Message_Block.h>
-#include <ace/Message_Queue_T.h>
 #include <ace/Reactor.h>
 #include <ace/SString.h>
 #include <ace/Time_Value.h>
 
+#include <atomic>
 #include <cstdint>
 #include <functional>
 #include <map>
 #include <memory>
 #include <mutex>
+#include <shared_mutex>
 #include <thread>
 #include <vector>
 
@@ -69,7 +72,11 @@ using audiomuxer_tick_t = std::function< void (teamtalk::StreamTypes sts, uint32
 class AudioMuxer : private TimerListener, NonCopyable
 {
 public:
-    AudioMuxer(teamtalk::StreamTypes sts);
+    // 'encodepool' encodes the file (if any). Otherwise the file is
+    // written by the mux thread. 'timers' runs the muxing instead of
+    // a thread of its own
+    AudioMuxer(teamtalk::StreamTypes sts, teamtalk::EncodePool* encodepool = nullptr,
+               teamtalk::ReactorPool* timers = nullptr);
     ~AudioMuxer() override;
 
     bool RegisterMuxCallback(const media::AudioInputFormat& fmt,
@@ -95,39 +102,89 @@ private:
     void Run();
     int TimerEvent(ACE_UINT32 timer_event_id, long userdata) override;
 
+    // Mux ready audio frame from a source
+    struct MuxSlot
+    {
+        std::vector<short> buffer;
+        // zero if the stream ended
+        int samples = 0;
+        uint32_t sample_no = 0;
+        teamtalk::StreamTypes sts = teamtalk::STREAMTYPE_NONE;
+    };
+
+    // Audio from a user ID and StreamType. QueueUserAudio() fills
+    // 'ring' and the mux thread empties it.
+    struct MuxSource : NonCopyable
+    {
+        uint32_t key = 0;
+        SPSCRing<MuxSlot> ring;
+
+        // producer side
+        std::mutex producer_lock;
+        // audio which is not yet a full mux frame
+        ACE_Message_Block* remainder = nullptr;
+        // audio has been queued so muxer must wait for it
+        std::atomic<bool> waiting{false};
+        // 'ring' was full so frames, possibly the end of the stream,
+        // were dropped
+        std::atomic<bool> overflow{false};
+
+        // mux thread side
+        bool active = false;
+        // sample no of previous frame muxed
+        bool has_progress = false;
+        uint32_t progress = 0;
+
+        ~MuxSource();
+    };
+
     void ProcessAudioQueues(bool flush);
     bool CanMuxUserAudio();
     void RemoveEmptyMuxUsers(); // should only be used during flush
+    void DeactivateSource(MuxSource& source);
+    // mux thread side. Has no pending audio
+    static bool IsIdleSource(MuxSource& source);
+    // free sources which are no longer muxed, e.g. user left
+    void RemoveIdleSources();
     teamtalk::StreamTypes MuxUserAudio();
     void WriteAudio(int cb_samples, teamtalk::StreamTypes sts);
+    void EncodeAudio(const short* buffer, int samples);
+    // submit 'm_encode_batch' to 'm_encodepool'
+    void SubmitEncodeBatch();
+    // wait for 'm_encodepool' to finish encoding
+    void DrainEncoder();
     bool FileActive();
 
-    using message_queue_t = std::shared_ptr< ACE_Message_Queue<ACE_MT_SYNCH> >;
-    message_queue_t GetMuxQueue(int key);
-    // return number of media::AudioFrame in queue
-    int SubmitMuxAudioFrame(int key, const media::AudioFrame& frm);
-    // drain everything in 'm_preprocess_queue'
-    void SubmitPreprocessQueue();
+    // caller must hold 'm_sources_lock'
+    MuxSource* FindMuxSource(uint32_t key);
+    MuxSource* AddMuxSource(uint32_t key);
+    // move mux ready frames from 'm_preprocess_queue' into 'source.ring'
+    void SubmitPreprocessQueue(MuxSource& source);
+    bool SubmitMuxAudioFrame(MuxSource& source, const media::AudioFrame& frm);
     ACE_Message_Block* BuildMuxAudioFrame(std::vector<ACE_Message_Block*>& mbs) const;
 
-    // preprocess queue (audio that cannot yet to into 'm_usermux_queue')
+    // preprocess queue (audio that is not yet a mux frame)
     AudioContainer m_preprocess_queue;
-    std::recursive_mutex m_mutex1_preprocess;
-    // key -> media::AudioFrame. Audio block storing the remainder of 'm_preprocess_queue'
-    std::map<int, ACE_Message_Block*> m_preprocess_block;
-
-    // raw audio data from a user ID
-    using user_audio_queue_t = std::map<int, message_queue_t>;
-    user_audio_queue_t m_usermux_queue;
-    // next sample number to expect for muxing from a user ID
-    using user_muxprogress_t = std::map<int, uint32_t>;
-    user_muxprogress_t m_usermux_progress;
+
+    // Sources are only added while the mux thread is running and
+    // only removed by the mux thread so it can read the first
+    // 'm_sources_count' without locking
+    std::vector< std::unique_ptr<MuxSource> > m_sources;
+    std::atomic<int> m_sources_count{0};
+    // shared by QueueUserAudio(). Exclusive when adding or clearing
+    // sources
+    std::shared_mutex m_sources_lock;
+    bool m_accept_audio = false;
     std::vector<short> m_muxed_buffer;
 
     ACE_Reactor m_reactor;
     ACE_Time_Value m_mux_interval;
-    std::recursive_mutex m_mutex2_mux;
     std::shared_ptr< std::thread > m_thread;
+    // mux timer on shared reactor instead of 'm_thread'
+    teamtalk::ReactorPool* m_timerpool = nullptr;
+    ACE_Reactor* m_timer_reactor = nullptr;
+    std::unique_ptr<TimerHandler> m_timerhandler;
+    long m_timerid = -1;
 
     uint32_t m_sample_no = 0;
     uint32_t m_last_flush_time = 0;
@@ -147,6 +204,12 @@ private:
     opusencfile_t m_opusfile;
 #endif
 
+    teamtalk::EncodePool* m_encodepool = nullptr;
+    int m_encode_strand = 0;
+    // muxed audio not yet submitted to 'm_encodepool'
+    std::vector<short> m_encode_batch;
+    std::mutex m_mutex3_encode;
+
     audiomuxer_callback_t m_muxcallback;
     audiomuxer_tick_t m_tickcallback;
 };
@@ -163,9 +226,12 @@ class ChannelAudioMuxer
     std::map<int, audiomuxer_t> m_muxers;
 
     std::recursive_mutex m_mutex;
+    teamtalk::EncodePool* m_encodepool = nullptr;
+    teamtalk::ReactorPool* m_timerpool = nullptr;
 
 public:
-    ChannelAudioMuxer();
+    ChannelAudioMuxer(teamtalk::EncodePool* encodepool = nullptr,
+                      teamtalk::ReactorPool* timers = nullptr);
     ~ChannelAudioMuxer();
 
     bool SaveFile(int channelid, const teamtalk::AudioCodec& codec,
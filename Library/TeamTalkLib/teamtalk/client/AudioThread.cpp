@@ -34,7 +34,9 @@
 #include <api/environment/environment_factory.h>
 #endif
 
+#include <algorithm>
 #include <cassert>
+#include <chrono>
 #include <cstddef>
 #include <cstdlib>
 #include <cstring>
@@ -66,6 +68,9 @@ bool AudioThread::StartEncoder(const audioencodercallback_t& callback,
     int const sample_rate = GetAudioCodecSampleRate(codec);
     int const channels = GetAudioCodecChannels(codec);
 
+    m_packetloss_pct = 0;
+    m_bitrate_pct = 100;
+
     switch(codec.codec)
     {
     case CODEC_NO_CODEC :
@@ -126,6 +131,8 @@ bool AudioThread::StartEncoder(const audioencodercallback_t& callback,
         TTASSERT(channels);
 
         m_opus = std::make_unique<OpusEncode>();
+        m_opus_packetloss = 0;
+        m_opus_bitrate_pct = 100;
         if(!m_opus->Open(codec.opus.samplerate, codec.opus.channels,
                          codec.opus.application) ||
            !m_opus->SetComplexity(codec.opus.complexity) ||
@@ -138,6 +145,11 @@ bool AudioThread::StartEncoder(const audioencodercallback_t& callback,
             StopEncoder();
             return false;
         }
+#if defined(OPUS_SET_DRED_DURATION_REQUEST)
+        // optional since libopus may be built without DRED
+        if (codec.opus.fec)
+            m_opus->SetDRED(OPUS_DRED_MSEC);
+#endif
     }
     break;
 #else
@@ -163,6 +175,12 @@ bool AudioThread::StartEncoder(const audioencodercallback_t& callback,
     this->msg_queue()->high_water_mark(max_queue);
     this->msg_queue()->low_water_mark(max_queue);
 
+    {
+        std::unique_lock<std::recursive_mutex> const g(m_preprocess_lock);
+        UpdateStages();
+    }
+    ResetStageStats();
+
     if(spawn_thread && this->activate() < 0)
     {
         StopEncoder();
@@ -214,10 +232,22 @@ void AudioThread::StopEncoder()
 
     m_echobuf.clear();
 
+    if (m_stage_timing)
+    {
+        auto const stats = GetStageStats();
+        const auto& frame = stats[CAPTURESTAGE_FRAME];
+        MYTRACE_COND(frame.frames > 0, ACE_TEXT("Capture path %u frames, avg %u usec, max %u usec\n"),
+                     unsigned(frame.frames), unsigned(frame.total_nsec / std::max(frame.frames, uint64_t(1)) / 1000),
+                     unsigned(frame.max_nsec / 1000));
+    }
+
     m_callback = {};
 
     memset(&m_codec, 0, sizeof(m_codec));
     m_codec.codec = teamtalk::CODEC_NO_CODEC;
+
+    std::unique_lock<std::recursive_mutex> const g(m_preprocess_lock);
+    UpdateStages();
 }
 
 int AudioThread::close(u_long /*flags*/)
@@ -228,9 +258,15 @@ int AudioThread::close(u_long /*flags*/)
 
 bool AudioThread::UpdatePreprocessor(const teamtalk::AudioPreprocessor& preprocess)
 {
-    //set AGC
     std::unique_lock<std::recursive_mutex> const g(m_preprocess_lock);
 
+    bool const ret = SetupPreprocessor(preprocess);
+    UpdateStages();
+    return ret;
+}
+
+bool AudioThread::SetupPreprocessor(const teamtalk::AudioPreprocessor& preprocess)
+{
     if (preprocess.preprocessor != AUDIOPREPROCESSOR_TEAMTALK)
         MuteSound(false, false);
 
@@ -411,6 +447,40 @@ void AudioThread::MuteSound(bool leftchannel, bool rightchannel)
     m_stereo = ToStereoMask(leftchannel, rightchannel);
 }
 
+void AudioThread::UpdateStages()
+{
+    m_stages_count = 0;
+    m_stages[m_stages_count++] = CAPTURESTAGE_TONE;
+    m_stages[m_stages_count++] = CAPTURESTAGE_GAIN;
+#if defined(ENABLE_SPEEXDSP)
+    //don't include dereverb since it's not user configurable
+    if (m_preprocess_left && (m_preprocess_left->IsEchoCancel() ||
+                              m_preprocess_left->IsDenoising() ||
+                              m_preprocess_left->IsAGC()))
+        m_stages[m_stages_count++] = CAPTURESTAGE_SPEEXDSP;
+#endif
+#if defined(ENABLE_WEBRTC)
+    if (m_apm)
+        m_stages[m_stages_count++] = CAPTURESTAGE_WEBRTC;
+#endif
+    m_stages[m_stages_count++] = CAPTURESTAGE_VOICELEVEL;
+    if (GetAudioCodecChannels(m_codec) == 2 && m_stereo != STEREO_BOTH)
+        m_stages[m_stages_count++] = CAPTURESTAGE_STEREOMASK;
+    TTASSERT(m_stages_count <= int(m_stages.size()));
+}
+
+capturestats_t AudioThread::GetStageStats()
+{
+    std::lock_guard<std::mutex> const g(m_stats_lock);
+    return m_stage_stats;
+}
+
+void AudioThread::ResetStageStats()
+{
+    std::lock_guard<std::mutex> const g(m_stats_lock);
+    m_stage_stats = {};
+}
+
 void AudioThread::QueueAudio(const media::AudioFrame& audframe)
 {
     TTASSERT(m_codec.codec != CODEC_NO_CODEC);
@@ -475,35 +545,102 @@ int AudioThread::svc()
 
 void AudioThread::ProcessAudioFrame(media::AudioFrame& audblock)
 {
-    if(m_tone_frequency != 0u)
-         m_tone_sample_index = GenerateTone(audblock, m_tone_sample_index, m_tone_frequency);
-
-    SOFTGAIN(audblock.input_buffer, audblock.input_samples,
-             audblock.inputfmt.channels, m_gainlevel, GAIN_NORMAL);
+    using clock = std::chrono::steady_clock;
 
-#if defined(ENABLE_SPEEXDSP)
-    PreprocessSpeex(audblock);
-#endif
+    bool const timing = m_stage_timing;
+    // nanoseconds per stage, -1 if stage didn't run
+    std::array<int64_t, CAPTURESTAGE_COUNT> elapsed;
+    clock::time_point framestart, start;
+    if (timing)
+    {
+        elapsed.fill(-1);
+        framestart = clock::now();
+    }
 
-#if defined(ENABLE_WEBRTC)
-    if (m_gainlevel > 0)
     {
-        // WebRTC preprocessing (especially AEC) is very CPU-intensive
-        // Only do it if the input is not muted.
-        // This allows client apps that use PTT to close the MIC input when there's
-        // no PTT and thus prevent the processing hit.
-        // AEC still functions fine if it's activated like this, although there's
-        // minute echo fragment at the (re)start of the preprocessing
-        PreprocessWebRTC(audblock);
+        std::unique_lock<std::recursive_mutex> const g(m_preprocess_lock);
+        for (int i=0;i<m_stages_count;i++)
+        {
+            if (timing)
+                start = clock::now();
+            RunStage(m_stages[i], audblock);
+            if (timing)
+                elapsed[m_stages[i]] = std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - start).count();
+        }
     }
-#endif
 
-    MeasureVoiceLevel(audblock);
+    if (timing)
+        start = clock::now();
+    EncodeAudioFrame(audblock);
 
-    // mute left or right speaker (if enabled)
-    if(audblock.inputfmt.channels == 2)
-        SelectStereo(m_stereo, audblock.input_buffer, audblock.input_samples);
+    if (timing)
+    {
+        auto const end = clock::now();
+        elapsed[CAPTURESTAGE_ENCODE] = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+        elapsed[CAPTURESTAGE_FRAME] = std::chrono::duration_cast<std::chrono::nanoseconds>(end - framestart).count();
 
+        std::lock_guard<std::mutex> const g(m_stats_lock);
+        for (size_t i=0;i<elapsed.size();i++)
+        {
+            if (elapsed[i] < 0)
+                continue;
+            auto& stats = m_stage_stats[i];
+            stats.frames++;
+            stats.total_nsec += elapsed[i];
+            stats.max_nsec = std::max(stats.max_nsec, uint64_t(elapsed[i]));
+        }
+    }
+}
+
+void AudioThread::RunStage(CaptureStage stage, media::AudioFrame& audblock)
+{
+    switch (stage)
+    {
+    case CAPTURESTAGE_TONE :
+        if(m_tone_frequency != 0u)
+            m_tone_sample_index = GenerateTone(audblock, m_tone_sample_index, m_tone_frequency);
+        break;
+    case CAPTURESTAGE_GAIN :
+        SOFTGAIN(audblock.input_buffer, audblock.input_samples,
+                 audblock.inputfmt.channels, m_gainlevel, GAIN_NORMAL);
+        break;
+    case CAPTURESTAGE_SPEEXDSP :
+#if defined(ENABLE_SPEEXDSP)
+        PreprocessSpeex(audblock);
+#endif
+        break;
+    case CAPTURESTAGE_WEBRTC :
+#if defined(ENABLE_WEBRTC)
+        if (m_gainlevel > 0)
+        {
+            // WebRTC preprocessing (especially AEC) is very CPU-intensive
+            // Only do it if the input is not muted.
+            // This allows client apps that use PTT to close the MIC input when there's
+            // no PTT and thus prevent the processing hit.
+            // AEC still functions fine if it's activated like this, although there's
+            // minute echo fragment at the (re)start of the preprocessing
+            PreprocessWebRTC(audblock);
+        }
+#endif
+        break;
+    case CAPTURESTAGE_VOICELEVEL :
+        MeasureVoiceLevel(audblock);
+        break;
+    case CAPTURESTAGE_STEREOMASK :
+        // mute left or right speaker (if enabled)
+        if(audblock.inputfmt.channels == 2)
+            SelectStereo(m_stereo, audblock.input_buffer, audblock.input_samples);
+        break;
+    case CAPTURESTAGE_ENCODE :
+    case CAPTURESTAGE_FRAME :
+    case CAPTURESTAGE_COUNT :
+        TTASSERT(0);
+        break;
+    }
+}
+
+void AudioThread::EncodeAudioFrame(media::AudioFrame& audblock)
+{
     if ((IsVoiceActive() && audblock.voiceact_enc) || audblock.force_enc)
     {
         //encode
@@ -524,6 +661,7 @@ void AudioThread::ProcessAudioFrame(media::AudioFrame& audblock)
             break;
         case CODEC_NO_CODEC :
         case CODEC_WEBM_VP8 :
+        case CODEC_WEBM_VP9 :
             break;
         }
         if(enc_data != nullptr)
@@ -605,22 +743,11 @@ void AudioThread::MeasureVoiceLevel(const media::AudioFrame& audblock)
 #if defined(ENABLE_SPEEXDSP)
 void AudioThread::PreprocessSpeex(media::AudioFrame& audblock)
 {
-    std::unique_lock<std::recursive_mutex> const g(m_preprocess_lock);
-
-    bool preprocess = false;
-
+    // stage is only enabled if echo cancel, denoise or AGC is active
+    TTASSERT(m_preprocess_left);
     if (!m_preprocess_left)
         return;
 
-    preprocess |= m_preprocess_left->IsEchoCancel();
-    preprocess |= m_preprocess_left->IsDenoising();
-    //don't include dereverb since it's not user configurable
-//    preprocess |= m_preprocess_left->IsDereverbing();
-    preprocess |= m_preprocess_left->IsAGC();
-
-    if(!preprocess)
-        return;
-
     if(audblock.inputfmt.channels == 1)
     {
         if (m_preprocess_left->IsEchoCancel() &&
@@ -639,34 +766,32 @@ void AudioThread::PreprocessSpeex(media::AudioFrame& audblock)
     else if(audblock.inputfmt.channels == 2)
     {
         assert(m_preprocess_right);
-        std::vector<short> in_leftchan(audblock.input_samples);
-        std::vector<short> in_rightchan(audblock.input_samples);
-        SplitStereo(audblock.input_buffer, audblock.input_samples, in_leftchan, in_rightchan);
+        // SpeexDSP only processes mono so deinterleave into buffers
+        // which are kept between frames
+        SplitStereo(audblock.input_buffer, audblock.input_samples, m_in_left, m_in_right);
 
         if(m_preprocess_left->IsEchoCancel() && m_preprocess_right->IsEchoCancel() &&
            audblock.outputfmt.channels == 2 && (audblock.output_buffer != nullptr))
         {
             assert(audblock.input_samples == audblock.output_samples);
 
-            std::vector<short> out_leftchan(audblock.output_samples);
-            std::vector<short> out_rightchan(audblock.output_samples);
-            std::vector<short> echobuf_left(audblock.output_samples);
-            std::vector<short> echobuf_right(audblock.output_samples);
+            m_echo_left.resize(audblock.output_samples);
+            m_echo_right.resize(audblock.output_samples);
             SplitStereo(audblock.output_buffer, audblock.output_samples,
-                        out_leftchan, out_rightchan);
-
-            m_preprocess_left->EchoCancel(in_leftchan.data(), out_leftchan.data(),
-                                         echobuf_left.data());
-            in_leftchan.swap(echobuf_left);
-            m_preprocess_right->EchoCancel(in_rightchan.data(), out_rightchan.data(),
-                                         echobuf_right.data());
-            in_rightchan.swap(echobuf_right);
+                        m_out_left, m_out_right);
+
+            m_preprocess_left->EchoCancel(m_in_left.data(), m_out_left.data(),
+                                          m_echo_left.data());
+            m_in_left.swap(m_echo_left);
+            m_preprocess_right->EchoCancel(m_in_right.data(), m_out_right.data(),
+                                           m_echo_right.data());
+            m_in_right.swap(m_echo_right);
         }
 
-        m_preprocess_left->Preprocess(in_leftchan.data()); //denoise, AGC, etc
-        m_preprocess_right->Preprocess(in_rightchan.data()); //denoise, AGC, etc
+        m_preprocess_left->Preprocess(m_in_left.data()); //denoise, AGC, etc
+        m_preprocess_right->Preprocess(m_in_right.data()); //denoise, AGC, etc
 
-        MergeStereo(in_leftchan, in_rightchan, audblock.input_buffer,
+        MergeStereo(m_in_left, m_in_right, audblock.input_buffer,
                     audblock.input_samples);
     }
 }
@@ -675,8 +800,6 @@ void AudioThread::PreprocessSpeex(media::AudioFrame& audblock)
 #if defined(ENABLE_WEBRTC)
 void AudioThread::PreprocessWebRTC(media::AudioFrame& audblock)
 {
-    std::unique_lock<std::recursive_mutex> const g(m_preprocess_lock);
-
     if (!m_apm)
         return;
 
@@ -746,6 +869,15 @@ const char* AudioThread::ProcessOPUS(const media::AudioFrame& audblock,
 
     enc_frm_size = int(m_encbuf.size()) / fpp;
 
+    int const packetloss = m_packetloss_pct;
+    if (packetloss != m_opus_packetloss && m_opus->SetPacketLoss(packetloss))
+        m_opus_packetloss = packetloss;
+
+    int const bitrate_pct = m_bitrate_pct;
+    if (bitrate_pct != m_opus_bitrate_pct &&
+        m_opus->SetBitrate(int(int64_t(m_codec.opus.bitrate) * bitrate_pct / 100)))
+        m_opus_bitrate_pct = bitrate_pct;
+
     while(n_processed < audblock.input_samples)
     {
         assert(nbBytes + enc_frm_size <= int(m_encbuf.size()));
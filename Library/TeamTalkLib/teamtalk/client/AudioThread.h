@@ -44,6 +44,9 @@
 #include <ace/Task_T.h>
 #include <ace/Time_Value.h>
 
+#include <array>
+#include <atomic>
+#include <cstdint>
 #include <functional>
 #include <memory>
 #include <mutex>
@@ -54,6 +57,31 @@ using audioencodercallback_t = std::function< void (const teamtalk::AudioCodec&
                              const std::vector<int>& enc_frame_sizes,
                              const media::AudioFrame& org_frame) >;
 
+// Stages of the capture path in the order they are applied to an
+// audio frame
+enum CaptureStage
+{
+    CAPTURESTAGE_TONE,
+    CAPTURESTAGE_GAIN,
+    CAPTURESTAGE_SPEEXDSP,
+    CAPTURESTAGE_WEBRTC,
+    CAPTURESTAGE_VOICELEVEL,
+    CAPTURESTAGE_STEREOMASK,
+    CAPTURESTAGE_ENCODE,
+    // all of the above for a frame
+    CAPTURESTAGE_FRAME,
+    CAPTURESTAGE_COUNT
+};
+
+struct CaptureStageStats
+{
+    uint64_t frames = 0;
+    uint64_t total_nsec = 0;
+    uint64_t max_nsec = 0;
+};
+
+using capturestats_t = std::array<CaptureStageStats, CAPTURESTAGE_COUNT>;
+
 class AudioThread : protected ACE_Task<ACE_MT_SYNCH>
 {
 public:
@@ -74,6 +102,18 @@ public:
 
     bool UpdatePreprocessor(const teamtalk::AudioPreprocessor& preprocess);
 
+    //packet loss in percent reported by receivers. Applied to encoder
+    //on next audio frame
+    void SetPacketLoss(int percent) { m_packetloss_pct = percent; }
+    //percent of codec's bitrate which receivers can sustain. Applied
+    //to encoder on next audio frame
+    void SetBitrateScale(int percent) { m_bitrate_pct = percent; }
+
+    // measure time spent in each capture stage
+    void EnableStageTiming(bool enable) { m_stage_timing = enable; }
+    capturestats_t GetStageStats();
+    void ResetStageStats();
+
     int m_voiceactlevel = VU_METER_MIN;
     ACE_Time_Value m_voiceact_delay = ACE_Time_Value(1, 500000);
 
@@ -92,6 +132,11 @@ private:
     int close(u_long /*flags*/) override;
     int svc() override;
     void ProcessAudioFrame(media::AudioFrame& audblock);
+    void RunStage(CaptureStage stage, media::AudioFrame& audblock);
+    void EncodeAudioFrame(media::AudioFrame& audblock);
+    bool SetupPreprocessor(const teamtalk::AudioPreprocessor& preprocess);
+    // rebuild 'm_stages' from the current preprocessor settings
+    void UpdateStages();
     void MeasureVoiceLevel(const media::AudioFrame& audblock);
 
     void MuteSound(bool leftchannel, bool rightchannel);
@@ -112,8 +157,17 @@ private:
 #endif
     audioencodercallback_t m_callback;
     std::recursive_mutex m_preprocess_lock;
+    // stages before encoding which are currently enabled
+    std::array<CaptureStage, CAPTURESTAGE_ENCODE> m_stages = {};
+    int m_stages_count = 0;
+    std::atomic<bool> m_stage_timing{false};
+    std::mutex m_stats_lock;
+    capturestats_t m_stage_stats;
 #if defined(ENABLE_SPEEXDSP)
     std::unique_ptr<SpeexPreprocess> m_preprocess_left, m_preprocess_right;
+    // deinterleaved stereo, reused between frames
+    std::vector<short> m_in_left, m_in_right, m_out_left, m_out_right;
+    std::vector<short> m_echo_left, m_echo_right;
 #endif
 #if defined(ENABLE_WEBRTC)
     webrtc::scoped_refptr<webrtc::AudioProcessing> m_apm;
@@ -124,7 +178,11 @@ private:
 #endif
 #if defined(ENABLE_OPUS)
     std::unique_ptr<OpusEncode> m_opus;
+    int m_opus_packetloss = 0;
+    int m_opus_bitrate_pct = 100;
 #endif
+    std::atomic<int> m_packetloss_pct{0};
+    std::atomic<int> m_bitrate_pct{100};
     std::vector<char> m_encbuf;
     std::vector<short> m_echobuf;
     teamtalk::AudioCodec m_codec;
@@ -0,0 +1,113 @@
+/*
+ * Copyright (c) 2005-2018, BearWare.dk
+ * 
+ * Contact Information:
+ *
+ * Bjoern D. Rasmussen
+ * Kirketoften 5
+ * DK-8260 Viby J
+ * Denmark
+ * Email: contact@bearware.dk
+ * Phone: +45 20 20 54 59
+ * Web: http://www.bearware.dk
+ *
+ * This source code is part of the TeamTalk SDK owned by
+ * BearWare.dk. Use of this file, or its compiled unit, requires a
+ * TeamTalk SDK License Key issued by BearWare.dk.
+ *
+ * The TeamTalk SDK License Agreement along with its Terms and
+ * Conditions are outlined in the file License.txt included with the
+ * TeamTalk SDK distribution.
+ *
+ */
+
+#include "BandwidthEstimator.h"
+
+#include "myace/MyACE.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+namespace teamtalk {
+
+void ArrivalMonitor::PacketReceived(uint32_t send_time, uint32_t recv_time)
+{
+    auto const transit = int32_t(recv_time - send_time);
+    if (m_started)
+    {
+        int const d = std::abs(transit - m_last_transit);
+        m_jitter16 += d - ((m_jitter16 + 8) >> 4);
+    }
+    m_started = true;
+    m_last_transit = transit;
+    m_transit_sum += transit;
+    m_transit_count++;
+}
+
+void ArrivalMonitor::Reset()
+{
+    *this = ArrivalMonitor();
+}
+
+int ArrivalMonitor::GetDelayGradientMSec()
+{
+    if (m_transit_count == 0)
+        return 0;
+
+    auto const average = int32_t(m_transit_sum / m_transit_count);
+    int const gradient = m_has_average ? average - m_last_average : 0;
+    m_has_average = true;
+    m_last_average = average;
+    m_transit_sum = m_transit_count = 0;
+    return gradient;
+}
+
+void BandwidthEstimator::ReportReceived(int userid, int loss_percent,
+                                        int delay_gradient_msec, uint32_t now)
+{
+    Receiver& r = m_receivers[userid];
+    r.loss_percent = loss_percent;
+    r.report_time = now;
+
+    // decrease is multiplicative and increase is slow so encoder
+    // backs off quickly when queues on the path build up
+    if (loss_percent > BWE_LOSS_HIGH_PERCENT)
+        r.bitrate_percent = r.bitrate_percent * (100 - (loss_percent / 2)) / 100;
+    else if (delay_gradient_msec > BWE_DELAY_OVERUSE_MSEC)
+        r.bitrate_percent = r.bitrate_percent * 85 / 100;
+    else if (loss_percent < BWE_LOSS_LOW_PERCENT && delay_gradient_msec >= -BWE_DELAY_OVERUSE_MSEC)
+        r.bitrate_percent = (r.bitrate_percent * 108 / 100) + 1;
+
+    r.bitrate_percent = std::clamp(r.bitrate_percent, int(BWE_BITRATE_MIN_PERCENT), 100);
+}
+
+int BandwidthEstimator::GetBitratePercent(uint32_t now)
+{
+    RemoveExpired(now);
+    int percent = 100;
+    for (const auto& r : m_receivers)
+        percent = std::min(percent, r.second.bitrate_percent);
+    return percent;
+}
+
+int BandwidthEstimator::GetLossPercent(uint32_t now)
+{
+    RemoveExpired(now);
+    int loss = 0;
+    for (const auto& r : m_receivers)
+        loss = std::max(loss, r.second.loss_percent);
+    return loss;
+}
+
+void BandwidthEstimator::RemoveExpired(uint32_t now)
+{
+    for (auto i = m_receivers.begin(); i != m_receivers.end();)
+    {
+        if (W32_GT(now, i->second.report_time + m_report_timeout))
+            i = m_receivers.erase(i);
+        else
+            ++i;
+    }
+}
+
+} // namespace teamtalk
@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) 2005-2018, BearWare.dk
+ * 
+ * Contact Information:
+ *
+ * Bjoern D. Rasmussen
+ * Kirketoften 5
+ * DK-8260 Viby J
+ * Denmark
+ * Email: contact@bearware.dk
+ * Phone: +45 20 20 54 59
+ * Web: http://www.bearware.dk
+ *
+ * This source code is part of the TeamTalk SDK owned by
+ * BearWare.dk. Use of this file, or its compiled unit, requires a
+ * TeamTalk SDK License Key issued by BearWare.dk.
+ *
+ * The TeamTalk SDK License Agreement along with its Terms and
+ * Conditions are outlined in the file License.txt included with the
+ * TeamTalk SDK distribution.
+ *
+ */
+
+#if !defined(BANDWIDTHESTIMATOR_H)
+#define BANDWIDTHESTIMATOR_H
+
+#include <cstdint>
+#include <map>
+
+namespace teamtalk {
+
+    // Measures arrival of a receiver's packets from a single sender
+    // so it can be included in receiver reports. Sender and receiver
+    // clocks are not synchronized but only differences in transit
+    // time are used.
+    class ArrivalMonitor
+    {
+    public:
+        void PacketReceived(uint32_t send_time, uint32_t recv_time);
+        void Reset();
+
+        //interarrival jitter as defined by RFC 3550
+        int GetJitterMSec() const { return m_jitter16 / 16; }
+        //change in average transit time since previous call
+        int GetDelayGradientMSec();
+
+    private:
+        bool m_started = false;
+        int32_t m_last_transit = 0;
+        //jitter in 1/16 msec
+        int m_jitter16 = 0;
+        int64_t m_transit_sum = 0;
+        int m_transit_count = 0;
+        bool m_has_average = false;
+        int32_t m_last_average = 0;
+    };
+
+    // loss above this decreases bitrate relative to the loss
+    constexpr auto BWE_LOSS_HIGH_PERCENT = 10;
+    // loss below this allows bitrate to increase
+    constexpr auto BWE_LOSS_LOW_PERCENT = 2;
+    // increase in queuing delay per report which means overuse
+    constexpr auto BWE_DELAY_OVERUSE_MSEC = 10;
+    constexpr auto BWE_BITRATE_MIN_PERCENT = 20;
+
+    // Sender side estimate of the bitrate each receiver can sustain
+    // based on its receiver reports. The encoder's bitrate is scaled
+    // to the receiver with the most congested path.
+    class BandwidthEstimator
+    {
+    public:
+        BandwidthEstimator(uint32_t report_timeout_msec)
+            : m_report_timeout(report_timeout_msec) {}
+
+        void ReportReceived(int userid, int loss_percent,
+                            int delay_gradient_msec, uint32_t now);
+        void Reset() { m_receivers.clear(); }
+
+        //percent of configured bitrate
+        int GetBitratePercent(uint32_t now);
+        //worst loss reported by a receiver
+        int GetLossPercent(uint32_t now);
+
+    private:
+        void RemoveExpired(uint32_t now);
+
+        struct Receiver
+        {
+            int loss_percent = 0;
+            int bitrate_percent = 100;
+            uint32_t report_time = 0;
+        };
+        std::map<int, Receiver> m_receivers;
+        uint32_t const m_report_timeout;
+    };
+} // namespace teamtalk
+
+#endif
@@ -55,6 +55,7 @@ namespace teamtalk {
         std::vector<ACE_INET_Addr> hostaddrs;
         ACE_INET_Addr udpaddr; // same as hostaddrs[0] but port number may be different
         ACE_TString accesstoken;
+        ACE_INT64 migratetoken = 0; // sent in hello after changing network
         ServerInfo() = default;
     };
 
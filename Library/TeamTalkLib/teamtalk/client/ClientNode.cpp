@@ -36,8 +36,10 @@
 #include <cstddef>
 #include <cstring>
 #include <ctime>
+#include <utility>
 
 #include <ace/OS.h>
+#include <ace/SOCK_CODgram.h>
 
 #if defined(ENABLE_ENCRYPTION)
 #include <openssl/rand.h>
@@ -68,8 +70,14 @@ constexpr auto LOCAL_MEDIAPLAYBACK_SESSIONID_MAX    = 16; // Max session id. Sho
 #error Packetloss in release mode
 #endif
 
-ClientNode::ClientNode(const ACE_TString& version, ClientListener* listener)
-                       : m_flags(CLIENT_CLOSED)
+ClientNode::ClientNode(const ACE_TString& version, ClientListener* listener,
+                       const ClientSharedPools& shared/* = ClientSharedPools()*/)
+                       : ClientNodeBase(shared.eventloops)
+                       , m_flags(CLIENT_CLOSED)
+                       , m_shared(shared)
+                       , m_encodepool(shared.encoders ? shared.encoders : std::make_shared<EncodePool>())
+                       , m_decodepool(shared.decoders ? shared.decoders : std::make_shared<AudioDecodePool>())
+                       , m_channelrecord(m_encodepool.get(), shared.timers.get())
                        , m_connector(GetEventLoop(), ACE_NONBLOCK)
 #if defined(ENABLE_ENCRYPTION)
                        , m_crypt_connector(GetEventLoop(), ACE_NONBLOCK)
@@ -109,9 +117,8 @@ ClientNode::~ClientNode()
 
     m_soundsystem->RemoveSoundGroup(m_soundprop.soundgroupid);
 
-#if defined(ENABLE_ENCRYPTION)
-    CryptStreamHandler::RemoveSSLContext(GetEventLoop());
-#endif
+    // a shared event loop outlives this instance
+    GetEventLoop()->purge_pending_notifications(&m_packethandler);
 
     //close reactor so no one can register new handlers
     SuspendEventHandling(true);
@@ -124,7 +131,8 @@ VoiceLogger& ClientNode::GetVoiceLogger()
     ASSERT_CLIENTNODE_LOCKED(this);
 
     if(!m_voicelogger)
-        m_voicelogger = std::make_shared<VoiceLogger>(m_listener);
+        m_voicelogger = std::make_shared<VoiceLogger>(m_listener, m_encodepool.get(),
+                                                      m_shared.timers.get());
 
     return *m_voicelogger;
 }
@@ -166,6 +174,20 @@ bool ClientNode::GetClientStatistics(ClientStats& stats)
         else
             m_clientstats.tcp_ping_dirty = true;
 
+        stats.packets_fragmented = m_packets_fragmented;
+        // 'm_clientstats' holds count of users who have logged out
+        for (const auto& u : m_users)
+            stats.packets_reassembled += u.second->GetStatistics().packets_reassembled;
+
+        if (m_trace_latency)
+        {
+            std::lock_guard<std::mutex> const g(m_latency_mtx);
+            stats.voice_encoded_p50_msec = m_voice_encoded_latency.Percentile(0.5) / 1000;
+            stats.voice_encoded_p95_msec = m_voice_encoded_latency.Percentile(0.95) / 1000;
+            stats.voice_sent_p50_msec = m_voice_sent_latency.Percentile(0.5) / 1000;
+            stats.voice_sent_p95_msec = m_voice_sent_latency.Percentile(0.95) / 1000;
+        }
+
         return true;
     }
     return false;
@@ -257,6 +279,15 @@ clientuser_t ClientNode::GetUser(int userid, bool include_local/* = false*/)
     return suser;
 }
 
+clientuser_t ClientNode::GetUserFast(int userid)
+{
+    ASSERT_CLIENTNODE_LOCKED(this);
+
+    if (std::cmp_less(userid, m_users_table.size()) && m_users_table[userid])
+        return m_users_table[userid];
+    return GetUser(userid);
+}
+
 clientuser_t ClientNode::GetUserByUsername(const ACE_TString& username)
 {
     ASSERT_CLIENTNODE_LOCKED(this);
@@ -365,6 +396,59 @@ void ClientNode::UpdateKeepAlive(const ClientKeepAlive& keepalive)
     }
 }
 
+void ClientNode::SetUserEventCoalescing(const ACE_Time_Value& window)
+{
+    ASSERT_CLIENTNODE_LOCKED(this);
+
+    m_user_changes_window = window;
+    if (window == ACE_Time_Value::zero)
+    {
+        //deliver what is pending now that coalescing is disabled
+        if (TimerExists(TIMER_USER_CHANGES_ID))
+            StopTimer(TIMER_USER_CHANGES_ID);
+        TimerUserChanges();
+    }
+}
+
+bool ClientNode::CoalesceUserChange(int userid, uint32_t changes)
+{
+    ASSERT_CLIENTNODE_LOCKED(this);
+
+    if (m_user_changes_window == ACE_Time_Value::zero)
+        return false;
+
+    m_user_changes[userid] |= changes;
+    if (!TimerExists(TIMER_USER_CHANGES_ID))
+        StartTimer(TIMER_USER_CHANGES_ID, 0, m_user_changes_window);
+    return true;
+}
+
+void ClientNode::SetLatencyTracing(bool enable)
+{
+    ASSERT_CLIENTNODE_LOCKED(this);
+
+    m_trace_latency = enable;
+    {
+        std::lock_guard<std::mutex> const g(m_latency_mtx);
+        m_voice_encoded_latency.Reset();
+        m_voice_sent_latency.Reset();
+    }
+    for (const auto& u : m_users)
+        u.second->SetLatencyTracing(enable);
+}
+
+void ClientNode::TraceVoiceLatency(LatencyHistogram& histogram, uint32_t captured)
+{
+    // audio input and media streams have timestamps relative to
+    // stream start
+    auto const msec = int32_t(GETTIMESTAMP() - captured);
+    if (msec < 0 || msec > CLIENT_LATENCY_TRACE_MAX_MSEC)
+        return;
+
+    std::lock_guard<std::mutex> const g(m_latency_mtx);
+    histogram.Add(int64_t(msec) * 1000);
+}
+
 ClientKeepAlive ClientNode::GetKeepAlive()
 {
     ASSERT_CLIENTNODE_LOCKED(this);
@@ -400,7 +484,9 @@ int ClientNode::TimerEvent(ACE_UINT32 timer_event_id, long userdata)
         }
         else
         {
-            SendPacket(HelloPacket(m_myuserid, GETTIMESTAMP()),
+            //server only accepts a new IP-address with the token
+            ACE_INT64 const token = ((m_flags & CLIENT_CONNECTED) != 0u) ? m_serverinfo.migratetoken : 0;
+            SendPacket(HelloPacket(m_myuserid, GETTIMESTAMP(), token),
                        m_serverinfo.udpaddr);
             ret = 0;
         }
@@ -425,12 +511,18 @@ int ClientNode::TimerEvent(ACE_UINT32 timer_event_id, long userdata)
     case TIMER_DESKTOPNAKPACKET_TIMEOUT_ID :
         ret = TimerDesktopNakPacket();
         break;
+    case TIMER_DESKTOPCURSOR_ID :
+        ret = TimerDesktopCursor();
+        break;
     case TIMER_BUILD_DESKTOPPACKETS_ID :
         ret = TimerBuildDesktopPackets();
         break;
     case TIMER_QUERY_MTU_ID :
         ret = TimerQueryMtu(userdata);
         break;
+    case TIMER_USER_CHANGES_ID :
+        ret = TimerUserChanges();
+        break;
     case TIMER_STOP_AUDIOINPUT :
         m_audioinput_voice.reset();
         ret = -1;
@@ -598,7 +690,7 @@ int ClientNode::TimerEvent(ACE_UINT32 timer_event_id, long userdata)
     case USER_TIMER_UPDATE_USER :
     {
         clientuser_t const user = GetUser(userdata);
-        if(user.get() != nullptr)
+        if(user.get() != nullptr && !CoalesceUserChange(user->GetUserID(), USERCHANGE_STATE))
             m_listener->OnUserStateChange(*user);
         ret = -1;
     }
@@ -654,6 +746,24 @@ int ClientNode::TimerOneSecond()
         }
     }
 
+    //follow route to server to another network interface,
+    //e.g. when switching from Wi-Fi to mobile network
+    if ((m_flags & CLIENT_CONNECTED) != 0u && m_localUdpAddr == ACE_INET_Addr())
+    {
+        ACE_INET_Addr const routeaddr = GetRouteLocalAddr();
+        if (!routeaddr.is_any() && !routeaddr.is_ip_equal(m_routeaddr))
+            MigrateUdpSocket(routeaddr);
+    }
+
+    //repeat path MTU discovery since route to server may change
+    //(not while UDP is reconnecting)
+    if ((m_flags & CLIENT_CONNECTED) != 0u && m_mtu_probe_next != ACE_Time_Value::zero &&
+        m_mtu_probe_next <= ACE_OS::gettimeofday() && !TimerExists(TIMER_QUERY_MTU_ID) &&
+        !TimerExists(TIMER_UDPCONNECT_ID))
+    {
+        StartMTUProbe(false);
+    }
+
     return 0;
 }
 
@@ -701,6 +811,9 @@ int ClientNode::TimerBuildDesktopPackets()
     if(packets.empty())
         return -1;
 
+    if (packets.size() > 1)
+        m_packets_fragmented++;
+
     //calculate bytes to send
     int total_size = 0;
     int pk_size = 0;
@@ -807,6 +920,37 @@ int ClientNode::TimerDesktopNakPacket()
     return 0;
 }
 
+int ClientNode::TimerDesktopCursor()
+{
+    ASSERT_CLIENTNODE_LOCKED(this);
+
+    //stop timer when cursor is idle so next update is sent immediately
+    if (!m_desktop_cursor_pending)
+        return -1;
+
+    m_desktop_cursor_pending = false;
+    if (!QueueDesktopCursor(m_desktop_cursor_x, m_desktop_cursor_y))
+        return -1;
+    return 0;
+}
+
+int ClientNode::TimerUserChanges()
+{
+    ASSERT_CLIENTNODE_LOCKED(this);
+
+    //listener callbacks must not see a half-processed 'm_user_changes'
+    std::map<int, uint32_t> changes;
+    changes.swap(m_user_changes);
+    for (const auto& c : changes)
+    {
+        //user may have logged out within window
+        clientuser_t const user = GetUser(c.first, true);
+        if (user)
+            m_listener->OnUserChanged(*user, c.second);
+    }
+    return -1;
+}
+
 int ClientNode::TimerQueryMtu(int mtu_index)
 {
     ASSERT_CLIENTNODE_LOCKED(this);
@@ -815,13 +959,8 @@ int ClientNode::TimerQueryMtu(int mtu_index)
 
     if(m_mtu_packets.size() >= MTU_QUERY_RETRY_COUNT)
     {
-        m_mtu_packets.clear();
-        //MTU query failed
-        if(mtu_index == 0)
-            m_listener->OnMTUQueryComplete(0);
-        else
-            m_listener->OnMTUQueryComplete(m_mtu_max_payload_size);
-            
+        //no reply to this size so use the largest confirmed
+        MTUProbeCompleted();
         return -1;
     }
 
@@ -839,6 +978,43 @@ int ClientNode::TimerQueryMtu(int mtu_index)
     return 0;
 }
 
+void ClientNode::StartMTUProbe(bool notify)
+{
+    ASSERT_CLIENTNODE_LOCKED(this);
+    TTASSERT(!TimerExists(TIMER_QUERY_MTU_ID));
+
+    m_mtu_packets.clear();
+    m_mtu_probe_confirmed = 0;
+    m_mtu_probe_notify = notify;
+    m_mtu_probe_last = ACE_OS::gettimeofday();
+    m_mtu_probe_next = m_mtu_probe_last + CLIENT_MTU_REPROBE_INTERVAL;
+
+    StartTimer(TIMER_QUERY_MTU_ID, 0, ACE_Time_Value::zero,
+               CLIENT_QUERY_MTU_INTERVAL);
+}
+
+void ClientNode::MTUProbeCompleted()
+{
+    ASSERT_CLIENTNODE_LOCKED(this);
+
+    m_mtu_packets.clear();
+
+    // path MTU may also have shrunk since last query
+    bool changed = false;
+    if (m_mtu_probe_confirmed > 0 && m_mtu_probe_confirmed != m_mtu_data_size)
+    {
+        m_mtu_data_size = m_mtu_probe_confirmed;
+        changed = true;
+    }
+
+    MYTRACE(ACE_TEXT("MTU query completed. Max data size %d\n"), int(m_mtu_data_size));
+
+    // automatic queries only report changes
+    if (m_mtu_probe_notify || changed)
+        m_listener->OnMTUQueryComplete(m_mtu_probe_confirmed > 0 ? m_mtu_probe_confirmed + FIELDHEADER_PAYLOAD : 0);
+    m_mtu_probe_notify = false;
+}
+
 void ClientNode::RecreateUdpSocket()
 {
     ASSERT_CLIENTNODE_LOCKED(this);
@@ -846,9 +1022,51 @@ void ClientNode::RecreateUdpSocket()
     //recreate the UDP socket which has the server connection
     m_packethandler.Close();
     auto localaddr = GetLocalAddr();
+    //TCP connection may still be on previous network interface
+    if (m_localUdpAddr == ACE_INET_Addr() && !m_routeaddr.is_any())
+    {
+        localaddr = m_routeaddr;
+        localaddr.set_port_number(0);
+    }
     m_packethandler.Open(localaddr);
 }
 
+ACE_INET_Addr ClientNode::GetRouteLocalAddr() const
+{
+    //connecting a UDP socket makes the OS select the local address
+    //without sending anything
+    ACE_INET_Addr localaddr;
+    ACE_SOCK_CODgram sock;
+    if (sock.open(m_serverinfo.udpaddr, ACE_Addr::sap_any,
+                  m_serverinfo.udpaddr.get_type()) == 0)
+    {
+        sock.get_local_addr(localaddr);
+        sock.close();
+    }
+    return localaddr;
+}
+
+void ClientNode::MigrateUdpSocket(const ACE_INET_Addr& routeaddr)
+{
+    ASSERT_CLIENTNODE_LOCKED(this);
+
+    MYTRACE(ACE_TEXT("Route to server moved from %s to %s. Migrating UDP socket\n"),
+            InetAddrToString(m_routeaddr).c_str(), InetAddrToString(routeaddr).c_str());
+
+    m_routeaddr = routeaddr;
+    RecreateUdpSocket();
+
+    //send hello with migration token right away instead of waiting
+    //for UDP keep alives to time out
+    if (TimerExists(TIMER_UDPKEEPALIVE_ID))
+        StopTimer(TIMER_UDPKEEPALIVE_ID);
+    if (TimerExists(TIMER_UDPCONNECT_ID))
+        StopTimer(TIMER_UDPCONNECT_ID);
+
+    m_clientstats.udp_silence_sec = 0;
+    StartTimer(TIMER_UDPCONNECT_ID, 0, ACE_Time_Value::zero, m_keepalive.udp_connect_interval);
+}
+
 void ClientNode::OpenAudioCapture(const AudioCodec& codec)
 {
     ASSERT_CLIENTNODE_LOCKED(this);
@@ -1208,6 +1426,9 @@ void ClientNode::EncodedAudioVoiceFrame(const teamtalk::AudioCodec& codec,
                             m_voice_pkt_counter++, enc_data, enc_length));
     }
 
+    if (m_trace_latency)
+        TraceVoiceLatency(m_voice_encoded_latency, org_frame.timestamp);
+
     if(!QueuePacket(newpacket))
         delete newpacket;
 }
@@ -1624,13 +1845,17 @@ void ClientNode::ReceivedPacket(PacketHandler* /*ph*/,
 #endif
 
 
+    //validate and locate fields in a single pass so the packets
+    //below don't scan the fields again
+    FieldIndex fields;
+    bool const valid = fields.Build(packet_data, packet_size);
 #ifdef _DEBUG
-    TTASSERT(packet.ValidatePacket());
+    TTASSERT(valid);
 #endif
-    if(!packet.ValidatePacket())
+    if(!valid)
         return;
 
-    clientuser_t const user = GetUser(packet.GetSrcUserID());
+    clientuser_t const user = GetUserFast(packet.GetSrcUserID());
 
     switch(packet.GetKind())
     {
@@ -1643,16 +1868,14 @@ void ClientNode::ReceivedPacket(PacketHandler* /*ph*/,
     }
 
     //FieldPackets are destined for channels
-    FieldPacket const chanpacket(packet_data, packet_size);
-
-    clientchannel_t const chan = GetChannel(chanpacket.GetChannel());
+    clientchannel_t const chan = GetChannel(packet.GetChannel());
     if (!chan)
     {
         MYTRACE(ACE_TEXT("Received packet kind %d without a specified channel\n"), int(packet.GetKind()));
         return;
     }
     
-    switch(chanpacket.GetKind())
+    switch(packet.GetKind())
     {
 #ifdef ENABLE_ENCRYPTION
     case PACKET_KIND_VOICE_CRYPT :
@@ -1677,7 +1900,8 @@ void ClientNode::ReceivedPacket(PacketHandler* /*ph*/,
 #endif
     case PACKET_KIND_VOICE :
     {
-        VoicePacket const audio_pkt(packet_data, packet_size);
+        VoicePacket audio_pkt(packet_data, packet_size);
+        audio_pkt.SetFieldIndex(&fields);
         MYTRACE_COND(!user,
                      ACE_TEXT("Received voice packet from unknown user #%d\n"),
                      packet.GetSrcUserID());
@@ -1708,7 +1932,8 @@ void ClientNode::ReceivedPacket(PacketHandler* /*ph*/,
 #endif
     case PACKET_KIND_MEDIAFILE_AUDIO :
     {
-        AudioFilePacket const audio_pkt(packet_data, packet_size);
+        AudioFilePacket audio_pkt(packet_data, packet_size);
+        audio_pkt.SetFieldIndex(&fields);
         MYTRACE_COND(!user,
                      ACE_TEXT("Received AudioFilePacket from unknown user #%d"),
                      packet.GetSrcUserID());
@@ -1735,7 +1960,8 @@ void ClientNode::ReceivedPacket(PacketHandler* /*ph*/,
 #endif
     case PACKET_KIND_VIDEO :
     {
-        VideoCapturePacket const video_pkt(packet_data, packet_size);
+        VideoCapturePacket video_pkt(packet_data, packet_size);
+        video_pkt.SetFieldIndex(&fields);
         MYTRACE_COND(!user,
                      ACE_TEXT("Received VideoCapturePacket from unknown user #%d\n"),
                      packet.GetSrcUserID());
@@ -1762,7 +1988,8 @@ void ClientNode::ReceivedPacket(PacketHandler* /*ph*/,
 #endif
     case PACKET_KIND_MEDIAFILE_VIDEO :
     {
-        VideoFilePacket const video_pkt(packet_data, packet_size);
+        VideoFilePacket video_pkt(packet_data, packet_size);
+        video_pkt.SetFieldIndex(&fields);
         MYTRACE_COND(!user,
                      ACE_TEXT("Received VideoFilePacket from unknown user #%d\n"),
                      packet.GetSrcUserID());
@@ -1790,7 +2017,8 @@ void ClientNode::ReceivedPacket(PacketHandler* /*ph*/,
 #endif
     case PACKET_KIND_DESKTOP :
     {
-        DesktopPacket const desktop_pkt(packet_data, packet_size);
+        DesktopPacket desktop_pkt(packet_data, packet_size);
+        desktop_pkt.SetFieldIndex(&fields);
         MYTRACE_COND(!user,
                      ACE_TEXT("Received DesktopPacket from unknown user #%d"),
                      packet.GetSrcUserID());
@@ -1900,8 +2128,46 @@ void ClientNode::ReceivedPacket(PacketHandler* /*ph*/,
         m_clientstats.desktopbytes_recv += packet_size;
     }
     break;
+#ifdef ENABLE_ENCRYPTION
+    case PACKET_KIND_VIDEO_FEEDBACK_CRYPT :
+    {
+        CryptVideoFeedbackPacket const crypt_pkt(packet_data, packet_size);
+        auto decrypt_pkt = crypt_pkt.Decrypt(chan->GetEncryptKey());
+        if(!decrypt_pkt)
+            return;
+        ReceivedVideoFeedbackPacket(*decrypt_pkt);
+        m_clientstats.vidcapbytes_recv += packet_size;
+    }
+    break;
+#endif
+    case PACKET_KIND_VIDEO_FEEDBACK :
+    {
+        VideoFeedbackPacket const fb_pkt(packet_data, packet_size);
+        ReceivedVideoFeedbackPacket(fb_pkt);
+        m_clientstats.vidcapbytes_recv += packet_size;
+    }
+    break;
+#ifdef ENABLE_ENCRYPTION
+    case PACKET_KIND_RECEIVER_REPORT_CRYPT :
+    {
+        CryptReceiverReportPacket const crypt_pkt(packet_data, packet_size);
+        auto decrypt_pkt = crypt_pkt.Decrypt(chan->GetEncryptKey());
+        if(!decrypt_pkt)
+            return;
+        ReceivedReceiverReportPacket(*decrypt_pkt);
+        m_clientstats.voicebytes_recv += packet_size;
+    }
+    break;
+#endif
+    case PACKET_KIND_RECEIVER_REPORT :
+    {
+        ReceiverReportPacket const rr_pkt(packet_data, packet_size);
+        ReceivedReceiverReportPacket(rr_pkt);
+        m_clientstats.voicebytes_recv += packet_size;
+    }
+    break;
     default :
-        MYTRACE_COND(user.get(),
+        MYTRACE_COND(user != nullptr,
                      ACE_TEXT("Received unknown packet type %d from #%d, %s\n"), 
                      (int)packet.GetKind(), user->GetUserID(), user->GetNickname().c_str());
         break;
@@ -1931,8 +2197,15 @@ void ClientNode::ReceivedHelloAckPacket(const HelloPacket& packet,
 
         TTASSERT(!TimerExists(TIMER_UDPKEEPALIVE_ID));
 
+        //detect when route to server changes network interface
+        m_routeaddr = GetRouteLocalAddr();
+
         StartTimer(TIMER_UDPKEEPALIVE_ID, 0, m_keepalive.udp_keepalive_interval,
                    m_keepalive.udp_keepalive_rtx);
+
+        //discover path MTU so media packets are not fragmented by IP
+        if (!TimerExists(TIMER_QUERY_MTU_ID))
+            StartMTUProbe(false);
         
         //notify parent application
         if(m_listener != nullptr)
@@ -1951,6 +2224,9 @@ void ClientNode::ReceivedHelloAckPacket(const HelloPacket& packet,
         {
             StartTimer(TIMER_UDPKEEPALIVE_ID, 0, m_keepalive.udp_keepalive_interval,
                        m_keepalive.udp_keepalive_rtx);
+
+            //new connection may have taken another route
+            m_mtu_probe_next = ACE_OS::gettimeofday();
         }
     }
 }
@@ -1983,8 +2259,13 @@ void ClientNode::ReceivedKeepAliveReplyPacket(const KeepAlivePacket& packet,
 
         m_mtu_packets.clear();
 
-        m_mtu_data_size = payload_size;
-        m_mtu_max_payload_size = m_mtu_data_size + FIELDHEADER_PAYLOAD;
+        //a confirmed larger size can be used right away whereas a
+        //smaller size is applied when query completes
+        m_mtu_probe_confirmed = payload_size;
+        if (payload_size > m_mtu_data_size)
+        {
+            m_mtu_data_size = payload_size;
+        }
 
         if(payload_size < MTU_QUERY_SIZES[MTU_QUERY_SIZES_COUNT-1])
         {
@@ -1999,7 +2280,7 @@ void ClientNode::ReceivedKeepAliveReplyPacket(const KeepAlivePacket& packet,
         }
         else
         {
-            m_listener->OnMTUQueryComplete(m_mtu_max_payload_size);
+            MTUProbeCompleted();
         }
     }
 
@@ -2163,6 +2444,97 @@ void ClientNode::ReceivedDesktopInputPacket(const DesktopInputPacket& di_pkt)
     }
 }
 
+void ClientNode::ReceivedVideoFeedbackPacket(const VideoFeedbackPacket& fb_pkt)
+{
+    ASSERT_REACTOR_THREAD(*GetEventLoop());
+
+    if(std::cmp_not_equal(fb_pkt.GetDestUserID() , m_myuserid))
+        return;
+
+    //feedback may be for a previous video session
+    if((m_flags & CLIENT_TX_VIDEOCAPTURE) == 0 ||
+       fb_pkt.GetStreamID() != m_vidcap_stream_id)
+        return;
+
+    int const layer = fb_pkt.GetLayer();
+    if (fb_pkt.GetKeyFrameRequest())
+    {
+        MYTRACE(ACE_TEXT("User #%d requested key frame for video layer %d\n"),
+                fb_pkt.GetSrcUserID(), layer);
+        m_vidcap_thread.RequestKeyFrame(layer);
+    }
+
+    video_nacks_t const nacks = fb_pkt.GetNacks();
+    if (nacks.empty())
+        return;
+
+    videopackets_t packets;
+    {
+        std::lock_guard<std::mutex> const g(m_vidcap_history_mtx);
+        packets = m_vidcap_history.GetVideoPackets(layer, nacks, fb_pkt.GetSrcUserID());
+    }
+
+    MYTRACE(ACE_TEXT("User #%d reported %u video packets missing. Retransmitting %u fragments\n"),
+            fb_pkt.GetSrcUserID(), unsigned(nacks.size()), unsigned(packets.size()));
+
+    //large video fragments may be dropped due to smaller path MTU
+    if (m_mtu_probe_last + CLIENT_MTU_LOSS_REPROBE_INTERVAL <= ACE_OS::gettimeofday() &&
+        !TimerExists(TIMER_QUERY_MTU_ID))
+    {
+        StartMTUProbe(false);
+    }
+
+    for (auto* p : packets)
+    {
+        if(!QueuePacket(p))
+            delete p;
+    }
+}
+
+void ClientNode::ReceivedReceiverReportPacket(const ReceiverReportPacket& rr_pkt)
+{
+    ASSERT_REACTOR_THREAD(*GetEventLoop());
+
+    if(std::cmp_not_equal(rr_pkt.GetDestUserID() , m_myuserid) || !m_mychannel)
+        return;
+
+    uint32_t const now = GETTIMESTAMP();
+    ReceiverReport const report = rr_pkt.GetReport();
+
+    //OPUS encoder adds FEC according to the worst loss reported by
+    //a receiver and lowers bitrate to the most congested receiver
+    if (report.stream_id != 0)
+    {
+        m_voice_bwe.ReportReceived(rr_pkt.GetSrcUserID(), rr_pkt.GetLossPercent(),
+                                   report.delay_gradient_msec, now);
+        int const loss = m_voice_bwe.GetLossPercent(now);
+        int const bitrate = m_voice_bwe.GetBitratePercent(now);
+
+        MYTRACE_COND(rr_pkt.GetPacketsLost() > 0 || bitrate < 100,
+                     ACE_TEXT("User #%d reported %d%% voice packet loss, jitter %d msec, delay gradient %d msec. Encoder loss %d%%, bitrate %d%%\n"),
+                     rr_pkt.GetSrcUserID(), rr_pkt.GetLossPercent(), int(report.jitter_msec),
+                     int(report.delay_gradient_msec), loss, bitrate);
+        m_voice_thread.SetPacketLoss(loss);
+        m_voice_thread.SetBitrateScale(bitrate);
+    }
+
+    //video reports may be for a previous video session
+    if (report.video_stream_id != 0 && report.video_stream_id == m_vidcap_stream_id &&
+        (m_flags & CLIENT_TX_VIDEOCAPTURE) != 0u)
+    {
+        int const expected = report.video_frames_recv + report.video_frames_lost;
+        int const loss = expected != 0 ? report.video_frames_lost * 100 / expected : 0;
+        m_vidcap_bwe.ReportReceived(rr_pkt.GetSrcUserID(), loss,
+                                    report.video_delay_gradient_msec, now);
+        int const bitrate = m_vidcap_bwe.GetBitratePercent(now);
+
+        MYTRACE_COND(report.video_frames_lost > 0 || bitrate < 100,
+                     ACE_TEXT("User #%d reported %d%% video frame loss, delay gradient %d msec. Encoder bitrate %d%%\n"),
+                     rr_pkt.GetSrcUserID(), loss, int(report.video_delay_gradient_msec), bitrate);
+        m_vidcap_thread.SetBitrateScale(bitrate);
+    }
+}
+
 void ClientNode::ReceivedDesktopInputAckPacket(const DesktopInputAckPacket& ack_pkt)
 {
     ASSERT_REACTOR_THREAD(*GetEventLoop());
@@ -2286,11 +2658,15 @@ void ClientNode::SendPackets()
                                                            m_mtu_data_size);
             if(!fragments.empty())
             {
+                m_packets_fragmented++;
                 for(const auto & fragment : fragments)
                     SendVoicePacket(*fragment);
             }
             else
                 SendVoicePacket(*audpkt);
+
+            if (m_trace_latency)
+                TraceVoiceLatency(m_voice_sent_latency, audpkt->GetTime());
         }
         break;
         case PACKET_KIND_MEDIAFILE_AUDIO :
@@ -2313,6 +2689,7 @@ void ClientNode::SendPackets()
                                                            m_mtu_data_size);
             if(!fragments.empty())
             {
+                m_packets_fragmented++;
                 for(const auto & fragment : fragments)
                     SendAudioFilePacket(*fragment);
             }
@@ -2470,6 +2847,56 @@ void ClientNode::SendPackets()
             }
         }
         break;
+        case PACKET_KIND_VIDEO_FEEDBACK :
+        {
+            auto* fb_packet = dynamic_cast<VideoFeedbackPacket*>(p.get());
+            TTASSERT(fb_packet);
+            TTASSERT(fb_packet->Finalized());
+
+#ifdef ENABLE_ENCRYPTION
+            if(m_crypt_stream != nullptr)
+            {
+                clientchannel_t const chan = GetChannel(fb_packet->GetChannel());
+                if (!chan)
+                    break;
+                CryptVideoFeedbackPacket const crypt_pkt(*fb_packet, chan->GetEncryptKey());
+                ret = SendPacket(crypt_pkt, m_serverinfo.udpaddr);
+                TTASSERT(crypt_pkt.ValidatePacket());
+            }
+            else
+#endif
+            {
+                TTASSERT(m_def_stream);
+                ret = SendPacket(*fb_packet, m_serverinfo.udpaddr);
+                TTASSERT(fb_packet->ValidatePacket());
+            }
+        }
+        break;
+        case PACKET_KIND_RECEIVER_REPORT :
+        {
+            auto* rr_packet = dynamic_cast<ReceiverReportPacket*>(p.get());
+            TTASSERT(rr_packet);
+            TTASSERT(rr_packet->Finalized());
+
+#ifdef ENABLE_ENCRYPTION
+            if(m_crypt_stream != nullptr)
+            {
+                clientchannel_t const chan = GetChannel(rr_packet->GetChannel());
+                if (!chan)
+                    break;
+                CryptReceiverReportPacket const crypt_pkt(*rr_packet, chan->GetEncryptKey());
+                ret = SendPacket(crypt_pkt, m_serverinfo.udpaddr);
+                TTASSERT(crypt_pkt.ValidatePacket());
+            }
+            else
+#endif
+            {
+                TTASSERT(m_def_stream);
+                ret = SendPacket(*rr_packet, m_serverinfo.udpaddr);
+                TTASSERT(rr_packet->ValidatePacket());
+            }
+        }
+        break;
         case PACKET_KIND_DESKTOP_NAK :
         {
             auto* nak_packet = dynamic_cast<DesktopNakPacket*>(p.get());
@@ -2640,12 +3067,16 @@ int ClientNode::SendPacket(const FieldPacket& packet, const ACE_INET_Addr& addr)
             TTASSERT(m_def_stream); //sending unencrypted
 #endif
         case PACKET_KIND_VOICE_CRYPT :
+        case PACKET_KIND_RECEIVER_REPORT :
+        case PACKET_KIND_RECEIVER_REPORT_CRYPT :
             m_clientstats.voicebytes_sent += ret; break;
         case PACKET_KIND_VIDEO :
 #ifdef ENABLE_ENCRYPTION
             TTASSERT(m_def_stream); //sending unencrypted
 #endif
         case PACKET_KIND_VIDEO_CRYPT :
+        case PACKET_KIND_VIDEO_FEEDBACK :
+        case PACKET_KIND_VIDEO_FEEDBACK_CRYPT :
             m_clientstats.vidcapbytes_sent += ret; break;
         case PACKET_KIND_MEDIAFILE_AUDIO :
 #ifdef ENABLE_ENCRYPTION
@@ -2685,6 +3116,21 @@ int ClientNode::SendPacket(const FieldPacket& packet, const ACE_INET_Addr& addr)
     {
         MYTRACE(ACE_TEXT("Failed to UDP packet kind %d of size %d\n"),
                 (int)packet.GetKind(), (int)packet.GetPacketSize());
+
+        //path MTU is smaller than packet so step down to next MTU
+        //query size and let one second timer rerun MTU query
+        if (ACE_OS::last_error() == EMSGSIZE && packet.GetKind() != PACKET_KIND_KEEPALIVE)
+        {
+            for (int i=int(MTU_QUERY_SIZES_COUNT)-1;i>=0;i--)
+            {
+                if (MTU_QUERY_SIZES[i] < m_mtu_data_size)
+                {
+                    m_mtu_data_size = MTU_QUERY_SIZES[i];
+                    m_mtu_probe_next = ACE_OS::gettimeofday();
+                    break;
+                }
+            }
+        }
     }
 
     return (int)ret;
@@ -2805,6 +3251,21 @@ bool ClientNode::CloseSoundOutputDevice()
     return true;
 }
 
+bool ClientNode::EnableSoundOutputMixer(bool enable)
+{
+    ASSERT_CLIENTNODE_LOCKED(this);
+
+    rguard_t g_snd(LockSndprop());
+    m_soundprop.outputmixer = enable;
+    g_snd.release();
+
+    // relaunch audio players on the new output stream(s)
+    if ((m_flags & CLIENT_SNDOUTPUT_READY) != 0u)
+        ResetAudioPlayers();
+
+    return true;
+}
+
 bool ClientNode::CloseSoundDuplexDevices()
 {
     ASSERT_CLIENTNODE_LOCKED(this);
@@ -3003,7 +3464,7 @@ bool ClientNode::EnableAudioBlockCallback(int userid, StreamTypes sts,
     {
         if (enable)
         {
-            audiomuxer_t const newmuxer(new AudioMuxer(sts));
+            audiomuxer_t const newmuxer(new AudioMuxer(sts, nullptr, m_shared.timers.get()));
             media::AudioInputFormat infmt;
 
             if (outfmt.IsValid())
@@ -3196,17 +3657,30 @@ void ClientNode::StopRecordingMuxedAudioFile(int channelid)
     m_channelrecord.CloseFile(channelid);
 }
 
+bool ClientNode::SetRecordingMemoryLimit(int bytes)
+{
+    if (bytes <= 0)
+        return false;
+
+    m_encodepool->SetMemoryLimit(bytes);
+    return true;
+}
+
 bool ClientNode::StartMTUQuery()
 {
     ASSERT_CLIENTNODE_LOCKED(this);
 
     if(TimerExists(TIMER_QUERY_MTU_ID))
-        return false;
-
-    m_mtu_packets.clear();
+    {
+        //join automatic MTU query in progress
+        if (m_mtu_probe_notify)
+            return false;
+        m_mtu_probe_notify = true;
+        return true;
+    }
 
-    return StartTimer(TIMER_QUERY_MTU_ID, 0, ACE_Time_Value::zero,
-                      CLIENT_QUERY_MTU_INTERVAL)>=0;
+    StartMTUProbe(true);
+    return TimerExists(TIMER_QUERY_MTU_ID);
 }
 
 bool ClientNode::StartStreamingMediaFile(const ACE_TString& filename,
@@ -3273,9 +3747,12 @@ bool ClientNode::StartStreamingMediaFile(const ACE_TString& filename,
         m_flags |= CLIENT_STREAM_VIDEOFILE;
 
         m_videofile_thread = std::make_shared<VideoThread>();
-        auto cbfunc = [this](auto && PH1, auto && PH2, auto && PH3, auto && PH4, auto && PH5) { return EncodedVideoFileFrame(std::forward<decltype(PH1)>(PH1), std::forward<decltype(PH2)>(PH2), std::forward<decltype(PH3)>(PH3), std::forward<decltype(PH4)>(PH4), std::forward<decltype(PH5)>(PH5)); };
+        //simulcast is only supported for video capture
+        VideoCodec filecodec = vid_codec;
+        filecodec.webm_vp8.simulcast_layers = 0;
+        auto cbfunc = [this](auto && PH1, auto && PH2, auto && PH3, auto && PH4, auto && PH5, auto && PH6, auto && PH7) { return EncodedVideoFileFrame(std::forward<decltype(PH1)>(PH1), std::forward<decltype(PH2)>(PH2), std::forward<decltype(PH3)>(PH3), std::forward<decltype(PH4)>(PH4), std::forward<decltype(PH5)>(PH5), std::forward<decltype(PH6)>(PH6), std::forward<decltype(PH7)>(PH7)); };
         if (!m_videofile_thread->StartEncoder(cbfunc, m_mediafile_streamer->GetMediaOutput().video,
-                                              vid_codec, VIDEOFILE_ENCODER_FRAMES_MAX))
+                                              filecodec, VIDEOFILE_ENCODER_FRAMES_MAX))
         {
             StopStreamingMediaFile();
             return false;
@@ -3620,13 +4097,14 @@ bool ClientNode::OpenVideoCaptureSession(const VideoCodec& codec)
 
     m_vidcap_thread.StopEncoder();
 
-    if(!m_vidcap_thread.StartEncoder([this](auto && PH1, auto && PH2, auto && PH3, auto && PH4, auto && PH5) { return EncodedVideoCaptureFrame(std::forward<decltype(PH1)>(PH1), std::forward<decltype(PH2)>(PH2), std::forward<decltype(PH3)>(PH3), std::forward<decltype(PH4)>(PH4), std::forward<decltype(PH5)>(PH5)); },
+    if(!m_vidcap_thread.StartEncoder([this](auto && PH1, auto && PH2, auto && PH3, auto && PH4, auto && PH5, auto && PH6, auto && PH7) { return EncodedVideoCaptureFrame(std::forward<decltype(PH1)>(PH1), std::forward<decltype(PH2)>(PH2), std::forward<decltype(PH3)>(PH3), std::forward<decltype(PH4)>(PH4), std::forward<decltype(PH5)>(PH5), std::forward<decltype(PH6)>(PH6), std::forward<decltype(PH7)>(PH7)); },
                                      cap_format, codec, VIDEOCAPTURE_ENCODER_FRAMES_MAX))
     {
         CloseVideoCaptureSession();
         return false;
     }
     GEN_NEXT_ID(m_vidcap_stream_id);
+    m_vidcap_bwe.Reset();
 
     m_flags |= CLIENT_TX_VIDEOCAPTURE;
 
@@ -3640,6 +4118,11 @@ void ClientNode::CloseVideoCaptureSession()
     m_vidcap_thread.StopEncoder();
     m_local_vidcapframes.close();
 
+    {
+        std::lock_guard<std::mutex> const g(m_vidcap_history_mtx);
+        m_vidcap_history.Reset();
+    }
+
     m_flags &= ~CLIENT_TX_VIDEOCAPTURE;
 }
 
@@ -3656,20 +4139,32 @@ ACE_Message_Block* ClientNode::AcquireVideoCaptureFrame()
 bool ClientNode::EncodedVideoCaptureFrame(ACE_Message_Block* org_frame,
                                           const char* enc_data, int enc_len,
                                           ACE_UINT32 packet_no,
-                                          ACE_UINT32 timestamp)
+                                          ACE_UINT32 timestamp,
+                                          int layer, bool key_frame)
 {
     if((enc_data != nullptr) && ((m_flags & CLIENT_AUTHORIZED) != 0u) &&
        ((m_flags & CLIENT_TX_VIDEOCAPTURE) != 0u))
     {
-        auto w = (uint16_t)m_vidcap_thread.GetVideoFormat().width;
-        auto h = (uint16_t)m_vidcap_thread.GetVideoFormat().height;
+        auto w = (uint16_t)m_vidcap_thread.GetVideoFormat(layer).width;
+        auto h = (uint16_t)m_vidcap_thread.GetVideoFormat(layer).height;
+        int const layers = m_vidcap_thread.GetSimulcastLayers();
+        uint8_t const simulcast = (layers > 1) ? VideoPacket::SimulcastInfo(layer, layers, key_frame) : 0;
         //max supported is uint16 * MAX_PAYLOAD_SIZE
         videopackets_t packets = BuildVideoPackets(PACKET_KIND_VIDEO,
                                                    m_myuserid, timestamp,
                                                    m_mtu_data_size,
                                                    m_vidcap_stream_id, 
                                                    packet_no, &w, &h,
-                                                   enc_data, enc_len);
+                                                   enc_data, enc_len,
+                                                   GetVideoPacketCodec(m_vidcap_thread.GetCodec()),
+                                                   simulcast);
+        {
+            std::lock_guard<std::mutex> const g(m_vidcap_history_mtx);
+            m_vidcap_history.AddVideoPackets(packets);
+        }
+
+        if (packets.size() > 1)
+            m_packets_fragmented++;
 
         bool failed = false;
         for(auto & packet : packets)
@@ -3699,8 +4194,12 @@ bool ClientNode::EncodedVideoCaptureFrame(ACE_Message_Block* org_frame,
 bool ClientNode::EncodedVideoFileFrame(ACE_Message_Block* /*org_frame*/,
                                        const char* enc_data, int enc_len,
                                        ACE_UINT32 packet_no,
-                                       ACE_UINT32 timestamp)
+                                       ACE_UINT32 timestamp,
+                                       int layer, bool /*key_frame*/)
 {
+    TTASSERT(layer == 0);
+    ACE_UNUSED_ARG(layer);
+
     //max supported is uint16 * MAX_PAYLOAD_SIZE
     auto w = (uint16_t)m_videofile_thread->GetVideoFormat().width;
     auto h = (uint16_t)m_videofile_thread->GetVideoFormat().height;
@@ -3710,12 +4209,16 @@ bool ClientNode::EncodedVideoFileFrame(ACE_Message_Block* /*org_frame*/,
                                                m_mediafile_stream_id, 
                                                packet_no,
                                                &w, &h,
-                                               enc_data, enc_len);
+                                               enc_data, enc_len,
+                                               GetVideoPacketCodec(m_videofile_thread->GetCodec()));
 
     // MYTRACE(ACE_TEXT("Video packet %d, fragments %d, size %d, csum 0x%x\n"),
     //         packet_no, (int)packets.size(), enc_len, 
     //         ACE::crc32(enc_data, enc_len));
 
+    if (packets.size() > 1)
+        m_packets_fragmented++;
+
     bool failed = false;
     for(auto & packet : packets)
     {
@@ -3754,10 +4257,11 @@ int ClientNode::SendDesktopWindow(int width, int height, RGBMode rgb,
         DesktopWindow const new_wnd(m_desktop_session_id, width, height, rgb, 
                               DESKTOPPROTOCOL_ZLIB_1);
 
+        uint16_t const mtu_data_size = m_mtu_data_size;
         DesktopInitiator* desktop = nullptr;
         ACE_NEW_RETURN(desktop, DesktopInitiator(GetUserID(), new_wnd,
-                                                 m_mtu_data_size,
-                                                 m_mtu_max_payload_size),
+                                                 mtu_data_size,
+                                                 uint16_t(mtu_data_size + FIELDHEADER_PAYLOAD)),
                                                  false);
         m_desktop = desktop_initiator_t(desktop);
 
@@ -3848,6 +4352,9 @@ void ClientNode::CloseDesktopSession(bool stop_nak_timer)
         StopTimer(TIMER_BUILD_DESKTOPPACKETS_ID);
     if(TimerExists(TIMER_DESKTOPPACKET_RTX_TIMEOUT_ID))
         StopTimer(TIMER_DESKTOPPACKET_RTX_TIMEOUT_ID);
+    if(TimerExists(TIMER_DESKTOPCURSOR_ID))
+        StopTimer(TIMER_DESKTOPCURSOR_ID);
+    m_desktop_cursor_pending = false;
 
     if(stop_nak_timer && TimerExists(TIMER_DESKTOPNAKPACKET_TIMEOUT_ID))
     {
@@ -3895,6 +4402,30 @@ bool ClientNode::SendDesktopCursor(int x, int y)
 {
     ASSERT_CLIENTNODE_LOCKED(this);
 
+    if (!GetMyChannel() || !m_desktop)
+        return false;
+
+    //latest position wins while waiting for the next time slot
+    if (TimerExists(TIMER_DESKTOPCURSOR_ID))
+    {
+        m_desktop_cursor_x = int16_t(x);
+        m_desktop_cursor_y = int16_t(y);
+        m_desktop_cursor_pending = true;
+        return true;
+    }
+
+    if (!QueueDesktopCursor(int16_t(x), int16_t(y)))
+        return false;
+
+    ACE_Time_Value const interval(0, DESKTOPCURSOR_INTERVAL_MSEC * 1000);
+    StartTimer(TIMER_DESKTOPCURSOR_ID, 0, interval, interval);
+    return true;
+}
+
+bool ClientNode::QueueDesktopCursor(int16_t x, int16_t y)
+{
+    ASSERT_CLIENTNODE_LOCKED(this);
+
     clientchannel_t chan;
     DesktopCursorPacket* pkt = nullptr;
 
@@ -3929,14 +4460,7 @@ bool ClientNode::SendDesktopInput(int userid,
     if (!user)
         return false;
 
-    int const n_tx_queue = int(user->GetDesktopInputTxQueue().size() + user->GetDesktopInputRtxQueue().size());
-    TTASSERT(n_tx_queue <= DESKTOPINPUT_QUEUE_MAX_SIZE);
-
-    TTASSERT(n_tx_queue == 0 ||
-            TimerExists(USER_TIMER_DESKTOPINPUT_RTX_ID, userid));
-
-    if(n_tx_queue == DESKTOPINPUT_QUEUE_MAX_SIZE ||
-       (m_myuseraccount.userrights & USERRIGHT_TRANSMIT_DESKTOPINPUT) == USERRIGHT_NONE)
+    if((m_myuseraccount.userrights & USERRIGHT_TRANSMIT_DESKTOPINPUT) == USERRIGHT_NONE)
        return false;
 
     chan = user->GetChannel();
@@ -3947,12 +4471,50 @@ bool ClientNode::SendDesktopInput(int userid,
     if (!viewer)
         return false;
 
+    //merge with desktop input which is still waiting for previous
+    //packets to be ack'ed. Adds no delay since the packet cannot be
+    //sent before the ack arrives anyway
+    auto& tx_queue = user->GetDesktopInputTxQueue();
+    if(!tx_queue.empty() && tx_queue.back()->GetSessionID() == viewer->GetSessionID())
+    {
+        std::vector<DesktopInput> merged = tx_queue.back()->GetDesktopInput();
+        CoalesceDesktopInput(merged, inputs);
+        if(merged.size() <= DESKTOPINPUT_PACKET_MAX_INPUTS)
+        {
+            DesktopInputPacket* merge_pkt = nullptr;
+            ACE_NEW_RETURN(merge_pkt, DesktopInputPacket(GetUserID(),
+                                                         GETTIMESTAMP(),
+                                                         viewer->GetSessionID(),
+                                                         tx_queue.back()->GetPacketNo(),
+                                                         merged), false);
+            merge_pkt->SetDestUser(userid);
+            merge_pkt->SetChannel(chan->GetChannelID());
+
+            MYTRACE(ACE_TEXT("Merged desktop input into packet no %d, now %u keys\n"),
+                    (int)merge_pkt->GetPacketNo(), (unsigned)merged.size());
+            tx_queue.back() = desktopinput_pkt_t(merge_pkt);
+            return true;
+        }
+    }
+
+    int const n_tx_queue = int(tx_queue.size() + user->GetDesktopInputRtxQueue().size());
+    TTASSERT(n_tx_queue <= DESKTOPINPUT_QUEUE_MAX_SIZE);
+
+    TTASSERT(n_tx_queue == 0 ||
+            TimerExists(USER_TIMER_DESKTOPINPUT_RTX_ID, userid));
+
+    if(n_tx_queue == DESKTOPINPUT_QUEUE_MAX_SIZE)
+       return false;
+
+    std::vector<DesktopInput> coalesced;
+    CoalesceDesktopInput(coalesced, inputs);
+
     DesktopInputPacket* pkt = nullptr;
     ACE_NEW_RETURN(pkt, DesktopInputPacket(GetUserID(),
                                            GETTIMESTAMP(),
                                            viewer->GetSessionID(),
                                            user->NextDesktopInputTxPacket(),
-                                           inputs), false);
+                                           coalesced), false);
     pkt->SetDestUser(userid);
     pkt->SetChannel(chan->GetChannelID());
 
@@ -3967,7 +4529,7 @@ bool ClientNode::SendDesktopInput(int userid,
     }
 
     MYTRACE(ACE_TEXT("Queueing packet no %d with %u keys\n"),
-            (int)pkt->GetPacketNo(), (unsigned)inputs.size());
+            (int)pkt->GetPacketNo(), (unsigned)coalesced.size());
     //store for tx
     desktopinput_pkt_t const tx_pkt(rtx_pkt);
     user->GetDesktopInputTxQueue().push_back(tx_pkt);
@@ -4058,7 +4620,11 @@ bool ClientNode::Connect(bool encrypted, const ACE_INET_Addr& hosttcpaddr,
 #if defined(ENABLE_ENCRYPTION)
     if(encrypted)
     {
-        ACE_NEW_RETURN(m_crypt_stream, CryptStreamHandler(GetEventLoop()), false);
+        CryptStreamHandler* crypt_stream = nullptr;
+        ACE_NEW_RETURN(crypt_stream, CryptStreamHandler(GetEventLoop()), false);
+        if (m_sslcontext)
+            crypt_stream->SSLReset(m_sslcontext.get());
+        m_crypt_stream = crypt_stream;
         m_crypt_stream->SetListener(this);
         ACE_Synch_Options const options(ACE_Synch_Options::USE_REACTOR, ACE_Time_Value(0, 0));
         if (localtcpaddr != nullptr)
@@ -4094,6 +4660,7 @@ void ClientNode::Disconnect()
     MYTRACE(ACE_TEXT("Disconnecting #%d.\n"), GetUserID());
 
     ResetTimers();
+    m_user_changes.clear();
     
     ACE_HANDLE h = ACE_INVALID_HANDLE;
 #if defined(ENABLE_ENCRYPTION)
@@ -4152,7 +4719,12 @@ void ClientNode::Disconnect()
 
     m_serverinfo = ServerInfo();
     m_clientstats = ClientStats();
+    m_packets_fragmented = 0;
+    m_mtu_data_size = MAX_PAYLOAD_DATA_SIZE;
+    m_mtu_probe_notify = false;
+    m_mtu_probe_last = m_mtu_probe_next = ACE_Time_Value::zero;
     m_localTcpAddr = m_localUdpAddr = ACE_INET_Addr();
+    m_routeaddr = ACE_INET_Addr();
 
     MYTRACE(ACE_TEXT("Disconnected #%d.\n"), GetUserID());
 }
@@ -4236,6 +4808,7 @@ void ClientNode::LeftChannel(ClientChannel& chan)
         CloseAudioCapture();
 
     m_voice_thread.StopEncoder();
+    m_voice_bwe.Reset();
 
     // remove "self" from muxed recording
     m_channelrecord.RemoveUser(LOCAL_TX_USERID, STREAMTYPE_VOICE);
@@ -4296,6 +4869,7 @@ void ClientNode::LoggedOut()
     m_rootchannel.reset();
     //clear users
     m_users.clear();
+    m_users_table.clear();
     m_myuseraccount = UserAccount();
 
     m_flags &= ~CLIENT_AUTHORIZED;
@@ -4942,9 +5516,9 @@ ACE_SSL_Context* ClientNode::SetupEncryptionContext()
     if ((m_flags & CLIENT_CONNECTION) != 0u)
         return nullptr;
     
-    CryptStreamHandler::RemoveSSLContext(GetEventLoop());
-
-    return CryptStreamHandler::AddSSLContext(GetEventLoop());
+    // context is per instance since the event loop may be shared
+    m_sslcontext = std::make_shared<ACE_SSL_Context>();
+    return m_sslcontext.get();
 }
 #endif
 
@@ -5167,6 +5741,7 @@ bool ClientNode::ProcessCommand(const ACE_CString& cmdline)
     else if(cmd == SERVER_REMOVEUSERACCOUNT) HandleRemoveUserAccount(properties);
     else if(cmd == SERVER_FILE_ACCEPTED) HandleFileAccepted(properties);
     else if(cmd == SERVER_STATS) HandleServerStats(properties);
+    else if(cmd == SERVER_MIGRATETOKEN) HandleMigrateToken(properties);
     else
     {
         m_listener->OnCommandError(m_current_cmdid,
@@ -5198,6 +5773,7 @@ void ClientNode::HandleWelcome(const mstrings_t& properties)
         GetProperty(properties, TT_USERTIMEOUT, m_serverinfo.usertimeout);
         GetProperty(properties, TT_ACCESSTOKEN, m_serverinfo.accesstoken);
         GetProperty(properties, TT_LOGEVENTS, m_serverinfo.logevents);
+        GetProperty(properties, TT_MIGRATETOKEN, m_serverinfo.migratetoken);
 
         //start keepalive timer for TCP (if not set, then set it to half the user timeout)
         UpdateKeepAlive(GetKeepAlive());
@@ -5296,6 +5872,14 @@ void ClientNode::HandleKeepAlive(const mstrings_t& /*properties*/)
     m_clientstats.tcp_ping_dirty = false;
 }
 
+void ClientNode::HandleMigrateToken(const mstrings_t& properties)
+{
+    ASSERT_CLIENTNODE_LOCKED(this);
+
+    //server replaces token after each hello which carried it
+    GetProperty(properties, TT_MIGRATETOKEN, m_serverinfo.migratetoken);
+}
+
 void ClientNode::HandleLoggedIn(const mstrings_t& properties)
 {
     ASSERT_CLIENTNODE_LOCKED(this);
@@ -5344,6 +5928,9 @@ void ClientNode::HandleLoggedIn(const mstrings_t& properties)
         user->SetClientName(clientname);
 
     m_users[userid] = user;
+    if (std::cmp_greater_equal(userid, m_users_table.size()))
+        m_users_table.resize(userid + 1);
+    m_users_table[userid] = user;
 
     m_listener->OnUserLoggedIn(*user);
 }
@@ -5371,8 +5958,13 @@ void ClientNode::HandleLoggedOut(const mstrings_t& properties)
         //if user is admin he might have file stream coming in
         clientuser_t const user = GetUser(userid);
         if (user)
+        {
             user->ResetAllStreams();
+            m_clientstats.packets_reassembled += user->GetStatistics().packets_reassembled;
+        }
         m_users.erase(userid);
+        if (std::cmp_less(userid, m_users_table.size()))
+            m_users_table[userid] = nullptr;
 
         if (user)
             m_listener->OnUserLoggedOut(*user);
@@ -5498,7 +6090,8 @@ void ClientNode::HandleUpdateUser(const mstrings_t& properties)
     }
 
     //notify parent application
-    m_listener->OnUserUpdate(*user);
+    if (!CoalesceUserChange(userid, USERCHANGE_PROPERTIES))
+        m_listener->OnUserUpdate(*user);
 }
 
 void ClientNode::HandleRemoveUser(const mstrings_t& properties)
@@ -5957,6 +6550,8 @@ void ClientNode::HandleServerStats(const mstrings_t& properties)
     GetProperty(properties, TT_USERSPEAK, serverstats.userspeak);
     GetProperty(properties, TT_FILESTX, serverstats.files_bytessent);
     GetProperty(properties, TT_FILESRX, serverstats.files_bytesreceived);
+    GetProperty(properties, TT_VOICEFWDP50, serverstats.voice_forward_p50_usec);
+    GetProperty(properties, TT_VOICEFWDP95, serverstats.voice_forward_p95_usec);
 
     GetProperty(properties, TT_UPTIME, uptime);
     //not really stored as "start time"
@@ -29,6 +29,7 @@
 #include "AudioContainer.h"
 #include "AudioMuxer.h"
 #include "AudioThread.h"
+#include "BandwidthEstimator.h"
 #include "Client.h"
 #include "ClientChannel.h"
 #include "ClientNodeEvent.h"
@@ -46,6 +47,7 @@
 #include "codec/MediaUtil.h"
 #include "teamtalk/Commands.h"
 #include "teamtalk/Common.h"
+#include "teamtalk/LatencyHistogram.h"
 #include "teamtalk/PacketHandler.h"
 #include "teamtalk/PacketHelper.h"
 #include "teamtalk/PacketLayout.h"
@@ -64,15 +66,21 @@
 #include <cstdint>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <set>
 #include <vector>
 
 static const auto CLIENT_DESKTOPNAK_TIMEOUT          = ACE_Time_Value(4); //close a desktop session
 static const auto CLIENT_QUERY_MTU_INTERVAL          = ACE_Time_Value(0, 500000); //time between MTU query packets
+static const auto CLIENT_MTU_REPROBE_INTERVAL        = ACE_Time_Value(300); //time between automatic MTU queries
+static const auto CLIENT_MTU_LOSS_REPROBE_INTERVAL   = ACE_Time_Value(30); //min time between MTU queries caused by packet loss
 static const auto CLIENT_DESKTOPINPUT_RTX_TIMEOUT    = ACE_Time_Value(1);
 static const auto CLIENT_DESKTOPINPUT_ACK_DELAY      = ACE_Time_Value(0, 10000);
 
 constexpr auto MTU_QUERY_RETRY_COUNT = 20; //20 * 500ms = 10 seconds for MTU query (CLIENT_QUERY_MTU_INTERVAL)
+constexpr auto CLIENT_VIDEO_RTX_HISTORY_MSEC = 1000; //keep sent video packets for retransmission
+constexpr auto CLIENT_RECEIVER_REPORT_TIMEOUT_MSEC = 5000; //ignore loss reports older than this
+constexpr auto CLIENT_LATENCY_TRACE_MAX_MSEC = 10000; //ignore frame timestamps which are not capture time
 
 #if defined(_DEBUG)
 
@@ -144,6 +152,14 @@ namespace teamtalk {
         bool udp_ping_dirty = true;
         bool tcp_ping_dirty = true;
         int streamcapture_delay_msec = 0;
+        // packets sent split to fit MTU
+        ACE_INT64 packets_fragmented = 0;
+        // packets received in fragments
+        ACE_INT64 packets_reassembled = 0;
+        // latency tracing, msec from voice captured until it was
+        // encoded and until it was sent
+        ACE_INT64 voice_encoded_p50_msec = 0, voice_encoded_p95_msec = 0;
+        ACE_INT64 voice_sent_p50_msec = 0, voice_sent_p95_msec = 0;
         ClientStats() = default;
     };
 
@@ -167,6 +183,18 @@ namespace teamtalk {
 
     using filenode_t = std::shared_ptr< class FileNode >;
 
+    // Threads shared by many ClientNode instances. Empty members means
+    // each instance creates its own.
+    struct ClientSharedPools
+    {
+        // socket handling and client timers
+        reactorpool_t eventloops;
+        // voice log and muxed recording timers
+        reactorpool_t timers;
+        std::shared_ptr<EncodePool> encoders;
+        std::shared_ptr<AudioDecodePool> decoders;
+    };
+
     class ClientNode
         : public ClientNodeBase
         , public PacketListener
@@ -178,7 +206,8 @@ namespace teamtalk {
         , public FileTransferListener
     {
     public:
-        ClientNode(const ACE_TString& version, ClientListener* listener);
+        ClientNode(const ACE_TString& version, ClientListener* listener,
+                   const ClientSharedPools& shared = ClientSharedPools());
         ~ClientNode() override;
 
 #if defined(_DEBUG)
@@ -187,6 +216,7 @@ namespace teamtalk {
         
         ACE_Recursive_Thread_Mutex& LockSndprop() { return m_sndgrp_lock; }
         VoiceLogger& GetVoiceLogger() override;
+        AudioDecodePool& GetAudioDecodePool() override { return *m_decodepool; }
         AudioContainer& GetAudioContainer();
 
         //server properties
@@ -213,6 +243,7 @@ namespace teamtalk {
         bool InitSoundDuplexDevices(int inputdeviceid, int outputdeviceid);
         bool CloseSoundInputDevice();
         bool CloseSoundOutputDevice();
+        bool EnableSoundOutputMixer(bool enable);
         bool CloseSoundDuplexDevices();
         bool SoundDuplexMode() override;
         bool SetSoundDeviceEffects(const SoundDeviceEffects& effects);
@@ -257,6 +288,7 @@ namespace teamtalk {
                                           AudioFileFormat aff);
         void StopRecordingMuxedAudioFile();
         void StopRecordingMuxedAudioFile(int channelid);
+        bool SetRecordingMemoryLimit(int bytes);
         
         bool StartMTUQuery();
 
@@ -329,6 +361,14 @@ namespace teamtalk {
         //set keep alive timer intervals
         void UpdateKeepAlive(const ClientKeepAlive& keepalive);
         ClientKeepAlive GetKeepAlive();
+        //merge user state changes and updates into a single
+        //OnUserChanged() per user every 'window' (zero = disabled)
+        void SetUserEventCoalescing(const ACE_Time_Value& window);
+        bool CoalesceUserChange(int userid, uint32_t changes) override;
+        //trace latency of voice from capture to sent and from
+        //received to played. Resets the latency statistics
+        void SetLatencyTracing(bool enable);
+        bool LatencyTracing() override { return m_trace_latency; }
 
         //TimerListener - reactor thread
         int TimerEvent(ACE_UINT32 timer_event_id, long userdata) override;
@@ -348,11 +388,13 @@ namespace teamtalk {
         bool EncodedVideoCaptureFrame(ACE_Message_Block* org_frame,
                                       const char* enc_data, int enc_len,
                                       ACE_UINT32 packet_no,
-                                      ACE_UINT32 timestamp);
+                                      ACE_UINT32 timestamp,
+                                      int layer, bool key_frame);
         bool EncodedVideoFileFrame(ACE_Message_Block* org_frame,
                                    const char* enc_data, int enc_len,
                                    ACE_UINT32 packet_no,
-                                   ACE_UINT32 timestamp);
+                                   ACE_UINT32 timestamp,
+                                   int layer, bool key_frame);
 
         // SoundSystem listener - separate thread
         void StreamCaptureCb(const soundsystem::InputStreamer& streamer,
@@ -454,6 +496,7 @@ namespace teamtalk {
         void HandleAccepted(const mstrings_t& properties);
         void HandleServerUpdate(const mstrings_t& properties);
         void HandleKeepAlive(const mstrings_t& properties);
+        void HandleMigrateToken(const mstrings_t& properties);
         void HandleLoggedIn(const mstrings_t& properties);
         void HandleLoggedOut(const mstrings_t& properties);
         void HandleCmdError(const mstrings_t& properties);
@@ -487,13 +530,22 @@ namespace teamtalk {
         void LoggedOut();
 
         void RecreateUdpSocket();
+        //local IP-address of the OS's current route to the server
+        ACE_INET_Addr GetRouteLocalAddr() const;
+        //move UDP socket to network interface of 'routeaddr' and
+        //rebind it on the server
+        void MigrateUdpSocket(const ACE_INET_Addr& routeaddr);
 
         int TimerOneSecond();
         int TimerUdpKeepAlive();
         int TimerBuildDesktopPackets();
         int TimerDesktopPacketRtx();
         int TimerDesktopNakPacket();
+        int TimerDesktopCursor();
         int TimerQueryMtu(int mtu_index);
+        void StartMTUProbe(bool notify);
+        void MTUProbeCompleted();
+        int TimerUserChanges();
 
         //audio start/stop/update
         void OpenAudioCapture(const AudioCodec& codec);
@@ -503,8 +555,12 @@ namespace teamtalk {
                              ACE_Message_Block* mb_audio = nullptr);
 
         void SendVoicePacket(const VoicePacket& packet);
+        //add time since 'captured' to 'histogram'
+        void TraceVoiceLatency(LatencyHistogram& histogram, uint32_t captured);
         void SendAudioFilePacket(const AudioFilePacket& packet);
 
+        //GetUser() which avoids map lookup for logged in users
+        clientuser_t GetUserFast(int userid);
         void ReceivedHelloAckPacket(const HelloPacket& packet,
                                     const ACE_INET_Addr& addr); //called when ACK packet is received from server
         void ReceivedKeepAliveReplyPacket(const KeepAlivePacket& packet,
@@ -515,8 +571,11 @@ namespace teamtalk {
         void ReceivedDesktopAckPacket(const DesktopAckPacket& ack_pkt);
         void ReceivedDesktopNakPacket(const DesktopNakPacket& nak_pkt);
         void ReceivedDesktopCursorPacket(const DesktopCursorPacket& csr_pkt);
+        bool QueueDesktopCursor(int16_t x, int16_t y);
         void ReceivedDesktopInputPacket(const DesktopInputPacket& csr_pkt);
         void ReceivedDesktopInputAckPacket(const DesktopInputAckPacket& ack_pkt);
+        void ReceivedVideoFeedbackPacket(const VideoFeedbackPacket& fb_pkt);
+        void ReceivedReceiverReportPacket(const ReceiverReportPacket& rr_pkt);
         void CloseDesktopSession(bool stop_nak_timer);
 
         void ResetAudioPlayers();
@@ -527,8 +586,14 @@ namespace teamtalk {
         // active sound groups (shared master volume)
         ACE_Recursive_Thread_Mutex m_sndgrp_lock;
         SoundProperties m_soundprop;
+        // threads shared with other instances (if any)
+        ClientSharedPools m_shared;
+        //encoding of voice logs and muxed recordings
+        std::shared_ptr<EncodePool> m_encodepool;
         //log voice to files
         voicelogger_t m_voicelogger;
+        //decoding of audio players in mixer mode
+        std::shared_ptr<AudioDecodePool> m_decodepool;
         // audio container for getting raw audio from users
         AudioContainer m_audiocontainer;
         // muxed audio into files
@@ -541,6 +606,8 @@ namespace teamtalk {
 #if defined(ENABLE_ENCRYPTION)
         crypt_connector_t m_crypt_connector;
         CryptStreamHandler::StreamHandler_t* m_crypt_stream = nullptr;
+        // set by SetupEncryptionContext(), otherwise ACE's default
+        std::shared_ptr<ACE_SSL_Context> m_sslcontext;
 #endif
         //TCP send/receive buffer for StreamHandler
         ACE_CString m_recvbuffer, m_sendbuffer;
@@ -555,6 +622,8 @@ namespace teamtalk {
         //channels and users
         using musers_t = std::map<int, clientuser_t>;
         musers_t m_users;
+        //user-ID -> 'm_users' entry for the packet receive path
+        std::vector<clientuser_t> m_users_table;
 
         clientchannel_t m_rootchannel;
         clientchannel_t m_mychannel;
@@ -580,6 +649,8 @@ namespace teamtalk {
         //encode voice from sound input
         AudioThread m_voice_thread;
         uint8_t m_voice_stream_id = 0; //0 means not used
+        //voice receivers' loss and delay from receiver reports
+        BandwidthEstimator m_voice_bwe{CLIENT_RECEIVER_REPORT_TIMEOUT_MSEC};
         uint16_t m_voice_pkt_counter = 0;
         std::atomic<bool> m_voice_tx_closed{false}; // CLIENT_TX_VOICE was toggled (transmit next packet)
 
@@ -588,6 +659,10 @@ namespace teamtalk {
         VideoThread m_vidcap_thread;
         ACE_Message_Queue<ACE_MT_SYNCH> m_local_vidcapframes; //local RGB32 video frames
         uint8_t m_vidcap_stream_id = 0; //0 means not used
+        BandwidthEstimator m_vidcap_bwe{CLIENT_RECEIVER_REPORT_TIMEOUT_MSEC};
+        //sent video packets for retransmission. Encoder thread adds packets
+        VideoPacketHistory m_vidcap_history{CLIENT_VIDEO_RTX_HISTORY_MSEC};
+        std::mutex m_vidcap_history_mtx;
 
         //media streamer to channels
         mediafile_streamer_t m_mediafile_streamer;
@@ -612,6 +687,19 @@ namespace teamtalk {
         desktop_transmitter_t m_desktop_tx;
         desktop_nak_tx_t m_desktop_nak_tx;
         uint8_t m_desktop_session_id = 0;
+        //cursor position waiting for TIMER_DESKTOPCURSOR_ID
+        bool m_desktop_cursor_pending = false;
+        int16_t m_desktop_cursor_x = 0, m_desktop_cursor_y = 0;
+
+        //latency of own voice in usec. Encoder thread adds to
+        //'m_voice_encoded_latency'
+        std::atomic<bool> m_trace_latency{false};
+        LatencyHistogram m_voice_encoded_latency, m_voice_sent_latency;
+        std::mutex m_latency_mtx;
+
+        //user-ID -> UserChange-mask waiting for TIMER_USER_CHANGES_ID
+        std::map<int, uint32_t> m_user_changes;
+        ACE_Time_Value m_user_changes_window;
 
         //UDP packets waiting for transmission
         PacketQueue m_tx_queue;
@@ -622,11 +710,23 @@ namespace teamtalk {
 
         //local UDP sockets to use (stored in case UDP socket must be recreated)
         ACE_INET_Addr m_localTcpAddr, m_localUdpAddr;
+        //local IP-address of route to server when last checked
+        ACE_INET_Addr m_routeaddr;
 
         //query MTU (timestamp -> MTU packet)
         using mtu_packets_t = std::map<uint32_t, ka_mtu_packet_t>;
         mtu_packets_t m_mtu_packets;
-        uint16_t m_mtu_data_size = MAX_PAYLOAD_DATA_SIZE, m_mtu_max_payload_size = MAX_PACKET_PAYLOAD_SIZE;
+        //read by video encoder threads. Max payload size is always
+        //this plus FIELDHEADER_PAYLOAD so a single load gives both
+        std::atomic<uint16_t> m_mtu_data_size{MAX_PAYLOAD_DATA_SIZE};
+        //largest payload confirmed by MTU query in progress
+        uint16_t m_mtu_probe_confirmed = 0;
+        //report result of MTU query even if MTU is unchanged
+        bool m_mtu_probe_notify = false;
+        //start of last MTU query and time of next automatic MTU query
+        ACE_Time_Value m_mtu_probe_last, m_mtu_probe_next;
+        //incremented by video encoder threads
+        std::atomic<ACE_INT64> m_packets_fragmented{0};
 
         //the client's version number
         ACE_TString m_version;
@@ -37,16 +37,27 @@
 
 using namespace teamtalk;
 
-ClientNodeBase::ClientNodeBase()
-    : m_reactor(new ACE_Select_Reactor(nullptr, &m_timer_queue), true) //Ensure we don't use ACE_WFMO_Reactor!!!
+ClientNodeBase::ClientNodeBase(const reactorpool_t& eventloops/* = reactorpool_t()*/)
+    : m_reactorpool(eventloops)
 {
-    m_timer_queue.set_time_policy(&ACE_High_Res_Timer::gettimeofday_hr);
-    this->reactor(&m_reactor);
+    if (m_reactorpool)
+    {
+        m_reactor = m_reactorpool->Acquire();
+    }
+    else
+    {
+        m_own_reactor = std::make_unique<ACE_Reactor>(new ACE_Select_Reactor(nullptr, &m_timer_queue), true); //Ensure we don't use ACE_WFMO_Reactor!!!
+        m_timer_queue.set_time_policy(&ACE_High_Res_Timer::gettimeofday_hr);
+        m_reactor = m_own_reactor.get();
+    }
+    this->reactor(m_reactor);
 }
 
 ClientNodeBase::~ClientNodeBase()
 {
     assert(thr_count() == 0);
+    if (m_reactorpool)
+        m_reactorpool->Release(m_reactor);
 }
 
 int ClientNodeBase::svc()
@@ -57,12 +68,12 @@ int ClientNodeBase::svc()
     }
 
     m_reactor_thread = ACE_OS::thr_self();
-    int const ret = m_reactor.owner (ACE_OS::thr_self());
+    int const ret = m_reactor->owner (ACE_OS::thr_self());
     assert(ret >= 0);
 
     m_reactor_wait_cv.notify_all();
 
-    m_reactor.run_reactor_event_loop ();
+    m_reactor->run_reactor_event_loop ();
 
     m_reactor_thread = ACE_thread_t();
 
@@ -73,14 +84,27 @@ int ClientNodeBase::svc()
 
 bool ClientNodeBase::CanSuspend()
 {
-    return m_reactor_thread == ACE_OS::thr_self();
+    // a shared event loop also runs other instances
+    return !m_reactorpool && m_reactor_thread == ACE_OS::thr_self();
 }
 
 void ClientNodeBase::SuspendEventHandling(bool quit)
 {
+    if (m_reactorpool)
+    {
+        // only this instance's timers can be stopped. Holding the
+        // reactor lock ensures none of them are running
+        TTASSERT(quit);
+        GUARD_REACTOR(this);
+        wguard_t const gt(LockTimers());
+        ResetTimers();
+        MYTRACE(ACE_TEXT("ClientNodeBase detached from shared event loop.\n"));
+        return;
+    }
+
     MYTRACE( (ACE_TEXT("ClientNodeBase reactor thread suspending.\n")) );
 
-    m_reactor.end_reactor_event_loop();
+    m_reactor->end_reactor_event_loop();
 
     // don't wait for thread to die if SuspendEventHandling() is called from reactor loop
     assert(quit || m_reactor_thread == ACE_OS::thr_self());
@@ -92,10 +116,14 @@ void ClientNodeBase::SuspendEventHandling(bool quit)
 
 void ClientNodeBase::ResumeEventHandling()
 {
+    // shared event loop is always running
+    if (m_reactorpool)
+        return;
+
     MYTRACE( (ACE_TEXT("ClientNodeBase reactor thread activating.\n")) );
 
     ACE_thread_t thr_id = ACE_thread_t();
-    m_reactor.owner(&thr_id);
+    m_reactor->owner(&thr_id);
     if(thr_id != ACE_OS::thr_self())
     {
         MYTRACE( (ACE_TEXT("ClientNodeBase reactor thread waiting.\n")) );
@@ -103,7 +131,7 @@ void ClientNodeBase::ResumeEventHandling()
     }
     assert(m_reactor_thread == ACE_thread_t());
 
-    m_reactor.reset_reactor_event_loop();
+    m_reactor->reset_reactor_event_loop();
 
     std::unique_lock<std::mutex> lck(m_reactor_wait_mtx);
     int const ret = this->activate();
@@ -126,7 +154,7 @@ ACE_Lock& ClientNodeBase::ReactorLock()
     // {
     //     MYTRACE("Reactor lock obtained by %p\n", ACE_OS::thr_self());
     // }
-    return m_reactor.lock();
+    return m_reactor->lock();
 }
 
 long ClientNodeBase::StartTimer(uint32_t timer_id, long userdata,
@@ -148,7 +176,7 @@ long ClientNodeBase::StartTimer(uint32_t timer_id, long userdata,
         m_timers[timer_id] = th; //put in before schedule because timeout might be 0
     }
 
-    long const reactor_timerid = m_reactor.schedule_timer(th, nullptr, delay, interval);
+    long const reactor_timerid = m_reactor->schedule_timer(th, nullptr, delay, interval);
     TTASSERT(reactor_timerid>=0);
     if(reactor_timerid<0)
     {
@@ -172,7 +200,7 @@ bool ClientNodeBase::StopTimer(uint32_t timer_id)
         m_timers.erase(ii);
         g.release(); //don't hold reactor lock when cancelling
 
-        if(m_reactor.cancel_timer(th, 0) != -1)
+        if(m_reactor->cancel_timer(th, 0) != -1)
             return true;
     }
     return false;
@@ -190,7 +218,7 @@ void ClientNodeBase::ResetTimers()
 {
     while (!m_timers.empty())
     {
-        m_reactor.cancel_timer(m_timers.begin()->second, 0);
+        m_reactor->cancel_timer(m_timers.begin()->second, 0);
         m_timers.erase(m_timers.begin());
     }
 }
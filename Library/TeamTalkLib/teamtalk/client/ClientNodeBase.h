@@ -24,6 +24,7 @@
 #if !defined(CLIENTNODEBASE_H)
 #define CLIENTNODEBASE_H
 
+#include "ReactorPool.h"
 #include "VoiceLogger.h"
 #include "avstream/SoundSystem.h"
 #include "codec/MediaUtil.h"
@@ -42,6 +43,7 @@
 
 #include <condition_variable>
 #include <cstdint>
+#include <memory>
 #include <mutex>
 
 constexpr auto TIMERID_MASK             = 0x0000FFFF;
@@ -69,6 +71,8 @@ namespace teamtalk {
         TIMER_STOP_AUDIOINPUT                   = 12,
         TIMER_REMOVE_LOCALPLAYBACK              = 13,
         TIMER_STOP_STREAM_MEDIAFILE_ID          = 14,
+        TIMER_DESKTOPCURSOR_ID                  = 15, //send coalesced desktop cursor position
+        TIMER_USER_CHANGES_ID                   = 16, //notify coalesced user changes
 
         //User instance timers (termination not handled by ClientNode::StopTimer())
         USER_TIMER_MASK                         = USER_TIMER_START,
@@ -84,10 +88,20 @@ namespace teamtalk {
         USER_TIMER_JITTER_BUFFER_ID             = USER_TIMER_MASK + 11,
     };
 
+    // Changes accumulated per user when user events are coalesced
+    enum UserChange
+    {
+        USERCHANGE_NONE         = 0x0,
+        USERCHANGE_STATE        = 0x1, // ClientUser's streams (talking, video, etc.)
+        USERCHANGE_PROPERTIES   = 0x2, // server update of user (nickname, status, etc.)
+    };
+
     struct SoundProperties
     {
         int inputdeviceid = SOUNDDEVICE_IGNORE_ID;
         int outputdeviceid = SOUNDDEVICE_IGNORE_ID;
+        // mix all users' audio players in a single output stream
+        bool outputmixer = false;
         //sound group for current instance
         int soundgroupid = 0;
         // AGC, AEC and denoise settings
@@ -131,8 +145,12 @@ namespace teamtalk {
 
         //timer queue we can change to high-resolution timer (monotomic)
         ACE_Timer_Heap m_timer_queue;
+        //reactor owned by this client instance (unless 'm_reactorpool')
+        std::unique_ptr<ACE_Reactor> m_own_reactor;
+        //shared event loop. The reactor is also used by other instances
+        reactorpool_t m_reactorpool;
         //the reactor associated with this client instance
-        ACE_Reactor m_reactor;
+        ACE_Reactor* m_reactor = nullptr;
         ACE_thread_t m_reactor_thread = ACE_thread_t();
 
         // sync reactor thread start/stop
@@ -159,7 +177,9 @@ namespace teamtalk {
 
     public:
 
-        ClientNodeBase();
+        // 'eventloops' set means the instance's events are handled by a
+        // reactor shared with other instances instead of its own thread
+        ClientNodeBase(const reactorpool_t& eventloops = reactorpool_t());
         ~ClientNodeBase() override;
 
         bool CanSuspend() override;
@@ -182,6 +202,14 @@ namespace teamtalk {
         virtual bool TimerExists(uint32_t timer_id);
         virtual bool TimerExists(uint32_t timer_id, int userid);
 
+        // Merge 'changes' (UserChange) of user into next coalesced
+        // notification. Returns false if user events are not coalesced,
+        // i.e. caller must notify immediately.
+        virtual bool CoalesceUserChange(int /*userid*/, uint32_t /*changes*/) { return false; }
+
+        // Whether latency of voice streams is traced
+        virtual bool LatencyTracing() { return false; }
+
         // Whether sound system is running is duplex mode, soundsystem::OpenDuplexStream()
         virtual bool SoundDuplexMode() = 0;
 
@@ -194,6 +222,8 @@ namespace teamtalk {
         virtual bool QueuePacket(FieldPacket* packet) = 0;
         // Get logger for writing audio streams to disk (wav, ogg, etc)
         virtual class VoiceLogger& GetVoiceLogger() = 0;
+        // Get worker threads for decoding audio players in mixer mode
+        virtual class AudioDecodePool& GetAudioDecodePool() = 0;
 
         // Callback function for teamtalk::AudioPlayer-class
         virtual void AudioUserCallback(int userid, StreamType st,
@@ -94,6 +94,8 @@ namespace teamtalk {
 
         virtual void OnUserFirstStreamVoicePacket(const teamtalk::ClientUser& user, int streamid) = 0;
         virtual void OnUserStateChange(const teamtalk::ClientUser& user) = 0;
+        // Coalesced OnUserStateChange() and OnUserUpdate(). 'changes' is UserChange-mask
+        virtual void OnUserChanged(const teamtalk::ClientUser& user, uint32_t changes) = 0;
         virtual void OnUserVideoCaptureFrame(int userid, int stream_id) = 0;
         virtual void OnUserMediaFileVideoFrame(int userid, int stream_id) = 0;
 
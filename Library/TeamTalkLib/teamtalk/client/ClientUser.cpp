@@ -334,10 +334,19 @@ int ClientUser::TimerMonitorVoicePlayback()
     bool const changed = talking != IsAudioActive(STREAMTYPE_VOICE);
     m_voice_active = talking;
     if(changed)
-        m_listener->OnUserStateChange(*this);
+        NotifyStateChange();
 
     m_stats.voicepackets_recv += m_voice_player->GetNumAudioPacketsRecv(true);
     m_stats.voicepackets_lost += m_voice_player->GetNumAudioPacketsLost(true);
+    m_stats.voice_playout_delay_msec = m_voice_player->GetPlayoutDelayMSec();
+    m_stats.voice_playout_accelerated += m_voice_player->GetNumAccelerated(true);
+    m_stats.voice_playout_expanded += m_voice_player->GetNumExpanded(true);
+    m_stats.voicepackets_recovered += m_voice_player->GetNumAudioPacketsRecovered(true);
+    m_stats.voicepackets_concealed += m_voice_player->GetNumAudioPacketsConcealed(true);
+    m_stats.packets_reassembled += m_voice_player->GetNumAudioPacketsReassembled(true);
+
+    if (talking && W32_GEQ(GETTIMESTAMP(), m_report_time + RECEIVER_REPORT_MSEC))
+        SendReceiverReport();
 
     //MYTRACE_COND(n_blocks, ACE_TEXT("User #%d has %d new voice block at %u\n"), GetUserID(), n_blocks, GETTIMESTAMP());
 
@@ -353,6 +362,91 @@ int ClientUser::TimerMonitorVoicePlayback()
     return 0;
 }
 
+const ClientUserStats& ClientUser::GetStatistics()
+{
+    if (m_clientnode->LatencyTracing())
+    {
+        CollectVoiceLatency();
+        m_stats.voice_buffered_p50_msec = m_voice_buffered_latency.Percentile(0.5) / 1000;
+        m_stats.voice_buffered_p95_msec = m_voice_buffered_latency.Percentile(0.95) / 1000;
+        m_stats.voice_played_p50_msec = m_voice_played_latency.Percentile(0.5) / 1000;
+        m_stats.voice_played_p95_msec = m_voice_played_latency.Percentile(0.95) / 1000;
+    }
+    return m_stats;
+}
+
+void ClientUser::SetLatencyTracing(bool enable)
+{
+    m_voice_buffered_latency.Reset();
+    m_voice_played_latency.Reset();
+    m_stats.voice_buffered_p50_msec = m_stats.voice_buffered_p95_msec = 0;
+    m_stats.voice_played_p50_msec = m_stats.voice_played_p95_msec = 0;
+    if (m_voice_player)
+        m_voice_player->SetLatencyTracing(enable);
+}
+
+void ClientUser::CollectVoiceLatency()
+{
+    if (m_voice_player)
+        m_voice_player->CollectLatency(m_voice_buffered_latency, m_voice_played_latency);
+}
+
+void ClientUser::SendReceiverReport()
+{
+    clientchannel_t const chan = GetChannel();
+    if (!chan)
+        return;
+
+    m_report_time = GETTIMESTAMP();
+    ReceiverReport report;
+
+    //only OPUS senders can adapt to the reported loss
+    if (m_voice_player && m_voice_player->GetAudioCodec().codec == CODEC_OPUS)
+    {
+        ACE_INT64 const recv = m_stats.voicepackets_recv - m_voice_report_recv;
+        ACE_INT64 const lost = m_stats.voicepackets_lost - m_voice_report_lost;
+        m_voice_report_recv = m_stats.voicepackets_recv;
+        m_voice_report_lost = m_stats.voicepackets_lost;
+        if (recv + lost > 0)
+        {
+            report.stream_id = uint8_t(m_voice_player->GetStreamID());
+            report.packets_recv = uint16_t(std::min<ACE_INT64>(recv, 0xFFFF));
+            report.packets_lost = uint16_t(std::min<ACE_INT64>(lost, 0xFFFF));
+            report.jitter_msec = uint16_t(std::min(m_voice_arrival.GetJitterMSec(), 0xFFFF));
+            report.delay_gradient_msec = int16_t(std::clamp(m_voice_arrival.GetDelayGradientMSec(), -0x8000, 0x7FFF));
+        }
+    }
+
+#if defined(ENABLE_VPX)
+    if (m_vidcap_player)
+    {
+        ACE_INT64 const recv = m_stats.vidcapframes_recv - m_vidcap_report_recv;
+        ACE_INT64 const lost = m_stats.vidcapframes_lost - m_vidcap_report_lost;
+        m_vidcap_report_recv = m_stats.vidcapframes_recv;
+        m_vidcap_report_lost = m_stats.vidcapframes_lost;
+        if (recv + lost > 0)
+        {
+            report.video_stream_id = uint8_t(m_vidcap_player->GetStreamID());
+            report.video_frames_recv = uint16_t(std::min<ACE_INT64>(recv, 0xFFFF));
+            report.video_frames_lost = uint16_t(std::min<ACE_INT64>(lost, 0xFFFF));
+            report.video_delay_gradient_msec = int16_t(std::clamp(m_vidcap_arrival.GetDelayGradientMSec(), -0x8000, 0x7FFF));
+        }
+    }
+#endif
+
+    if (report.stream_id == 0 && report.video_stream_id == 0)
+        return;
+
+    ReceiverReportPacket* report_packet = nullptr;
+    ACE_NEW(report_packet, ReceiverReportPacket(m_clientnode->GetUserID(),
+                                                GETTIMESTAMP(), GetUserID(),
+                                                report));
+    report_packet->SetChannel(chan->GetChannelID());
+
+    if(!m_clientnode->QueuePacket(report_packet))
+        delete report_packet;
+}
+
 int ClientUser::TimerMonitorAudioFilePlayback()
 {
     if (!m_audiofile_player)
@@ -362,10 +456,11 @@ int ClientUser::TimerMonitorAudioFilePlayback()
     bool const changed = active != IsAudioActive(STREAMTYPE_MEDIAFILE_AUDIO);
     m_audiofile_active = active;
     if(changed)
-        m_listener->OnUserStateChange(*this);
+        NotifyStateChange();
 
     m_stats.mediafile_audiopackets_recv += m_audiofile_player->GetNumAudioPacketsRecv(true);
     m_stats.mediafile_audiopackets_lost += m_audiofile_player->GetNumAudioPacketsLost(true);
+    m_stats.packets_reassembled += m_audiofile_player->GetNumAudioPacketsReassembled(true);
 
     //check if player should be reset
     if((m_audiofile_player->GetLastPlaytime() != 0u) &&
@@ -469,6 +564,8 @@ void ClientUser::AddVoicePacket(const VoicePacket& audpkt,
     //store time of packet for later use
     UpdateLastTimeStamp(audpkt);
 
+    m_voice_arrival.PacketReceived(audpkt.GetTime(), GETTIMESTAMP());
+
     if (!m_voice_player)
         LaunchVoicePlayer(chan->GetAudioCodec(), sndprop);
     if (!m_voice_player)
@@ -606,22 +703,44 @@ void ClientUser::AddVideoCapturePacket(const VideoCapturePacket& p,
     UpdateLastTimeStamp(p);
 
 #if defined(ENABLE_VPX)
+    m_vidcap_arrival.PacketReceived(p.GetTime(), GETTIMESTAMP());
+
+    //the server normally forwards a single simulcast layer, but
+    //older servers forward all layers, so ignore layers which are
+    //not requested and only change layer (resolution) on a key frame.
+    //Like the server keep the current layer until then
+    int layer = 0, layers = 0;
+    bool key_frame = false;
+    p.GetSimulcast(layer, layers, key_frame);
+    m_vidcap_layers = layers;
+    int const wanted = LocalSubscribes(SUBSCRIBE_VIDEOCAPTURE_LOWRES) ? std::max(layers - 1, 0) : 0;
+    bool const current = m_vidcap_player &&
+        p.GetStreamID() == m_vidcap_player->GetStreamID() &&
+        layer == m_vidcap_layer;
+    if (layer != wanted && !current)
+        return;
+    uint16_t w, h;
+    bool const layer_start = key_frame && p.GetVideoInfo(w, h);
+
     bool new_vidframe = false;
-    if (m_vidcap_player &&
-       p.GetStreamID() == m_vidcap_player->GetStreamID())
+    if (current)
     {
         new_vidframe = m_vidcap_player->AddPacket(p);
     }
-    else if ((m_vidcap_player &&
-             p.GetStreamID() != m_vidcap_player->GetStreamID() &&
-             W32_GEQ(p.GetTime(), GetLastTimeStamp(p))) ||
-            (!m_vidcap_player && W32_GEQ(p.GetTime(), GetLastTimeStamp(p))))
+    else if (m_vidcap_player &&
+             p.GetStreamID() == m_vidcap_player->GetStreamID() &&
+             !layer_start)
+    {
+        return;
+    }
+    else if (W32_GEQ(p.GetTime(), GetLastTimeStamp(p)))
     {
         WebMPlayer* webm_player = nullptr;
         ACE_NEW(webm_player, WebMPlayer(GetUserID(), p.GetStreamID()));
         m_vidcap_player = webm_player_t(webm_player);
+        m_vidcap_layer = layer;
         new_vidframe = m_vidcap_player->AddPacket(p);
-        m_listener->OnUserStateChange(*this);
+        NotifyStateChange();
     }
     else
     {
@@ -635,6 +754,27 @@ void ClientUser::AddVideoCapturePacket(const VideoCapturePacket& p,
     m_stats.vidcapframes_recv += m_vidcap_player->GetVideoFramesRecv(true);
     m_stats.vidcapframes_dropped += m_vidcap_player->GetVideoFramesDropped(true);
     m_stats.vidcapframes_lost += m_vidcap_player->GetVideoFramesLost(true);
+    m_stats.packets_reassembled += m_vidcap_player->GetVideoFramesReassembled(true);
+
+    //report loss and delay so sender can adapt its bitrate
+    if (W32_GEQ(GETTIMESTAMP(), m_report_time + RECEIVER_REPORT_MSEC))
+        SendReceiverReport();
+
+    //ask sender for key frame or retransmission of lost packets
+    bool keyframe_request = false;
+    video_nacks_t nacks;
+    if (m_vidcap_player->GetVideoFeedback(keyframe_request, nacks))
+    {
+        VideoFeedbackPacket* feedback_packet = nullptr;
+        ACE_NEW(feedback_packet, VideoFeedbackPacket(m_clientnode->GetUserID(),
+                                                     GETTIMESTAMP(), GetUserID(),
+                                                     p.GetStreamID(), m_vidcap_layer,
+                                                     keyframe_request, nacks));
+        feedback_packet->SetChannel(p.GetChannel());
+
+        if(!m_clientnode->QueuePacket(feedback_packet))
+            delete feedback_packet;
+    }
 #endif
 }
 
@@ -673,7 +813,7 @@ void ClientUser::AddVideoFilePacket(const VideoFilePacket& p,
         new_vidframe = m_videofile_player->AddPacket(p);
         stream_id = m_videofile_player->GetStreamID();
 
-        m_listener->OnUserStateChange(*this);
+        NotifyStateChange();
 
         if(!m_clientnode->TimerExists(USER_TIMER_MEDIAFILE_VIDEO_PLAYBACK_ID, GetUserID()))
         {
@@ -712,6 +852,7 @@ void ClientUser::AddVideoFilePacket(const VideoFilePacket& p,
     m_stats.mediafile_video_frames_recv += m_videofile_player->GetVideoFramesRecv(true);
     m_stats.mediafile_video_frames_dropped += m_videofile_player->GetVideoFramesDropped(true);
     m_stats.mediafile_video_frames_lost += m_videofile_player->GetVideoFramesLost(true);
+    m_stats.packets_reassembled += m_videofile_player->GetVideoFramesReassembled(true);
 #endif
 }
 
@@ -799,7 +940,7 @@ void ClientUser::AddPacket(const DesktopPacket& p, const ClientChannel& chan)
         m_desktop_queue.clear();
 
         //new desktop session
-        m_listener->OnUserStateChange(*this);
+        NotifyStateChange();
     }
 
     if(m_desktop->GetSessionID() != p.GetSessionID())
@@ -1114,6 +1255,20 @@ void ClientUser::SetJitterControl(const StreamType stream_type, const JitterCont
         return;
 
     m_jitter_calculator.SetConfig(config);
+    UpdatePlayoutDelay();
+}
+
+void ClientUser::UpdatePlayoutDelay()
+{
+    if (!m_voice_player)
+        return;
+
+    //adaptive playout must not go below the configured fixed delay
+    JitterControlConfig config;
+    m_jitter_calculator.GetConfig(config);
+    int const max_msec = (config.useAdativeDejitter && config.maxAdaptiveDelayMSec > 0) ?
+        config.fixedDelayMSec + config.maxAdaptiveDelayMSec : 0;
+    m_voice_player->SetPlayoutDelay(config.fixedDelayMSec, max_msec);
 }
 
 bool ClientUser::GetJitterControl(const StreamType stream_type, JitterControlConfig& config)
@@ -1314,12 +1469,14 @@ void ClientUser::ResetVoicePlayer()
         bool const b = m_soundsystem->CloseOutputStream(m_voice_player.get());
         assert(b);
     }
+    m_clientnode->GetAudioDecodePool().RemovePlayer(m_voice_player.get());
 
+    CollectVoiceLatency();
     m_voice_player.reset();
     m_voice_active = false;
 
     if(talking)
-        m_listener->OnUserStateChange(*this);
+        NotifyStateChange();
 
     //reset existing voice log
     if(!GetAudioFolder().empty())
@@ -1346,11 +1503,12 @@ void ClientUser::ResetAudioFilePlayer()
         bool const b = m_soundsystem->CloseOutputStream(m_audiofile_player.get());
         assert(b);
     }
+    m_clientnode->GetAudioDecodePool().RemovePlayer(m_audiofile_player.get());
     m_audiofile_player.reset();
     m_audiofile_active = false;
 
     if(active)
-        m_listener->OnUserStateChange(*this);
+        NotifyStateChange();
 
     MYTRACE(ACE_TEXT("Shutdown media file player for %s\n"), GetNickname().c_str());
 }
@@ -1408,6 +1566,12 @@ audio_player_t ClientUser::LaunchAudioPlayer(const teamtalk::AudioCodec& codec,
         output_samples = codec_samples;
     }
 
+    // in mixer mode all audio players are pulled by the callback of
+    // a single shared output stream
+    int outputdeviceid = sndprop.outputdeviceid;
+    if (sndprop.outputmixer)
+        outputdeviceid |= SOUND_DEVICE_SHARED_FLAG;
+
     auto audiofunc = [this](auto && PH1, auto && PH2, auto && PH3) { m_clientnode->AudioUserCallback(std::forward<decltype(PH1)>(PH1), std::forward<decltype(PH2)>(PH2), std::forward<decltype(PH3)>(PH3)); };
 
     AudioPlayer* audio_player = nullptr;
@@ -1462,7 +1626,7 @@ audio_player_t ClientUser::LaunchAudioPlayer(const teamtalk::AudioCodec& codec,
     {
         MYTRACE(ACE_TEXT("Launching player for #%d \"%s\", SampleRate %d, Channels %d, Callback %d\n"),
                 GetUserID(), GetNickname().c_str(), output_samplerate, output_channels, output_samples);
-        success = m_soundsystem->OpenOutputStream(audio_player, sndprop.outputdeviceid,
+        success = m_soundsystem->OpenOutputStream(audio_player, outputdeviceid,
                                                   sndprop.soundgroupid, output_samplerate,
                                                   output_channels, output_samples);
     }
@@ -1471,6 +1635,11 @@ audio_player_t ClientUser::LaunchAudioPlayer(const teamtalk::AudioCodec& codec,
     
     if (success)
     {
+        // the mixer's stream callback should only mix so decoding is
+        // done ahead by worker threads
+        if (sndprop.outputmixer && !m_snd_duplexmode)
+            m_clientnode->GetAudioDecodePool().AddPlayer(ret);
+
         // don't make sense to use auto position on duplex but just ignore return value
         m_soundsystem->SetAutoPositioning(audio_player, true);
         if (m_soundsystem->IsAutoPositioning(sndprop.soundgroupid))
@@ -1499,6 +1668,8 @@ bool ClientUser::LaunchVoicePlayer(const teamtalk::AudioCodec& codec,
 
     SetDirtyProps();
     m_voice_player->SetAudioBufferSize(GetAudioStreamBufferSize(STREAMTYPE_VOICE));
+    m_voice_player->SetLatencyTracing(m_clientnode->LatencyTracing());
+    UpdatePlayoutDelay();
 
     //start timer to monitor when to stop stream
     if(!m_clientnode->TimerExists(USER_TIMER_VOICE_PLAYBACK_ID, GetUserID()))
@@ -1564,8 +1735,13 @@ void ClientUser::SetDirtyProps()
     SetStereo(STREAMTYPE_MEDIAFILE_AUDIO, (m_audiofile_stereo & STEREO_LEFT) != 0, (m_audiofile_stereo & STEREO_RIGHT) != 0);
 }
 
+void ClientUser::NotifyStateChange()
+{
+    if (!m_clientnode->CoalesceUserChange(GetUserID(), USERCHANGE_STATE))
+        m_listener->OnUserStateChange(*this);
+}
 
-ACE_Message_Block* ClientUser::GetVideoCaptureFrame()
+ACE_Message_Block* ClientUser::GetVideoCaptureFrame(media::FourCC fourcc)
 {
 #if defined(ENABLE_VPX)
     if (m_vidcap_player)
@@ -1581,9 +1757,10 @@ ACE_Message_Block* ClientUser::GetVideoCaptureFrame()
 
         //    return m_vidcap_player->GetNextFrame();
         //}
-        return m_vidcap_player->GetNextFrame();
+        return m_vidcap_player->GetNextFrame(nullptr, fourcc);
     }
 #endif /* ENABLE_VPX */
+    ACE_UNUSED_ARG(fourcc);
     return nullptr;
 }
 
@@ -1609,7 +1786,7 @@ void ClientUser::CloseVideoCapturePlayer()
     if(notify)
     {
         m_listener->OnUserVideoCaptureFrame(GetUserID(), 0);
-        m_listener->OnUserStateChange(*this);
+        NotifyStateChange();
     }
 #endif
 }
@@ -1654,7 +1831,7 @@ void ClientUser::CloseVideoFilePlayer()
     if(notify)
     {
         m_listener->OnUserMediaFileVideoFrame(GetUserID(), 0);
-        m_listener->OnUserStateChange(*this);
+        NotifyStateChange();
     }
 #endif /* ENABLE_VPX */
 }
@@ -1706,7 +1883,7 @@ void ClientUser::CloseDesktopSession()
     if(notify)
     {
         m_listener->OnUserDesktopWindow(GetUserID(), 0);
-        m_listener->OnUserStateChange(*this);
+        NotifyStateChange();
     }
 }
 
@@ -1725,7 +1902,29 @@ void ClientUser::ResetDesktopInputTx()
 
 void ClientUser::SetLocalSubscriptions(Subscriptions mask)
 {
+#if defined(ENABLE_VPX)
+    bool const lowres_changed = ((m_localsubscriptions ^ mask) & SUBSCRIBE_VIDEOCAPTURE_LOWRES) != 0u;
+#endif
     m_localsubscriptions = mask;
+
+#if defined(ENABLE_VPX)
+    //ask for a key frame of the new layer, otherwise the video
+    //freezes until the sender's next periodic key frame
+    clientchannel_t const chan = GetChannel();
+    if (lowres_changed && m_vidcap_player && m_vidcap_layers > 1 && chan)
+    {
+        int const wanted = LocalSubscribes(SUBSCRIBE_VIDEOCAPTURE_LOWRES) ? m_vidcap_layers - 1 : 0;
+        VideoFeedbackPacket* feedback_packet = nullptr;
+        ACE_NEW(feedback_packet, VideoFeedbackPacket(m_clientnode->GetUserID(),
+                                                     GETTIMESTAMP(), GetUserID(),
+                                                     m_vidcap_player->GetStreamID(), wanted,
+                                                     true, video_nacks_t()));
+        feedback_packet->SetChannel(chan->GetChannelID());
+
+        if(!m_clientnode->QueuePacket(feedback_packet))
+            delete feedback_packet;
+    }
+#endif
 }
 
 bool ClientUser::LocalSubscribes(const FieldPacket& packet) const
@@ -24,6 +24,7 @@
 #if !defined(CLIENTUSER_H)
 #define CLIENTUSER_H
 
+#include "BandwidthEstimator.h"
 #include "ClientChannel.h"
 #include "DesktopShare.h"
 #include "StreamPlayers.h"
@@ -46,8 +47,10 @@
 
 constexpr auto DESKTOPINPUT_QUEUE_MAX_SIZE = 100;
 constexpr auto DESKTOPINPUT_MAX_RTX_PACKETS = 16;
+constexpr auto DESKTOPINPUT_PACKET_MAX_INPUTS = 64; //inputs merged into a single packet (fits MTU)
 
 constexpr auto VOICE_BUFFER_MSEC            = 1000;
+constexpr auto RECEIVER_REPORT_MSEC         = 1000; //report voice/video loss and delay to sender
 constexpr auto MEDIAFILE_BUFFER_MSEC        = 20000;
 
 namespace teamtalk {
@@ -96,6 +99,15 @@ namespace teamtalk {
     {
         ACE_INT64 voicepackets_recv = 0;
         ACE_INT64 voicepackets_lost = 0;
+        ACE_INT64 voicepackets_recovered = 0;
+        ACE_INT64 voicepackets_concealed = 0;
+        ACE_INT64 voice_playout_delay_msec = 0;
+        ACE_INT64 voice_playout_accelerated = 0;
+        ACE_INT64 voice_playout_expanded = 0;
+        // latency tracing, msec from voice packet received until it
+        // left the jitter buffer and until it was played
+        ACE_INT64 voice_buffered_p50_msec = 0, voice_buffered_p95_msec = 0;
+        ACE_INT64 voice_played_p50_msec = 0, voice_played_p95_msec = 0;
 
         ACE_INT64 vidcappackets_recv = 0;
         ACE_INT64 vidcapframes_recv = 0;
@@ -110,6 +122,9 @@ namespace teamtalk {
         ACE_INT64 mediafile_video_frames_lost = 0;
         ACE_INT64 mediafile_video_frames_dropped = 0;
 
+        // audio packets and video frames received in fragments
+        ACE_INT64 packets_reassembled = 0;
+
         ClientUserStats() = default;
     };
 
@@ -166,7 +181,10 @@ namespace teamtalk {
 
         void FeedVoicePacketToPlayer(const VoicePacket& audpkt);
 
-        const ClientUserStats& GetStatistics() const { return m_stats; }
+        const ClientUserStats& GetStatistics();
+        // start/stop tracing latency of voice playback and reset
+        // the latency statistics
+        void SetLatencyTracing(bool enable);
 
         bool IsAudioActive(StreamType stream_type) const;
 
@@ -179,6 +197,7 @@ namespace teamtalk {
         void SetJitterControl(StreamType stream_type, const JitterControlConfig& config);
         bool GetJitterControl(StreamType stream_type, JitterControlConfig& config);
         int32_t GetActiveAdaptiveJitterDelayVoice() const { return m_jitter_calculator.GetActiveAdaptiveJitterDelay(); }
+        void UpdatePlayoutDelay();
 
         void SetVolume(StreamType stream_type, int volume);
         int GetVolume(StreamType stream_type) const;
@@ -198,7 +217,8 @@ namespace teamtalk {
         void ResetVoicePlayer();
         void ResetAudioFilePlayer();
 
-        ACE_Message_Block* GetVideoCaptureFrame();
+        //'fourcc' is either FOURCC_RGB32 or FOURCC_I420
+        ACE_Message_Block* GetVideoCaptureFrame(media::FourCC fourcc = media::FOURCC_RGB32);
         bool GetVideoCaptureCodec(VideoCodec& codec) const;
         void CloseVideoCapturePlayer();
 
@@ -243,6 +263,8 @@ namespace teamtalk {
 
 
     private:
+        void SendReceiverReport();
+        void CollectVoiceLatency();
         audio_player_t LaunchAudioPlayer(const teamtalk::AudioCodec& codec,
                                          const struct SoundProperties& sndprop,
                                          StreamType stream_type);
@@ -252,6 +274,8 @@ namespace teamtalk {
                                    const struct SoundProperties& sndprop);
 
         void SetDirtyProps();
+        // notify listener that user's state changed, possibly coalesced
+        void NotifyStateChange();
 
         ClientNodeBase* m_clientnode = nullptr;
         ClientListener* m_listener = nullptr;
@@ -271,10 +295,24 @@ namespace teamtalk {
         int m_voice_buf_msec = VOICE_BUFFER_MSEC;
         JitterCalculator m_jitter_calculator;
         std::queue<audiopacket_t> m_jitterbuffer;
+        //time of last receiver report to sender of voice/video
+        uint32_t m_report_time = 0;
+        //voice packets received/lost at last receiver report
+        ACE_INT64 m_voice_report_recv = 0, m_voice_report_lost = 0;
+        ArrivalMonitor m_voice_arrival;
+        //latency traced by 'm_voice_player' in usec
+        LatencyHistogram m_voice_buffered_latency, m_voice_played_latency;
 
         //video playback
 #if defined(ENABLE_VPX)
         webm_player_t m_vidcap_player;
+        //simulcast layer decoded by 'm_vidcap_player'
+        int m_vidcap_layer = 0;
+        //simulcast layers in the user's video stream
+        int m_vidcap_layers = 0;
+        //video frames received/lost at last receiver report
+        ACE_INT64 m_vidcap_report_recv = 0, m_vidcap_report_lost = 0;
+        ArrivalMonitor m_vidcap_arrival;
 #endif
 
         //audio file playback
@@ -0,0 +1,153 @@
+/*
+ * Copyright (c) 2005-2018, BearWare.dk
+ * 
+ * Contact Information:
+ *
+ * Bjoern D. Rasmussen
+ * Kirketoften 5
+ * DK-8260 Viby J
+ * Denmark
+ * Email: contact@bearware.dk
+ * Phone: +45 20 20 54 59
+ * Web: http://www.bearware.dk
+ *
+ * This source code is part of the TeamTalk SDK owned by
+ * BearWare.dk. Use of this file, or its compiled unit, requires a
+ * TeamTalk SDK License Key issued by BearWare.dk.
+ *
+ * The TeamTalk SDK License Agreement along with its Terms and
+ * Conditions are outlined in the file License.txt included with the
+ * TeamTalk SDK distribution.
+ *
+ */
+
+
+#include "EncodePool.h"
+
+#include "teamtalk/TTAssert.h"
+
+#include <algorithm>
+#include <utility>
+
+constexpr auto ENCODEPOOL_MAX_WORKERS = 4;
+constexpr auto ENCODEPOOL_DEFAULT_MEMORY_LIMIT = 64 * 1024 * 1024;
+
+namespace teamtalk {
+
+EncodePool::EncodePool(int workers/* = 0*/)
+: m_memory_limit(ENCODEPOOL_DEFAULT_MEMORY_LIMIT)
+, m_workers_count(workers)
+{
+    if (m_workers_count <= 0)
+        m_workers_count = std::clamp(int(std::thread::hardware_concurrency() / 2), 1, ENCODEPOOL_MAX_WORKERS);
+}
+
+EncodePool::~EncodePool()
+{
+    {
+        std::lock_guard<std::mutex> const g(m_mutex);
+        m_stop = true;
+    }
+    for (auto& worker : m_workers)
+    {
+        worker->signal.notify_one();
+        worker->thread.join();
+        TTASSERT(worker->jobs.empty());
+    }
+}
+
+int EncodePool::NewStrand()
+{
+    std::lock_guard<std::mutex> const g(m_mutex);
+    return m_next_strand++;
+}
+
+void EncodePool::Submit(int strand, job_t job, size_t bytes/* = 0*/)
+{
+    std::unique_lock<std::mutex> g(m_mutex);
+
+    // start all workers on first job so a strand always maps to the
+    // same worker
+    if (m_workers.empty())
+    {
+        for (int i=0;i<m_workers_count;i++)
+        {
+            m_workers.push_back(std::make_unique<Worker>());
+            m_workers.back()->thread = std::thread(&EncodePool::Run, this, std::ref(*m_workers.back()));
+        }
+    }
+
+    // back-pressure. Jobs without memory (e.g. closing a file) are
+    // never held back and a single job larger than the limit is
+    // accepted when nothing else is queued
+    m_done.wait(g, [&]()
+    {
+        return bytes == 0 || m_pending_bytes == 0 || m_pending_bytes + bytes <= m_memory_limit;
+    });
+
+    m_pending_bytes += bytes;
+    m_strandjobs[strand]++;
+
+    Worker& worker = *m_workers[strand % m_workers.size()];
+    worker.jobs.push_back({strand, std::move(job), bytes});
+    worker.signal.notify_one();
+}
+
+void EncodePool::Drain(int strand)
+{
+    std::unique_lock<std::mutex> g(m_mutex);
+    m_done.wait(g, [&]() { return !m_strandjobs.contains(strand); });
+}
+
+bool EncodePool::IsIdle(int strand) const
+{
+    std::lock_guard<std::mutex> const g(m_mutex);
+    return !m_strandjobs.contains(strand);
+}
+
+void EncodePool::SetMemoryLimit(size_t bytes)
+{
+    {
+        std::lock_guard<std::mutex> const g(m_mutex);
+        m_memory_limit = bytes;
+    }
+    m_done.notify_all();
+}
+
+size_t EncodePool::GetMemoryLimit() const
+{
+    std::lock_guard<std::mutex> const g(m_mutex);
+    return m_memory_limit;
+}
+
+size_t EncodePool::GetPendingBytes() const
+{
+    std::lock_guard<std::mutex> const g(m_mutex);
+    return m_pending_bytes;
+}
+
+void EncodePool::Run(Worker& worker)
+{
+    std::unique_lock<std::mutex> g(m_mutex);
+    while (true)
+    {
+        worker.signal.wait(g, [&]() { return !worker.jobs.empty() || m_stop; });
+        if (worker.jobs.empty())
+            break;
+
+        Job job = std::move(worker.jobs.front());
+        worker.jobs.pop_front();
+
+        g.unlock();
+        job.job();
+        job.job = {};
+        g.lock();
+
+        m_pending_bytes -= job.bytes;
+        if (--m_strandjobs[job.strand] == 0)
+            m_strandjobs.erase(job.strand);
+        m_done.notify_all();
+    }
+}
+
+} // namespace teamtalk
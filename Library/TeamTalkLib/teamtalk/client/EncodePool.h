@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2005-2018, BearWare.dk
+ * 
+ * Contact Information:
+ *
+ * Bjoern D. Rasmussen
+ * Kirketoften 5
+ * DK-8260 Viby J
+ * Denmark
+ * Email: contact@bearware.dk
+ * Phone: +45 20 20 54 59
+ * Web: http://www.bearware.dk
+ *
+ * This source code is part of the TeamTalk SDK owned by
+ * BearWare.dk. Use of this file, or its compiled unit, requires a
+ * TeamTalk SDK License Key issued by BearWare.dk.
+ *
+ * The TeamTalk SDK License Agreement along with its Terms and
+ * Conditions are outlined in the file License.txt included with the
+ * TeamTalk SDK distribution.
+ *
+ */
+
+
+#if !defined(ENCODEPOOL_H)
+#define ENCODEPOOL_H
+
+#include "mystd/MyStd.h"
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace teamtalk {
+
+    // Worker threads which encode recordings (VoiceLogger and
+    // AudioMuxer) so writing files doesn't hold up the thread
+    // producing the audio.
+    //
+    // Jobs submitted on the same strand run in order on the same
+    // worker. The memory held by queued jobs is limited by blocking
+    // Submit() until the workers have caught up.
+    class EncodePool : NonCopyable
+    {
+    public:
+        using job_t = std::function<void()>;
+
+        // 'workers' zero means half the CPU cores (max 4)
+        EncodePool(int workers = 0);
+        ~EncodePool();
+
+        // New strand for a series of jobs which must run in order
+        int NewStrand();
+        // Queue 'job' which holds 'bytes' of memory until it has
+        // run. Blocks while the memory limit is exceeded
+        void Submit(int strand, job_t job, size_t bytes = 0);
+        // Wait until all jobs on 'strand' have run
+        void Drain(int strand);
+        // No jobs queued or running on 'strand'
+        bool IsIdle(int strand) const;
+
+        void SetMemoryLimit(size_t bytes);
+        size_t GetMemoryLimit() const;
+        size_t GetPendingBytes() const;
+        int GetWorkersCount() const { return m_workers_count; }
+
+    private:
+        struct Job
+        {
+            int strand = 0;
+            job_t job;
+            size_t bytes = 0;
+        };
+        struct Worker
+        {
+            std::thread thread;
+            std::condition_variable signal;
+            std::deque<Job> jobs;
+        };
+        void Run(Worker& worker);
+
+        mutable std::mutex m_mutex;
+        // signaled when a job completes
+        std::condition_variable m_done;
+        std::vector< std::unique_ptr<Worker> > m_workers;
+        // strand -> jobs queued or running
+        std::map<int, int> m_strandjobs;
+        size_t m_pending_bytes = 0;
+        size_t m_memory_limit = 0;
+        int m_next_strand = 0;
+        int m_workers_count = 0;
+        bool m_stop = false;
+    };
+} // namespace teamtalk
+
+#endif
@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2005-2018, BearWare.dk
+ * 
+ * Contact Information:
+ *
+ * Bjoern D. Rasmussen
+ * Kirketoften 5
+ * DK-8260 Viby J
+ * Denmark
+ * Email: contact@bearware.dk
+ * Phone: +45 20 20 54 59
+ * Web: http://www.bearware.dk
+ *
+ * This source code is part of the TeamTalk SDK owned by
+ * BearWare.dk. Use of this file, or its compiled unit, requires a
+ * TeamTalk SDK License Key issued by BearWare.dk.
+ *
+ * The TeamTalk SDK License Agreement along with its Terms and
+ * Conditions are outlined in the file License.txt included with the
+ * TeamTalk SDK distribution.
+ *
+ */
+
+#include "ReactorPool.h"
+
+#include "myace/MyACE.h"
+#include "teamtalk/TTAssert.h"
+
+#include <ace/High_Res_Timer.h>
+#include <ace/Select_Reactor.h>
+
+#include <algorithm>
+
+namespace teamtalk {
+
+ReactorPool::ReactorPool(int threads)
+{
+    TTASSERT(threads > 0);
+    for (int i=0;i<std::max(threads, 1);i++)
+    {
+        m_loops.push_back(std::make_unique<Loop>());
+        Loop& loop = *m_loops.back();
+        loop.timerqueue.set_time_policy(&ACE_High_Res_Timer::gettimeofday_hr);
+        loop.reactor = std::make_unique<ACE_Reactor>(new ACE_Select_Reactor(nullptr, &loop.timerqueue), true); //Ensure we don't use ACE_WFMO_Reactor!!!
+        loop.thread = std::thread(&ReactorPool::Run, this, std::ref(loop));
+        SyncReactor(*loop.reactor);
+    }
+}
+
+ReactorPool::~ReactorPool()
+{
+    for (auto& loop : m_loops)
+    {
+        TTASSERT(loop->users == 0);
+        loop->reactor->end_reactor_event_loop();
+        loop->thread.join();
+        loop->reactor->close();
+    }
+    MYTRACE(ACE_TEXT("~ReactorPool() %p\n"), this);
+}
+
+ACE_Reactor* ReactorPool::Acquire()
+{
+    std::lock_guard<std::mutex> const g(m_mutex);
+    auto loop = std::ranges::min_element(m_loops, {}, [](const auto& l) { return l->users; });
+    (*loop)->users++;
+    return (*loop)->reactor.get();
+}
+
+void ReactorPool::Release(ACE_Reactor* reactor)
+{
+    std::lock_guard<std::mutex> const g(m_mutex);
+    auto loop = std::ranges::find_if(m_loops, [reactor](const auto& l) { return l->reactor.get() == reactor; });
+    TTASSERT(loop != m_loops.end() && (*loop)->users > 0);
+    if (loop != m_loops.end())
+        (*loop)->users--;
+}
+
+int ReactorPool::GetUsersCount(const ACE_Reactor* reactor) const
+{
+    std::lock_guard<std::mutex> const g(m_mutex);
+    auto loop = std::ranges::find_if(m_loops, [reactor](const auto& l) { return l->reactor.get() == reactor; });
+    return loop != m_loops.end() ? (*loop)->users : 0;
+}
+
+void ReactorPool::Run(Loop& loop)
+{
+    loop.reactor->owner(ACE_OS::thr_self());
+    loop.reactor->run_reactor_event_loop();
+    MYTRACE(ACE_TEXT("ReactorPool thread exited.\n"));
+}
+
+} // namespace teamtalk
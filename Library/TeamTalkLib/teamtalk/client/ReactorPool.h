@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2005-2018, BearWare.dk
+ * 
+ * Contact Information:
+ *
+ * Bjoern D. Rasmussen
+ * Kirketoften 5
+ * DK-8260 Viby J
+ * Denmark
+ * Email: contact@bearware.dk
+ * Phone: +45 20 20 54 59
+ * Web: http://www.bearware.dk
+ *
+ * This source code is part of the TeamTalk SDK owned by
+ * BearWare.dk. Use of this file, or its compiled unit, requires a
+ * TeamTalk SDK License Key issued by BearWare.dk.
+ *
+ * The TeamTalk SDK License Agreement along with its Terms and
+ * Conditions are outlined in the file License.txt included with the
+ * TeamTalk SDK distribution.
+ *
+ */
+
+
+#if !defined(REACTORPOOL_H)
+#define REACTORPOOL_H
+
+#include "mystd/MyStd.h"
+
+#include <ace/Reactor.h>
+#include <ace/Timer_Heap.h>
+
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace teamtalk {
+
+    // Threads each running an ACE_Select_Reactor which is shared by
+    // many users, e.g. ClientNode instances. Acquire() assigns the
+    // reactor with fewest users, so a user's events are still handled
+    // by a single thread and the reactor's lock still serializes
+    // them.
+    class ReactorPool : NonCopyable
+    {
+    public:
+        ReactorPool(int threads);
+        // all reactors must have been released
+        ~ReactorPool();
+
+        ACE_Reactor* Acquire();
+        void Release(ACE_Reactor* reactor);
+
+        int GetThreadsCount() const { return int(m_loops.size()); }
+        int GetUsersCount(const ACE_Reactor* reactor) const;
+
+    private:
+        struct Loop
+        {
+            ACE_Timer_Heap timerqueue;
+            std::unique_ptr<ACE_Reactor> reactor;
+            std::thread thread;
+            int users = 0;
+        };
+        void Run(Loop& loop);
+
+        mutable std::mutex m_mutex;
+        std::vector< std::unique_ptr<Loop> > m_loops;
+    };
+
+    using reactorpool_t = std::shared_ptr<ReactorPool>;
+}
+
+#endif
@@ -39,6 +39,18 @@
 
 constexpr auto DEBUG_PLAYBACK = 0;
 
+//number of recent packets used for estimating jitter
+constexpr auto PLAYOUT_JITTER_WINDOW = 100;
+//percentile of transit time variation which the playout delay covers
+constexpr auto PLAYOUT_JITTER_PERCENTILE = 95;
+//max packets concealed when buffer runs dry during a stream
+constexpr auto PLAYOUT_CONCEAL_MAX = 2;
+//max comfort noise after last packet while sender is in DTX
+constexpr auto PLAYOUT_DTX_MSEC = 1000;
+//decoded audio kept ahead of the sound system's callback
+constexpr auto DECODE_AHEAD_MSEC = 10;
+constexpr auto DECODEPOOL_MAX_WORKERS = 4;
+
 using namespace media;
 
 namespace teamtalk {
@@ -63,6 +75,9 @@ AudioPlayer::AudioPlayer(int userid, StreamType stream_type, soundsystem::sounds
         m_resample_buffer.resize(size_t(input_samples)*input_channels);
 
     SetAudioBufferSize(GetAudioCodecCbMillis(m_codec) * 4);
+
+    //media files may contain music which doesn't time-stretch well
+    m_timestretch = (stream_type == STREAMTYPE_VOICE);
 }
 
 AudioPlayer::~AudioPlayer()
@@ -120,6 +135,7 @@ audiopacket_t AudioPlayer::QueuePacket(const AudioPacket& new_audpkt)
 
         //erase what we reassembled
         m_audfragments.erase(ii);
+        m_audiopackets_reassembled++;
 
         //make 'audpkt' point to our reassembled packet
         audpkt = ptr_audpkt.get();
@@ -129,6 +145,10 @@ audiopacket_t AudioPlayer::QueuePacket(const AudioPacket& new_audpkt)
 
     AddPacket(*audpkt);
 
+    //a new stream has nothing decoded yet
+    if (m_decode_ahead)
+        m_decode_request();
+
     return ptr_audpkt;
 }
 
@@ -156,6 +176,13 @@ void AudioPlayer::Reset()
     m_buffer.clear();
     m_play_pkt_no = 0;
     m_stream_id = 0;
+    m_playout.clear();
+    m_concealed = 0;
+    m_dtx = false;
+
+    //Reset() is called by StreamPlayerCb() which is the consumer
+    while (m_decoded.Front() != nullptr)
+        m_decoded.Pop();
 
     //do not reset play time since they're used by ClientUser to check
     //how long the player has been inactive.
@@ -175,7 +202,8 @@ bool AudioPlayer::StreamPlayerCb(const soundsystem::OutputStreamer& streamer,
     bool const new_stream = (old_stream_id != 0 && m_stream_id != 0 && old_stream_id != m_stream_id);
     bool stopped_talking = false;
 
-    bool const played = PlayBuffer(tmp_output_buffer, input_samples);
+    bool const played = m_decode_ahead ? PlayDecoded(tmp_output_buffer, input_samples) :
+                                         PlayBuffer(tmp_output_buffer, input_samples);
     
     if (played)
     {
@@ -249,6 +277,14 @@ int AudioPlayer::GetNumAudioPacketsRecv(bool reset)
     return n;
 }
 
+int AudioPlayer::GetNumAudioPacketsReassembled(bool reset)
+{
+    int const n = m_audiopackets_reassembled;
+    if(reset)
+        m_audiopackets_reassembled = 0;
+    return n;
+}
+
 int AudioPlayer::GetNumAudioPacketsLost(bool reset)
 {
     int const n = m_audiopacket_lost;
@@ -257,11 +293,182 @@ int AudioPlayer::GetNumAudioPacketsLost(bool reset)
     return n;
 }
 
+int AudioPlayer::GetNumAudioPacketsRecovered(bool reset)
+{
+    wguard_t const g(m_mutex);
+    int const n = m_audiopackets_recovered;
+    if(reset)
+        m_audiopackets_recovered = 0;
+    return n;
+}
+
+int AudioPlayer::GetNumAudioPacketsConcealed(bool reset)
+{
+    wguard_t const g(m_mutex);
+    int const n = m_audiopackets_concealed;
+    if(reset)
+        m_audiopackets_concealed = 0;
+    return n;
+}
+
+int AudioPlayer::GetNumAccelerated(bool reset)
+{
+    wguard_t const g(m_mutex);
+    int const n = m_accelerated;
+    if(reset)
+        m_accelerated = 0;
+    return n;
+}
+
+int AudioPlayer::GetNumExpanded(bool reset)
+{
+    wguard_t const g(m_mutex);
+    int const n = m_expanded;
+    if(reset)
+        m_expanded = 0;
+    return n;
+}
+
 void AudioPlayer::SetAudioBufferSize(int msec)
 {
     m_buffer_msec = std::max(msec, GetAudioCodecCbMillis(m_codec));
 }
 
+void AudioPlayer::SetPlayoutDelay(int min_msec, int max_msec)
+{
+    wguard_t const g(m_mutex);
+    m_min_target_msec = std::max(min_msec, 0);
+    m_max_target_msec = std::max(max_msec, 0);
+}
+
+int AudioPlayer::GetPlayoutDelayMSec()
+{
+    wguard_t const g(m_mutex);
+
+    int msec = GetBufferedAudioMSec();
+    int const channels = GetAudioCodecChannels(m_codec);
+    int const samplerate = GetAudioCodecSampleRate(m_codec);
+    if (channels > 0 && samplerate > 0)
+        msec += PCM16_SAMPLES_DURATION(int(m_playout.size()) / channels, samplerate);
+    msec += int(m_decoded.Size()) * GetAudioCodecCbMillis(m_codec);
+    return msec;
+}
+
+void AudioPlayer::SetLatencyTracing(bool enable)
+{
+    wguard_t const g(m_mutex);
+    m_trace_latency = enable;
+    m_buffered_latency.Reset();
+    m_played_latency.Reset();
+}
+
+void AudioPlayer::CollectLatency(LatencyHistogram& buffered, LatencyHistogram& played)
+{
+    wguard_t const g(m_mutex);
+    buffered.Merge(m_buffered_latency);
+    played.Merge(m_played_latency);
+    m_buffered_latency.Reset();
+    m_played_latency.Reset();
+}
+
+void AudioPlayer::TraceLatency(uint32_t arrival)
+{
+    int const buffered = int(GETTIMESTAMP() - arrival);
+
+    //decoded audio queued ahead of this frame plus the callback
+    //which hands it to the sound device
+    int const codec_msec = GetAudioCodecCbMillis(m_codec);
+    int queued = codec_msec * (int(m_decode_ahead ? m_decoded.Size() : 0) + 1);
+    int const channels = GetAudioCodecChannels(m_codec);
+    int const samplerate = GetAudioCodecSampleRate(m_codec);
+    if (channels > 0 && samplerate > 0)
+        queued += PCM16_SAMPLES_DURATION(int(m_playout.size()) / channels, samplerate);
+
+    m_buffered_latency.Add(int64_t(buffered) * 1000);
+    m_played_latency.Add(int64_t(buffered + queued) * 1000);
+}
+
+void AudioPlayer::EnableDecodeAhead(decode_request_t request)
+{
+    int input_channels = GetAudioCodecChannels(m_codec);
+    if(GetAudioCodecSimulateStereo(m_codec))
+        input_channels = 2;
+    int const input_samples = GetAudioCodecCbSamples(m_codec);
+    int const codec_msec = std::max(GetAudioCodecCbMillis(m_codec), 1);
+    int const frames = std::max(1, (DECODE_AHEAD_MSEC + codec_msec - 1) / codec_msec);
+
+    m_decoded.Reset(frames, std::vector<short>(size_t(input_samples) * input_channels));
+    m_decode_request = std::move(request);
+    m_decode_ahead = true;
+}
+
+bool AudioPlayer::DecodeAhead()
+{
+    TTASSERT(m_decode_ahead);
+
+    int const input_samples = GetAudioCodecCbSamples(m_codec);
+    bool decoded = false;
+    std::vector<short>* frame = nullptr;
+    while ((frame = m_decoded.Back()) != nullptr)
+    {
+        //push while locked so Reset() cannot be passed by a stale frame
+        wguard_t const g(m_mutex);
+        if (!PlayBuffer(frame->data(), input_samples, true))
+            break;
+        m_decoded.Push();
+        decoded = true;
+    }
+    return decoded;
+}
+
+bool AudioPlayer::PlayDecoded(short* output_buffer, int n_samples)
+{
+    const std::vector<short>* frame = m_decoded.Front();
+    bool played = false;
+    if (frame == nullptr)
+    {
+        //DecodeAhead() may be pushing the next frame so check again
+        //while locked. Otherwise the frame after would be decoded
+        //first and play out of order
+        wguard_t const g(m_mutex);
+        frame = m_decoded.Front();
+        //next packet is missing or late so decode, conceal or recover
+        //from FEC now that its playout deadline is reached
+        if (frame == nullptr)
+            played = PlayBuffer(output_buffer, n_samples);
+    }
+
+    if (frame != nullptr)
+    {
+        std::copy(frame->begin(), frame->end(), output_buffer);
+        m_decoded.Pop();
+        played = true;
+    }
+
+    //decode next frame while this one is being played
+    m_decode_request();
+    return played;
+}
+
+void AudioPlayer::UpdateTargetDelay(const AudioPacket& packet)
+{
+    m_transit_msec.push_back(int32_t(m_last_arrival - packet.GetTime()));
+    if (m_transit_msec.size() > PLAYOUT_JITTER_WINDOW)
+        m_transit_msec.pop_front();
+
+    //sender and receiver clocks differ so only the variation in
+    //transit time is usable
+    std::vector<int32_t> transit(m_transit_msec.begin(), m_transit_msec.end());
+    int32_t const fastest = *std::min_element(transit.begin(), transit.end());
+    auto const nth = transit.begin() + ((transit.size() - 1) * PLAYOUT_JITTER_PERCENTILE / 100);
+    std::nth_element(transit.begin(), nth, transit.end());
+
+    int const codec_msec = GetAudioCodecCbMillis(m_codec);
+    int const lowest = std::max(codec_msec, m_min_target_msec);
+    int const highest = std::max(lowest, m_max_target_msec > 0 ? std::min(m_max_target_msec, m_buffer_msec) : m_buffer_msec);
+    m_target_msec = std::clamp(codec_msec + (*nth - fastest), lowest, highest);
+}
+
 int AudioPlayer::GetBufferedAudioMSec()
 {
     wguard_t const g(m_mutex);
@@ -295,6 +502,17 @@ void AudioPlayer::AddPacket(const teamtalk::AudioPacket& packet)
     if(packet.GetStreamID() == 0)
         return;
 
+    m_last_arrival = GETTIMESTAMP();
+
+    //late packets also count towards jitter
+    if (m_timestretch)
+        UpdateTargetDelay(packet);
+
+    //the server doesn't forward silent packets while sender is in
+    //DTX so resume from this packet instead of waiting for them
+    if (m_dtx && m_buffer.empty() && m_stream_id == packet.GetStreamID())
+        m_play_pkt_no = pkt_no;
+
     if ((m_stream_id != 0) && W16_LT(pkt_no, m_play_pkt_no))
     {
         MYTRACE(ACE_TEXT("User #%d, packet %d arrived too late\n"), m_userid, pkt_no);
@@ -333,6 +551,7 @@ void AudioPlayer::AddPacket(const teamtalk::AudioPacket& packet)
             m_buffer[pkt_no].enc_frame_sizes.push_back(enc_len);
     }
     m_buffer[pkt_no].timestamp = packet.GetTime();
+    m_buffer[pkt_no].arrival = m_last_arrival;
     TTASSERT(packet.GetStreamID());
     m_buffer[pkt_no].stream_id = packet.GetStreamID();
 
@@ -361,78 +580,156 @@ void AudioPlayer::AddPacket(const teamtalk::AudioPacket& packet)
     //    packet_number, m_play_pkt_no);
 }
 
-bool AudioPlayer::PlayBuffer(short* output_buffer, int n_samples)
+bool AudioPlayer::PlayBuffer(short* output_buffer, int n_samples, bool decode_ahead /*= false*/)
 {
     wguard_t const g(m_mutex);
-    bool played = false;
+
+    if (decode_ahead && !m_timestretch && !m_buffer.contains(m_play_pkt_no))
+        return false;
+
+    bool const played = m_timestretch ? PlayTimeStretched(output_buffer, n_samples, !decode_ahead) :
+                                        DecodeNextPacket(output_buffer, n_samples);
+    if (!played)
+    {
+        memset(output_buffer, 0, GetAudioCodecCbBytes(m_codec));
+
+        MYTRACE_COND(DEBUG_PLAYBACK,
+                     ACE_TEXT("No packets available for playback for user #%d. Current packet: %d\n"),
+                     m_userid, m_play_pkt_no);
+    }
+
+    //stereo simulation
+    if (GetAudioCodecSimulateStereo(m_codec))
+    {
+        //Speex doesn't support stereo so simulate
+        //If in stereo then choose which channels to output audio to
+        AudioMonoToStereo(output_buffer, n_samples);
+    }
+
+    return played;
+}
+
+bool AudioPlayer::DecodeNextPacket(short* output_buffer, int n_samples)
+{
+    //play comfort noise while sender is in DTX but not beyond
+    //where it has most likely stopped transmitting
+    if (m_dtx && W32_GEQ(GETTIMESTAMP(), m_last_arrival + PLAYOUT_DTX_MSEC))
+        m_dtx = false;
 
     //play until last packet arrived
-    if(!m_buffer.empty())
+    if(m_buffer.empty() && !m_dtx)
+        return false;
+
+    TTASSERT(m_buffer.empty() || W16_GEQ(m_buffer.begin()->first, m_play_pkt_no));
+
+    while((m_stream_id != 0) && GetBufferedAudioMSec() > m_buffer_msec)
     {
-        TTASSERT(W16_GEQ(m_buffer.begin()->first, m_play_pkt_no));
+        MYTRACE(ACE_TEXT("User #%d, dropped packet %d, max %d\n"), 
+                m_userid, m_buffer.begin()->first, m_buffer.rbegin()->first);
+        m_buffer.erase(m_buffer.begin());
 
-        while((m_stream_id != 0) && GetBufferedAudioMSec() > m_buffer_msec)
+        if (!m_buffer.empty())
         {
-            MYTRACE(ACE_TEXT("User #%d, dropped packet %d, max %d\n"), 
-                    m_userid, m_buffer.begin()->first, m_buffer.rbegin()->first);
-            m_buffer.erase(m_buffer.begin());
-
-            if (!m_buffer.empty())
-            {
-                MYTRACE(ACE_TEXT("User #%d, skipped %d-%d packets\n"),
-                        m_userid, m_play_pkt_no, m_buffer.begin()->first-1);
-                m_play_pkt_no = m_buffer.begin()->first;
-            }
+            MYTRACE(ACE_TEXT("User #%d, skipped %d-%d packets\n"),
+                    m_userid, m_play_pkt_no, m_buffer.begin()->first-1);
+            m_play_pkt_no = m_buffer.begin()->first;
         }
+    }
 
-        MYTRACE_COND(DEBUG_PLAYBACK,
-                     ACE_TEXT("User #%d, streamtype %u, stream id %d, cur_pkt %d, max pkt %d, tm: %u\n"),
-                     m_userid, m_streamtype, m_stream_id, m_play_pkt_no, m_buffer.rbegin()->first,
-                     GETTIMESTAMP());
+    MYTRACE_COND(DEBUG_PLAYBACK,
+                 ACE_TEXT("User #%d, streamtype %u, stream id %d, cur_pkt %d, max pkt %d, tm: %u\n"),
+                 m_userid, m_streamtype, m_stream_id, m_play_pkt_no,
+                 (m_buffer.empty() ? m_play_pkt_no : m_buffer.rbegin()->first), GETTIMESTAMP());
 
-        if(DecodeFrame(m_buffer[m_play_pkt_no], output_buffer, n_samples))
+    const encframe& frame = m_buffer[m_play_pkt_no];
+    //missing packets after a DTX packet are silence, not loss
+    bool const dtx_gap = m_dtx && frame.enc_frames.empty();
+    if(DecodeFrame(frame, output_buffer, n_samples))
+    {
+        if (!dtx_gap)
         {
-            m_played_packet_time = m_buffer[m_play_pkt_no].timestamp;
-            MYTRACE_COND(m_stream_id != m_buffer[m_play_pkt_no].stream_id,
+            m_played_packet_time = frame.timestamp;
+            MYTRACE_COND(m_stream_id != frame.stream_id,
                          ACE_TEXT("User #%d started new audio stream %d\n"), m_userid, 
-                         m_buffer[m_play_pkt_no].stream_id);
-            m_stream_id = m_buffer[m_play_pkt_no].stream_id;
-        }
-        else
-        {
-            m_audiopacket_lost++;
+                         frame.stream_id);
+            m_stream_id = frame.stream_id;
+            m_dtx = m_codec.codec == CODEC_OPUS && IsOpusDTX(frame.enc_frame_sizes);
+            if (m_trace_latency && !frame.enc_frames.empty())
+                TraceLatency(frame.arrival);
         }
-
-        //clear slot
-        m_buffer.erase(m_play_pkt_no);
-
-        //increment packet number to be played next time
-        m_play_pkt_no++;
-        played = true;
     }
     else
     {
-        memset(output_buffer, 0, GetAudioCodecCbBytes(m_codec));
-        played = false;
-        
-        MYTRACE_COND(DEBUG_PLAYBACK,
-                     ACE_TEXT("No packets available for playback for user #%d. Current packet: %d\n"),
-                     m_userid, m_play_pkt_no);
+        m_audiopacket_lost++;
+        m_dtx = false;
     }
 
-    //stereo simulation
-    if (GetAudioCodecSimulateStereo(m_codec))
+    //clear slot
+    m_buffer.erase(m_play_pkt_no);
+
+    //increment packet number to be played next time
+    m_play_pkt_no++;
+    return true;
+}
+
+bool AudioPlayer::PlayTimeStretched(short* output_buffer, int n_samples, bool conceal)
+{
+    int const channels = GetAudioCodecChannels(m_codec);
+    int const samplerate = GetAudioCodecSampleRate(m_codec);
+    int const codec_msec = GetAudioCodecCbMillis(m_codec);
+    size_t const n_output = size_t(n_samples) * channels;
+    //pitch periods from 2.5 msec (400 Hz) to 15 msec (67 Hz)
+    int const min_period = samplerate * 25 / 10000;
+    int const max_period = samplerate * 15 / 1000;
+
+    while (m_playout.size() < n_output)
     {
-        //Speex doesn't support stereo so simulate
-        //If in stereo then choose which channels to output audio to
-        for(int i=(2*n_samples) - 2; i >= 0; i -= 2)
+        //packet may still arrive before its playout deadline
+        if (!conceal && !m_buffer.contains(m_play_pkt_no))
+            break;
+
+        m_decode_buffer.resize(n_output);
+        if (DecodeNextPacket(m_decode_buffer.data(), n_samples))
         {
-            output_buffer[i] = output_buffer[i/2];
-            output_buffer[i+1] = output_buffer[i/2];
+            m_concealed = 0;
+
+            //compress or stretch audio towards the target delay
+            int const delay = GetPlayoutDelayMSec();
+            if (delay > m_target_msec + codec_msec)
+            {
+                if (AudioAccelerate(m_decode_buffer, channels, min_period, max_period) > 0)
+                    m_accelerated++;
+            }
+            else if (delay + codec_msec < m_target_msec)
+            {
+                if (AudioExpand(m_decode_buffer, channels, min_period, max_period) > 0)
+                    m_expanded++;
+            }
         }
+        else if (m_stream_id != 0 && m_concealed < PLAYOUT_CONCEAL_MAX &&
+                 W32_LT(GETTIMESTAMP(), m_last_arrival + m_target_msec + codec_msec))
+        {
+            //next packet is late so let decoder conceal instead of
+            //inserting silence
+            DecodeFrame(encframe(), m_decode_buffer.data(), n_samples);
+            m_concealed++;
+            m_expanded++;
+        }
+        else
+            break;
+
+        m_playout.insert(m_playout.end(), m_decode_buffer.begin(), m_decode_buffer.end());
     }
 
-    return played;
+    //keep partial output until playout deadline
+    if (m_playout.empty() || (!conceal && m_playout.size() < n_output))
+        return false;
+
+    size_t const n = std::min(n_output, m_playout.size());
+    std::copy(m_playout.begin(), m_playout.begin() + n, output_buffer);
+    std::fill(output_buffer + n, output_buffer + n_output, short(0));
+    m_playout.erase(m_playout.begin(), m_playout.begin() + n);
+    return true;
 }
 
 #if defined(ENABLE_SPEEX)
@@ -454,6 +751,7 @@ SpeexPlayer::SpeexPlayer(int userid, StreamType stream_type, soundsystem::sounds
     case CODEC_NO_CODEC :
     case CODEC_OPUS :
     case CODEC_WEBM_VP8 :
+    case CODEC_WEBM_VP9 :
         TTASSERT(0);
         break;
     }
@@ -467,6 +765,8 @@ SpeexPlayer::~SpeexPlayer()
 
 void SpeexPlayer::Reset()
 {
+    //decoder may be in use by AudioDecodePool
+    wguard_t const g(m_mutex);
     AudioPlayer::Reset();
     m_decoder.Reset();
 }
@@ -496,6 +796,7 @@ bool SpeexPlayer::DecodeFrame(const encframe& enc_frame,
     MYTRACE(ACE_TEXT("User #%d is missing packet %d\n"), m_userid, m_play_pkt_no);
     std::vector<int> frm_sizes(GetAudioCodecFramesPerPacket(m_codec), 0);
     m_decoder.DecodeMultiple(NULL, frm_sizes, output_buffer);
+    m_audiopackets_concealed++;
     //increment 'm_played_packet_time' with GetAudioCodecCbMillis()?
     return false;
 }
@@ -518,6 +819,7 @@ OpusPlayer::OpusPlayer(int userid, StreamType stream_type, soundsystem::soundsys
     case CODEC_SPEEX :
     case CODEC_SPEEX_VBR :
     case CODEC_WEBM_VP8 :
+    case CODEC_WEBM_VP9 :
     case CODEC_NO_CODEC :
         TTASSERT(0);
         break;
@@ -532,6 +834,8 @@ OpusPlayer::~OpusPlayer()
 
 void OpusPlayer::Reset()
 {
+    //decoder may be in use by AudioDecodePool
+    wguard_t const g(m_mutex);
     AudioPlayer::Reset();
     m_decoder.Reset();
 }
@@ -583,25 +887,197 @@ bool OpusPlayer::DecodeFrame(const encframe& enc_frame,
         }
         return true;
     }
-     //packet lost
-            MYTRACE(ACE_TEXT("User #%d is missing packet %d\n"), m_userid, m_play_pkt_no);
+
         int fpp = GetAudioCodecFramesPerPacket(m_codec);
         int decoffset = 0;
+
+        //sender is in DTX so decoder continues comfort noise
+        if (m_dtx)
+        {
+            for (int i=0;i<fpp;i++)
+            {
+                m_decoder.Decode(NULL, 0, &output_buffer[decoffset*channels], framesize);
+                decoffset += framesize;
+            }
+            return true;
+        }
+
+     //packet lost
+            MYTRACE(ACE_TEXT("User #%d is missing packet %d\n"), m_userid, m_play_pkt_no);
+
+        // in-band FEC of the first frame in the next packet holds the
+        // last frame of the lost packet. Frames before it are
+        // concealed.
+        const encframe* next_frame = nullptr;
+        auto const ii = m_buffer.find(uint16_t(m_play_pkt_no + 1));
+        if (ii != m_buffer.end() && ii->second.stream_id == m_stream_id &&
+            !ii->second.enc_frame_sizes.empty() &&
+            ii->second.enc_frame_sizes[0] <= ii->second.enc_frames.size())
+        {
+            next_frame = &ii->second;
+        }
+
+#if defined(OPUS_SET_DRED_DURATION_REQUEST)
+        // Deep REDundancy (DRED) in one of the following packets can
+        // recover all frames of the lost packet, also if more packets
+        // are lost in a row.
+        int dred_packets = 0, dred_samples = 0;
+        int const max_dred_packets = std::max(OPUS_DRED_MSEC / std::max(GetAudioCodecCbMillis(m_codec), 1), 1);
+        for (int j=1;j<=max_dred_packets && dred_samples == 0;j++)
+        {
+            auto const di = m_buffer.find(uint16_t(m_play_pkt_no + j));
+            if (di == m_buffer.end() || di->second.stream_id != m_stream_id ||
+                di->second.enc_frame_sizes.empty() ||
+                di->second.enc_frame_sizes[0] > di->second.enc_frames.size())
+                continue;
+
+            dred_packets = j;
+            dred_samples = m_decoder.ParseDRED(di->second.enc_frames.data(),
+                                               di->second.enc_frame_sizes[0],
+                                               j * fpp * framesize);
+        }
+#endif
+
+        bool recovered = false;
         for (int i=0;i<fpp;i++)
         {
+            if (i == fpp - 1 && next_frame != nullptr)
+            {
+                ret = m_decoder.DecodeFEC(next_frame->enc_frames.data(),
+                                          next_frame->enc_frame_sizes[0],
+                                          &output_buffer[decoffset*channels], framesize);
+                if (ret == framesize)
+                {
+                    recovered = true;
+                    break;
+                }
+                MYTRACE(ACE_TEXT("OPUS FEC decode failed for #%d. Ret = %d\n"), m_userid, ret);
+            }
+#if defined(OPUS_SET_DRED_DURATION_REQUEST)
+            // offset is counted backwards from the start of the packet with DRED
+            int const dred_offset = ((dred_packets * fpp) - i) * framesize;
+            if (dred_samples > 0 && dred_offset <= dred_samples &&
+                m_decoder.DecodeDRED(dred_offset, &output_buffer[decoffset*channels], framesize) == framesize)
+            {
+                recovered = true;
+                decoffset += framesize;
+                continue;
+            }
+#endif
             m_decoder.Decode(NULL, 0, &output_buffer[decoffset*channels], framesize);
             decoffset += framesize;
         }
+
+        if (recovered)
+            m_audiopackets_recovered++;
+        else
+            m_audiopackets_concealed++;
+
         //increment 'm_played_packet_time' with GetAudioCodecCbMillis()?
         return false;
    
 }
 #endif
 
+AudioDecodePool::~AudioDecodePool()
+{
+    for (auto& worker : m_workers)
+    {
+        {
+            std::lock_guard<std::mutex> const g(worker->mutex);
+            TTASSERT(worker->players.empty());
+        }
+        {
+            std::lock_guard<std::mutex> const g(worker->signal_mutex);
+            worker->stop = true;
+        }
+        worker->signal.notify_one();
+        worker->thread.join();
+    }
+}
+
+void AudioDecodePool::AddPlayer(const audio_player_t& player)
+{
+    std::lock_guard<std::mutex> const g(m_mutex);
+
+    //start workers as players are added, then use the least busy
+    Worker* worker = nullptr;
+    int const max_workers = std::clamp(int(std::thread::hardware_concurrency() / 2), 1, DECODEPOOL_MAX_WORKERS);
+    if (int(m_workers.size()) < max_workers)
+    {
+        m_workers.push_back(std::make_unique<Worker>());
+        worker = m_workers.back().get();
+        worker->thread = std::thread(&AudioDecodePool::Run, this, std::ref(*worker));
+    }
+    else
+    {
+        size_t fewest = SIZE_MAX;
+        for (auto& w : m_workers)
+        {
+            std::lock_guard<std::mutex> const gw(w->mutex);
+            if (w->players.size() < fewest)
+            {
+                fewest = w->players.size();
+                worker = w.get();
+            }
+        }
+    }
+
+    player->EnableDecodeAhead([worker]()
+    {
+        //'signal_mutex' is never held while decoding so the sound
+        //system's callback isn't blocked
+        {
+            std::lock_guard<std::mutex> const g(worker->signal_mutex);
+            worker->pending = true;
+        }
+        worker->signal.notify_one();
+    });
+
+    std::lock_guard<std::mutex> const gw(worker->mutex);
+    worker->players.push_back(player);
+}
+
+void AudioDecodePool::RemovePlayer(const AudioPlayer* player)
+{
+    std::lock_guard<std::mutex> const g(m_mutex);
+    for (auto& worker : m_workers)
+    {
+        // waits for worker to complete decoding
+        std::lock_guard<std::mutex> const gw(worker->mutex);
+        std::erase_if(worker->players, [player](const audio_player_t& p) { return p.get() == player; });
+    }
+}
+
+void AudioDecodePool::Run(Worker& worker)
+{
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> gs(worker.signal_mutex);
+            worker.signal.wait(gs, [&worker]() { return worker.pending || worker.stop; });
+            if (worker.stop)
+                break;
+            worker.pending = false;
+        }
+
+        std::lock_guard<std::mutex> const g(worker.mutex);
+        for (auto& player : worker.players)
+            player->DecodeAhead();
+    }
+}
+
 #if defined(ENABLE_VPX)
 
 constexpr auto VPX_MAX_FRAG_PACKETS = 3000;
 constexpr auto VPX_MAX_PACKETS = 3000;
+//max number of recent packets to check for missing fragments
+constexpr auto VPX_MAX_NACK_PACKETS = 32;
+//time to wait for retransmission of missing packet before skipping it
+constexpr auto VPX_RTX_WAIT_MSEC = 250;
+//time a packet may arrive after a newer packet before it's reported
+//missing, i.e. reordering on the network
+constexpr auto VPX_NACK_REORDER_MSEC = 30;
 
 WebMPlayer::WebMPlayer(int userid, int stream_id)
 : m_userid(userid)
@@ -634,23 +1110,30 @@ bool WebMPlayer::AddPacket(const VideoPacket& packet,
         uint16_t h;
         if(packet.GetStreamID(&m_packet_no, nullptr, nullptr, &w, &h) == 0u)
             return false;
-        if(!m_decoder.Open(w, h))
+        Codec const codec = GetVideoCodecFromPacket(packet.GetVideoCodec());
+        MYTRACE_COND(codec == CODEC_NO_CODEC, ACE_TEXT("Unsupported video codec %d from user #%d\n"),
+                     int(packet.GetVideoCodec()), m_userid);
+        if (codec == CODEC_NO_CODEC)
+            return false;
+        if(!m_decoder.Open(w, h, codec == CODEC_WEBM_VP9))
             return false;
 
-        MYTRACE(ACE_TEXT("Starting new video stream %d for user #%d. %dx%d\n"), 
-                packet.GetStreamID(), m_userid, w, h);
+        m_codec = codec;
+        m_packet_no_max = m_packet_no;
+        MYTRACE(ACE_TEXT("Starting new video stream %d for user #%d. %dx%d, codec %d\n"), 
+                packet.GetStreamID(), m_userid, w, h, int(m_codec));
         m_decoder_ready = true;
     }
 
-    ProcessVideoPacket(packet);
+    bool const new_frame = ProcessVideoPacket(packet);
 
     // dumpFragments();
 
     //return true if packet has ended up in the packet queue
-    return m_video_frames.contains(packet.GetTime());
+    return new_frame && m_video_frames.contains(packet.GetTime());
 }
 
-void WebMPlayer::ProcessVideoPacket(const VideoPacket& packet)
+bool WebMPlayer::ProcessVideoPacket(const VideoPacket& packet)
 {
     wguard_t const g(m_mutex);
 
@@ -660,8 +1143,19 @@ void WebMPlayer::ProcessVideoPacket(const VideoPacket& packet)
                  packet.GetPacketNo(), m_userid, m_packet_no);
                  
     if(W32_LT(packet_no, m_packet_no))
-        return;
+        return false;
+
+    //retransmission of packet which has already been received
+    if((m_decoded && W32_LEQ(packet_no, m_packet_no_decoded)) || FrameQueued(packet_no))
+        return false;
 
+    if(W32_GT(packet_no, m_packet_no_max))
+    {
+        m_packet_no_max = packet_no;
+        m_packet_no_max_times[packet_no] = m_local_timestamp;
+    }
+
+    bool frame_ready = false;
     uint16_t const fragno = packet.GetFragmentNo();
     if(fragno == VideoPacket::INVALID_FRAGMENT_NO)
     {
@@ -669,13 +1163,14 @@ void WebMPlayer::ProcessVideoPacket(const VideoPacket& packet)
         const char* data = packet.GetEncodedData(frame_size);
         assert(data);
         if(data == nullptr)
-            return;
+            return false;
 
         enc_frame new_frame;
         new_frame.enc_data.assign(data, data+frame_size);
         new_frame.packet_no = packet_no;
-        m_video_frames[packet.GetTime()] = new_frame;
+        QueueFrame(packet.GetTime(), new_frame);
         m_videoframes_recv++;
+        frame_ready = true;
     }
     else //fragmented packet
     {
@@ -687,10 +1182,12 @@ void WebMPlayer::ProcessVideoPacket(const VideoPacket& packet)
             new_frame.packet_no = packet_no;
             if(ReassembleVideoPackets(ii->second, packet, new_frame.enc_data))
             {
-                m_video_frames[packet.GetTime()] = new_frame;
+                QueueFrame(packet.GetTime(), new_frame);
                 m_videoframes_recv++;
+                m_videoframes_reassembled++;
                 m_video_fragments.erase(ii);
                 store_fragment = false;
+                frame_ready = true;
             }
         }
         
@@ -711,7 +1208,7 @@ void WebMPlayer::ProcessVideoPacket(const VideoPacket& packet)
     if(m_video_frames.size()>VPX_MAX_PACKETS)
     {
         MYTRACE(ACE_TEXT("Dropped video packet %d\n"), m_video_frames.begin()->first);
-        m_video_frames.erase(m_video_frames.begin());
+        EraseFrame(m_video_frames.begin());
     }
 
     // if a packet is more than 5 seconds old it will be evicted
@@ -737,16 +1234,18 @@ void WebMPlayer::ProcessVideoPacket(const VideoPacket& packet)
     }
 
     RemoveObsoletePackets();
+
+    return frame_ready;
 }
 
-ACE_Message_Block* WebMPlayer::GetNextFrame(const uint32_t* timestamp)
+ACE_Message_Block* WebMPlayer::GetNextFrame(const uint32_t* timestamp, media::FourCC fourcc)
 {
     wguard_t const g(m_mutex);
 #if defined(_DEBUG)
     DumpFragments();
 #endif
     //m_video_frames are sorted with UINT32 wrap
-    auto const ii = m_video_frames.begin();
+    auto ii = m_video_frames.begin();
 
     MYTRACE_COND(!m_decoder_ready, ACE_TEXT("Decoder not ready from user #%d\n"), m_userid);
     MYTRACE_COND(ii == m_video_frames.end(), ACE_TEXT("No video frames ready from user #%d\n"), m_userid);
@@ -758,6 +1257,41 @@ ACE_Message_Block* WebMPlayer::GetNextFrame(const uint32_t* timestamp)
         return nullptr;
     }
 
+    if (WaitForRetransmission(timestamp))
+    {
+        m_rtx_held_frames++;
+        return nullptr;
+    }
+
+    //decode the frames which were held back while waiting for
+    //retransmission, so frame delay doesn't build up
+    while (m_rtx_held_frames > 0 && m_video_frames.size() > 1)
+    {
+        m_rtx_held_frames--;
+        auto const held = m_video_frames.begin();
+        if (held->second.packet_no != m_packet_no_decoded + 1)
+            m_keyframe_request = true;
+        if (m_decoder.PushDecoder(held->second.enc_data.data(),
+                                  int(held->second.enc_data.size())) != VPX_CODEC_OK)
+            m_keyframe_request = true;
+        m_packet_no = m_packet_no_decoded = held->second.packet_no;
+        m_decoded = true;
+        EraseFrame(held);
+        RemoveObsoletePackets();
+        if (WaitForRetransmission(timestamp))
+        {
+            m_rtx_held_frames++;
+            return nullptr;
+        }
+    }
+    m_rtx_held_frames = 0;
+
+    ii = m_video_frames.begin();
+
+    //decoding across a lost frame causes artifacts until next key frame
+    if (m_decoded && ii->second.packet_no != m_packet_no_decoded + 1)
+        m_keyframe_request = true;
+
     // MYTRACE(ACE_TEXT("GetNextFrame(), process video packet %d, size %d, csum 0x%x\n"),
     //         ii->second.packet_no, ii->second.enc_data.size(), 
     //         ACE::crc32(&ii->second.enc_data[0], ii->second.enc_data.size()));
@@ -776,34 +1310,62 @@ ACE_Message_Block* WebMPlayer::GetNextFrame(const uint32_t* timestamp)
         h = m_decoder.GetConfig().h;
 
         m_decoder.Close();
-        m_decoder.Open(w, h);
+        m_decoder.Open(w, h, m_codec == CODEC_WEBM_VP9);
     }
     default :
         MYTRACE(ACE_TEXT("VPX decoder reported error %d in packet %d for user #%d\n"),
                 ret, ii->second.packet_no, m_userid);
-        m_packet_no = ii->second.packet_no;
-        m_video_frames.erase(ii);
+        m_packet_no = m_packet_no_decoded = ii->second.packet_no;
+        m_decoded = true;
+        EraseFrame(ii);
+        //decoder cannot recover until next key frame
+        m_keyframe_request = true;
         return nullptr;
     case VPX_CODEC_OK :
         break;
     }
 
-    m_packet_no = ii->second.packet_no;
-    m_video_frames.erase(ii);
+    m_packet_no = m_packet_no_decoded = ii->second.packet_no;
+    m_decoded = true;
+    EraseFrame(ii);
 
     RemoveObsoletePackets();
 
     int w = m_decoder.GetConfig().w;
     int h = m_decoder.GetConfig().h;
-    int const bytes = RGB32_BYTES(w, h);
-    VideoFrame vid_frame(nullptr, bytes, w, h, FOURCC_RGB32, true);
+    int bytes = 0;
+    switch (fourcc)
+    {
+    case FOURCC_I420 :
+        bytes = (w * h) + (2 * ((w + 1) / 2) * ((h + 1) / 2));
+        break;
+    case FOURCC_RGB32 :
+        bytes = RGB32_BYTES(w, h);
+        break;
+    default :
+        TTASSERT(0);
+        return nullptr;
+    }
+    VideoFrame vid_frame(nullptr, bytes, w, h, fourcc, true);
     vid_frame.key_frame = false; //TODO: detect key frame
     vid_frame.stream_id = m_videostream_id;
-    ACE_Message_Block* mb = VideoFrameInMsgBlock(vid_frame);
+    ACE_Message_Block* mb = m_frame_pool.Acquire(vid_frame);
+    if (mb == nullptr)
+        return nullptr;
 
     //sweep the decoder clean
-    while(m_decoder.GetRGB32Image(vid_frame.frame, vid_frame.frame_length));
+    bool copied = false;
+    if (fourcc == FOURCC_I420)
+        while(m_decoder.GetI420Image(vid_frame.frame, vid_frame.frame_length)) copied = true;
+    else
+        while(m_decoder.GetRGB32Image(vid_frame.frame, vid_frame.frame_length)) copied = true;
 
+    // don't hand out pooled frame which was never written
+    if (!copied)
+    {
+        mb->release();
+        return nullptr;
+    }
     return mb;
 }
 
@@ -862,21 +1424,130 @@ void WebMPlayer::RemoveObsoletePackets()
         m_videoframes_lost += m_packet_no - packet_no;
         m_video_fragments.erase(packet_no);
         packet_no++;
+        //decoder cannot recover until next key frame
+        m_keyframe_request = true;
     }
 
     video_frames_t::iterator i;
     while((i = m_video_frames.begin()) != m_video_frames.end() &&
           W32_LT(i->second.packet_no, m_packet_no))
     {
-        m_video_frames.erase(i);
+        EraseFrame(i);
+    }
+
+    while (!m_nacked.empty() && W32_LT(m_nacked.begin()->first, m_packet_no))
+        m_nacked.erase(m_nacked.begin());
+
+    //keep the arrival time of the packet after 'm_packet_no'
+    while (m_packet_no_max_times.size() > 1 &&
+           W32_LEQ(std::next(m_packet_no_max_times.begin())->first, m_packet_no))
+        m_packet_no_max_times.erase(m_packet_no_max_times.begin());
+}
+
+bool WebMPlayer::FrameQueued(uint32_t packet_no) const
+{
+    return m_video_frames_queued.contains(packet_no);
+}
+
+void WebMPlayer::QueueFrame(uint32_t timestamp, const enc_frame& frame)
+{
+    auto const ii = m_video_frames.find(timestamp);
+    if (ii != m_video_frames.end())
+        m_video_frames_queued.erase(ii->second.packet_no);
+    m_video_frames[timestamp] = frame;
+    m_video_frames_queued.insert(frame.packet_no);
+}
+
+void WebMPlayer::EraseFrame(video_frames_t::iterator ii)
+{
+    m_video_frames_queued.erase(ii->second.packet_no);
+    m_video_frames.erase(ii);
+}
+
+bool WebMPlayer::WaitForRetransmission(const uint32_t* timestamp) const
+{
+    //media file playback is paced by 'timestamp'
+    if (!m_decoded || (timestamp != nullptr) || m_video_frames.empty())
+        return false;
+
+    uint32_t const next_packet_no = m_packet_no_decoded + 1;
+    if (m_video_frames.begin()->second.packet_no == next_packet_no)
+        return false;
+
+    auto const ii = m_nacked.find(next_packet_no);
+    return ii != m_nacked.end() && W32_LT(GETTIMESTAMP(), ii->second + VPX_RTX_WAIT_MSEC);
+}
+
+bool WebMPlayer::GetVideoFeedback(bool& keyframe_request, video_nacks_t& nacks)
+{
+    wguard_t const g(m_mutex);
+
+    uint32_t const now = GETTIMESTAMP();
+    keyframe_request = false;
+    nacks.clear();
+
+    if (m_decoder_ready)
+    {
+        //older packets will be skipped by the decoder and trigger a
+        //key frame request instead
+        uint32_t first = m_packet_no;
+        if (W32_LT(first + VPX_MAX_NACK_PACKETS, m_packet_no_max))
+            first = m_packet_no_max - VPX_MAX_NACK_PACKETS;
+
+        //the newest packet may still have fragments on the way
+        for (uint32_t p = first;W32_LT(p, m_packet_no_max);++p)
+        {
+            if ((m_decoded && W32_LEQ(p, m_packet_no_decoded)) || m_nacked.contains(p))
+                continue;
+
+            //'p' may just be reordered if a newer packet arrived
+            //recently. Newer packets are missing for even shorter.
+            auto const newer = m_packet_no_max_times.upper_bound(p);
+            if (newer != m_packet_no_max_times.end() &&
+                W32_LT(now, newer->second + VPX_NACK_REORDER_MSEC))
+                break;
+
+            auto const ii = m_video_fragments.find(p);
+            if (ii != m_video_fragments.end())
+            {
+                auto const frag0 = ii->second.find(0);
+                uint16_t const fragcnt = (frag0 != ii->second.end()) ? frag0->second->GetFragmentCount() : 0;
+                //unknown fragment count implies all fragments
+                std::set<uint16_t>& missing = nacks[p];
+                for (uint16_t f=0;f<fragcnt;++f)
+                {
+                    if (!ii->second.contains(f))
+                        missing.insert(f);
+                }
+            }
+            else if (!FrameQueued(p))
+            {
+                nacks[p];
+            }
+            else continue;
+
+            m_nacked[p] = now;
+        }
     }
+
+    if (m_keyframe_request &&
+        W32_GEQ(now, m_keyframe_request_time + VIDEO_KEYFRAME_REQUEST_MSEC))
+    {
+        MYTRACE(ACE_TEXT("Requesting key frame from #%d, stream %d\n"),
+                m_userid, int(m_videostream_id));
+        keyframe_request = true;
+        m_keyframe_request = false;
+        m_keyframe_request_time = now;
+    }
+
+    return keyframe_request || !nacks.empty();
 }
 
 
-VideoCodec WebMPlayer::GetVideoCodec() 
+VideoCodec WebMPlayer::GetVideoCodec() const
 {
     VideoCodec codec;
-    codec.codec = CODEC_WEBM_VP8;
+    codec.codec = m_codec;
     return codec;
 }
 
@@ -923,6 +1594,14 @@ int WebMPlayer::GetVideoFramesDropped(bool reset)
         m_videoframes_dropped = 0;
     return n;
 }
+
+int WebMPlayer::GetVideoFramesReassembled(bool reset)
+{
+    int const n = m_videoframes_reassembled;
+    if(reset)
+        m_videoframes_reassembled = 0;
+    return n;
+}
 #endif
 
 } // namespace teamtalk
@@ -28,7 +28,9 @@
 #include "avstream/SoundSystem.h"
 #include "codec/MediaUtil.h"
 #include "myace/MyACE.h"
+#include "mystd/MyStd.h"
 #include "teamtalk/Common.h"
+#include "teamtalk/LatencyHistogram.h"
 #include "teamtalk/PacketHelper.h"
 #include "teamtalk/PacketLayout.h"
 
@@ -45,11 +47,16 @@
 #include <ace/Message_Block.h>
 #include <ace/Recursive_Thread_Mutex.h>
 
+#include <condition_variable>
 #include <cstddef>
 #include <cstdint>
+#include <deque>
 #include <functional>
 #include <map>
 #include <memory>
+#include <mutex>
+#include <set>
+#include <thread>
 #include <vector>
 
 constexpr auto STOPPED_TALKING_DELAY = 500; //msec
@@ -61,12 +68,15 @@ namespace teamtalk {
         std::vector<char> enc_frames;
         std::vector<uint16_t> enc_frame_sizes;
         uint32_t timestamp = 0;
+        //local time when packet was received
+        uint32_t arrival = 0;
         int stream_id = 0;
 
         encframe() = default;
         void Reset()
         {
             timestamp = 0;
+            arrival = 0;
             enc_frames.clear();
             enc_frame_sizes.clear();
             stream_id = 0;
@@ -74,6 +84,7 @@ namespace teamtalk {
     };
 
     using useraudio_callback_t = std::function< void (int userid, StreamType stream_type, const media::AudioFrame& frm) >;
+    using decode_request_t = std::function< void () >;
 
     class AudioPlayer
         : public soundsystem::StreamPlayer
@@ -90,13 +101,16 @@ namespace teamtalk {
         bool StreamPlayerCb(const soundsystem::OutputStreamer& streamer,
                                     short* output_buffer, int n_samples) override;
 
-        bool PlayBuffer(short* output_buffer, int n_samples);
+        //'decode_ahead' only decodes if the next packet is buffered
+        //so loss is handled at the packet's playout deadline
+        bool PlayBuffer(short* output_buffer, int n_samples, bool decode_ahead = false);
         virtual bool DecodeFrame(const encframe& enc_frame,
                                  short* output_buffer, int n_samples) = 0;
 
         uint32_t GetLastPlaytime() const { return m_last_playback; }
         uint16_t GetPlayedPacketNo() const { return m_play_pkt_no; }
         uint32_t GetPlayedPacketTime() const { return m_played_packet_time; }
+        int GetStreamID() const { return m_stream_id; }
         int GetBufferedAudioMSec();
 
         bool IsTalking() const { return m_talking; }
@@ -107,18 +121,48 @@ namespace teamtalk {
         bool IsRecordingAllowed() const { return !m_no_recording; }
 
         void SetAudioBufferSize(int msec);
+        //bounds for adaptive playout delay (time-stretching)
+        void SetPlayoutDelay(int min_msec, int max_msec);
+        //current delay from packet received to played
+        int GetPlayoutDelayMSec();
 
         int GetNumAudioPacketsRecv(bool reset);
         int GetNumAudioPacketsLost(bool reset);
+        //lost packets restored from FEC data in the next packet
+        int GetNumAudioPacketsRecovered(bool reset);
+        //lost packets replaced by decoder's loss concealment
+        int GetNumAudioPacketsConcealed(bool reset);
+        int GetNumAccelerated(bool reset);
+        int GetNumExpanded(bool reset);
+        //packets reassembled from fragments
+        int GetNumAudioPacketsReassembled(bool reset);
 
         const AudioCodec& GetAudioCodec() const { return m_codec; }
 
+        //trace time from packet received until it leaves the jitter
+        //buffer and until it is played by the sound device
+        void SetLatencyTracing(bool enable);
+        //merge traced latency into 'buffered' and 'played' and reset
+        void CollectLatency(LatencyHistogram& buffered, LatencyHistogram& played);
+
+        //decode ahead of StreamPlayerCb() on a worker thread which is
+        //signaled through 'request'. Call before the stream is started
+        void EnableDecodeAhead(decode_request_t request);
+        //called by worker thread. Returns true if frames were decoded
+        bool DecodeAhead();
+
     protected:
         void CleanUpAudioFragments(uint16_t too_old_packet_no);
+        bool PlayDecoded(short* output_buffer, int n_samples);
 
         void AddPacket(const AudioPacket& packet);
         virtual void Reset();
 
+        bool DecodeNextPacket(short* output_buffer, int n_samples);
+        bool PlayTimeStretched(short* output_buffer, int n_samples, bool conceal);
+        void UpdateTargetDelay(const AudioPacket& packet);
+        void TraceLatency(uint32_t arrival);
+
         int m_userid = 0;
         StreamType m_streamtype = STREAMTYPE_NONE;
         soundsystem::soundsystem_t m_sndsys;
@@ -142,6 +186,34 @@ namespace teamtalk {
         //stats
         int m_audiopackets_recv = 0;
         int m_audiopacket_lost = 0;
+        int m_audiopackets_reassembled = 0;
+        int m_audiopackets_recovered = 0;
+        int m_audiopackets_concealed = 0;
+        int m_accelerated = 0;
+        int m_expanded = 0;
+
+        //adaptive playout. Playout delay follows jitter of recent
+        //packets and is adjusted by time-stretching decoded audio
+        //instead of dropping packets
+        bool m_timestretch = false;
+        std::vector<short> m_playout, m_decode_buffer;
+        //transit time (local time - packet time) of recent packets
+        std::deque<int32_t> m_transit_msec;
+        int m_target_msec = 0, m_min_target_msec = 0, m_max_target_msec = 0;
+        uint32_t m_last_arrival = 0;
+        int m_concealed = 0;
+        //last played packet was Opus DTX so missing packets are
+        //silence which the server didn't forward
+        bool m_dtx = false;
+
+        //latency tracing in usec
+        bool m_trace_latency = false;
+        LatencyHistogram m_buffered_latency, m_played_latency;
+
+        //decoded frames ready for StreamPlayerCb()
+        bool m_decode_ahead = false;
+        SPSCRing< std::vector<short> > m_decoded;
+        decode_request_t m_decode_request;
 
         //received frames
         using enc_frames_t = std::map<uint16_t, encframe, W16LessComp>;
@@ -195,6 +267,34 @@ namespace teamtalk {
     };
 #endif
 
+    // Worker threads decoding AudioPlayers ahead of the sound
+    // system's callback so the callback only has to mix
+    class AudioDecodePool : NonCopyable
+    {
+    public:
+        AudioDecodePool() = default;
+        ~AudioDecodePool();
+
+        void AddPlayer(const audio_player_t& player);
+        void RemovePlayer(const AudioPlayer* player);
+
+    private:
+        struct Worker
+        {
+            std::thread thread;
+            std::mutex mutex; // protects 'players'
+            std::mutex signal_mutex; // protects 'pending' and 'stop'
+            std::condition_variable signal;
+            bool pending = false;
+            bool stop = false;
+            std::vector<audio_player_t> players;
+        };
+        void Run(Worker& worker);
+
+        std::mutex m_mutex;
+        std::vector< std::unique_ptr<Worker> > m_workers;
+    };
+
     using fragmentnums_t = std::vector<uint16_t>;
 
 #if defined(ENABLE_VPX)
@@ -206,24 +306,35 @@ namespace teamtalk {
         ~WebMPlayer();
 
         bool AddPacket(const VideoPacket& packet, size_t* n_packets = nullptr);
-        ACE_Message_Block* GetNextFrame(const uint32_t* timestamp = nullptr);
+        //'fourcc' is either FOURCC_RGB32 or FOURCC_I420
+        ACE_Message_Block* GetNextFrame(const uint32_t* timestamp = nullptr,
+                                        media::FourCC fourcc = media::FOURCC_RGB32);
         bool GetNextFrameTime(uint32_t* tm);
 
-        static VideoCodec GetVideoCodec() ;
+        VideoCodec GetVideoCodec() const;
         media::VideoFormat GetVideoFormat() const;
 
         int GetVideoPacketRecv(bool reset);
         int GetVideoFramesRecv(bool reset);
         int GetVideoFramesLost(bool reset);
         int GetVideoFramesDropped(bool reset);
+        //frames reassembled from fragments
+        int GetVideoFramesReassembled(bool reset);
+
+        //loss feedback for the video sender. Returns false if there
+        //is nothing to request
+        bool GetVideoFeedback(bool& keyframe_request, video_nacks_t& nacks);
 
         uint8_t GetStreamID() const { return m_videostream_id; }
 
         uint32_t GetLastTimeStamp() const { return m_local_timestamp; }
 
     private:
-        void ProcessVideoPacket(const VideoPacket& packet);
+        //returns true if packet completed a video frame
+        bool ProcessVideoPacket(const VideoPacket& packet);
         void RemoveObsoletePackets();
+        bool FrameQueued(uint32_t packet_no) const;
+        bool WaitForRetransmission(const uint32_t* timestamp) const;
 
         void DumpFragments();
 
@@ -232,9 +343,24 @@ namespace teamtalk {
         int m_videoframes_recv = 0;
         int m_videoframes_lost = 0;
         int m_videoframes_dropped = 0;
+        int m_videoframes_reassembled = 0;
 
         uint8_t m_videostream_id = 0;
         uint32_t m_packet_no = 0;
+        //newest packet no received
+        uint32_t m_packet_no_max = 0;
+        //packet no of last decoded frame
+        uint32_t m_packet_no_decoded = 0;
+        bool m_decoded = false;
+        //packet no -> time when reported missing
+        std::map<uint32_t, uint32_t, W32LessComp> m_nacked;
+        //newest packet no -> local time when it arrived. Packets
+        //older than it are missing since then
+        std::map<uint32_t, uint32_t, W32LessComp> m_packet_no_max_times;
+        //frames not decoded while waiting for retransmission
+        int m_rtx_held_frames = 0;
+        bool m_keyframe_request = false;
+        uint32_t m_keyframe_request_time = 0;
         //local time stamp of latest packet to arrive
         uint32_t m_local_timestamp = 0;
 
@@ -252,9 +378,17 @@ namespace teamtalk {
         //timestamp -> enc video frame (sorted by UINT32 wrap)
         using video_frames_t = std::map<uint32_t, enc_frame, W32LessComp >;
         video_frames_t m_video_frames;
+        //packet numbers in 'm_video_frames'
+        std::set<uint32_t, W32LessComp> m_video_frames_queued;
+        //keep 'm_video_frames_queued' in sync
+        void QueueFrame(uint32_t timestamp, const enc_frame& frame);
+        void EraseFrame(video_frames_t::iterator ii);
 
         VpxDecoder m_decoder;
+        //decoded frames handed out by GetNextFrame()
+        VideoFramePool m_frame_pool;
         bool m_decoder_ready = false;
+        Codec m_codec = CODEC_WEBM_VP8;
 
         ACE_Recursive_Thread_Mutex m_mutex;
     };
@@ -29,6 +29,7 @@
 #include <ace/Message_Block.h>
 #include <ace/Time_Value.h>
 
+#include <algorithm>
 #include <cassert>
 #include <cstddef>
 #include <utility>
@@ -36,6 +37,51 @@
 using namespace media;
 using namespace teamtalk;
 
+#if defined(ENABLE_VPX)
+static vpx_codec_err_t EncodeVideoFrame(VpxEncoder& encoder, const VideoFrame& vid,
+                                        int enc_deadline, bool force_key_frame)
+{
+    vpx_codec_err_t vpxerr = VPX_CODEC_INVALID_PARAM;
+    switch (vid.fourcc)
+    {
+    case media::FOURCC_RGB32 :
+        vpxerr = encoder.EncodeRGB32(vid.frame, vid.frame_length,
+                                     !vid.top_down, vid.timestamp,
+                                     enc_deadline, force_key_frame);
+        assert(vpxerr == VPX_CODEC_OK);
+        break;
+    case media::FOURCC_I420 :
+        vpxerr = encoder.Encode(vid.frame, VPX_IMG_FMT_I420, 1,
+                                !vid.top_down, vid.timestamp,
+                                enc_deadline, force_key_frame);
+        assert(vpxerr == VPX_CODEC_OK);
+        break;
+    default :
+        assert(0/* unsupported format */);
+        break;
+    }
+    return vpxerr;
+}
+
+// 0 = 256 kbit/sec, i.e. VPX default. Every simulcast layer has a
+// quarter of the pixels of the previous layer.
+static int GetLayerBitrate(int target_bitrate, int layer)
+{
+    if (layer == 0)
+        return target_bitrate;
+    if (target_bitrate == 0)
+        target_bitrate = 256;
+    return std::max(target_bitrate >> (2 * layer), 16);
+}
+
+static int GetScaledBitrate(int target_bitrate, int percent)
+{
+    if (target_bitrate == 0)
+        target_bitrate = 256;
+    return std::max(target_bitrate * percent / 100, 16);
+}
+#endif
+
 VideoThread::VideoThread() 
 {
     m_codec.codec = CODEC_NO_CODEC;
@@ -65,6 +111,7 @@ bool VideoThread::StartEncoder(videoencodercallback_t callback,
 
     m_callback = std::move(callback);
     m_cap_format = cap_format;
+    m_layer_formats[0] = cap_format;
     m_codec = codec;
 
     switch(codec.codec)
@@ -80,20 +127,35 @@ bool VideoThread::StartEncoder(videoencodercallback_t callback,
     }
 #if defined(ENABLE_VPX)
     case CODEC_WEBM_VP8 :
+    case CODEC_WEBM_VP9 :
     {
         int fps = 1;
         if(cap_format.fps_denominator != 0)
             fps = cap_format.fps_numerator / cap_format.fps_denominator;
 
-        MYTRACE(ACE_TEXT("Launching VPX encoder %dx%d@%d bitrate %d\n"),
-                         cap_format.width, cap_format.height, fps,
-                         m_codec.webm_vp8.rc_target_bitrate);
-        
-        if(!m_vpx_encoder.Open(cap_format.width, cap_format.height, 
-                               m_codec.webm_vp8.rc_target_bitrate, fps))
+        bool const vp9 = codec.codec == CODEC_WEBM_VP9;
+        m_layers = std::clamp(codec.webm_vp8.simulcast_layers, 1, VIDEO_SIMULCAST_LAYERS_MAX);
+        for (int i=0;i<m_layers;++i)
         {
-            StopEncoder();
-            return false;
+            if (i > 0)
+            {
+                // must match dimensions of VideoFrameHalfSize()
+                m_layer_formats[i] = m_layer_formats[i-1];
+                m_layer_formats[i].width = (m_layer_formats[i-1].width / 2) & ~1;
+                m_layer_formats[i].height = (m_layer_formats[i-1].height / 2) & ~1;
+            }
+            const VideoFormat& fmt = m_layer_formats[i];
+            int const bitrate = GetLayerBitrate(m_codec.webm_vp8.rc_target_bitrate, i);
+            MYTRACE(ACE_TEXT("Launching VPX %s encoder %dx%d@%d bitrate %d, layer %d/%d\n"),
+                    (vp9 ? ACE_TEXT("VP9") : ACE_TEXT("VP8")),
+                    fmt.width, fmt.height, fps, bitrate, i + 1, m_layers);
+
+            if (fmt.width <= 0 || fmt.height <= 0 ||
+                !m_vpx_encoders[i].Open(fmt.width, fmt.height, bitrate, fps, vp9))
+            {
+                StopEncoder();
+                return false;
+            }
         }
         if(this->activate()<0)
         {
@@ -121,13 +183,22 @@ void VideoThread::StopEncoder()
         break;
 #if defined(ENABLE_VPX)
     case CODEC_WEBM_VP8 :
-        m_vpx_encoder.Close();
+    case CODEC_WEBM_VP9 :
+        for (auto& enc : m_vpx_encoders)
+            enc.Close();
         break;
 #endif
     default : break;
     }
     m_callback = {};
-    m_packet_counter = 0;
+    m_packet_counters = {};
+    m_keyframe_requests = 0;
+    m_keyframe_times = {};
+    m_bitrate_pct = 100;
+    m_encoder_bitrate_pct = 100;
+    m_layer_formats = {};
+    m_layer_buffers = {};
+    m_layers = 1;
     m_cap_format = VideoFormat();
     m_codec = VideoCodec();
     m_frames_passed = m_frames_dropped = 0;
@@ -141,14 +212,29 @@ bool VideoThread::UpdateEncoder(const teamtalk::VideoCodec& codec)
         break;
 #if defined(ENABLE_VPX)
     case CODEC_WEBM_VP8:
+    case CODEC_WEBM_VP9:
+    {
+        // number of simulcast layers cannot change while encoding
+        int const layers = m_layers;
         m_codec.webm_vp8 = codec.webm_vp8;
-        return m_vpx_encoder.Update(codec.webm_vp8.rc_target_bitrate);
+        m_codec.webm_vp8.simulcast_layers = layers;
+        bool ret = true;
+        for (int i=0;i<layers;++i)
+            ret &= m_vpx_encoders[i].Update(GetLayerBitrate(GetScaledBitrate(codec.webm_vp8.rc_target_bitrate, m_bitrate_pct), i));
+        return ret;
+    }
 #endif
     default: break;
     }
     return false;
 }
 
+void VideoThread::RequestKeyFrame(int layer)
+{
+    if (layer >= 0 && layer < VIDEO_SIMULCAST_LAYERS_MAX)
+        m_keyframe_requests |= (1u << layer);
+}
+
 int VideoThread::close(u_long /*flags*/)
 {
     MYTRACE( ACE_TEXT("Video Encoder thread closed\n") );
@@ -169,35 +255,57 @@ int VideoThread::svc()
         {
 #if defined(ENABLE_VPX)
         case CODEC_WEBM_VP8 :
+        case CODEC_WEBM_VP9 :
         {
-            vpx_codec_err_t vpxerr = VPX_CODEC_OK;
-            switch (vid.fourcc)
+            // key frame requests are ignored if a key frame was
+            // recently produced, e.g. if several receivers lost the
+            // same packet
+            uint32_t const keyframe_requests = m_keyframe_requests.exchange(0);
+            ACE_UINT32 const now = GETTIMESTAMP();
+
+            int const bitrate_pct = m_bitrate_pct;
+            if (bitrate_pct != m_encoder_bitrate_pct)
             {
-            case media::FOURCC_RGB32 :
-                vpxerr = m_vpx_encoder.EncodeRGB32(vid.frame, vid.frame_length,
-                                                   !vid.top_down, vid.timestamp,
-                                                   m_codec.webm_vp8.encode_deadline);
-                assert(vpxerr == VPX_CODEC_OK);
-                break;
-            case media::FOURCC_I420 :
-                vpxerr = m_vpx_encoder.Encode(vid.frame, VPX_IMG_FMT_I420, 1,
-                                              !vid.top_down, vid.timestamp,
-                                              m_codec.webm_vp8.encode_deadline);
-                assert(vpxerr == VPX_CODEC_OK);
-                break;
-            default :
-                assert(0/* unsupported format */);
-                break;
+                int const bitrate = GetScaledBitrate(m_codec.webm_vp8.rc_target_bitrate, bitrate_pct);
+                for (int i=0;i<m_layers;++i)
+                    m_vpx_encoders[i].Update(GetLayerBitrate(bitrate, i));
+                m_encoder_bitrate_pct = bitrate_pct;
+            }
+
+            // encode all layers before invoking callback since
+            // callback may take ownership of 'mb'
+            VideoFrame layer_frm = vid;
+            for (int i=0;i<m_layers;++i)
+            {
+                if (i > 0)
+                    layer_frm = VideoFrameHalfSize(layer_frm, m_layer_buffers[i]);
+                bool const force_key_frame = ((keyframe_requests & (1u << i)) != 0u) &&
+                    W32_GEQ(now, m_keyframe_times[i] + (VIDEO_KEYFRAME_REQUEST_MSEC / 2));
+                if (layer_frm.IsValid())
+                    EncodeVideoFrame(m_vpx_encoders[i], layer_frm, m_codec.webm_vp8.encode_deadline,
+                                     force_key_frame);
             }
 
             int enc_len = 0;
-            const char* enc_data = m_vpx_encoder.GetEncodedData(enc_len);
+            bool key_frame = false;
+            const char* enc_data = m_vpx_encoders[0].GetEncodedData(enc_len, key_frame);
+            if (enc_data != nullptr && key_frame)
+                m_keyframe_times[0] = now;
             new_ownership = m_callback(mb, enc_data, enc_len,
-                                       m_packet_counter++, vid.timestamp);
+                                       m_packet_counters[0]++, vid.timestamp,
+                                       0, key_frame);
 
-            while((enc_data = m_vpx_encoder.GetEncodedData(enc_len)) != nullptr)
-                m_callback(nullptr, enc_data, enc_len,
-                           m_packet_counter++, vid.timestamp);
+            for (int i=0;i<m_layers;++i)
+            {
+                while((enc_data = m_vpx_encoders[i].GetEncodedData(enc_len, key_frame)) != nullptr)
+                {
+                    if (key_frame)
+                        m_keyframe_times[i] = now;
+                    m_callback(nullptr, enc_data, enc_len,
+                               m_packet_counters[i]++, vid.timestamp,
+                               i, key_frame);
+                }
+            }
         }
         break;
 #endif
@@ -212,7 +320,7 @@ int VideoThread::svc()
 
 void VideoThread::QueueFrame(const media::VideoFrame& video_frame)
 {
-    ACE_Message_Block* mb = VideoFrameToMsgBlock(video_frame);
+    ACE_Message_Block* mb = m_frame_pool.Copy(video_frame);
     if(mb != nullptr)
         QueueFrame(mb);
 }
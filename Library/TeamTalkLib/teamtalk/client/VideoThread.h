@@ -33,8 +33,11 @@
 #include <ace/Message_Block.h>
 #include <ace/Task_T.h>
 
+#include <array>
+#include <atomic>
 #include <functional>
 #include <memory>
+#include <vector>
 
 //Get VideoFrame from ACE_Message_Block
 #define GET_VIDEOFRAME_FROM_MB(video_frame, msg_block) \
@@ -43,10 +46,12 @@
 #define GET_OGGPACKET_FROM_MB(ogg_pkt, msg_block) \
     memcpy(&(ogg_pkt), (msg_block)->rd_ptr(), sizeof(ogg_pkt))
 
+//'layer' is simulcast layer, 0 = full resolution
 using videoencodercallback_t = std::function< bool (ACE_Message_Block* org_frame, /* can be NULL */
                              const char* enc_data, int enc_len,
                              ACE_UINT32 packet_no,
-                             ACE_UINT32 timestamp) >;
+                             ACE_UINT32 timestamp,
+                             int layer, bool key_frame) >;
 
 class VideoThread : protected ACE_Task<ACE_MT_SYNCH>
 {
@@ -61,12 +66,20 @@ public:
     void StopEncoder();
 
     bool UpdateEncoder(const teamtalk::VideoCodec& codec);
+    //next frame of simulcast 'layer' will be a key frame
+    void RequestKeyFrame(int layer);
+    //percent of codec's target bitrate which receivers can
+    //sustain. Applied to encoder on next frame
+    void SetBitrateScale(int percent) { m_bitrate_pct = percent; }
 
     void QueueFrame(const media::VideoFrame& video_frame);
     void QueueFrame(ACE_Message_Block* mb_video);
 
     const teamtalk::VideoCodec& GetCodec() const { return m_codec; }
     const media::VideoFormat& GetVideoFormat() const { return m_cap_format; }
+    // 1 = simulcast disabled
+    int GetSimulcastLayers() const { return m_layers; }
+    const media::VideoFormat& GetVideoFormat(int layer) const { return m_layer_formats[layer]; }
 
 private:
     int close(u_long /*flags*/) override;
@@ -75,9 +88,20 @@ private:
     videoencodercallback_t m_callback;
     
 #if defined(ENABLE_VPX)
-    VpxEncoder m_vpx_encoder;
+    std::array<VpxEncoder, teamtalk::VIDEO_SIMULCAST_LAYERS_MAX> m_vpx_encoders;
 #endif
-    ACE_UINT32 m_packet_counter = 0;
+    // each simulcast layer has its own packet sequence
+    std::array<ACE_UINT32, teamtalk::VIDEO_SIMULCAST_LAYERS_MAX> m_packet_counters = {};
+    //bitmask of layers where a key frame has been requested
+    std::atomic<uint32_t> m_keyframe_requests{0};
+    std::array<ACE_UINT32, teamtalk::VIDEO_SIMULCAST_LAYERS_MAX> m_keyframe_times = {};
+    std::atomic<int> m_bitrate_pct{100};
+    int m_encoder_bitrate_pct = 100;
+    std::array<media::VideoFormat, teamtalk::VIDEO_SIMULCAST_LAYERS_MAX> m_layer_formats;
+    std::array<std::vector<char>, teamtalk::VIDEO_SIMULCAST_LAYERS_MAX> m_layer_buffers;
+    int m_layers = 1;
+    //captured frames, i.e. queued frames and local preview frames
+    VideoFramePool m_frame_pool{8};
     media::VideoFormat m_cap_format;
     teamtalk::VideoCodec m_codec;
 
@@ -96,7 +120,8 @@ public:
                                    ACE_Message_Block* org_frame, /* can be NULL */
                                    const char* enc_data, int enc_len,
                                    ACE_UINT32 packet_no,
-                                   ACE_UINT32 timestamp) = 0;
+                                   ACE_UINT32 timestamp,
+                                   int layer, bool key_frame) = 0;
 };
 
 #endif
@@ -33,6 +33,7 @@
 
 #include <cstddef>
 #include <ctime>
+#include <utility>
 
 enum
 {
@@ -106,6 +107,7 @@ VoiceLog::VoiceLog(int userid, const ACE_TString& filename,
 #endif /* ENABLE_OPUSTOOLS */
         case CODEC_NO_CODEC :
         case CODEC_WEBM_VP8 :
+        case CODEC_WEBM_VP9 :
             break;
         }
     }
@@ -150,7 +152,8 @@ VoiceLog::VoiceLog(int userid, const ACE_TString& filename,
         return;
     }
 
-    switch(codec.codec)
+    // channel codec format is written without decoding
+    switch(aff == AFF_CHANNELCODEC_FORMAT ? CODEC_NO_CODEC : codec.codec)
     {
     case CODEC_SPEEX :
     case CODEC_SPEEX_VBR :
@@ -168,7 +171,9 @@ VoiceLog::VoiceLog(int userid, const ACE_TString& filename,
 #endif
         break;
     case CODEC_NO_CODEC :
+        break;
     case CODEC_WEBM_VP8 :
+    case CODEC_WEBM_VP9 :
         TTASSERT(0);
         break;
     }
@@ -216,17 +221,30 @@ void VoiceLog::AddVoicePacket(const teamtalk::AudioPacket& packet)
         m_packet_timestamp = packet.GetTime();
 
     m_mQueuePackets[packet_no] = std::make_shared<AudioPacket>(packet);
+    m_queued_bytes += packet.GetPacketSize();
 }
 
 void VoiceLog::FlushLog()
 {
+    // a flush queued before the log was closed
+    if (m_closed)
+        return;
+
     wguard_t g(m_mutex);
     m_mFlushPackets.insert(m_mQueuePackets.begin(),m_mQueuePackets.end());
     m_mQueuePackets.clear();
+    m_queued_bytes = 0;
 
     g.release();
 
     m_packet_current = WritePackets(m_packet_current);
+    m_closed = m_closing;
+}
+
+size_t VoiceLog::GetQueuedBytes()
+{
+    wguard_t const g(m_mutex);
+    return m_queued_bytes;
 }
 
 int VoiceLog::WritePackets(int pktno_cur)
@@ -307,6 +325,7 @@ void VoiceLog::WritePacket(int packet_no)
         break;
     case CODEC_NO_CODEC :
     case CODEC_WEBM_VP8 :
+    case CODEC_WEBM_VP9 :
         assert(0);
         break;
     }
@@ -499,18 +518,39 @@ int VoiceLog::GetChannels() const
 ////////////////////
 //  VoiceLogger
 ////////////////////
-VoiceLogger::VoiceLogger(VoiceLogListener* listener)
-: m_listener(listener)
+VoiceLogger::VoiceLogger(VoiceLogListener* listener, EncodePool* encodepool/* = nullptr*/,
+                         ReactorPool* timers/* = nullptr*/)
+: m_encodepool(encodepool)
+, m_timerpool(timers)
+, m_listener(listener)
 {
+    if (!m_timerpool)
+        m_timer_reactor = &m_reactor;
 }
 
 VoiceLogger::~VoiceLogger()
 {
-    if(m_timerid != -1)
-        m_reactor.cancel_timer(m_timerid, nullptr, 0);
+    if (m_timer_reactor)
+    {
+        guard_t const g(m_timer_reactor->lock());
+        if(m_timerid != -1)
+            m_timer_reactor->cancel_timer(m_timerid, nullptr, 0);
+        if (m_cancel_timerid != -1)
+            m_timer_reactor->cancel_timer(m_cancel_timerid, nullptr, 0);
+    }
     m_reactor.end_reactor_event_loop();
     this->wait();
 
+    if (m_timerpool && m_timer_reactor)
+        m_timerpool->Release(m_timer_reactor);
+
+    if (m_encodepool)
+    {
+        std::lock_guard<std::mutex> const g(m_strands_mtx);
+        for (const auto& strand : m_strands)
+            m_encodepool->Drain(strand.second);
+    }
+
     MYTRACE(ACE_TEXT("~VoiceLogger()\n"));
 }
 
@@ -522,9 +562,16 @@ int VoiceLogger::TimerEvent(ACE_UINT32 timer_event_id, long userdata)
         FlushLogs();
         break;
     case TIMER_CANCELLOG_ID :
-        EndLog(userdata);
+    {
+        // reactor lock is held
+        std::set<int> users;
+        users.swap(m_cancel_users);
+        m_cancel_timerid = -1;
+        for (int const userid : users)
+            EndLog(userid);
         return -1;
     }
+    }
     return 0;
 }
 
@@ -534,18 +581,25 @@ void VoiceLogger::BeginLog(ClientUser& from_user,
                            const ACE_TString& folderpath)
 {
     //spawn thread?
-    if(this->thr_count() == 0)
+    if (m_timerid == -1)
     {
-        TTASSERT(m_timerid == -1);
-        long const prio = ACE_Sched_Params::priority_min (ACE_SCHED_FIFO);
+        if (m_timerpool)
+        {
+            m_timer_reactor = m_timerpool->Acquire();
+        }
+        else
+        {
+            TTASSERT(this->thr_count() == 0);
+            long const prio = ACE_Sched_Params::priority_min (ACE_SCHED_FIFO);
 
-        int const ret = this->activate(THR_NEW_LWP | THR_JOINABLE | THR_INHERIT_SCHED, 
-            1, 0, prio);
-        TTASSERT(ret>=0);
+            int const ret = this->activate(THR_NEW_LWP | THR_JOINABLE | THR_INHERIT_SCHED, 
+                1, 0, prio);
+            TTASSERT(ret>=0);
+        }
 
         TimerHandler* th = nullptr;
         ACE_NEW(th, TimerHandler(*this, TIMER_WRITELOG_ID));
-        m_timerid = m_reactor.schedule_timer(th, nullptr, FLUSH_INTERVAL, FLUSH_INTERVAL);
+        m_timerid = m_timer_reactor->schedule_timer(th, nullptr, FLUSH_INTERVAL, FLUSH_INTERVAL);
         TTASSERT(m_timerid>=0);
     }
 
@@ -605,6 +659,7 @@ void VoiceLogger::BeginLog(ClientUser& from_user,
             break;
         case CODEC_NO_CODEC :
         case CODEC_WEBM_VP8 :
+        case CODEC_WEBM_VP9 :
             break;
         }
         break;
@@ -645,10 +700,12 @@ void VoiceLogger::BeginLog(ClientUser& from_user,
     VoiceLogFile const vlogfile = log->GetVoiceLogFile();
     log.reset(); //ensure file is not locked
 
-    if(active)
-        m_listener->OnMediaFileStatus(from_user.GetUserID(), MFS_STARTED, vlogfile);
-    else
-        m_listener->OnMediaFileStatus(from_user.GetUserID(), MFS_ERROR, vlogfile);
+    // notify after the previous log of the user has finished
+    auto* listener = m_listener;
+    Dispatch(userid, [listener, userid, active, vlogfile]()
+    {
+        listener->OnMediaFileStatus(userid, active ? MFS_STARTED : MFS_ERROR, vlogfile);
+    });
 }
 
 bool VoiceLogger::EndLog(int userid)
@@ -660,18 +717,24 @@ bool VoiceLogger::EndLog(int userid)
     if(ite != m_mLogs.end())
     {
         voicelog_t vlog = ite->second;
-        vlog->SetClosing();
-        vlog->FlushLog();
         m_mLogs.erase(userid);
 
-        VoiceLogFile const vlogfile = vlog->GetVoiceLogFile();
         if(vlog->IsActive())
         {
-            vlog.reset(); //ensure file is not locked
-            m_listener->OnMediaFileStatus(userid, MFS_FINISHED, vlogfile);
+            auto* listener = m_listener;
+            Dispatch(userid, [vlog, listener, userid]() mutable
+            {
+                vlog->SetClosing();
+                vlog->FlushLog();
+                VoiceLogFile const vlogfile = vlog->GetVoiceLogFile();
+                vlog.reset(); //ensure file is not locked
+                listener->OnMediaFileStatus(userid, MFS_FINISHED, vlogfile);
+            });
+            PruneStrands();
             return true;
         }
     }
+    PruneStrands();
     return false;
 }
 
@@ -717,10 +780,20 @@ void VoiceLogger::AddVoicePacket(ClientUser& from_user,
 
 void VoiceLogger::CancelLog(int userid)
 {
+    // no logs have been started
+    if (m_timer_reactor == nullptr)
+        return;
+
+    // cancellations are collected so a single timer closes them
+    guard_t const g(m_timer_reactor->lock());
+    m_cancel_users.insert(userid);
+    if (m_cancel_timerid != -1)
+        return;
+
     TimerHandler* th = nullptr;
-    ACE_NEW(th, TimerHandler(*this, TIMER_CANCELLOG_ID, userid));
-    long const tid = m_reactor.schedule_timer(th, nullptr, ACE_Time_Value::zero);
-    TTASSERT(tid >= 0);
+    ACE_NEW(th, TimerHandler(*this, TIMER_CANCELLOG_ID));
+    m_cancel_timerid = m_timer_reactor->schedule_timer(th, nullptr, ACE_Time_Value::zero);
+    TTASSERT(m_cancel_timerid >= 0);
 }
 
 ACE_TString VoiceLogger::GetVoiceLogFileName(int userid)
@@ -737,19 +810,59 @@ void VoiceLogger::FlushLogs()
 {
     wguard_t g(m_flush_mtx);
 
+    std::vector<voicelog_t> flushLogs;
     std::vector<int> closeLogs;
     for(auto & m_mLog : m_mLogs)
     {
-        m_mLog.second->FlushLog();
+        flushLogs.push_back(m_mLog.second);
         if (m_mLog.second->GetVoiceEndTime() < ACE_OS::gettimeofday())
             closeLogs.push_back(m_mLog.first);
     }
     g.release(); // don't hold lock otherwise lock-order with m_add_mtx can end up wrong
 
+    // Dispatch() may block until the encoders catch up so this must
+    // be outside 'm_flush_mtx' which is needed for adding packets
+    for (const auto& vlog : flushLogs)
+        Dispatch(vlog->GetUserID(), [vlog]() { vlog->FlushLog(); }, vlog->GetQueuedBytes());
+
     for(int closeLog : closeLogs)
         EndLog(closeLog);
 }
 
+void VoiceLogger::Dispatch(int userid, EncodePool::job_t job, size_t bytes/* = 0*/)
+{
+    if (!m_encodepool)
+    {
+        wguard_t const g(m_flush_mtx);
+        job();
+        return;
+    }
+
+    int strand;
+    {
+        std::lock_guard<std::mutex> const g(m_strands_mtx);
+        auto si = m_strands.find(userid);
+        if (si == m_strands.end())
+            si = m_strands.insert({userid, m_encodepool->NewStrand()}).first;
+        strand = si->second;
+    }
+    m_encodepool->Submit(strand, std::move(job), bytes);
+}
+
+void VoiceLogger::PruneStrands()
+{
+    if (!m_encodepool)
+        return;
+
+    // a strand is kept until the close job of its log has run so a
+    // new log of the same user is started after the old one finished
+    std::lock_guard<std::mutex> const g(m_strands_mtx);
+    std::erase_if(m_strands, [this](const std::pair<const int, int>& strand)
+    {
+        return !m_mLogs.contains(strand.first) && m_encodepool->IsIdle(strand.second);
+    });
+}
+
 int VoiceLogger::svc ()
 {
     m_reactor.owner (ACE_OS::thr_self ());
@@ -25,6 +25,8 @@
 #define VOICELOGGER_H
 
 #include "ClientUser.h"
+#include "EncodePool.h"
+#include "ReactorPool.h"
 
 #include "codec/WaveFile.h"
 #include "myace/MyACE.h"
@@ -54,9 +56,13 @@
 #include <ace/Task.h>
 #include <ace/Time_Value.h>
 
+#include <atomic>
+#include <cstddef>
 #include <cstdint>
 #include <map>
 #include <memory>
+#include <mutex>
+#include <set>
 #include <vector>
 
 #define DEFAULT_VOICELOG_VARS ACE_TEXT("%Y%m%d-%H%M%S #%userid% %username%")
@@ -88,6 +94,8 @@ namespace teamtalk {
 
         void AddVoicePacket(const teamtalk::AudioPacket& packet);
         void FlushLog();
+        // bytes of packets waiting for FlushLog()
+        size_t GetQueuedBytes();
 
         uint32_t GetLatestPacketTime() const;
         ACE_Time_Value GetVoiceEndTime() const;
@@ -116,6 +124,7 @@ namespace teamtalk {
         ACE_Recursive_Thread_Mutex m_mutex;
         mappackets_t m_mQueuePackets; //packetnum --> packet
         mappackets_t m_mFlushPackets; //packetnum --> packet
+        size_t m_queued_bytes = 0;
         int m_packet_current = -1;
         ACE_Time_Value m_last;
         uint32_t m_packet_timestamp = 0; // timestamp of most recent packet
@@ -142,7 +151,8 @@ namespace teamtalk {
         AudioFileFormat m_aff = AFF_NONE;
         std::vector<short> m_samples_buf;
         bool m_active = false;
-        bool m_closing = false;
+        std::atomic<bool> m_closing{false};
+        std::atomic<bool> m_closed{false};
         int m_userid = 0;
         int m_streamid = 0;
     };
@@ -161,7 +171,11 @@ namespace teamtalk {
                       , private ACE_Task_Base
     {
     public:
-        VoiceLogger(VoiceLogListener* listener);
+        // 'encodepool' writes the logs. Otherwise logs are written by
+        // VoiceLogger's timer thread. 'timers' runs the timers instead
+        // of a thread of its own
+        VoiceLogger(VoiceLogListener* listener, EncodePool* encodepool = nullptr,
+                    ReactorPool* timers = nullptr);
         ~VoiceLogger() override;
 
         int TimerEvent(ACE_UINT32 timer_event_id, long userdata) override;
@@ -181,11 +195,27 @@ namespace teamtalk {
                       const ACE_TString& folderpath);
         bool EndLog(int userid);
         void FlushLogs();
+        // run 'job' in order with previous jobs of 'userid'
+        void Dispatch(int userid, EncodePool::job_t job, size_t bytes = 0);
+        // forget strands of ended logs which have no jobs left.
+        // Caller must hold 'm_add_mtx'
+        void PruneStrands();
         using mapvlogs_t = std::map<int, voicelog_t>;
         mapvlogs_t m_mLogs;
+        EncodePool* m_encodepool = nullptr;
+        // userid -> strand in 'm_encodepool'
+        std::map<int, int> m_strands;
+        std::mutex m_strands_mtx;
         ACE_Recursive_Thread_Mutex m_add_mtx, m_flush_mtx;
         ACE_Reactor m_reactor;
+        // 'm_reactor' or reactor acquired from 'm_timerpool'
+        ACE_Reactor* m_timer_reactor = nullptr;
+        ReactorPool* m_timerpool = nullptr;
         int m_timerid = -1;
+        // logs to close on next TIMER_CANCELLOG_ID. Protected by
+        // 'm_timer_reactor' lock
+        std::set<int> m_cancel_users;
+        long m_cancel_timerid = -1;
         VoiceLogListener* m_listener = nullptr;
     };
 
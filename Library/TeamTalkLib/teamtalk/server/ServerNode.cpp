@@ -651,6 +651,21 @@ int ServerNode::TimerEvent(ACE_UINT32 timer_event_id, long userdata)
 
         return -1;
     }
+    case TIMERSRV_DESKTOPCURSOR_ID :
+    {
+        //forward latest cursor which was held back by rate limit
+        timer_userdata tm_data;
+        tm_data.userdata = userdata;
+        serveruser_t const src_user = GetUser(tm_data.src_userid, nullptr);
+        if(!src_user)
+            return -1;
+
+        auto const packet = src_user->TakeDesktopCursor();
+        serverchannel_t const chan = src_user->GetChannel();
+        if(packet && chan && chan->GetChannelID() == packet->GetChannel())
+            ForwardDesktopCursorPacket(*src_user, *chan, *packet);
+        return -1;
+    }
     default:
         TTASSERT(0);
     }
@@ -1484,6 +1499,9 @@ int ServerNode::SendPackets(const FieldPacket& packet,
 void ServerNode::ReceivedPacket(PacketHandler* ph, const char* packet_data,
                                 int packet_size, const ACE_INET_Addr& remoteaddr)
 {
+    //forward latency includes waiting for the lock
+    auto const received = std::chrono::steady_clock::now();
+
     GUARD_OBJ(this, Lock());
 
     m_stats.packets_received++;
@@ -1515,10 +1533,19 @@ void ServerNode::ReceivedPacket(PacketHandler* ph, const char* packet_data,
     if(!remoteaddr.is_ip_equal(user->GetUdpAddress()) && 
        !user->GetUdpAddress().is_any())
     {
-        MYTRACE(ACE_TEXT("User #%d sent UDP packet from invalid IP-address %s. Should be %s\n"),
-                user->GetUserID(), InetAddrToString(remoteaddr).c_str(), 
-                InetAddrToString(user->GetUdpAddress()).c_str());
-        return;
+        //client which changed network proves it's the same client
+        //with the token it got on TCP. The hello rebinds its UDP address.
+        if (packetkind != PACKET_KIND_HELLO ||
+            HelloPacket(packet_data, packet_size).GetMigrateToken() != user->GetMigrateToken())
+        {
+            MYTRACE(ACE_TEXT("User #%d sent UDP packet from invalid IP-address %s. Should be %s\n"),
+                    user->GetUserID(), InetAddrToString(remoteaddr).c_str(), 
+                    InetAddrToString(user->GetUdpAddress()).c_str());
+            return;
+        }
+        MYTRACE(ACE_TEXT("User #%d migrated UDP from %s to %s\n"),
+                user->GetUserID(), InetAddrToString(user->GetUdpAddress()).c_str(),
+                InetAddrToString(remoteaddr).c_str());
     }
 
     ACE_INET_Addr const localaddr = ph->GetLocalAddr();
@@ -1535,15 +1562,21 @@ void ServerNode::ReceivedPacket(PacketHandler* ph, const char* packet_data,
 #if defined(ENABLE_ENCRYPTION)
     case PACKET_KIND_VOICE_CRYPT :
         if((user->GetUserRights() & USERRIGHT_TRANSMIT_VOICE) != 0u)
+        {
             ReceivedVoicePacket(*user, CryptVoicePacket(packet_data, packet_size), 
                                 remoteaddr, localaddr);
+            TraceVoiceForward(received);
+        }
         m_stats.voice_bytesreceived += packet_size;
         break;
 #endif
     case PACKET_KIND_VOICE :
         if((user->GetUserRights() & USERRIGHT_TRANSMIT_VOICE) != 0u)
+        {
             ReceivedVoicePacket(*user, VoicePacket(packet_data, packet_size), 
                                 remoteaddr, localaddr);
+            TraceVoiceForward(received);
+        }
         m_stats.voice_bytesreceived += packet_size;
         break;
 #if defined(ENABLE_ENCRYPTION)
@@ -1676,6 +1709,34 @@ void ServerNode::ReceivedPacket(PacketHandler* ph, const char* packet_data,
                                       remoteaddr, localaddr);
         m_stats.desktop_bytesreceived += packet_size;
         break;
+#if defined(ENABLE_ENCRYPTION)
+    case PACKET_KIND_VIDEO_FEEDBACK_CRYPT :
+        ReceivedVideoFeedbackPacket(*user,
+                                    CryptVideoFeedbackPacket(packet_data, packet_size),
+                                    remoteaddr, localaddr);
+        m_stats.vidcap_bytesreceived += packet_size;
+        break;
+#endif
+    case PACKET_KIND_VIDEO_FEEDBACK :
+        ReceivedVideoFeedbackPacket(*user,
+                                    VideoFeedbackPacket(packet_data, packet_size),
+                                    remoteaddr, localaddr);
+        m_stats.vidcap_bytesreceived += packet_size;
+        break;
+#if defined(ENABLE_ENCRYPTION)
+    case PACKET_KIND_RECEIVER_REPORT_CRYPT :
+        ReceivedReceiverReportPacket(*user,
+                                     CryptReceiverReportPacket(packet_data, packet_size),
+                                     remoteaddr, localaddr);
+        m_stats.voice_bytesreceived += packet_size;
+        break;
+#endif
+    case PACKET_KIND_RECEIVER_REPORT :
+        ReceivedReceiverReportPacket(*user,
+                                     ReceiverReportPacket(packet_data, packet_size),
+                                     remoteaddr, localaddr);
+        m_stats.voice_bytesreceived += packet_size;
+        break;
     default :
         MYTRACE(ACE_TEXT("Received an unknown packet %d from #%d\n"),
                 (int)packet.GetKind(), packet.GetSrcUserID());
@@ -1700,6 +1761,14 @@ void ServerNode::ReceivedHelloPacket(ServerUser& user,
     user.SetUdpAddress(remoteaddr, localaddr);
     user.SetPacketProtocol(version);
 
+    //token has been seen on the network so a replay of the hello
+    //must not be able to move the user's UDP address
+    if (packet.GetMigrateToken() != 0 && packet.GetMigrateToken() == user.GetMigrateToken())
+    {
+        user.NewMigrateToken();
+        user.DoMigrateToken();
+    }
+
     //send acknowledge packet
     HelloPacket const ackpacket((uint16_t)0, packet.GetTime());
     SendPacket(ackpacket, user);
@@ -1890,6 +1959,8 @@ void ServerNode::ReceivedVoicePacket(ServerUser& user,
 
     ServerChannel& chan = *tmp_chan;
     uint8_t streamid = 0;
+    bool const opus = chan.GetAudioCodec().codec == CODEC_OPUS;
+    bool dtx = false;
     switch (packet.GetKind())
     {
 #if defined(ENABLE_ENCRYPTION)
@@ -1897,13 +1968,20 @@ void ServerNode::ReceivedVoicePacket(ServerUser& user,
     {
         auto p = CryptVoicePacket(packet).Decrypt(chan.GetEncryptKey());
         if (p)
+        {
             streamid = p->GetStreamID();
+            dtx = opus && p->IsOpusDTX();
+        }
         break;
     }
 #endif
     case PACKET_KIND_VOICE :
-        streamid = VoicePacket(packet).GetStreamID();
+    {
+        VoicePacket const p(packet);
+        streamid = p.GetStreamID();
+        dtx = opus && p.IsOpusDTX();
         break;
+    }
     default :
         assert(packet.GetKind() == PACKET_KIND_VOICE);
         break;
@@ -1926,13 +2004,43 @@ void ServerNode::ReceivedVoicePacket(ServerUser& user,
         m_srvguard->OnUserUpdateStream(user, chan, STREAMTYPE_VOICE, streamid);
     }
 
-    ServerChannel::users_t const users = GetPacketDestinations(user, chan, packet,
+    ServerChannel::users_t users = GetPacketDestinations(user, chan, packet,
                                                          SUBSCRIBE_VOICE,
                                                          SUBSCRIBE_INTERCEPT_VOICE);
 
+    //receivers generate comfort noise after the first DTX packet so
+    //the following silent packets are only forwarded if subscribed.
+    //Clients older than v5.15 count them as lost if not forwarded
+    if (!user.ForwardVoiceDTX(streamid, dtx))
+    {
+        users.erase(std::remove_if(users.begin(), users.end(),
+                                   [&](const auto& u)
+                                   {
+                                       return VersionSameOrLater(u->GetStreamProtocol(), ACE_TEXT("5.15")) &&
+                                           (u->GetSubscriptions(user) & SUBSCRIBE_VOICE_DTX) == 0u;
+                                   }), users.end());
+    }
+
     SendPackets(packet, users);
 }
 
+LatencyHistogram ServerNode::CollectVoiceForwardLatency()
+{
+    ASSERT_SERVERNODE_LOCKED(this);
+
+    LatencyHistogram const latency = m_voice_forward_latency;
+    m_voice_forward_latency.Reset();
+    return latency;
+}
+
+void ServerNode::TraceVoiceForward(const std::chrono::steady_clock::time_point& received)
+{
+    ASSERT_SERVERNODE_LOCKED(this);
+
+    auto const elapsed = std::chrono::steady_clock::now() - received;
+    m_voice_forward_latency.Add(std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count());
+}
+
 void ServerNode::ReceivedAudioFilePacket(ServerUser& user, 
                                          const FieldPacket& packet, 
                                          const ACE_INET_Addr& remoteaddr,
@@ -2002,6 +2110,10 @@ void ServerNode::ReceivedVideoCapturePacket(ServerUser& user,
 
     ServerChannel& chan = *tmp_chan;
     uint8_t streamid = 0;
+    int layer = 0, layers = 0;
+    bool key_frame = false, simulcast = false;
+    uint16_t w, h;
+    bool vidinfo = false;
     
     switch (packet.GetKind())
     {
@@ -2010,13 +2122,22 @@ void ServerNode::ReceivedVideoCapturePacket(ServerUser& user,
     {
         auto p = CryptVideoCapturePacket(packet).Decrypt(chan.GetEncryptKey());
         if (p)
+        {
             streamid = p->GetStreamID();
+            simulcast = p->GetSimulcast(layer, layers, key_frame);
+            vidinfo = p->GetVideoInfo(w, h);
+        }
         break;
     }
 #endif
     case PACKET_KIND_VIDEO :
-        streamid = VideoCapturePacket(packet).GetStreamID();
+    {
+        VideoCapturePacket const p(packet);
+        streamid = p.GetStreamID();
+        simulcast = p.GetSimulcast(layer, layers, key_frame);
+        vidinfo = p.GetVideoInfo(w, h);
         break;
+    }
     default :
         assert(packet.GetKind() == PACKET_KIND_VIDEO_CRYPT);
     }
@@ -2031,8 +2152,20 @@ void ServerNode::ReceivedVideoCapturePacket(ServerUser& user,
     }
 
 
-    ServerChannel::users_t const users = GetPacketDestinations(user, chan, packet, SUBSCRIBE_VIDEOCAPTURE,
+    ServerChannel::users_t users = GetPacketDestinations(user, chan, packet, SUBSCRIBE_VIDEOCAPTURE,
                                                          SUBSCRIBE_INTERCEPT_VIDEOCAPTURE);
+
+    //only forward a single simulcast layer to each user
+    if (simulcast)
+    {
+        bool const layer_start = key_frame && vidinfo;
+        users.erase(std::remove_if(users.begin(), users.end(),
+                                   [&](const auto& u)
+                                   {
+                                       return !u->ForwardVideoCaptureLayer(user, streamid, layer,
+                                                                           layers, layer_start);
+                                   }), users.end());
+    }
     
     SendPackets(packet, users);
 }
@@ -2453,17 +2586,29 @@ void ServerNode::ReceivedDesktopCursorPacket(ServerUser& user,
     if(!tmp_chan)
         return;
 
-    ServerChannel& chan = *tmp_chan;
-
-    if(!chan.CanTransmit(user.GetUserID(), STREAMTYPE_DESKTOP, packet.GetSessionID(), nullptr))
-       return;
-    
 #ifdef _DEBUG
     bool ok_tm = false;
     user.GetLastTimeStamp(&ok_tm);
     TTASSERT(ok_tm);
 #endif
 
+    //throw away packet if a newer one has already arrived
+    bool is_set = false;
+    if(!W32_GEQ(packet.GetTime(),
+                user.GetLastTimeStamp(packet, &is_set)) && is_set)
+        return;
+
+    ForwardDesktopCursorPacket(user, *tmp_chan, packet);
+}
+
+void ServerNode::ForwardDesktopCursorPacket(ServerUser& user, ServerChannel& chan,
+                                            const DesktopCursorPacket& packet)
+{
+    ASSERT_SERVERNODE_LOCKED(this);
+
+    if(!chan.CanTransmit(user.GetUserID(), STREAMTYPE_DESKTOP, packet.GetSessionID(), nullptr))
+       return;
+
     //ignore cursor if it's not the current desktop session
     uint8_t session_id = 0;
     uint16_t dest_userid = 0;
@@ -2476,11 +2621,21 @@ void ServerNode::ReceivedDesktopCursorPacket(ServerUser& user,
     if (!session || session->GetSessionID() != session_id)
         return;
 
-    //throw away packet if a newer one has already arrived
-    bool is_set = false;
-    if(!W32_GEQ(packet.GetTime(),
-                user.GetLastTimeStamp(packet, &is_set)) && is_set)
+    //cap cursor updates from clients which don't coalesce. The
+    //latest cursor is forwarded when the interval expires
+    uint32_t const now = GETTIMESTAMP();
+    if(!user.ForwardDesktopCursor(now))
+    {
+        int const delay = user.QueueDesktopCursor(packet, now);
+        if (delay >= 0)
+        {
+            timer_userdata tm_data = {};
+            tm_data.src_userid = user.GetUserID();
+            if (StartTimer(TIMERSRV_DESKTOPCURSOR_ID, tm_data, ToTimeValue(delay)) < 0)
+                user.TakeDesktopCursor();
+        }
         return;
+    }
 
     if (((m_properties.logevents & SERVERLOGEVENT_USER_NEW_STREAM) != 0u) &&
         user.UpdateActiveStream(STREAMTYPE_DESKTOPINPUT, packet.GetSessionID()) != packet.GetSessionID())
@@ -2621,6 +2776,113 @@ void ServerNode::ReceivedDesktopInputAckPacket(ServerUser& user,
     }
 }
 
+#if defined(ENABLE_ENCRYPTION)
+void ServerNode::ReceivedVideoFeedbackPacket(ServerUser& user, 
+                                             const CryptVideoFeedbackPacket& crypt_pkt, 
+                                             const ACE_INET_Addr& remoteaddr,
+                                             const ACE_INET_Addr& localaddr)
+{
+    serverchannel_t const tmp_chan = GetPacketChannel(user, crypt_pkt, remoteaddr, localaddr);
+    if(!tmp_chan)
+        return;
+
+    ServerChannel const& chan = *tmp_chan;
+
+    auto decrypt_pkt = crypt_pkt.Decrypt(chan.GetEncryptKey());
+    if(!decrypt_pkt)
+        return;
+
+    ReceivedVideoFeedbackPacket(user, *decrypt_pkt, remoteaddr, localaddr);
+}
+#endif
+
+void ServerNode::ReceivedVideoFeedbackPacket(ServerUser& user, 
+                                             const VideoFeedbackPacket& packet, 
+                                             const ACE_INET_Addr& remoteaddr,
+                                             const ACE_INET_Addr& localaddr)
+{
+    serverchannel_t const tmp_chan = GetPacketChannel(user, packet, remoteaddr, localaddr);
+    if(!tmp_chan)
+        return;
+
+    ServerChannel const& chan = *tmp_chan;
+
+    //only a receiver of the video stream can send feedback to the
+    //video sender
+    uint16_t const dest_userid = packet.GetDestUserID();
+    serveruser_t const dest_user = GetUser(dest_userid, &user);
+    if (!dest_user || !chan.UserExists(dest_userid) ||
+        (user.GetSubscriptions(*dest_user) &
+         (SUBSCRIBE_VIDEOCAPTURE | SUBSCRIBE_INTERCEPT_VIDEOCAPTURE)) == 0)
+        return;
+
+#if defined(ENABLE_ENCRYPTION)
+    if(!m_crypt_acceptors.empty())
+    {
+        CryptVideoFeedbackPacket const crypt_pkt(VideoFeedbackPacket(packet), chan.GetEncryptKey());
+        SendPacket(crypt_pkt, *dest_user);
+    }
+    else
+#endif
+    {
+        SendPacket(packet, *dest_user);
+    }
+}
+
+#if defined(ENABLE_ENCRYPTION)
+void ServerNode::ReceivedReceiverReportPacket(ServerUser& user, 
+                                              const CryptReceiverReportPacket& crypt_pkt, 
+                                              const ACE_INET_Addr& remoteaddr,
+                                              const ACE_INET_Addr& localaddr)
+{
+    serverchannel_t const tmp_chan = GetPacketChannel(user, crypt_pkt, remoteaddr, localaddr);
+    if(!tmp_chan)
+        return;
+
+    ServerChannel const& chan = *tmp_chan;
+
+    auto decrypt_pkt = crypt_pkt.Decrypt(chan.GetEncryptKey());
+    if(!decrypt_pkt)
+        return;
+
+    ReceivedReceiverReportPacket(user, *decrypt_pkt, remoteaddr, localaddr);
+}
+#endif
+
+void ServerNode::ReceivedReceiverReportPacket(ServerUser& user, 
+                                              const ReceiverReportPacket& packet, 
+                                              const ACE_INET_Addr& remoteaddr,
+                                              const ACE_INET_Addr& localaddr)
+{
+    serverchannel_t const tmp_chan = GetPacketChannel(user, packet, remoteaddr, localaddr);
+    if(!tmp_chan)
+        return;
+
+    ServerChannel const& chan = *tmp_chan;
+
+    //only a receiver of the voice or video stream can report to the
+    //sender
+    uint16_t const dest_userid = packet.GetDestUserID();
+    serveruser_t const dest_user = GetUser(dest_userid, &user);
+    if (!dest_user || !chan.UserExists(dest_userid) ||
+        (user.GetSubscriptions(*dest_user) &
+         (SUBSCRIBE_VOICE | SUBSCRIBE_INTERCEPT_VOICE |
+          SUBSCRIBE_VIDEOCAPTURE | SUBSCRIBE_INTERCEPT_VIDEOCAPTURE)) == 0)
+        return;
+
+#if defined(ENABLE_ENCRYPTION)
+    if(!m_crypt_acceptors.empty())
+    {
+        CryptReceiverReportPacket const crypt_pkt(ReceiverReportPacket(packet), chan.GetEncryptKey());
+        SendPacket(crypt_pkt, *dest_user);
+    }
+    else
+#endif
+    {
+        SendPacket(packet, *dest_user);
+    }
+}
+
 void ServerNode::CheckKeepAlive()
 {
     ASSERT_SERVERNODE_LOCKED(this);
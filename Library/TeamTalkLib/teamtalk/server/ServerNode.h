@@ -33,6 +33,7 @@
 #include "myace/TimerHandler.h"
 #include "teamtalk/Commands.h"
 #include "teamtalk/Common.h"
+#include "teamtalk/LatencyHistogram.h"
 #include "teamtalk/PacketHandler.h"
 #include "teamtalk/PacketLayout.h"
 #include "teamtalk/StreamHandler.h"
@@ -50,6 +51,7 @@
 #include <ace/SSL/SSL_Context.h>
 #endif
 
+#include <chrono>
 #include <cstddef>
 #include <map>
 #include <memory>
@@ -75,7 +77,8 @@ namespace teamtalk {
         TIMERSRV_DESKTOPPACKET_RTX_TIMEOUT_ID      = 3,
         TIMERSRV_START_DESKTOPTX_ID                = 4,
         TIMERSRV_CLOSE_DESKTOPSESSION_ID           = 5,
-        TIMERSRV_COMMAND_RESUME_ID                 = 6
+        TIMERSRV_COMMAND_RESUME_ID                 = 6,
+        TIMERSRV_DESKTOPCURSOR_ID                  = 7
     };
 
     class ServerNodeListener;
@@ -145,6 +148,7 @@ namespace teamtalk {
         void ReceivedVoicePacket(ServerUser& user, 
                                  const FieldPacket& packet, 
                                  const ACE_INET_Addr& remoteaddr, const ACE_INET_Addr& localaddr);
+        void TraceVoiceForward(const std::chrono::steady_clock::time_point& received);
         void ReceivedAudioFilePacket(ServerUser& user, 
                                      const FieldPacket& packet, 
                                      const ACE_INET_Addr& remoteaddr, const ACE_INET_Addr& localaddr);
@@ -203,11 +207,30 @@ namespace teamtalk {
         void ReceivedDesktopInputAckPacket(ServerUser& user, 
                                            const DesktopInputAckPacket& packet, 
                                            const ACE_INET_Addr& remoteaddr, const ACE_INET_Addr& localaddr);
+#ifdef ENABLE_ENCRYPTION
+        void ReceivedVideoFeedbackPacket(ServerUser& user, 
+                                         const CryptVideoFeedbackPacket& crypt_pkt, 
+                                         const ACE_INET_Addr& remoteaddr, const ACE_INET_Addr& localaddr);
+#endif
+        void ReceivedVideoFeedbackPacket(ServerUser& user, 
+                                         const VideoFeedbackPacket& packet, 
+                                         const ACE_INET_Addr& remoteaddr, const ACE_INET_Addr& localaddr);
+#ifdef ENABLE_ENCRYPTION
+        void ReceivedReceiverReportPacket(ServerUser& user, 
+                                          const CryptReceiverReportPacket& crypt_pkt, 
+                                          const ACE_INET_Addr& remoteaddr, const ACE_INET_Addr& localaddr);
+#endif
+        void ReceivedReceiverReportPacket(ServerUser& user, 
+                                          const ReceiverReportPacket& packet, 
+                                          const ACE_INET_Addr& remoteaddr, const ACE_INET_Addr& localaddr);
 
         //server properties
         void SetServerProperties(const ServerSettings& srvprop);
         const ServerSettings& GetServerProperties() const;
         const ServerStats& GetServerStats() const;
+        //usec from voice packet received until forwarded since last
+        //collected
+        LatencyHistogram CollectVoiceForwardLatency();
         ACE_TString GetMessageOfTheDay(int ignore_userid = 0);
         bool SetFileSharing(const ACE_TString& rootdir);
         ACE_INT64 GetDiskUsage();
@@ -330,6 +353,9 @@ namespace teamtalk {
                                                      const FieldPacket& packet,
                                                      Subscriptions subscrip_check,
                                                      Subscriptions intercept_check);
+        //forward desktop cursor or queue it if rate limited
+        void ForwardDesktopCursorPacket(ServerUser& user, ServerChannel& chan,
+                                        const DesktopCursorPacket& packet);
         //send desktop ack packet (client desktop -> server)
         bool SendDesktopAckPacket(int userid);
         //process desktop transmitter (server -> client)
@@ -401,6 +427,7 @@ namespace teamtalk {
 
         //server stats
         ServerStats m_stats;
+        LatencyHistogram m_voice_forward_latency;
         //listener for changes
         ServerNodeListener* m_srvguard = nullptr;
         //server's properties
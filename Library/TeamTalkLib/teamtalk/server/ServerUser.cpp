@@ -28,8 +28,10 @@
 #include "teamtalk/CodecCommon.h"
 #include "teamtalk/TTAssert.h"
 
+#include <algorithm>
 #include <cstdio>
 #include <queue>
+#include <random>
 
 #if defined(ENABLE_ENCRYPTION)
 #include <openssl/rand.h>
@@ -57,6 +59,23 @@ ServerUser::ServerUser(int userid,
 #if defined(ENABLE_TEAMTALKPRO)
     RAND_bytes(m_accesstoken, sizeof(m_accesstoken));
 #endif
+
+    NewMigrateToken();
+}
+
+void ServerUser::NewMigrateToken()
+{
+    ACE_INT64 token = 0;
+    while (token == 0 || token == m_migrate_token)
+    {
+#if defined(ENABLE_ENCRYPTION)
+        RAND_bytes(reinterpret_cast<unsigned char*>(&token), sizeof(token));
+#else
+        std::random_device rd;
+        token = ACE_INT64((uint64_t(rd()) << 32) | rd());
+#endif
+    }
+    m_migrate_token = token;
 }
 
 ServerUser::~ServerUser()
@@ -1158,6 +1177,7 @@ Subscriptions ServerUser::GetSubscriptions(const ServerUser& user) const
 void ServerUser::ClearUserSubscription(const ServerUser& user)
 {
     m_usersubscriptions.erase(user.GetUserID());
+    m_vidcap_layers.erase(user.GetUserID());
 }
 
 int ServerUser::UpdateActiveStream(StreamType stream, int streamid)
@@ -1167,6 +1187,51 @@ int ServerUser::UpdateActiveStream(StreamType stream, int streamid)
     return prev_streamid;
 }
 
+bool ServerUser::ForwardVideoCaptureLayer(const ServerUser& user, uint8_t streamid,
+                                          int layer, int layers, bool layer_start)
+{
+    int const wanted = ((GetSubscriptions(user) & SUBSCRIBE_VIDEOCAPTURE_LOWRES) != 0u) ? layers - 1 : 0;
+
+    auto& fwd = m_vidcap_layers[user.GetUserID()];
+    if (fwd.streamid != streamid)
+    {
+        fwd.streamid = streamid;
+        fwd.layer = wanted;
+    }
+    else if (fwd.layer != wanted && layer == wanted && layer_start)
+    {
+        fwd.layer = wanted;
+    }
+    return fwd.layer == layer;
+}
+
+bool ServerUser::ForwardDesktopCursor(uint32_t tm)
+{
+    if (m_desktopcursor_forwarded &&
+        W32_LT(tm, m_desktopcursor_time + (DESKTOPCURSOR_INTERVAL_MSEC / 2)))
+        return false;
+
+    m_desktopcursor_time = tm;
+    m_desktopcursor_forwarded = true;
+    return true;
+}
+
+int ServerUser::QueueDesktopCursor(const DesktopCursorPacket& packet, uint32_t tm)
+{
+    bool const pending = bool(m_desktopcursor_pending);
+    m_desktopcursor_pending = std::make_unique<DesktopCursorPacket>(packet);
+    if (pending)
+        return -1;
+    return std::max(int(m_desktopcursor_time + (DESKTOPCURSOR_INTERVAL_MSEC / 2) - tm), 0);
+}
+
+bool ServerUser::ForwardVoiceDTX(uint8_t streamid, bool dtx)
+{
+    bool const forward = !dtx || m_voice_dtx_streamid != streamid;
+    m_voice_dtx_streamid = dtx ? streamid : 0;
+    return forward;
+}
+
 void ServerUser::HandleBinaryFileWrite(const char* buff, int len, bool& bContinue)
 {
     TTASSERT(m_filetransfer.get());
@@ -1235,6 +1300,7 @@ void ServerUser::DoWelcome(const ServerSettings& properties)
 #if defined(ENABLE_TEAMTALKPRO)
     AppendProperty(TT_ACCESSTOKEN, GetAccessToken(), command);
 #endif
+    AppendProperty(TT_MIGRATETOKEN, GetMigrateToken(), command);
 
     command += ACE_TString(EOL);
 
@@ -1611,6 +1677,16 @@ void ServerUser::DoPingReply()
     TransmitCommand(command);
 }
 
+void ServerUser::DoMigrateToken()
+{
+    ACE_TString command;
+    command = ACE_TString(SERVER_MIGRATETOKEN);
+    AppendProperty(TT_MIGRATETOKEN, GetMigrateToken(), command);
+    command += ACE_TString(EOL);
+
+    TransmitCommand(command);
+}
+
 void ServerUser::DoBeginCmd(int cmdID)
 {
     ACE_TString command;
@@ -1898,6 +1974,9 @@ void ServerUser::DoServerStats()
     AppendProperty(TT_FILESTX, stats.files_bytessent, command);
     AppendProperty(TT_FILESRX, stats.files_bytesreceived, command);
     AppendProperty(TT_UPTIME, (ACE_INT64)msec, command);
+    LatencyHistogram const voicefwd = m_servernode.CollectVoiceForwardLatency();
+    AppendProperty(TT_VOICEFWDP50, voicefwd.Percentile(0.5), command);
+    AppendProperty(TT_VOICEFWDP95, voicefwd.Percentile(0.95), command);
     command += EOL;
 
     TransmitCommand(command);
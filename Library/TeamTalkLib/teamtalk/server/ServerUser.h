@@ -109,6 +109,10 @@ namespace teamtalk {
 #if defined(ENABLE_TEAMTALKPRO)
         ACE_TString GetAccessToken() const { return KeyToHexString(m_accesstoken, sizeof(m_accesstoken)); }
 #endif
+        //secret which lets client move its UDP address to a new IP-address
+        ACE_INT64 GetMigrateToken() const { return m_migrate_token; }
+        //token has been sent in cleartext so it must not be used again
+        void NewMigrateToken();
         bool IsAuthorized() const { return (m_account.usertype & (USERTYPE_ADMIN | USERTYPE_DEFAULT)) != 0u; }
         void SetUserAccount(const UserAccount& account) { m_account = account; }
         const UserAccount& GetUserAccount() const { return m_account; }
@@ -141,6 +145,26 @@ namespace teamtalk {
 
         int UpdateActiveStream(StreamType stream, int streamid);
 
+        //whether simulcast 'layer' of 'user's video capture stream
+        //should be forwarded to this user. Only switches layer when
+        //'layer_start' (key frame)
+        bool ForwardVideoCaptureLayer(const ServerUser& user, uint8_t streamid,
+                                      int layer, int layers, bool layer_start);
+
+        //whether desktop cursor from this user should be forwarded
+        //at time 'tm' (rate limited)
+        bool ForwardDesktopCursor(uint32_t tm);
+        //keep 'packet' as the latest cursor held back by rate
+        //limit. Returns msec until it can be forwarded or -1 if a
+        //cursor is already pending
+        int QueueDesktopCursor(const DesktopCursorPacket& packet, uint32_t tm);
+        std::unique_ptr<DesktopCursorPacket> TakeDesktopCursor() { return std::move(m_desktopcursor_pending); }
+
+        //whether voice packet from this user should be forwarded to
+        //users who haven't subscribed to DTX. Only the first of
+        //consecutive DTX packets in a stream is forwarded
+        bool ForwardVoiceDTX(uint8_t streamid, bool dtx);
+
         int GetFileTransferID() const { return (m_filetransfer != nullptr) ? m_filetransfer->transferid : 0; }
 
         ACE_Time_Value GetDuration() const;
@@ -174,6 +198,7 @@ namespace teamtalk {
         void DoKicked(int kicker_userid, bool channel_kick);
         void DoError(const ErrorMsg& cmderr);
         void DoPingReply();
+        void DoMigrateToken();
         void DoShowBan(const BannedUser& ban);
         void DoShowUserAccount(const UserAccount& user);
         void DoAddUserAccount(const UserAccount& user);
@@ -275,6 +300,7 @@ namespace teamtalk {
 #if defined(ENABLE_TEAMTALKPRO)
         uint8_t m_accesstoken[CRYPTKEY_SIZE];
 #endif
+        ACE_INT64 m_migrate_token = 0;
             
         int m_lastkeepalive = 0;
         std::weak_ptr< ServerChannel > m_channel;
@@ -304,6 +330,23 @@ namespace teamtalk {
         usersubscriptions_t m_usersubscriptions;
 
         std::map<StreamType, int> m_active_streams;
+
+        struct VideoLayer
+        {
+            uint8_t streamid = 0;
+            int layer = 0;
+        };
+        //userid -> simulcast layer forwarded to this user
+        std::map<int, VideoLayer> m_vidcap_layers;
+
+        //time of last forwarded desktop cursor
+        uint32_t m_desktopcursor_time = 0;
+        bool m_desktopcursor_forwarded = false;
+        //latest cursor held back by rate limit
+        std::unique_ptr<DesktopCursorPacket> m_desktopcursor_pending;
+
+        //stream id of last voice packet if it was DTX, otherwise 0
+        uint8_t m_voice_dtx_streamid = 0;
     };
 } // namespace teamtalk
 #endif
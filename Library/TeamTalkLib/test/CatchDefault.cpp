@@ -24,9 +24,12 @@
 #include <catch2/catch_test_macros.hpp>
 
 #include "TTUnitTest.h"
+#include "bin/dll/TTClientMsg.h"
 #include "avstream/MediaStreamer.h"
+#include "avstream/PolyphaseResampler.h"
 #include "avstream/VideoCapture.h"
 #include "bin/ttsrv/ServerUtil.h"
+#include "codec/AudioKernels.h"
 #include "codec/MediaUtil.h"
 #include "codec/SpeexEncoder.h"
 #include "codec/WaveFile.h"
@@ -36,8 +39,13 @@
 #include "settings/Settings.h"
 #include "teamtalk/Commands.h"
 #include "teamtalk/Common.h"
+#include "teamtalk/LatencyHistogram.h"
+#include "teamtalk/PacketHelper.h"
 #include "teamtalk/StreamHandler.h"
 #include "teamtalk/client/AudioMuxer.h"
+#include "teamtalk/client/BandwidthEstimator.h"
+#include "teamtalk/client/EncodePool.h"
+#include "teamtalk/client/ReactorPool.h"
 #include "teamtalk/client/Client.h"
 
 #if defined(ENABLE_OGG)
@@ -47,12 +55,21 @@
 #if defined(ENABLE_OPUS)
 #include "avstream/OpusFileStreamer.h"
 #include "codec/OpusDecoder.h"
+#include "codec/OpusEncoder.h"
 #endif
 
 #if defined(ENABLE_FFMPEG)
 #include "avstream/FFmpegStreamer.h"
 #endif
 
+#if defined(ENABLE_VPX)
+#include "codec/VpxDecoder.h"
+#include "codec/VpxEncoder.h"
+#include "teamtalk/CodecCommon.h"
+#include "teamtalk/PacketHelper.h"
+#include "teamtalk/PacketLayout.h"
+#endif
+
 #if defined(ENABLE_PORTAUDIO)
 #include "avstream/PortAudioWrapper.h"
 #endif
@@ -70,8 +87,10 @@
 #include <ace/Synch_Options.h>
 #include <ace/Timer_Heap.h>
 
+#include <algorithm>
 #include <cerrno>
 #include <chrono>
+#include <cmath>
 #include <condition_variable>
 #include <cstdint>
 #include <cstdio>
@@ -83,8 +102,10 @@
 #include <map>
 #include <memory>
 #include <mutex>
+#include <numbers>
 #include <set>
 #include <string>
+#include <thread>
 #include <utility>
 #include <vector>
 
@@ -270,6 +291,40 @@ TEST_CASE( "Last voice packet" )
 }
 #endif
 
+TEST_CASE("VoiceLogStreamRestart")
+{
+    auto ttclient = InitTeamTalk();
+    REQUIRE(InitSound(ttclient));
+    REQUIRE(Connect(ttclient));
+    REQUIRE(Login(ttclient, ACE_TEXT("TxClient")));
+    REQUIRE(JoinRoot(ttclient));
+    REQUIRE(WaitForCmdSuccess(ttclient, TT_DoSubscribe(ttclient, TT_GetMyUserID(ttclient), SUBSCRIBE_VOICE)));
+
+    TTCHAR curdir[1024] = {};
+    ACE_OS::getcwd(curdir, 1024);
+    REQUIRE(TT_SetUserMediaStorageDir(ttclient, TT_GetMyUserID(ttclient), curdir, ACE_TEXT(""), AFF_WAVE_FORMAT));
+    REQUIRE(TT_DBG_SetSoundInputTone(ttclient, STREAMTYPE_VOICE, 500));
+
+    // a new stream ends the current log and begins a new one
+    const size_t STREAMS = 3;
+    for (int i=0;i<STREAMS;i++)
+    {
+        REQUIRE(TT_EnableVoiceTransmission(ttclient, true));
+        WaitForEvent(ttclient, CLIENTEVENT_NONE, 500);
+        REQUIRE(TT_EnableVoiceTransmission(ttclient, false));
+    }
+
+    // previous log must be finished before the next one is started
+    std::vector<MediaFileStatus> events;
+    TTMessage msg;
+    while (events.size() < STREAMS * 2 && WaitForEvent(ttclient, CLIENTEVENT_USER_RECORD_MEDIAFILE, msg))
+        events.push_back(msg.mediafileinfo.nStatus);
+
+    REQUIRE(events.size() == STREAMS * 2);
+    for (size_t i=0;i<events.size();i++)
+        REQUIRE(events[i] == (i % 2 == 0 ? MFS_STARTED : MFS_FINISHED));
+}
+
 TEST_CASE( "AudioMuxerToFile" )
 {
     auto txclient = InitTeamTalk();
@@ -1192,6 +1247,113 @@ TEST_CASE( "AudioMuxerRawSampleIndex" )
     }
 }
 
+TEST_CASE( "AudioMuxerRawManySources" )
+{
+    media::AudioInputFormat const inputfmt(media::AudioFormat(48000, 2), int(48000 * .02));
+    const int TOTALSAMPLES = inputfmt.GetTotalSamples();
+    const int FRAMESIZE = inputfmt.samples;
+    const auto FMT = inputfmt.fmt;
+    const int SOURCES = 100, FRAMES = 20;
+
+    msg_queue_t mixed_frames;
+    auto QSIZE = 1024*1024*10;
+    mixed_frames.high_water_mark(QSIZE);
+    mixed_frames.low_water_mark(QSIZE);
+    AudioMuxer muxer(teamtalk::STREAMTYPE_VOICE | teamtalk::STREAMTYPE_MEDIAFILE_AUDIO);
+    auto mixedfunc = [&] (teamtalk::StreamTypes  /*sts*/, const media::AudioFrame& frm)
+    {
+        auto *mb = AudioFrameToMsgBlock(frm);
+        REQUIRE(mixed_frames.enqueue(mb) >= 0);
+    };
+    REQUIRE(muxer.RegisterMuxCallback(inputfmt, mixedfunc));
+
+    // half of the sources are voice and half media files
+    std::vector<short> buffer(TOTALSAMPLES, short(1));
+    for (int f=0;f<FRAMES;f++)
+    {
+        for (int s=0;s<SOURCES;s++)
+        {
+            auto const st = (s % 2) != 0 ? teamtalk::STREAMTYPE_MEDIAFILE_AUDIO : teamtalk::STREAMTYPE_VOICE;
+            media::AudioFrame frm(FMT, buffer.data(), FRAMESIZE, uint32_t(f * FRAMESIZE));
+            frm.userdata = st;
+            REQUIRE(muxer.QueueUserAudio(s + 1, st, frm));
+        }
+    }
+
+    // all sources must end up in the same mixed frame
+    int mixed = 0;
+    ACE_Message_Block* mb = nullptr;
+    ACE_Time_Value tm = ACE_OS::gettimeofday() + ToTimeValue(5000);
+    while (mixed == 0 && mixed_frames.dequeue(mb, &tm) >= 0)
+    {
+        MBGuard const g(mb);
+        media::AudioFrame const frm(mb);
+        if (frm.input_buffer[0] == SOURCES)
+        {
+            REQUIRE(frm.userdata == (teamtalk::STREAMTYPE_VOICE | teamtalk::STREAMTYPE_MEDIAFILE_AUDIO));
+            for (int i=0;i<TOTALSAMPLES;i++)
+                REQUIRE(frm.input_buffer[i] == SOURCES);
+            mixed++;
+        }
+    }
+    REQUIRE(mixed == 1);
+
+    for (int s=0;s<SOURCES;s++)
+    {
+        auto const st = (s % 2) != 0 ? teamtalk::STREAMTYPE_MEDIAFILE_AUDIO : teamtalk::STREAMTYPE_VOICE;
+        REQUIRE(muxer.QueueUserAudio(s + 1, st, media::AudioFrame()));
+    }
+}
+
+TEST_CASE( "AudioMuxerRawSourceChurn" )
+{
+    media::AudioInputFormat const inputfmt(media::AudioFormat(48000, 2), int(48000 * .02));
+    const int TOTALSAMPLES = inputfmt.GetTotalSamples();
+    const int FRAMESIZE = inputfmt.samples;
+    const auto FMT = inputfmt.fmt;
+    // more users than the AudioMuxer can hold at the same time
+    const int SOURCES = 100, ROUNDS = 12, FRAMES = 5;
+
+    msg_queue_t mixed_frames;
+    auto QSIZE = 1024*1024*10;
+    mixed_frames.high_water_mark(QSIZE);
+    mixed_frames.low_water_mark(QSIZE);
+    AudioMuxer muxer(teamtalk::STREAMTYPE_VOICE);
+    auto mixedfunc = [&] (teamtalk::StreamTypes  /*sts*/, const media::AudioFrame& frm)
+    {
+        auto *mb = AudioFrameToMsgBlock(frm);
+        REQUIRE(mixed_frames.enqueue(mb) >= 0);
+    };
+    REQUIRE(muxer.RegisterMuxCallback(inputfmt, mixedfunc));
+
+    std::vector<short> buffer(TOTALSAMPLES, short(1));
+    for (int r=0;r<ROUNDS;r++)
+    {
+        // users of previous round have left so these are new sources
+        for (int f=0;f<FRAMES;f++)
+        {
+            for (int s=0;s<SOURCES;s++)
+            {
+                media::AudioFrame frm(FMT, buffer.data(), FRAMESIZE, uint32_t(f * FRAMESIZE));
+                frm.userdata = teamtalk::STREAMTYPE_VOICE;
+                REQUIRE(muxer.QueueUserAudio((r * SOURCES) + s + 1, teamtalk::STREAMTYPE_VOICE, frm));
+            }
+        }
+        for (int s=0;s<SOURCES;s++)
+            REQUIRE(muxer.QueueUserAudio((r * SOURCES) + s + 1, teamtalk::STREAMTYPE_VOICE, media::AudioFrame()));
+
+        bool mixed = false;
+        ACE_Message_Block* mb = nullptr;
+        ACE_Time_Value tm = ACE_OS::gettimeofday() + ToTimeValue(5000);
+        while (!mixed && mixed_frames.dequeue(mb, &tm) >= 0)
+        {
+            MBGuard const g(mb);
+            mixed = media::AudioFrame(mb).input_buffer[0] == SOURCES;
+        }
+        REQUIRE(mixed);
+    }
+}
+
 TEST_CASE( "AudioMuxerStreamTypesIntoAudioBlock" )
 {
     auto txclient = InitTeamTalk();
@@ -2726,8 +2888,1024 @@ TEST_CASE("StreamVideoFile")
         }
     }
 }
+
+TEST_CASE("VP9VideoPacket")
+{
+    const int W = 320, H = 240;
+    VpxEncoder enc;
+    REQUIRE(enc.Open(W, H, 256, 10, true));
+
+    std::vector<char> rgb32(RGB32_BYTES(W, H), 0x40);
+    REQUIRE(enc.EncodeRGB32(rgb32.data(), int(rgb32.size()), false, 0, WEBM_VPX_DL_REALTIME) == VPX_CODEC_OK);
+    int enclen = 0;
+    const char* encdata = enc.GetEncodedData(enclen);
+    REQUIRE(encdata);
+    REQUIRE(enclen > 0);
+    REQUIRE(enclen < MAX_PAYLOAD_DATA_SIZE);
+
+    teamtalk::VideoCodec codec;
+    codec.codec = teamtalk::CODEC_WEBM_VP9;
+    uint16_t const w = W, h = H;
+    teamtalk::VideoPacket pkt(teamtalk::PACKET_KIND_VIDEO, 1, 0, 1, 1, &w, &h,
+                              encdata, uint16_t(enclen), teamtalk::GetVideoPacketCodec(codec));
+    REQUIRE(teamtalk::GetVideoCodecFromPacket(pkt.GetVideoCodec()) == teamtalk::CODEC_WEBM_VP9);
+
+    // VP8 packets must not carry the codec field so older clients can parse them
+    codec.codec = teamtalk::CODEC_WEBM_VP8;
+    teamtalk::VideoPacket vp8pkt(teamtalk::PACKET_KIND_VIDEO, 1, 0, 1, 1, &w, &h,
+                                 encdata, uint16_t(enclen), teamtalk::GetVideoPacketCodec(codec));
+    REQUIRE(vp8pkt.GetVideoCodec() == 0);
+    REQUIRE(vp8pkt.GetPacketSize() < pkt.GetPacketSize());
+    REQUIRE(teamtalk::GetVideoCodecFromPacket(vp8pkt.GetVideoCodec()) == teamtalk::CODEC_WEBM_VP8);
+
+    uint16_t pktlen = 0;
+    const char* pktdata = pkt.GetEncodedData(pktlen);
+    REQUIRE(pktlen == enclen);
+
+    VpxDecoder dec;
+    REQUIRE(dec.Open(W, H, true));
+    REQUIRE(dec.PushDecoder(pktdata, pktlen) == VPX_CODEC_OK);
+    auto frame = dec.GetImage();
+    REQUIRE(frame.width == W);
+    REQUIRE(frame.height == H);
+}
+
+TEST_CASE("VideoSimulcastLayers")
+{
+    const int W = 320, H = 240;
+    std::vector<char> rgb32(RGB32_BYTES(W, H), 0x40), buf;
+    media::VideoFrame frm(rgb32.data(), int(rgb32.size()), W, H, media::FOURCC_RGB32, true);
+    auto half = VideoFrameHalfSize(frm, buf);
+    REQUIRE(half.IsValid());
+    REQUIRE(half.width == W / 2);
+    REQUIRE(half.height == H / 2);
+    REQUIRE(half.frame_length == RGB32_BYTES(W / 2, H / 2));
+    REQUIRE(half.frame[0] == 0x40);
+
+    std::vector<char> i420((W * H) + (2 * (W / 2) * (H / 2)), 0x10);
+    media::VideoFrame yuv(i420.data(), int(i420.size()), W, H, media::FOURCC_I420, true);
+    auto quarter = VideoFrameHalfSize(VideoFrameHalfSize(yuv, buf), i420);
+    REQUIRE(quarter.width == W / 4);
+    REQUIRE(quarter.height == H / 4);
+    REQUIRE(quarter.frame_length == (W / 4) * (H / 4) * 3 / 2);
+
+    // all fragments must carry the simulcast layer so the server can filter them
+    std::vector<char> enc_data(3000, 1);
+    uint16_t w = W / 4, h = H / 4;
+    uint8_t const info = teamtalk::VideoPacket::SimulcastInfo(2, 3, true);
+    teamtalk::videopackets_t packets = teamtalk::BuildVideoPackets(teamtalk::PACKET_KIND_VIDEO, 1, 0, 1000, 1, 1, &w, &h,
+                                                                   enc_data.data(), uint32_t(enc_data.size()), 0, info);
+    REQUIRE(packets.size() == 3);
+    for (auto* p : packets)
+    {
+        int layer = 0, layers = 0;
+        bool key_frame = false;
+        REQUIRE(p->GetSimulcast(layer, layers, key_frame));
+        REQUIRE(layer == 2);
+        REQUIRE(layers == 3);
+        REQUIRE(key_frame);
+        delete p;
+    }
+
+    teamtalk::VideoPacket nosimulcast(teamtalk::PACKET_KIND_VIDEO, 1, 0, 1, 1, &w, &h,
+                                      enc_data.data(), 100);
+    int layer, layers;
+    bool key_frame;
+    REQUIRE(!nosimulcast.GetSimulcast(layer, layers, key_frame));
+}
+
+TEST_CASE("VideoFeedbackNack")
+{
+    teamtalk::video_nacks_t nacks;
+    nacks[0xFFFFFFFF]; // entire packet missing
+    nacks[2] = {1, 3};
+
+    teamtalk::VideoFeedbackPacket fb(2, 1000, 1, 5, 1, true, nacks);
+    int buffers = 0;
+    const iovec* vv = fb.GetPacket(buffers);
+    std::vector<char> raw;
+    for (int i = 0; i < buffers; ++i)
+        raw.insert(raw.end(), static_cast<const char*>(vv[i].iov_base),
+                   static_cast<const char*>(vv[i].iov_base) + vv[i].iov_len);
+    REQUIRE(raw.size() == fb.GetPacketSize());
+    teamtalk::VideoFeedbackPacket fbcopy(raw.data(), uint16_t(raw.size()));
+    REQUIRE(fbcopy.GetKind() == teamtalk::PACKET_KIND_VIDEO_FEEDBACK);
+    REQUIRE(fbcopy.GetDestUserID() == 1);
+    REQUIRE(fbcopy.GetStreamID() == 5);
+    REQUIRE(fbcopy.GetLayer() == 1);
+    REQUIRE(fbcopy.GetKeyFrameRequest());
+    REQUIRE(fbcopy.GetNacks() == nacks);
+    // sorted by packet number wrap-around
+    REQUIRE(fbcopy.GetNacks().begin()->first == 0xFFFFFFFF);
+
+    // sender resends only the fragments which were reported missing
+    std::vector<char> enc_data(3000, 1);
+    uint16_t w = 80, h = 60;
+    uint8_t const info = teamtalk::VideoPacket::SimulcastInfo(1, 2, false);
+    teamtalk::VideoPacketHistory history(1000);
+    for (uint32_t packet_no = 0xFFFFFFFF; packet_no != 3; ++packet_no)
+    {
+        auto packets = teamtalk::BuildVideoPackets(teamtalk::PACKET_KIND_VIDEO, 2, 1000 + packet_no, 800, 5, packet_no,
+                                                   &w, &h, enc_data.data(), uint32_t(enc_data.size()), 0, info);
+        REQUIRE(packets.size() == 4);
+        history.AddVideoPackets(packets);
+        for (auto* p : packets)
+            delete p;
+    }
+
+    REQUIRE(history.GetVideoPackets(0, nacks, 3).empty());
+    auto resend = history.GetVideoPackets(1, nacks, 3);
+    REQUIRE(resend.size() == 4 + 2);
+    std::set<std::pair<uint32_t, uint16_t>> resent;
+    for (auto* p : resend)
+    {
+        // only for the user who reported the loss
+        REQUIRE(p->GetHdrType() == teamtalk::PACKETHDR_DEST_USER);
+        REQUIRE(p->GetDestUserID() == 3);
+        REQUIRE(p->ValidatePacket());
+        resent.insert({p->GetPacketNo(), p->GetFragmentNo()});
+        delete p;
+    }
+    REQUIRE(resent.contains({2, 1}));
+    REQUIRE(resent.contains({2, 3}));
+    REQUIRE(!resent.contains({2, 0}));
+
+    history.Reset();
+    REQUIRE(history.GetVideoPackets(1, nacks, 3).empty());
+}
 #endif /* ENABLE_VPX */
 
+TEST_CASE("VideoFramePool")
+{
+    const int W = 64, H = 48;
+    std::vector<char> rgb32(RGB32_BYTES(W, H), 0x20);
+    media::VideoFrame frm(rgb32.data(), int(rgb32.size()), W, H, media::FOURCC_RGB32, true);
+
+    VideoFramePool pool(2);
+    ACE_Message_Block* mb1 = pool.Copy(frm);
+    REQUIRE(mb1);
+    media::VideoFrame frm1(mb1);
+    REQUIRE(frm1.frame_length == frm.frame_length);
+    REQUIRE(frm1.frame[0] == 0x20);
+    const char* buf1 = frm1.frame;
+
+    // frame in use by application cannot be recycled
+    ACE_Message_Block* mb2 = pool.Copy(frm);
+    REQUIRE(media::VideoFrame(mb2).frame != buf1);
+    mb2->release();
+
+    mb1->release();
+    mb1 = pool.Copy(frm);
+    REQUIRE(media::VideoFrame(mb1).frame == buf1);
+
+    // pool exhausted falls back to a new message block
+    mb2 = pool.Copy(frm);
+    ACE_Message_Block* mb3 = pool.Copy(frm);
+    REQUIRE(mb3);
+    REQUIRE(media::VideoFrame(mb3).frame[0] == 0x20);
+    mb1->release();
+    mb2->release();
+    mb3->release();
+
+    // resolution change replaces recycled blocks
+    std::vector<char> small(RGB32_BYTES(W / 2, H / 2), 0x30);
+    media::VideoFrame smallfrm(small.data(), int(small.size()), W / 2, H / 2, media::FOURCC_RGB32, true);
+    mb1 = pool.Copy(smallfrm);
+    REQUIRE(media::VideoFrame(mb1).frame_length == smallfrm.frame_length);
+    REQUIRE(media::VideoFrame(mb1).frame[0] == 0x30);
+
+    // application may release after pool is destroyed
+    pool.Clear();
+    mb1->release();
+}
+
+TEST_CASE("CoalesceDesktopInput")
+{
+    auto move = [](int x, int y)
+    {
+        teamtalk::DesktopInput input;
+        input.x = ACE_UINT16(x);
+        input.y = ACE_UINT16(y);
+        return input;
+    };
+    auto key = [](ACE_UINT32 keycode, teamtalk::KeyStateMask keystate)
+    {
+        teamtalk::DesktopInput input;
+        input.keycode = keycode;
+        input.keystate = keystate;
+        return input;
+    };
+
+    std::vector<teamtalk::DesktopInput> inputs;
+    teamtalk::CoalesceDesktopInput(inputs, {move(1, 1), move(2, 2), move(3, 3)});
+    REQUIRE(inputs.size() == 1);
+    REQUIRE(inputs[0].x == 3);
+
+    // mouse moves across a key event are not merged
+    teamtalk::CoalesceDesktopInput(inputs, {key(0x1000, teamtalk::KEYSTATE_DOWN), move(4, 4)});
+    teamtalk::CoalesceDesktopInput(inputs, {move(5, 5), key(0x1000, teamtalk::KEYSTATE_UP)});
+    REQUIRE(inputs.size() == 4);
+    REQUIRE(inputs[0].x == 3);
+    REQUIRE(inputs[1].keystate == teamtalk::KEYSTATE_DOWN);
+    REQUIRE(inputs[2].x == 5);
+    REQUIRE(inputs[3].keystate == teamtalk::KEYSTATE_UP);
+}
+
+TEST_CASE("AudioTimeStretch")
+{
+    const int SAMPLERATE = 48000, CHANNELS = 2;
+    const int MIN_PERIOD = SAMPLERATE * 25 / 10000, MAX_PERIOD = SAMPLERATE * 15 / 1000;
+
+    // 200 Hz tone has a period of 240 samples
+    std::vector<short> tone(960 * CHANNELS);
+    for (size_t i=0;i<tone.size() / CHANNELS;i++)
+    {
+        for (int c=0;c<CHANNELS;c++)
+            tone[(i * CHANNELS) + c] = short(8000 * std::sin(2.0 * std::numbers::pi * 200 * i / SAMPLERATE));
+    }
+
+    std::vector<short> buffer = tone;
+    int period = AudioAccelerate(buffer, CHANNELS, MIN_PERIOD, MAX_PERIOD);
+    REQUIRE(period > 0);
+    REQUIRE(period % 240 == 0);
+    REQUIRE(buffer.size() == tone.size() - (period * CHANNELS));
+
+    buffer = tone;
+    period = AudioExpand(buffer, CHANNELS, MIN_PERIOD, MAX_PERIOD);
+    REQUIRE(period > 0);
+    REQUIRE(period % 240 == 0);
+    REQUIRE(buffer.size() == tone.size() + (period * CHANNELS));
+
+    // noise is not periodic so it cannot be stretched inaudibly
+    std::vector<short> noise(tone.size());
+    uint32_t seed = 1;
+    for (auto& s : noise)
+    {
+        seed = (seed * 1103515245) + 12345;
+        s = short(int((seed >> 16) % 16000) - 8000);
+    }
+    buffer = noise;
+    REQUIRE(AudioAccelerate(buffer, CHANNELS, MIN_PERIOD, MAX_PERIOD) == 0);
+    REQUIRE(AudioExpand(buffer, CHANNELS, MIN_PERIOD, MAX_PERIOD) == 0);
+    REQUIRE(buffer == noise);
+
+    // buffer must hold two minimum periods
+    buffer.assign(tone.begin(), tone.begin() + (MIN_PERIOD * CHANNELS));
+    REQUIRE(AudioAccelerate(buffer, CHANNELS, MIN_PERIOD, MAX_PERIOD) == 0);
+}
+
+TEST_CASE("AudioKernels")
+{
+    // all instruction sets must give same result as scalar version
+    std::vector<short> a(1925), b(1925);
+    uint32_t seed = 1;
+    for (size_t i=0;i<a.size();i++)
+    {
+        seed = (seed * 1103515245) + 12345;
+        a[i] = short(seed >> 16);
+        seed = (seed * 1103515245) + 12345;
+        b[i] = short(seed >> 16);
+    }
+    a[0] = 32767; b[0] = 1;
+    a[1] = -32768; b[1] = -1;
+
+    auto run = [&](int n)
+    {
+        std::vector<short> result, buf = a;
+        AudioMix(buf.data(), b.data(), n);
+        result.insert(result.end(), buf.begin(), buf.end());
+        buf = a;
+        AudioGain(buf.data(), n, 2.5f);
+        result.insert(result.end(), buf.begin(), buf.end());
+        buf = a;
+        AudioGain(buf.data(), n, 0.3f);
+        result.insert(result.end(), buf.begin(), buf.end());
+        std::vector<short> left(n), right(n), stereo(size_t(n) * 2);
+        AudioSplitStereo(a.data(), left.data(), right.data(), n / 2);
+        AudioMergeStereo(left.data(), right.data(), stereo.data(), n / 2);
+        result.insert(result.end(), left.begin(), left.end());
+        result.insert(result.end(), stereo.begin(), stereo.end());
+        buf = a;
+        AudioMonoToStereo(buf.data(), n / 2);
+        result.insert(result.end(), buf.begin(), buf.end());
+        int const dot = AudioDotProduct(a.data(), b.data(), n);
+        result.push_back(short(dot));
+        result.push_back(short(dot >> 16));
+        return result;
+    };
+
+    AudioKernelISA const best = GetAudioKernelISA();
+    for (int n : {0, 1, 7, 8, 17, 960, 1925})
+    {
+        REQUIRE(SetAudioKernelISA(AUDIOKERNEL_SCALAR));
+        auto const expected = run(n);
+        for (auto isa : { AUDIOKERNEL_SSE2, AUDIOKERNEL_AVX2, AUDIOKERNEL_NEON })
+        {
+            if (SetAudioKernelISA(isa))
+                REQUIRE(run(n) == expected);
+        }
+    }
+    REQUIRE(SetAudioKernelISA(best));
+
+    std::vector<short> mix = {32767, -32768, 100};
+    std::vector<short> const add = {1, -1, -50};
+    AudioMix(mix.data(), add.data(), 3);
+    REQUIRE(mix == std::vector<short>{32767, -32768, 50});
+
+    std::vector<short> mono = {1, 2, 3};
+    mono.resize(6);
+    AudioMonoToStereo(mono.data(), 3);
+    REQUIRE(mono == std::vector<short>{1, 1, 2, 2, 3, 3});
+
+    REQUIRE(AudioDotProduct(add.data(), std::vector<short>{2, 3, 4}.data(), 3) == -201);
+}
+
+TEST_CASE("PolyphaseResampler")
+{
+    // resample a tone and compare with the same tone generated at
+    // the output sample rate
+    auto resampletone = [](const media::AudioFormat& infmt, const media::AudioFormat& outfmt, double freq)
+    {
+        const int FRAMES = 50, INSAMPLES = infmt.samplerate / 50;
+        const int OUTSAMPLES = outfmt.samplerate / 50;
+        PolyphaseResampler resampler(infmt, outfmt, INSAMPLES);
+        REQUIRE(resampler.Init());
+
+        std::vector<short> input(size_t(INSAMPLES) * infmt.channels);
+        std::vector<short> output(size_t(OUTSAMPLES) * outfmt.channels), left;
+        int t = 0, total = 0;
+        for (int f=0;f<FRAMES;f++)
+        {
+            for (int i=0;i<INSAMPLES;i++,t++)
+            {
+                for (int c=0;c<infmt.channels;c++)
+                    input[(i * infmt.channels) + c] = short(16000 * std::sin(2 * std::numbers::pi * freq * t / infmt.samplerate));
+            }
+            total += resampler.Resample(input.data(), INSAMPLES, output.data(), OUTSAMPLES);
+            for (int i=0;i<OUTSAMPLES;i++)
+            {
+                left.push_back(output[i * outfmt.channels]);
+                if (outfmt.channels == 2)
+                    REQUIRE(output[i * 2] == output[(i * 2) + 1]);
+            }
+        }
+        // output is delayed by the samples missing from the first frame
+        int const delay = (FRAMES * OUTSAMPLES) - total;
+        REQUIRE(delay > 0);
+        REQUIRE(delay <= resampler.GetDelay() * 2 * outfmt.samplerate / infmt.samplerate);
+        double error = 0;
+        for (int i=OUTSAMPLES;i<int(left.size());i++)
+        {
+            double const ref = 16000 * std::sin(2 * std::numbers::pi * freq * double(i - delay) / outfmt.samplerate);
+            error = std::max(error, std::abs(left[i] - ref));
+        }
+        return error;
+    };
+
+    using media::AudioFormat;
+    REQUIRE(resampletone(AudioFormat(48000, 1), AudioFormat(16000, 1), 1000) < 32);
+    REQUIRE(resampletone(AudioFormat(16000, 1), AudioFormat(48000, 1), 1000) < 32);
+    REQUIRE(resampletone(AudioFormat(44100, 1), AudioFormat(48000, 1), 3000) < 32);
+    REQUIRE(resampletone(AudioFormat(48000, 2), AudioFormat(32000, 1), 500) < 32);
+    REQUIRE(resampletone(AudioFormat(16000, 1), AudioFormat(48000, 2), 500) < 32);
+    REQUIRE(resampletone(AudioFormat(32000, 2), AudioFormat(48000, 2), 5000) < 32);
+
+    // 12 kHz is above Nyquist of 16 kHz and must be filtered out
+    PolyphaseResampler resampler(AudioFormat(48000, 1), AudioFormat(16000, 1));
+    REQUIRE(resampler.Init());
+    std::vector<short> input(960), output(320);
+    for (int f=0;f<10;f++)
+    {
+        for (int i=0;i<960;i++)
+            input[i] = short(16000 * std::sin(2 * std::numbers::pi * 12000 * ((f * 960) + i) / 48000));
+        REQUIRE(resampler.Resample(input.data(), 960, output.data(), 320) > 0);
+        if (f > 0)
+            REQUIRE(*std::max_element(output.begin(), output.end()) < 100);
+    }
+
+    // streaming interface only produces what the input allows
+    PolyphaseResampler stream(AudioFormat(16000, 1), AudioFormat(48000, 1));
+    REQUIRE(stream.Init());
+    REQUIRE(stream.GetReadAvailable() == 0);
+    stream.Write(input.data(), 160);
+    int const avail = stream.GetReadAvailable();
+    REQUIRE(avail > 0);
+    REQUIRE(avail <= 160 * 3);
+    REQUIRE(stream.Read(output.data(), 320) == std::min(avail, 320));
+    stream.Write(input.data(), 160);
+    REQUIRE(stream.GetReadAvailable() == avail + (160 * 3) - std::min(avail, 320));
+}
+
+TEST_CASE("ResamplerTypePolyphase")
+{
+    using media::AudioFormat;
+    REQUIRE(!TT_SetResamplerType(ResamplerType(2)));
+
+    REQUIRE(TT_SetResamplerType(RESAMPLERTYPE_POLYPHASE));
+    auto resampler = MakeAudioResampler(AudioFormat(48000, 2), AudioFormat(16000, 1), 960);
+    REQUIRE(resampler);
+    REQUIRE(dynamic_cast<PolyphaseResampler*>(resampler.get()) != nullptr);
+    std::vector<short> input(960 * 2, 1000);
+    int samples = 0;
+    REQUIRE(resampler->Resample(input.data(), &samples) != nullptr);
+    REQUIRE(samples > 0);
+    REQUIRE(samples <= 320);
+
+    // polyphase is also the fallback if the build has no other resampler
+    REQUIRE(TT_SetResamplerType(RESAMPLERTYPE_DEFAULT));
+    REQUIRE(MakeAudioResampler(AudioFormat(48000, 2), AudioFormat(16000, 1), 960));
+}
+
+TEST_CASE("SPSCRing")
+{
+    SPSCRing< std::vector<int> > ring;
+    ring.Reset(3, std::vector<int>(16));
+    REQUIRE(ring.Capacity() == 3);
+    REQUIRE(ring.Front() == nullptr);
+
+    const int FRAMES = 100000;
+    std::thread producer([&ring]()
+    {
+        for (int i=0;i<FRAMES;)
+        {
+            auto* slot = ring.Back();
+            if (slot == nullptr)
+            {
+                std::this_thread::yield();
+                continue;
+            }
+            std::fill(slot->begin(), slot->end(), i++);
+            ring.Push();
+        }
+    });
+
+    int next = 0;
+    bool ordered = true;
+    while (next < FRAMES)
+    {
+        auto* slot = ring.Front();
+        if (slot == nullptr)
+        {
+            std::this_thread::yield();
+            continue;
+        }
+        ordered &= std::all_of(slot->begin(), slot->end(), [next](int v) { return v == next; });
+        ring.Pop();
+        next++;
+    }
+    producer.join();
+    REQUIRE(ordered);
+    REQUIRE(ring.Size() == 0);
+}
+
+TEST_CASE("EncodePool")
+{
+    teamtalk::EncodePool pool;
+
+    // jobs on the same strand run in order
+    std::vector<int> const strands = {pool.NewStrand(), pool.NewStrand(), pool.NewStrand()};
+    std::map<int, std::vector<int>> done;
+    std::mutex mtx;
+    for (int i=0;i<100;i++)
+    {
+        for (int s : strands)
+        {
+            pool.Submit(s, [&done, &mtx, s, i]()
+            {
+                std::lock_guard<std::mutex> const g(mtx);
+                done[s].push_back(i);
+            }, 10);
+        }
+    }
+    for (int s : strands)
+        pool.Drain(s);
+    for (int s : strands)
+    {
+        REQUIRE(done[s].size() == 100);
+        REQUIRE(std::is_sorted(done[s].begin(), done[s].end()));
+    }
+    REQUIRE(pool.GetPendingBytes() == 0);
+
+    // submit blocks while memory limit is exceeded
+    pool.SetMemoryLimit(1000);
+    std::promise<void> release;
+    std::shared_future<void> const hold = release.get_future().share();
+    int const strand = pool.NewStrand();
+    pool.Submit(strand, [hold]() { hold.wait(); }, 800);
+    REQUIRE(pool.GetPendingBytes() == 800);
+    auto submitted = std::async(std::launch::async, [&pool, strand]()
+    {
+        pool.Submit(strand, []() {}, 800);
+    });
+    REQUIRE(submitted.wait_for(std::chrono::milliseconds(100)) == std::future_status::timeout);
+    // jobs without memory are never held back
+    pool.Submit(strand, []() {});
+    release.set_value();
+    submitted.wait();
+    pool.Drain(strand);
+    REQUIRE(pool.GetPendingBytes() == 0);
+}
+
+TEST_CASE("ReactorPool")
+{
+    teamtalk::ReactorPool pool(2);
+    REQUIRE(pool.GetThreadsCount() == 2);
+
+    // users are spread evenly
+    std::vector<ACE_Reactor*> reactors;
+    for (int i=0;i<4;i++)
+        reactors.push_back(pool.Acquire());
+    REQUIRE(std::set<ACE_Reactor*>(reactors.begin(), reactors.end()).size() == 2);
+    REQUIRE(pool.GetUsersCount(reactors[0]) == 2);
+    REQUIRE(pool.GetUsersCount(reactors[1]) == 2);
+
+    // timers run in the pool's threads
+    class Timeout : public ACE_Event_Handler
+    {
+    public:
+        std::promise<std::thread::id> fired;
+        int handle_timeout(const ACE_Time_Value& /*tv*/, const void* /*arg*/) override
+        {
+            fired.set_value(std::this_thread::get_id());
+            return 0;
+        }
+    } timeout;
+    REQUIRE(reactors[0]->schedule_timer(&timeout, nullptr, ACE_Time_Value(0, 10000)) >= 0);
+    auto fired = timeout.fired.get_future();
+    REQUIRE(fired.wait_for(std::chrono::seconds(5)) == std::future_status::ready);
+    REQUIRE(fired.get() != std::this_thread::get_id());
+
+    for (auto* r : reactors)
+        pool.Release(r);
+    REQUIRE(pool.GetUsersCount(reactors[0]) == 0);
+    // next user gets the least busy reactor
+    ACE_Reactor* r = pool.Acquire();
+    REQUIRE(pool.GetUsersCount(r) == 1);
+    pool.Release(r);
+}
+
+TEST_CASE("SharedEventLoop")
+{
+    REQUIRE(!TT_SetSharedEventLoop(-1, 0));
+    REQUIRE(TT_SetSharedEventLoop(2, 2));
+
+    std::vector<TTInstPtr> clients(8);
+    for (auto& client : clients)
+    {
+        REQUIRE((client = InitTeamTalk()));
+        REQUIRE(Connect(client));
+        REQUIRE(Login(client, ACE_TEXT("SharedEventLoop")));
+        REQUIRE(JoinRoot(client));
+    }
+
+    // events of all instances are handled by the shared threads
+    for (auto& client : clients)
+    {
+        int const cmdid = TT_DoPing(client);
+        REQUIRE(cmdid > 0);
+        REQUIRE(WaitForCmdSuccess(client, cmdid));
+    }
+
+    REQUIRE(TT_SetSharedEventLoop(0, 0));
+
+    // instances created with a shared event loop keep using it
+    TTInstPtr const own = InitTeamTalk();
+    REQUIRE(Connect(own));
+    REQUIRE(Login(own, ACE_TEXT("OwnEventLoop")));
+    for (auto& client : clients)
+        REQUIRE(WaitForCmdSuccess(client, TT_DoPing(client)));
+}
+
+TEST_CASE("TTMsgQueueBatch")
+{
+    TTMsgQueue events;
+    std::vector<TTMessage> msgs(50);
+    REQUIRE(events.GetMessages(msgs.data(), int(msgs.size()), 0) == 0);
+
+    // more events than ring slots, so some spill
+    const int EVENTS = 1000;
+    for (int i=0;i<EVENTS;i++)
+        events.OnCommandSuccess(i);
+
+    int next = 0;
+    int n = 0;
+    while ((n = events.GetMessages(msgs.data(), int(msgs.size()), 0)) > 0)
+    {
+        for (int i=0;i<n;i++)
+        {
+            REQUIRE(msgs[i].nClientEvent == CLIENTEVENT_CMD_SUCCESS);
+            REQUIRE(msgs[i].nSource == next++);
+        }
+    }
+    REQUIRE(next == EVENTS);
+
+    // events keep their order while produced and consumed concurrently
+    std::thread producer([&events]()
+    {
+        for (int i=0;i<EVENTS;i++)
+            events.OnCommandProcessing(i, (i % 2) != 0);
+    });
+    next = 0;
+    while (next < EVENTS)
+    {
+        n = events.GetMessages(msgs.data(), int(msgs.size()), 1000);
+        REQUIRE(n > 0);
+        for (int i=0;i<n;i++)
+        {
+            REQUIRE(msgs[i].nSource == next);
+            REQUIRE(msgs[i].bActive == ((next % 2) == 0));
+            next++;
+        }
+    }
+    producer.join();
+}
+
+TEST_CASE("UserEventCoalescing")
+{
+    auto txclient = InitTeamTalk();
+    auto rxclient = InitTeamTalk();
+
+    REQUIRE(!TT_SetUserEventCoalescing(rxclient, -1));
+    REQUIRE(TT_SetUserEventCoalescing(rxclient, 50));
+
+    REQUIRE(InitSound(txclient));
+    REQUIRE(Connect(txclient));
+    REQUIRE(Login(txclient, ACE_TEXT("TxClient")));
+    REQUIRE(JoinRoot(txclient));
+
+    REQUIRE(InitSound(rxclient));
+    REQUIRE(Connect(rxclient));
+    REQUIRE(Login(rxclient, ACE_TEXT("RxClient")));
+    REQUIRE(JoinRoot(rxclient));
+
+    int const txuserid = TT_GetMyUserID(txclient);
+
+    // status change and voice start within the same window end up in one event
+    REQUIRE(WaitForCmdSuccess(txclient, TT_DoChangeStatus(txclient, 1, ACE_TEXT("Coalesced"))));
+    REQUIRE(TT_EnableVoiceTransmission(txclient, true));
+
+    auto changed = [&](TTMessage msg)
+    {
+        return msg.nClientEvent == CLIENTEVENT_USER_STATECHANGE &&
+            msg.user.nUserID == txuserid &&
+            (msg.nSource & USERCHANGE_STATE) == USERCHANGE_STATE;
+    };
+    TTMessage ev;
+    REQUIRE(WaitForEvent(rxclient, CLIENTEVENT_USER_STATECHANGE, changed, &ev));
+    REQUIRE((ev.user.uUserState & USERSTATE_VOICE) == USERSTATE_VOICE);
+    REQUIRE(ev.user.nStatusMode == 1);
+
+    // disabled coalescing posts events immediately with no mask
+    REQUIRE(TT_SetUserEventCoalescing(rxclient, 0));
+    REQUIRE(TT_EnableVoiceTransmission(txclient, false));
+    auto voicestop = [&](TTMessage msg)
+    {
+        return msg.nClientEvent == CLIENTEVENT_USER_STATECHANGE &&
+            msg.user.nUserID == txuserid &&
+            (msg.user.uUserState & USERSTATE_VOICE) == USERSTATE_NONE;
+    };
+    REQUIRE(WaitForEvent(rxclient, CLIENTEVENT_USER_STATECHANGE, voicestop, &ev));
+    REQUIRE(ev.nSource == USERCHANGE_NONE);
+}
+
+TEST_CASE("MaxPayloadQuery")
+{
+    auto ttclient = InitTeamTalk();
+    REQUIRE(Connect(ttclient));
+
+    // MTU query started automatically on connect is joined by the
+    // first query
+    REQUIRE(TT_QueryMaxPayload(ttclient, 0));
+
+    TTMessage msg;
+    REQUIRE(WaitForEvent(ttclient, CLIENTEVENT_CON_MAX_PAYLOAD_UPDATED, msg, 15000));
+    REQUIRE(msg.nPayloadSize == MAX_PACKET_PAYLOAD_SIZE);
+
+    // no query is in progress so the first query starts a new one
+    // whereas the second is rejected
+    REQUIRE(TT_QueryMaxPayload(ttclient, 0));
+    REQUIRE(!TT_QueryMaxPayload(ttclient, 0));
+    REQUIRE(WaitForEvent(ttclient, CLIENTEVENT_CON_MAX_PAYLOAD_UPDATED, msg, 15000));
+    REQUIRE(msg.nPayloadSize == MAX_PACKET_PAYLOAD_SIZE);
+
+    ClientStatistics stats = {};
+    REQUIRE(TT_GetClientStatistics(ttclient, &stats));
+    REQUIRE(stats.nPacketsFragmented == 0);
+    REQUIRE(stats.nPacketsReassembled == 0);
+}
+
+TEST_CASE("HelloPacketMigrateToken")
+{
+    ACE_INT64 const token = 0x0123456789ABCDEFLL;
+    teamtalk::HelloPacket const hello(2, 1000, token);
+    int buffers = 0;
+    const iovec* vv = hello.GetPacket(buffers);
+    std::vector<char> raw;
+    for (int i = 0; i < buffers; ++i)
+        raw.insert(raw.end(), static_cast<const char*>(vv[i].iov_base),
+                   static_cast<const char*>(vv[i].iov_base) + vv[i].iov_len);
+    REQUIRE(raw.size() == hello.GetPacketSize());
+    teamtalk::HelloPacket const hellocopy(raw.data(), uint16_t(raw.size()));
+    REQUIRE(hellocopy.GetKind() == teamtalk::PACKET_KIND_HELLO);
+    REQUIRE(hellocopy.GetSrcUserID() == 2);
+    REQUIRE(hellocopy.GetProtocol() == teamtalk::TEAMTALK_PACKET_PROTOCOL);
+    REQUIRE(hellocopy.GetMigrateToken() == token);
+
+    // initial hello has no token so older servers see no difference
+    teamtalk::HelloPacket const initial(2, 1000);
+    REQUIRE(initial.GetMigrateToken() == 0);
+    REQUIRE(initial.GetPacketSize() < hello.GetPacketSize());
+}
+
+TEST_CASE("ReceiverReportPacket")
+{
+    teamtalk::ReceiverReportPacket const rr(2, 1000, 1, 7, 95, 5);
+    PacketCopy<teamtalk::ReceiverReportPacket> const rrcopy(rr);
+    REQUIRE(rrcopy);
+    REQUIRE(rrcopy->GetKind() == teamtalk::PACKET_KIND_RECEIVER_REPORT);
+    REQUIRE(rrcopy->GetSrcUserID() == 2);
+    REQUIRE(rrcopy->GetDestUserID() == 1);
+    REQUIRE(rrcopy->GetStreamID() == 7);
+    REQUIRE(rrcopy->GetPacketsRecv() == 95);
+    REQUIRE(rrcopy->GetPacketsLost() == 5);
+    REQUIRE(rrcopy->GetLossPercent() == 5);
+
+    teamtalk::ReceiverReportPacket const none(2, 1000, 1, 7, 0, 0);
+    REQUIRE(none.GetLossPercent() == 0);
+
+    teamtalk::ReceiverReport report;
+    report.stream_id = 7;
+    report.packets_recv = 50;
+    report.jitter_msec = 12;
+    report.delay_gradient_msec = -4;
+    report.video_stream_id = 3;
+    report.video_frames_recv = 25;
+    report.video_frames_lost = 2;
+    report.video_delay_gradient_msec = 30;
+    teamtalk::ReceiverReportPacket const full(2, 1000, 1, report);
+    teamtalk::ReceiverReportPacket const fullcopy(full);
+    auto const r = fullcopy.GetReport();
+    REQUIRE(r.stream_id == 7);
+    REQUIRE(r.packets_recv == 50);
+    REQUIRE(r.jitter_msec == 12);
+    REQUIRE(r.delay_gradient_msec == -4);
+    REQUIRE(r.video_stream_id == 3);
+    REQUIRE(r.video_frames_recv == 25);
+    REQUIRE(r.video_frames_lost == 2);
+    REQUIRE(r.video_delay_gradient_msec == 30);
+
+    // reports from older clients only have voice loss
+    auto const old = rrcopy->GetReport();
+    REQUIRE(old.stream_id == 7);
+    REQUIRE(old.jitter_msec == 0);
+    REQUIRE(old.video_stream_id == 0);
+}
+
+TEST_CASE("BandwidthEstimator")
+{
+    teamtalk::ArrivalMonitor arrival;
+    // constant transit time, i.e. no jitter and no queuing
+    for (uint32_t i = 0; i < 50; ++i)
+        arrival.PacketReceived(i * 20, 5000 + (i * 20));
+    REQUIRE(arrival.GetJitterMSec() == 0);
+    REQUIRE(arrival.GetDelayGradientMSec() == 0);
+    // transit time grows 2 msec per packet
+    for (uint32_t i = 50; i < 100; ++i)
+        arrival.PacketReceived(i * 20, 5000 + (i * 22) - 100);
+    REQUIRE(arrival.GetJitterMSec() > 0);
+    REQUIRE(arrival.GetDelayGradientMSec() > teamtalk::BWE_DELAY_OVERUSE_MSEC);
+
+    teamtalk::BandwidthEstimator bwe(5000);
+    REQUIRE(bwe.GetBitratePercent(0) == 100);
+
+    // congested receiver determines bitrate
+    bwe.ReportReceived(1, 0, 0, 1000);
+    bwe.ReportReceived(2, 0, 50, 1000);
+    REQUIRE(bwe.GetBitratePercent(1000) < 100);
+    bwe.ReportReceived(2, 30, 0, 2000);
+    int const congested = bwe.GetBitratePercent(2000);
+    REQUIRE(congested < 85);
+    REQUIRE(bwe.GetLossPercent(2000) == 30);
+
+    // bitrate recovers when receiver no longer sees loss or queuing
+    for (uint32_t t = 3000; t < 20000; t += 1000)
+    {
+        bwe.ReportReceived(1, 0, 0, t);
+        bwe.ReportReceived(2, 0, 0, t);
+    }
+    REQUIRE(bwe.GetBitratePercent(20000) == 100);
+
+    // receivers which stop reporting are ignored
+    bwe.ReportReceived(2, 90, 0, 21000);
+    REQUIRE(bwe.GetBitratePercent(21000) >= teamtalk::BWE_BITRATE_MIN_PERCENT);
+    REQUIRE(bwe.GetBitratePercent(30000) == 100);
+    REQUIRE(bwe.GetLossPercent(30000) == 0);
+}
+
+TEST_CASE("FieldIndex")
+{
+    std::vector<char> enc(300, 'x');
+    std::vector<uint16_t> const framesizes = {100, 200};
+    teamtalk::VoicePacket vp(teamtalk::PACKET_KIND_VOICE, 3, 1000, 5, 42,
+                             enc.data(), uint16_t(enc.size()), framesizes);
+    vp.SetChannel(1);
+    int buffers = 0;
+    const iovec* vv = vp.GetPacket(buffers);
+    std::vector<char> raw;
+    for (int i = 0; i < buffers; ++i)
+        raw.insert(raw.end(), static_cast<const char*>(vv[i].iov_base),
+                   static_cast<const char*>(vv[i].iov_base) + vv[i].iov_len);
+
+    teamtalk::FieldIndex fields;
+    REQUIRE(fields.Build(raw.data(), uint16_t(raw.size())));
+
+    // indexed lookups must match scanning the packet
+    teamtalk::VoicePacket scanned(raw.data(), uint16_t(raw.size()));
+    teamtalk::VoicePacket indexed(raw.data(), uint16_t(raw.size()));
+    indexed.SetFieldIndex(&fields);
+    REQUIRE(indexed.GetStreamID() == scanned.GetStreamID());
+    REQUIRE(indexed.GetPacketNumber() == 42);
+    REQUIRE(indexed.GetEncodedFrameSizes() == framesizes);
+    REQUIRE(indexed.HasFragments() == scanned.HasFragments());
+    uint16_t len1 = 0, len2 = 0;
+    REQUIRE(indexed.GetEncodedAudio(len1) == scanned.GetEncodedAudio(len2));
+    REQUIRE(len1 == enc.size());
+    REQUIRE(len1 == len2);
+
+    // same validation as ValidatePacket()
+    for (size_t size = 0; size < raw.size(); ++size)
+    {
+        teamtalk::FieldPacket const truncated(raw.data(), uint16_t(size));
+        bool const valid = size >= teamtalk::TT_CHANNEL_HEADER_SIZE && truncated.ValidatePacket();
+        REQUIRE(fields.Build(raw.data(), uint16_t(size)) == valid);
+    }
+}
+
+TEST_CASE("LatencyHistogram")
+{
+    teamtalk::LatencyHistogram hist;
+    REQUIRE(hist.Count() == 0);
+    REQUIRE(hist.Percentile(0.5) == 0);
+
+    // 1..1000 msec
+    for (int64_t msec = 1; msec <= 1000; ++msec)
+        hist.Add(msec * 1000);
+    REQUIRE(hist.Count() == 1000);
+    REQUIRE(hist.Max() == 1000 * 1000);
+    REQUIRE(std::abs(hist.Percentile(0.5) - (500 * 1000)) <= 500 * 1000 * 3 / 100);
+    REQUIRE(std::abs(hist.Percentile(0.95) - (950 * 1000)) <= 950 * 1000 * 3 / 100);
+
+    // small values have their own bucket
+    teamtalk::LatencyHistogram small;
+    small.Add(3);
+    small.Add(3);
+    small.Add(7);
+    REQUIRE(small.Percentile(0.5) == 3);
+
+    hist.Merge(small);
+    REQUIRE(hist.Count() == 1003);
+    REQUIRE(hist.Max() == 1000 * 1000);
+
+    hist.Reset();
+    REQUIRE(hist.Count() == 0);
+    REQUIRE(hist.Max() == 0);
+    REQUIRE(hist.Percentile(0.95) == 0);
+}
+
+#if defined(ENABLE_OPUS)
+TEST_CASE("OpusFECDecode")
+{
+    const int SAMPLERATE = 48000, CHANNELS = 1, FRAMESIZE = SAMPLERATE / 50;
+
+    OpusEncode enc;
+    REQUIRE(enc.Open(SAMPLERATE, CHANNELS, OPUS_APPLICATION_VOIP));
+    REQUIRE(enc.SetFEC(true));
+    REQUIRE(enc.SetPacketLoss(10));
+    REQUIRE(enc.SetBitrate(32000));
+
+    std::vector< std::vector<char> > packets;
+    std::vector<short> tone(FRAMESIZE * CHANNELS);
+    for (int f=0;f<10;f++)
+    {
+        for (int i=0;i<FRAMESIZE;i++)
+            tone[i] = short(8000 * std::sin(2.0 * std::numbers::pi * 300 * ((f * FRAMESIZE) + i) / SAMPLERATE));
+        std::vector<char> buf(1000);
+        int const ret = enc.Encode(tone.data(), FRAMESIZE, buf.data(), int(buf.size()));
+        REQUIRE(ret > 0);
+        buf.resize(ret);
+        packets.push_back(buf);
+    }
+
+    // lose packet #5 and restore it from FEC in packet #6
+    OpusDecode dec;
+    REQUIRE(dec.Open(SAMPLERATE, CHANNELS));
+    std::vector<short> output(FRAMESIZE * CHANNELS);
+    for (int f=0;f<5;f++)
+        REQUIRE(dec.Decode(packets[f].data(), int(packets[f].size()), output.data(), FRAMESIZE) == FRAMESIZE);
+    std::fill(output.begin(), output.end(), 0);
+    REQUIRE(dec.DecodeFEC(packets[6].data(), int(packets[6].size()), output.data(), FRAMESIZE) == FRAMESIZE);
+    REQUIRE(std::any_of(output.begin(), output.end(), [](short s) { return s != 0; }));
+    REQUIRE(dec.Decode(packets[6].data(), int(packets[6].size()), output.data(), FRAMESIZE) == FRAMESIZE);
+}
+
+TEST_CASE("OpusDTXPacket")
+{
+    const int SAMPLERATE = 48000, CHANNELS = 1, FRAMESIZE = SAMPLERATE / 50;
+
+    OpusEncode enc;
+    REQUIRE(enc.Open(SAMPLERATE, CHANNELS, OPUS_APPLICATION_VOIP));
+    REQUIRE(enc.SetDTX(true));
+    REQUIRE(enc.SetBitrate(32000));
+
+    // encoder enters DTX after a short period of silence
+    std::vector<short> const silence(FRAMESIZE * CHANNELS);
+    std::vector<char> buf(1000);
+    std::vector<uint16_t> framesizes;
+    std::vector<char> enc_data;
+    for (int f=0;f<50 && framesizes.size() < 2;f++)
+    {
+        int const ret = enc.Encode(silence.data(), FRAMESIZE, buf.data(), int(buf.size()));
+        REQUIRE(ret > 0);
+        if (ret <= teamtalk::OPUS_DTX_FRAMESIZE)
+        {
+            framesizes.push_back(uint16_t(ret));
+            enc_data.insert(enc_data.end(), buf.begin(), buf.begin() + ret);
+        }
+        else
+        {
+            framesizes.clear();
+            enc_data.clear();
+        }
+    }
+    REQUIRE(framesizes.size() == 2);
+    REQUIRE(teamtalk::IsOpusDTX(framesizes));
+
+    teamtalk::VoicePacket const dtx(teamtalk::PACKET_KIND_VOICE, 3, 1000, 5, 42,
+                                    enc_data.data(), uint16_t(enc_data.size()), framesizes);
+    REQUIRE(dtx.IsOpusDTX());
+
+    // a single frame with audio makes the packet non-DTX
+    framesizes.push_back(40);
+    std::vector<char> const speech(teamtalk::SumFrameSizes(framesizes), 0);
+    teamtalk::VoicePacket const mixed(teamtalk::PACKET_KIND_VOICE, 3, 1020, 5, 43,
+                                      speech.data(), uint16_t(speech.size()), framesizes);
+    REQUIRE(!mixed.IsOpusDTX());
+
+    // decoder produces comfort noise frames for missing packets
+    OpusDecode dec;
+    REQUIRE(dec.Open(SAMPLERATE, CHANNELS));
+    std::vector<short> output(FRAMESIZE * CHANNELS);
+    REQUIRE(dec.Decode(enc_data.data(), framesizes[0], output.data(), FRAMESIZE) == FRAMESIZE);
+    REQUIRE(dec.Decode(nullptr, 0, output.data(), FRAMESIZE) == FRAMESIZE);
+}
+#endif
+
+TEST_CASE("SoundOutputMixer")
+{
+    auto rxclient = InitTeamTalk();
+    REQUIRE(InitSound(rxclient, DEFAULT, TT_SOUNDDEVICE_ID_TEAMTALK_VIRTUAL, TT_SOUNDDEVICE_ID_TEAMTALK_VIRTUAL));
+    REQUIRE(TT_EnableSoundOutputMixer(rxclient, TRUE));
+    REQUIRE(Connect(rxclient));
+    REQUIRE(Login(rxclient, ACE_TEXT("RxClient")));
+    REQUIRE(JoinRoot(rxclient));
+
+    std::vector<TTInstPtr> txclients;
+    for (int i=0;i<3;i++)
+    {
+        auto txclient = InitTeamTalk();
+        REQUIRE(InitSound(txclient, DEFAULT, TT_SOUNDDEVICE_ID_TEAMTALK_VIRTUAL, TT_SOUNDDEVICE_ID_TEAMTALK_VIRTUAL));
+        REQUIRE(Connect(txclient));
+        REQUIRE(Login(txclient, ACE_TEXT("TxClient")));
+        REQUIRE(JoinRoot(txclient));
+        REQUIRE(TT_DBG_SetSoundInputTone(txclient, STREAMTYPE_VOICE, 300 + (i * 100)));
+        REQUIRE(TT_EnableAudioBlockEvent(rxclient, TT_GetMyUserID(txclient), STREAMTYPE_VOICE, TRUE));
+        txclients.push_back(txclient);
+    }
+
+    for (auto& txclient : txclients)
+        REQUIRE(TT_EnableVoiceTransmission(txclient, TRUE));
+
+    // all users are decoded by the single mixer stream
+    std::set<int> userids;
+    TTMessage msg;
+    while (userids.size() < txclients.size() &&
+           WaitForEvent(rxclient, CLIENTEVENT_USER_AUDIOBLOCK, msg))
+    {
+        AudioBlock* ab = TT_AcquireUserAudioBlock(rxclient, STREAMTYPE_VOICE, msg.nSource);
+        REQUIRE(ab);
+        userids.insert(msg.nSource);
+        REQUIRE(TT_ReleaseUserAudioBlock(rxclient, ab));
+    }
+    REQUIRE(userids.size() == txclients.size());
+
+    // switch back to one output stream per user while talking
+    REQUIRE(TT_EnableSoundOutputMixer(rxclient, FALSE));
+    REQUIRE(WaitForEvent(rxclient, CLIENTEVENT_USER_AUDIOBLOCK, msg));
+
+    for (auto& txclient : txclients)
+        REQUIRE(TT_EnableVoiceTransmission(txclient, FALSE));
+}
+
 TEST_CASE("ReactorDeadlock_BUG")
 {
     MediaFileInfo mfi = {};
@@ -2961,6 +4139,7 @@ TEST_CASE("ReactorLockedTimerStart_BUG")
                        , public VoiceLogListener
     {
         VoiceLogger m_vlog;
+        AudioDecodePool m_decodepool;
     public:
         MyClientNode() : m_vlog(this) {}
         void OnMediaFileStatus(int , teamtalk::MediaFileStatus ,
@@ -2974,6 +4153,7 @@ TEST_CASE("ReactorLockedTimerStart_BUG")
 
         bool QueuePacket(FieldPacket* ) override { return 0; }
         VoiceLogger& voicelogger() override { return m_vlog; }
+        AudioDecodePool& GetAudioDecodePool() override { return m_decodepool; }
 
         void AudioUserCallback(int , teamtalk::StreamType ,
                                const media::AudioFrame & ) override {}
@@ -3517,6 +4697,60 @@ TEST_CASE("OPUSFileEncDec")
     }
 }
 
+TEST_CASE("OPUSFilePassthrough")
+{
+    const int SAMPLERATE = 48000, CHANNELS = 2;
+    for (auto FRAMESIZE_SEC : {.01, .02, .04, .06, .1})
+    {
+        const int FRAMESIZE = int(SAMPLERATE * FRAMESIZE_SEC);
+        const int PACKETS = 100;
+
+        OpusEncode opusenc;
+        REQUIRE(opusenc.Open(SAMPLERATE, CHANNELS, OPUS_APPLICATION_VOIP));
+
+        ACE_TCHAR filename[TT_STRLEN];
+        ACE_OS::snprintf(filename, TT_STRLEN, ACE_TEXT("opuspassthrough_%dmsec.ogg"),
+                         PCM16_SAMPLES_DURATION(FRAMESIZE, SAMPLERATE));
+        OpusFile opusfile;
+        REQUIRE(opusfile.NewFile(filename, CHANNELS, SAMPLERATE, FRAMESIZE));
+
+        // write encoded packets as received, i.e. with every 10th
+        // packet lost
+        std::vector<short> buf(size_t(CHANNELS) * FRAMESIZE);
+        std::vector<char> enc(4000);
+        for (int i=0;i<PACKETS;i++)
+        {
+            for (int s=0;s<FRAMESIZE;s++)
+                buf[size_t(s) * CHANNELS] = buf[(size_t(s) * CHANNELS) + 1] = short(8000 * std::sin(s * 0.05));
+            int const ret = opusenc.Encode(buf.data(), FRAMESIZE, enc.data(), int(enc.size()));
+            REQUIRE(ret > 0);
+            if (i % 10 == 5)
+                REQUIRE(opusfile.WriteEncoded(nullptr, 0, FRAMESIZE, i + 1 == PACKETS) >= 0);
+            else
+                REQUIRE(opusfile.WriteEncoded(enc.data(), ret, FRAMESIZE, i + 1 == PACKETS) >= 0);
+        }
+        opusfile.Close();
+
+        REQUIRE(opusfile.OpenFile(filename));
+        OpusDecode opusdec;
+        REQUIRE(opusdec.Open(opusfile.GetSampleRate(), opusfile.GetChannels()));
+
+        // every packet, including the lost ones, must decode to a full
+        // frame
+        ogg_int64_t samplesduration = 0;
+        int packets = 0, bytes = 0;
+        const unsigned char* opusbuf = nullptr;
+        while ((opusbuf = opusfile.ReadEncoded(bytes, &samplesduration)) != nullptr)
+        {
+            REQUIRE(bytes > 0);
+            REQUIRE(opusdec.Decode(reinterpret_cast<const char*>(opusbuf), bytes, buf.data(), FRAMESIZE) == FRAMESIZE);
+            ++packets;
+        }
+        REQUIRE(packets == PACKETS);
+        REQUIRE(samplesduration == ogg_int64_t(PACKETS) * FRAMESIZE);
+    }
+}
+
 TEST_CASE("OPUSFileSeek")
 {
     const auto SAMPLERATE = 12000;
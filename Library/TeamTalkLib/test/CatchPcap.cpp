@@ -280,6 +280,7 @@ TEST_CASE("PlaybackJitter")
         teamtalk::SoundProperties m_sndprop;
 
         teamtalk::VoiceLogger m_vl;
+        teamtalk::AudioDecodePool m_decodepool;
         std::map<int, teamtalk::clientuser_t> m_users;
         const ttpackets_t& m_packets;
         ttpackets_t::const_iterator m_nextpacket;
@@ -377,6 +378,7 @@ TEST_CASE("PlaybackJitter")
         bool QueuePacket(teamtalk::FieldPacket* packet) override { return true; }
         // Get logger for writing audio streams to disk (wav, ogg, etc)
         teamtalk::VoiceLogger& GetVoiceLogger() override { return m_vl; }
+        teamtalk::AudioDecodePool& GetAudioDecodePool() override { return m_decodepool; }
         // Callback function for teamtalk::AudioPlayer-class
         void AudioUserCallback(int userid, teamtalk::StreamType st, const media::AudioFrame& audio_frame) override { }
     } myclientnode(57, mychan, &events, ttpackets);
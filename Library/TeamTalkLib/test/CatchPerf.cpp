@@ -24,15 +24,28 @@
  /* Catch unit-tests that are performance dependent. Typically unit-tests
   * that cannot run under Valgrind */
 
+#include <catch2/benchmark/catch_benchmark.hpp>
 #include <catch2/catch_test_macros.hpp>
 
 #include "TTUnitTest.h"
 
 #include "avstream/MediaPlayback.h"
+#include "avstream/PolyphaseResampler.h"
+#include "codec/AudioKernels.h"
+#include "codec/MediaUtil.h"
 #include "codec/WaveFile.h"
 #include "myace/MyACE.h"
+#include "teamtalk/client/AudioThread.h"
 
+#if defined(ENABLE_OPUS)
+#include <opus.h>
+#endif
+
+#include <algorithm>
 #include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
 
 TEST_CASE("AudioMuxerStreamRestart")
 {
@@ -965,3 +978,206 @@ TEST_CASE("AudioMuxerInOutOfChannel")
     } while ((n_blocks--) != 0);
     REQUIRE(n_blocks > 0);
 }
+
+TEST_CASE("AudioKernelsMixing")
+{
+    // mix 60 speakers with volume into a 20 msec stereo buffer at
+    // 48 kHz like a recording bot does on every callback
+    const int USERS = 60, SAMPLES = 960 * 2;
+    std::vector< std::vector<short> > users(USERS, std::vector<short>(SAMPLES));
+    for (int u=0;u<USERS;u++)
+    {
+        for (int i=0;i<SAMPLES;i++)
+            users[u][i] = short(((u * 7919) + (i * 104729)) % 65536 - 32768);
+    }
+    std::vector<short> tmp(SAMPLES), mixed(SAMPLES);
+
+    auto mixusers = [&]()
+    {
+        std::memset(mixed.data(), 0, mixed.size() * sizeof(short));
+        for (const auto& u : users)
+        {
+            tmp = u;
+            SOFTGAIN(tmp.data(), SAMPLES / 2, 2, 7, 10);
+            AudioMix(mixed.data(), tmp.data(), SAMPLES);
+        }
+        return mixed[0];
+    };
+
+    AudioKernelISA const best = GetAudioKernelISA();
+    for (auto isa : { AUDIOKERNEL_SCALAR, AUDIOKERNEL_SSE2, AUDIOKERNEL_AVX2, AUDIOKERNEL_NEON })
+    {
+        if (!SetAudioKernelISA(isa))
+            continue;
+        BENCHMARK(std::string("Mix 60 users ") + GetAudioKernelISAName(isa))
+        {
+            return mixusers();
+        };
+        BENCHMARK(std::string("Mono to stereo ") + GetAudioKernelISAName(isa))
+        {
+            AudioMonoToStereo(tmp.data(), SAMPLES / 2);
+            return tmp[0];
+        };
+    }
+    REQUIRE(SetAudioKernelISA(best));
+}
+
+TEST_CASE("PolyphaseResamplerPerf")
+{
+    // 20 msec from a 48 kHz stereo device to a 16 kHz mono codec and
+    // from a 44.1 kHz media file to a 48 kHz device
+    const media::AudioFormat devfmt(48000, 2), codecfmt(16000, 1);
+    const media::AudioFormat filefmt(44100, 2);
+    std::vector<short> input(960 * 2), output(960 * 2);
+    for (size_t i=0;i<input.size();i++)
+        input[i] = short(((i * 104729) % 65536) - 32768);
+
+    auto defaultresampler = MakeAudioResampler(devfmt, codecfmt, 960);
+    if (defaultresampler)
+    {
+        BENCHMARK("Default 48000/2 -> 16000/1")
+        {
+            return defaultresampler->Resample(input.data(), 960, output.data(), 320);
+        };
+    }
+
+    AudioKernelISA const best = GetAudioKernelISA();
+    for (auto isa : { AUDIOKERNEL_SCALAR, AUDIOKERNEL_SSE2, AUDIOKERNEL_AVX2, AUDIOKERNEL_NEON })
+    {
+        if (!SetAudioKernelISA(isa))
+            continue;
+        PolyphaseResampler down(devfmt, codecfmt, 960);
+        REQUIRE(down.Init());
+        BENCHMARK(std::string("Polyphase 48000/2 -> 16000/1 ") + GetAudioKernelISAName(isa))
+        {
+            return down.Resample(input.data(), 960, output.data(), 320);
+        };
+        PolyphaseResampler up(filefmt, devfmt, 882);
+        REQUIRE(up.Init());
+        BENCHMARK(std::string("Polyphase 44100/2 -> 48000/2 ") + GetAudioKernelISAName(isa))
+        {
+            return up.Resample(input.data(), 882, output.data(), 960);
+        };
+    }
+    REQUIRE(SetAudioKernelISA(best));
+}
+
+#if defined(ENABLE_OPUS)
+TEST_CASE("CapturePreprocessPerf")
+{
+    // recorded speech through the capture path in 20 msec frames with
+    // each audio preprocessor
+    WavePCMFile wavfile;
+    REQUIRE(wavfile.OpenFile(ACE_TEXT("testdata/AGC/input_16k_mono_low.wav"), true));
+    const int SAMPLERATE = wavfile.GetSampleRate(), FRAMESIZE = SAMPLERATE / 50;
+    REQUIRE(wavfile.GetChannels() == 1);
+    std::vector<short> speech(wavfile.GetSamplesCount());
+    REQUIRE(wavfile.ReadSamples(speech.data(), int(speech.size())) == int(speech.size()));
+    const int FRAMES = int(speech.size()) / FRAMESIZE;
+    REQUIRE(FRAMES > 0);
+
+    std::vector<teamtalk::AudioPreprocessor> preprocessors;
+    teamtalk::AudioPreprocessor preprocess;
+    preprocess.preprocessor = teamtalk::AUDIOPREPROCESSOR_NONE;
+    preprocessors.push_back(preprocess);
+
+    preprocess.preprocessor = teamtalk::AUDIOPREPROCESSOR_TEAMTALK;
+    preprocess.ttpreprocessor = teamtalk::TTAudioPreprocessor();
+    preprocess.ttpreprocessor.gainlevel = GAIN_NORMAL * 2;
+    preprocess.ttpreprocessor.muteright = true;
+    preprocessors.push_back(preprocess);
+
+#if defined(ENABLE_SPEEXDSP)
+    preprocess.preprocessor = teamtalk::AUDIOPREPROCESSOR_SPEEXDSP;
+    preprocess.speexdsp = teamtalk::SpeexDSP();
+    preprocess.speexdsp.enable_agc = true;
+    preprocess.speexdsp.agc_gainlevel = 8000;
+    preprocess.speexdsp.agc_maxincdbsec = 12;
+    preprocess.speexdsp.agc_maxdecdbsec = -40;
+    preprocess.speexdsp.agc_maxgaindb = 30;
+    preprocess.speexdsp.enable_denoise = true;
+    preprocess.speexdsp.maxnoisesuppressdb = -30;
+    preprocessors.push_back(preprocess);
+#endif
+
+#if defined(ENABLE_WEBRTC)
+    preprocess.preprocessor = teamtalk::AUDIOPREPROCESSOR_WEBRTC;
+    preprocess.webrtc = webrtc::AudioProcessing::Config();
+    preprocess.webrtc.gain_controller2.enabled = true;
+    preprocess.webrtc.noise_suppression.enabled = true;
+    preprocess.webrtc.noise_suppression.level = webrtc::AudioProcessing::Config::NoiseSuppression::kHigh;
+    preprocessors.push_back(preprocess);
+#endif
+
+    const char* stagenames[CAPTURESTAGE_COUNT] = { "tone", "gain", "speexdsp", "webrtc",
+                                                   "voicelevel", "stereomask", "encode", "frame" };
+
+    for (int CHANNELS : {1, 2})
+    {
+        std::vector<short> input(speech.size() * CHANNELS);
+        std::copy(speech.begin(), speech.end(), input.begin());
+        if (CHANNELS == 2)
+            AudioMonoToStereo(input.data(), int(speech.size()));
+
+        teamtalk::AudioCodec codec;
+        codec.codec = teamtalk::CODEC_OPUS;
+        codec.opus.samplerate = SAMPLERATE;
+        codec.opus.channels = CHANNELS;
+        codec.opus.application = OPUS_APPLICATION_VOIP;
+        codec.opus.complexity = 10;
+        codec.opus.fec = true;
+        codec.opus.dtx = false;
+        codec.opus.bitrate = 32000 * CHANNELS;
+        codec.opus.vbr = true;
+        codec.opus.vbr_constraint = false;
+        codec.opus.frame_size = FRAMESIZE;
+        codec.opus.frames_per_packet = 1;
+
+        for (const auto& pp : preprocessors)
+        {
+            AudioThread audthread;
+            auto encoded = [](const teamtalk::AudioCodec& /*codec*/, const char* /*enc_data*/, int /*enc_len*/,
+                              const std::vector<int>& /*enc_frame_sizes*/, const media::AudioFrame& /*org_frame*/) {};
+            REQUIRE(audthread.StartEncoder(encoded, codec, false));
+            REQUIRE(audthread.UpdatePreprocessor(pp));
+            audthread.EnableStageTiming(true);
+
+            int frameno = 0;
+            auto processframe = [&]()
+            {
+                media::AudioFrame frame(media::AudioFormat(SAMPLERATE, CHANNELS),
+                                        &input[size_t(frameno % FRAMES) * FRAMESIZE * CHANNELS], FRAMESIZE);
+                frame.force_enc = true;
+                audthread.QueueAudio(frame);
+                ACE_Time_Value tm;
+                audthread.ProcessQueue(&tm);
+                return ++frameno;
+            };
+
+            std::string const name = "Preprocessor " + std::to_string(pp.preprocessor) +
+                ", channels " + std::to_string(CHANNELS);
+            BENCHMARK(name)
+            {
+                return processframe();
+            };
+
+            auto const stats = audthread.GetStageStats();
+            audthread.StopEncoder();
+
+            std::cout << name << ":";
+            for (int s=0;s<CAPTURESTAGE_COUNT;s++)
+            {
+                if (stats[s].frames > 0)
+                    std::cout << " " << stagenames[s] << " " << (stats[s].total_nsec / stats[s].frames / 1000) << "/"
+                              << (stats[s].max_nsec / 1000) << " usec";
+            }
+            std::cout << std::endl;
+
+            // average CPU of a frame must stay well below its duration
+            const auto& frame = stats[CAPTURESTAGE_FRAME];
+            REQUIRE(frame.frames > 0);
+            REQUIRE(frame.total_nsec / frame.frames < uint64_t(PCM16_SAMPLES_DURATION(FRAMESIZE, SAMPLERATE)) * 1000 * 1000 / 2);
+        }
+    }
+}
+#endif
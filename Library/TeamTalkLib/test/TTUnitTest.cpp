@@ -248,6 +248,7 @@ AudioCodec MakeDefaultAudioCodec(Codec codec)
         break;
     case NO_CODEC :
     case WEBM_VP8_CODEC :
+    case WEBM_VP9_CODEC :
         break;
     }
     return result;
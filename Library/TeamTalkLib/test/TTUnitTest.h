@@ -30,8 +30,10 @@
 #include <string>
 
 
+#include <cstdint>
 #include <functional>
 #include <memory>
+#include <vector>
 
 constexpr auto DEFWAIT = 5000;
 
@@ -84,6 +86,33 @@ public:
 
 TTInstPtr InitTeamTalk();
 
+// Serialized copy of a FieldPacket parsed again as 'PACKET'. False if
+// serialized size doesn't match GetPacketSize()
+template <typename PACKET>
+class PacketCopy
+{
+public:
+    explicit PacketCopy(const PACKET& packet)
+    {
+        int buffers = 0;
+        const auto* vv = packet.GetPacket(buffers);
+        for (int i = 0; i < buffers; ++i)
+            m_raw.insert(m_raw.end(), static_cast<const char*>(vv[i].iov_base),
+                         static_cast<const char*>(vv[i].iov_base) + vv[i].iov_len);
+        if (m_raw.size() == packet.GetPacketSize())
+            m_packet = std::make_unique<PACKET>(m_raw.data(), uint16_t(m_raw.size()));
+    }
+    PacketCopy(const PacketCopy&) = delete;
+    void operator=(const PacketCopy&) = delete;
+
+    const PACKET* operator->() const { return m_packet.get(); }
+    explicit operator bool() const { return m_packet != nullptr; }
+
+private:
+    std::vector<char> m_raw;
+    std::unique_ptr<PACKET> m_packet;
+};
+
 class ABPtr
 {
 private:
@@ -100,6 +100,7 @@ SOURCES +=  main.cpp \
             $$TEAMTALKLIB_ROOT/myace/TimerHandler.cpp \
             $$TEAMTALKLIB_ROOT/mystd/MyStd.cpp \
             $$TEAMTALKLIB_ROOT/avstream/AudioResampler.cpp \
+            $$TEAMTALKLIB_ROOT/avstream/PolyphaseResampler.cpp \
             $$TEAMTALKLIB_ROOT/avstream/VideoCapture.cpp \
             $$TEAMTALKLIB_ROOT/avstream/SoundLoopback.cpp \
             $$TEAMTALKLIB_ROOT/avstream/SoundSystem.cpp \
@@ -117,6 +118,7 @@ SOURCES +=  main.cpp \
             $$TEAMTALKLIB_ROOT/codec/BmpFile.cpp \
             $$TEAMTALKLIB_ROOT/codec/WaveFile.cpp \
             $$TEAMTALKLIB_ROOT/codec/MediaUtil.cpp \
+            $$TEAMTALKLIB_ROOT/codec/AudioKernels.cpp \
             $$TEAMTALKLIB_ROOT/codec/SpeexEncoder.cpp \
             $$TEAMTALKLIB_ROOT/codec/SpeexDecoder.cpp \
             $$TEAMTALKLIB_ROOT/codec/OpusEncoder.cpp \
@@ -129,6 +131,7 @@ SOURCES +=  main.cpp \
             $$TEAMTALKLIB_ROOT/teamtalk/Commands.cpp \
             $$TEAMTALKLIB_ROOT/teamtalk/Common.cpp \
             $$TEAMTALKLIB_ROOT/teamtalk/DesktopSession.cpp \
+            $$TEAMTALKLIB_ROOT/teamtalk/LatencyHistogram.cpp \
             $$TEAMTALKLIB_ROOT/teamtalk/PacketHandler.cpp \
             $$TEAMTALKLIB_ROOT/teamtalk/PacketHelper.cpp \
             $$TEAMTALKLIB_ROOT/teamtalk/PacketLayout.cpp \
@@ -137,6 +140,7 @@ SOURCES +=  main.cpp \
             $$TEAMTALKLIB_ROOT/teamtalk/User.cpp \
             $$TEAMTALKLIB_ROOT/teamtalk/client/AudioContainer.cpp \
             $$TEAMTALKLIB_ROOT/teamtalk/client/AudioThread.cpp \
+            $$TEAMTALKLIB_ROOT/teamtalk/client/BandwidthEstimator.cpp \
             $$TEAMTALKLIB_ROOT/teamtalk/client/ClientChannel.cpp \
             $$TEAMTALKLIB_ROOT/teamtalk/client/ClientNode.cpp \
             $$TEAMTALKLIB_ROOT/teamtalk/client/ClientNodeBase.cpp \
@@ -145,6 +149,7 @@ SOURCES +=  main.cpp \
             $$TEAMTALKLIB_ROOT/teamtalk/client/StreamPlayers.cpp \
             $$TEAMTALKLIB_ROOT/teamtalk/client/VideoThread.cpp \
             $$TEAMTALKLIB_ROOT/teamtalk/client/VoiceLogger.cpp \
+            $$TEAMTALKLIB_ROOT/teamtalk/client/EncodePool.cpp \
             $$TEAMTALKLIB_ROOT/teamtalk/client/AudioMuxer.cpp \
             $$TEAMTALKLIB_ROOT/teamtalk/client/DesktopShare.cpp \
             $$TEAMTALKLIB_ROOT/bin/dll/Convert.cpp \
@@ -106,6 +106,10 @@ class SoundDeviceFeature(UINT32):
     SOUNDDEVICEFEATURE_DUPLEXMODE = 0x0010
     SOUNDDEVICEFEATURE_DEFAULTCOMDEVICE = 0x0020
 
+class ResamplerType(INT32):
+    RESAMPLERTYPE_DEFAULT = 0
+    RESAMPLERTYPE_POLYPHASE = 1
+
 class SoundDevice(Structure):
     _fields_ = [
     ("nDeviceID", INT32),
@@ -408,7 +412,8 @@ class WebMVP8Codec(Structure):
     _anonymous_ = ["u"]
     _fields_ = [
     ("u", WebMVP8CodecUnion),
-    ("nEncodeDeadline", UINT32)
+    ("nEncodeDeadline", UINT32),
+    ("nSimulcastLayers", INT32)
     ]
     def __init__(self):
         assert(DBG_SIZEOF(TTType.WEBMVP8CODEC) == ctypes.sizeof(WebMVP8Codec))
@@ -423,6 +428,7 @@ class Codec(INT32):
     SPEEX_VBR_CODEC = 2
     OPUS_CODEC = 3
     WEBM_VP8_CODEC = 128
+    WEBM_VP9_CODEC = 129
 
 class AudioCodecUnion(Union):
     _fields_ = [
@@ -592,7 +598,9 @@ class ServerStatistics(Structure):
     ("nUsersPeak", INT32),
     ("nFilesTx", INT64),
     ("nFilesRx", INT64),
-    ("nUptimeMSec", INT64)
+    ("nUptimeMSec", INT64),
+    ("nVoiceForwardP50USec", INT64),
+    ("nVoiceForwardP95USec", INT64)
     ]
     def __init__(self):
         assert(DBG_SIZEOF(TTType.SERVERSTATISTICS) == ctypes.sizeof(ServerStatistics))
@@ -658,6 +666,8 @@ class Subscription(UINT32):
     SUBSCRIBE_DESKTOP = 0x00000040
     SUBSCRIBE_DESKTOPINPUT = 0x00000080
     SUBSCRIBE_MEDIAFILE = 0x00000100
+    SUBSCRIBE_VIDEOCAPTURE_LOWRES = 0x00000200
+    SUBSCRIBE_VOICE_DTX = 0x00000400
     SUBSCRIBE_INTERCEPT_USER_MSG = 0x00010000
     SUBSCRIBE_INTERCEPT_CHANNEL_MSG = 0x00020000
     SUBSCRIBE_INTERCEPT_CUSTOM_MSG = 0x00080000
@@ -677,6 +687,11 @@ class UserState(UINT32):
     USERSTATE_MEDIAFILE_VIDEO = 0x00000040
     USERSTATE_MEDIAFILE = USERSTATE_MEDIAFILE_AUDIO | USERSTATE_MEDIAFILE_VIDEO
 
+class UserChange(UINT32):
+    USERCHANGE_NONE = 0x00000000
+    USERCHANGE_STATE = 0x00000001
+    USERCHANGE_PROPERTIES = 0x00000002
+
 class User(Structure):
     _fields_ = [
     ("nUserID", INT32),
@@ -723,6 +738,15 @@ class UserStatistics(Structure):
     ("nMediaFileVideoFramesRecv", INT64),
     ("nMediaFileVideoFramesLost", INT64),
     ("nMediaFileVideoFramesDropped", INT64),
+    ("nVoicePlayoutDelayMSec", INT64),
+    ("nVoicePlayoutAccelerated", INT64),
+    ("nVoicePlayoutExpanded", INT64),
+    ("nVoicePacketsRecovered", INT64),
+    ("nVoicePacketsConcealed", INT64),
+    ("nVoiceBufferedP50MSec", INT64),
+    ("nVoiceBufferedP95MSec", INT64),
+    ("nVoicePlayedP50MSec", INT64),
+    ("nVoicePlayedP95MSec", INT64),
     ]
     def __init__(self):
         assert(DBG_SIZEOF(TTType.USERSTATISTICS) == ctypes.sizeof(UserStatistics))
@@ -854,7 +878,13 @@ class ClientStatistics(Structure):
     ("nTcpPingTimeMs", INT32),
     ("nTcpServerSilenceSec", INT32),
     ("nUdpServerSilenceSec", INT32),
-    ("nSoundInputDeviceDelayMSec", INT32)
+    ("nSoundInputDeviceDelayMSec", INT32),
+    ("nPacketsFragmented", INT64),
+    ("nPacketsReassembled", INT64),
+    ("nVoiceEncodedP50MSec", INT64),
+    ("nVoiceEncodedP95MSec", INT64),
+    ("nVoiceSentP50MSec", INT64),
+    ("nVoiceSentP95MSec", INT64)
     ]
     def __init__(self):
         assert(DBG_SIZEOF(TTType.CLIENTSTATISTICS) == ctypes.sizeof(ClientStatistics))
@@ -1098,8 +1128,10 @@ def function_factory(func, signature):
 
 _GetVersion = function_factory(dll.TT_GetVersion, [TTCHAR_P])
 _InitTeamTalkPoll = function_factory(dll.TT_InitTeamTalkPoll, [_TTInstance])
+_SetSharedEventLoop = function_factory(dll.TT_SetSharedEventLoop, [BOOL, [INT32, INT32]])
 _CloseTeamTalk = function_factory(dll.TT_CloseTeamTalk, [BOOL, [_TTInstance]])
 _GetMessage = function_factory(dll.TT_GetMessage, [BOOL, [_TTInstance, POINTER(TTMessage), POINTER(INT32)]])
+_GetMessages = function_factory(dll.TT_GetMessages, [BOOL, [_TTInstance, POINTER(TTMessage), POINTER(INT32), INT32]])
 _PumpMessage = function_factory(dll.TT_PumpMessage, [BOOL, [_TTInstance, ClientEvent, INT32]])
 _GetFlags = function_factory(dll.TT_GetFlags, [UINT32, [_TTInstance]])
 _SetLicenseInformation = function_factory(dll.TT_SetLicenseInformation, [BOOL, [TTCHAR_P, TTCHAR_P]])
@@ -1107,6 +1139,7 @@ _GetDefaultSoundDevices = function_factory(dll.TT_GetDefaultSoundDevices, [BOOL,
 _GetDefaultSoundDevicesEx = function_factory(dll.TT_GetDefaultSoundDevicesEx, [BOOL, [SoundSystem, POINTER(INT32), POINTER(INT32)]])
 _GetSoundDevices = function_factory(dll.TT_GetSoundDevices, [BOOL, [POINTER(SoundDevice), POINTER(INT32)]])
 _RestartSoundSystem = function_factory(dll.TT_RestartSoundSystem, [BOOL])
+_SetResamplerType = function_factory(dll.TT_SetResamplerType, [BOOL, [ResamplerType]])
 _StartSoundLoopbackTest = function_factory(dll.TT_StartSoundLoopbackTest, [_TTSoundLoop, [INT32, INT32, INT32, INT32, BOOL, POINTER(SpeexDSP)]])
 _StartSoundLoopbackTestEx = function_factory(dll.TT_StartSoundLoopbackTestEx, [_TTSoundLoop, [INT32, INT32, INT32, INT32, BOOL, POINTER(AudioPreprocessor), POINTER(SoundDeviceEffects)]])
 _CloseSoundLoopbackTest = function_factory(dll.TT_CloseSoundLoopbackTest, [BOOL, [_TTSoundLoop]])
@@ -1117,6 +1150,7 @@ _InitSoundOutputSharedDevice = function_factory(dll.TT_InitSoundOutputSharedDevi
 _InitSoundDuplexDevices = function_factory(dll.TT_InitSoundDuplexDevices, [BOOL, [_TTInstance, INT32, INT32]])
 _CloseSoundInputDevice = function_factory(dll.TT_CloseSoundInputDevice, [BOOL, [_TTInstance]])
 _CloseSoundOutputDevice = function_factory(dll.TT_CloseSoundOutputDevice, [BOOL, [_TTInstance]])
+_EnableSoundOutputMixer = function_factory(dll.TT_EnableSoundOutputMixer, [BOOL, [_TTInstance, BOOL]])
 _CloseSoundDuplexDevices = function_factory(dll.TT_CloseSoundDuplexDevices, [BOOL, [_TTInstance]])
 _SetSoundDeviceEffects = function_factory(dll.TT_SetSoundDeviceEffects, [BOOL, [_TTInstance, POINTER(SoundDeviceEffects)]])
 _GetSoundDeviceEffects = function_factory(dll.TT_GetSoundDeviceEffects, [BOOL, [_TTInstance, POINTER(SoundDeviceEffects)]])
@@ -1146,11 +1180,14 @@ _StartRecordingMuxedAudioFileEx = function_factory(dll.TT_StartRecordingMuxedAud
 _StartRecordingMuxedStreams = function_factory(dll.TT_StartRecordingMuxedStreams, [BOOL, [_TTInstance, UINT32, POINTER(AudioCodec), TTCHAR_P, UINT32]])
 _StopRecordingMuxedAudioFile = function_factory(dll.TT_StopRecordingMuxedAudioFile, [BOOL, [_TTInstance]])
 _StopRecordingMuxedAudioFileEx = function_factory(dll.TT_StopRecordingMuxedAudioFileEx, [BOOL, [_TTInstance, INT32]])
+_SetRecordingMemoryLimit = function_factory(dll.TT_SetRecordingMemoryLimit, [BOOL, [_TTInstance, INT32]])
 _StartVideoCaptureTransmission = function_factory(dll.TT_StartVideoCaptureTransmission, [BOOL, [_TTInstance, POINTER(VideoCodec)]])
 _StopVideoCaptureTransmission = function_factory(dll.TT_StopVideoCaptureTransmission, [BOOL, [_TTInstance]])
 _GetVideoCaptureDevices = function_factory(dll.TT_GetVideoCaptureDevices, [BOOL, [POINTER(VideoCaptureDevice), POINTER(INT32)]])
 _InitVideoCaptureDevice = function_factory(dll.TT_InitVideoCaptureDevice, [BOOL, [_TTInstance, TTCHAR_P, POINTER(VideoFormat)]])
 _CloseVideoCaptureDevice = function_factory(dll.TT_CloseVideoCaptureDevice, [BOOL, [_TTInstance]])
+_AcquireUserVideoCaptureFrameEx = function_factory(dll.TT_AcquireUserVideoCaptureFrameEx, [POINTER(VideoFrame), [_TTInstance, INT32, FourCC]])
+_ReleaseUserVideoCaptureFrame = function_factory(dll.TT_ReleaseUserVideoCaptureFrame, [BOOL, [_TTInstance, POINTER(VideoFrame)]])
 _StartStreamingMediaFileToChannel = function_factory(dll.TT_StartStreamingMediaFileToChannel, [BOOL, [_TTInstance, TTCHAR_P, POINTER(VideoCodec)]])
 _StartStreamingMediaFileToChannelEx = function_factory(dll.TT_StartStreamingMediaFileToChannelEx, [BOOL, [_TTInstance, TTCHAR_P, POINTER(MediaFilePlayback), POINTER(VideoCodec)]])
 _UpdateStreamingMediaFileToChannel = function_factory(dll.TT_UpdateStreamingMediaFileToChannel, [BOOL, [_TTInstance, POINTER(MediaFilePlayback), POINTER(VideoCodec)]])
@@ -1168,6 +1205,8 @@ _QueryMaxPayload = function_factory(dll.TT_QueryMaxPayload, [BOOL, [_TTInstance,
 _GetClientStatistics = function_factory(dll.TT_GetClientStatistics, [BOOL, [_TTInstance, POINTER(ClientStatistics)]])
 _SetClientKeepAlive = function_factory(dll.TT_SetClientKeepAlive, [BOOL, [_TTInstance, POINTER(ClientKeepAlive)]])
 _GetClientKeepAlive = function_factory(dll.TT_GetClientKeepAlive, [BOOL, [_TTInstance, POINTER(ClientKeepAlive)]])
+_SetUserEventCoalescing = function_factory(dll.TT_SetUserEventCoalescing, [BOOL, [_TTInstance, INT32]])
+_EnableLatencyTracing = function_factory(dll.TT_EnableLatencyTracing, [BOOL, [_TTInstance, BOOL]])
 _DoPing = function_factory(dll.TT_DoPing, [INT32, [_TTInstance]])
 _DoLogin = function_factory(dll.TT_DoLogin, [INT32, [_TTInstance, TTCHAR_P, TTCHAR_P, TTCHAR_P]])
 _DoLoginEx = function_factory(dll.TT_DoLoginEx, [INT32, [_TTInstance, TTCHAR_P, TTCHAR_P, TTCHAR_P, TTCHAR_P]])
@@ -1249,6 +1288,12 @@ def getVersion():
 def setLicense(name, key):
     return _SetLicenseInformation(name, key)
 
+def setSharedEventLoop(nEventLoopThreads, nWorkerThreads):
+    return _SetSharedEventLoop(nEventLoopThreads, nWorkerThreads)
+
+def setResamplerType(nResamplerType):
+    return _SetResamplerType(nResamplerType)
+
 def DBG_SIZEOF(t):
     return _DBG_SIZEOF(t)
 
@@ -1418,6 +1463,19 @@ class TeamTalk(object):
         _GetMessage(self._tt, byref(msg), byref(nWaitMS))
         return msg
 
+    def getMessages(self, nMaxMessages: int = 64, nWaitMS: int = -1):
+        msgs = (TTMessage * nMaxMessages)()
+        count = INT32(nMaxMessages)
+        if not _GetMessages(self._tt, msgs, byref(count), nWaitMS):
+            return []
+        return msgs[:count.value]
+
+    def setUserEventCoalescing(self, nWindowMSec: int) -> bool:
+        return _SetUserEventCoalescing(self._tt, nWindowMSec)
+
+    def enableLatencyTracing(self, bEnable: bool) -> bool:
+        return _EnableLatencyTracing(self._tt, bEnable)
+
     def getFlags(self):
         return _GetFlags(self._tt)
 
@@ -1646,6 +1704,13 @@ class TeamTalk(object):
     def setUserStoppedPlaybackDelay(self, nUserID: int, nStreamType: StreamType, nDelayMSec: int) -> bool:
         return _SetUserStoppedPlaybackDelay(self._tt, nUserID, nStreamType, nDelayMSec)
 
+    def acquireUserVideoCaptureFrameEx(self, nUserID: int, nFourCC: FourCC):
+        frame = _AcquireUserVideoCaptureFrameEx(self._tt, nUserID, nFourCC)
+        return frame.contents if frame else None
+
+    def releaseUserVideoCaptureFrame(self, lpVideoFrame: VideoFrame) -> bool:
+        return _ReleaseUserVideoCaptureFrame(self._tt, byref(lpVideoFrame))
+
     def startStreamingMediaFileToChannel(self, szMediaFilePath, lpVideoCodec: VideoCodec) -> bool:
         return _StartStreamingMediaFileToChannel(self._tt, szMediaFilePath, lpVideoCodec)
 
@@ -396,6 +396,23 @@ extern "C" {
      * Checkout @c uSoundDeviceFeatures on #SoundDevice. */
     typedef UINT32 SoundDeviceFeatures;
 
+    /**
+     * @brief The resampler used when the sample rate or channels of
+     * an audio stream differ from the sound device.
+     *
+     * @see TT_SetResamplerType() */
+    typedef enum ResamplerType
+    {
+        /** @brief The platform's resampler, i.e. DMO on Windows,
+         * FFmpeg or SpeexDSP depending on the build. Falls back to
+         * #RESAMPLERTYPE_POLYPHASE if the build has none of
+         * these. */
+        RESAMPLERTYPE_DEFAULT = 0,
+        /** @brief Built-in polyphase resampler which uses SIMD
+         * instructions where available. */
+        RESAMPLERTYPE_POLYPHASE = 1,
+    } ResamplerType;
+
     /** 
      * @brief A struct containing the properties of a sound device
      * for either playback or recording.
@@ -1160,10 +1177,16 @@ extern "C" {
          * Value from 0-10. */
         INT32 nComplexity;
         /** @brief Forward error correction. 
-         * Corrects errors if there's packetloss. */
+         * Corrects errors if there's packetloss. The amount of FEC
+         * data adapts to the packet loss reported by the users
+         * receiving the voice stream. With Opus 1.5 built with Deep
+         * REDundancy (DRED) the packets also carry DRED.
+         * @see UserStatistics.nVoicePacketsRecovered */
         TTBOOL bFEC;
         /** @brief Discontinuous transmission.
-         * Enables "null" packets during silence. */
+         * Enables "null" packets during silence. The server only
+         * forwards the first of consecutive "null" packets unless the
+         * receiver subscribes with #SUBSCRIBE_VOICE_DTX. */
         TTBOOL bDTX;
         /** @brief Bitrate for encoded audio. Should be between
          * #OPUS_MIN_BITRATE and #OPUS_MAX_BITRATE. */
@@ -1443,6 +1466,14 @@ extern "C" {
          * Supported values are VPX_DL_REALTIME = 1, VPX_DL_GOOD_QUALITY = 1000000,
          * and VPX_DL_BEST_QUALITY = 0. */
         UINT32 nEncodeDeadline;
+        /** @brief Number of simulcast layers to encode when used for
+         * video capture. 0 or 1 means simulcast is disabled.
+         *
+         * Each layer has half the width and height of the previous
+         * layer and a quarter of the bitrate. The server forwards a
+         * single layer to each user. Max is 3.
+         * @see SUBSCRIBE_VIDEOCAPTURE_LOWRES */
+        INT32 nSimulcastLayers;
     } WebMVP8Codec;
 
 /** @brief @c nEncodeDeadline value for fastest encoding.
@@ -1472,6 +1503,12 @@ extern "C" {
         OPUS_CODEC                  = 3,
         /** @brief WebM video codec. @see WebMVP8Codec */
         WEBM_VP8_CODEC              = 128,
+        /** @brief WebM VP9 video codec. Uses the same settings as
+         * #WEBM_VP8_CODEC, i.e. @c webm_vp8 in #VideoCodec.
+         *
+         * Clients which do not support VP9 will not be able to
+         * display the video stream. @see WebMVP8Codec */
+        WEBM_VP9_CODEC              = 129,
     } Codec;
 
     /** @brief Struct used for specifying which audio codec a channel
@@ -1519,12 +1556,13 @@ extern "C" {
     /** @brief Struct used for specifying the video codec to use. */
     typedef struct VideoCodec
     {
-        /** @brief Specifies member holds the codec settings. So far
-         * there is only one video codec to choose from, namely @c
-         * webm_vp8. */
+        /** @brief Specifies member holds the codec settings. Both
+         * #WEBM_VP8_CODEC and #WEBM_VP9_CODEC use @c webm_vp8. */
         Codec nCodec;  
         union
         {
+            /** @brief WebM codec settings if @a nCodec is
+             * #WEBM_VP8_CODEC or #WEBM_VP9_CODEC. */
             WebMVP8Codec webm_vp8;
         };
     } VideoCodec;
@@ -1912,6 +1950,16 @@ extern "C" {
         INT64 nFilesRx;
         /** @brief The server's uptime in msec. */
         INT64 nUptimeMSec;
+        /** @brief Median time in usec from the server received a
+         * voice packet until it was forwarded to the receivers. Covers
+         * the voice packets since the server statistics were last
+         * queried. */
+        INT64 nVoiceForwardP50USec;
+        /** @brief 95th percentile of the time in usec from the server
+         * received a voice packet until it was forwarded. Covers the
+         * voice packets since the server statistics were last
+         * queried. */
+        INT64 nVoiceForwardP95USec;
     } ServerStatistics;
 
     /**
@@ -2107,6 +2155,20 @@ extern "C" {
         /** @brief Subscribing to #STREAMTYPE_MEDIAFILE_VIDEO and
          * #STREAMTYPE_MEDIAFILE_AUDIO. */
         SUBSCRIBE_MEDIAFILE               = 0x00000100,
+        /** @brief Receive lowest resolution simulcast layer of
+         * #STREAMTYPE_VIDEOCAPTURE. Only applies if the user's video
+         * capture is encoded with @c nSimulcastLayers.
+         * @see WebMVP8Codec */
+        SUBSCRIBE_VIDEOCAPTURE_LOWRES     = 0x00000200,
+        /** @brief Receive every silent packet of #STREAMTYPE_VOICE
+         * when the user's Opus codec has @c bDTX enabled, e.g. when
+         * recording the user's voice stream. By default the server
+         * only forwards the first of consecutive silent packets and
+         * the receiver generates comfort noise until the user speaks
+         * again. Clients older than protocol version 5.15 always
+         * receive every silent packet.
+         * @see OpusCodec */
+        SUBSCRIBE_VOICE_DTX               = 0x00000400,
         /** @brief Intercept all user text messages sent by a
         * user. Only user-type #USERTYPE_ADMIN can do this. */
         SUBSCRIBE_INTERCEPT_USER_MSG      = 0x00010000,
@@ -2192,6 +2254,28 @@ extern "C" {
      * state. */
     typedef UINT32 UserStates;
 
+    /** @brief The changes which have occured to a user while user
+     * events are coalesced. Used for #TTMessage's @a nSource in
+     * #CLIENTEVENT_USER_STATECHANGE.
+     *
+     * @see TT_SetUserEventCoalescing() */
+    typedef enum UserChange
+    {
+        /** @brief No changes. */
+        USERCHANGE_NONE                 = 0x00000000,
+        /** @brief The user's @a uUserState has changed, i.e. what
+         * would otherwise have been posted as
+         * #CLIENTEVENT_USER_STATECHANGE. */
+        USERCHANGE_STATE                = 0x00000001,
+        /** @brief The server has updated the user's properties,
+         * i.e. what would otherwise have been posted as
+         * #CLIENTEVENT_CMD_USER_UPDATE. */
+        USERCHANGE_PROPERTIES           = 0x00000002,
+    } UserChange;
+
+    /** @brief A bitmask based on #UserChange. */
+    typedef UINT32 UserChanges;
+
     /** 
      * @brief A struct containing the properties of a user.
      * @see UserType
@@ -2359,6 +2443,42 @@ extern "C" {
         /** @brief Number of media file video frames dropped because user 
          * application didn't retrieve video frames in time. */
         INT64 nMediaFileVideoFramesDropped;
+        /** @brief Current voice playout delay in msec, i.e. the duration of
+         * voice data queued for playback. The playout delay adapts to
+         * the network jitter within the limits of #JitterConfig. */
+        INT64 nVoicePlayoutDelayMSec;
+        /** @brief Number of times voice playback was time-compressed
+         * (accelerated) to reduce the playout delay. */
+        INT64 nVoicePlayoutAccelerated;
+        /** @brief Number of times voice playback was time-stretched
+         * (expanded) to increase the playout delay or to conceal lost
+         * packets. */
+        INT64 nVoicePlayoutExpanded;
+        /** @brief Number of lost voice packets which were restored
+         * from forward error correction (FEC) or Deep REDundancy
+         * (DRED) data in the following packets. Only available with
+         * #OPUS_CODEC where @c OpusCodec.bFEC is enabled. Recovered
+         * packets are also included in @c nVoicePacketsLost. */
+        INT64 nVoicePacketsRecovered;
+        /** @brief Number of lost voice packets which were replaced by
+         * the decoder's packet loss concealment. */
+        INT64 nVoicePacketsConcealed;
+        /** @brief Median time in msec from a voice packet was
+         * received until it left the jitter buffer. Only available
+         * when TT_EnableLatencyTracing() is enabled. */
+        INT64 nVoiceBufferedP50MSec;
+        /** @brief 95th percentile of the time in msec from a voice
+         * packet was received until it left the jitter buffer. */
+        INT64 nVoiceBufferedP95MSec;
+        /** @brief Median time in msec from a voice packet was
+         * received until it was played by the sound device. The
+         * time spent in the sound device is an estimate. Only
+         * available when TT_EnableLatencyTracing() is enabled. */
+        INT64 nVoicePlayedP50MSec;
+        /** @brief 95th percentile of the time in msec from a voice
+         * packet was received until it was played by the sound
+         * device. */
+        INT64 nVoicePlayedP95MSec;
     } UserStatistics;
 
     /** 
@@ -2811,6 +2931,29 @@ extern "C" {
          *
          * @see TT_InitSoundInputDevice() */
         INT32 nSoundInputDeviceDelayMSec;
+        /** @brief Number of audio packets, video frames and desktop
+         * updates sent which had to be split into several packets to
+         * fit the path MTU.
+         * @see TT_QueryMaxPayload() */
+        INT64 nPacketsFragmented;
+        /** @brief Number of audio packets and video frames received
+         * which were reassembled from several packets. */
+        INT64 nPacketsReassembled;
+        /** @brief Median time in msec from voice was captured until
+         * it was encoded. The delay of the sound input device,
+         * @c nSoundInputDeviceDelayMSec, is not included. Only
+         * available when TT_EnableLatencyTracing() is enabled. */
+        INT64 nVoiceEncodedP50MSec;
+        /** @brief 95th percentile of the time in msec from voice was
+         * captured until it was encoded. */
+        INT64 nVoiceEncodedP95MSec;
+        /** @brief Median time in msec from voice was captured until
+         * it was sent to the server. Only available when
+         * TT_EnableLatencyTracing() is enabled. */
+        INT64 nVoiceSentP50MSec;
+        /** @brief 95th percentile of the time in msec from voice was
+         * captured until it was sent to the server. */
+        INT64 nVoiceSentP95MSec;
     } ClientStatistics;
 
     /** @ingroup connectivity
@@ -3507,12 +3650,19 @@ extern "C" {
          * - A user has started/stopped a media file stream, i.e.
          *   i.e. #USERSTATE_MEDIAFILE_AUDIO or #USERSTATE_MEDIAFILE_VIDEO
          *
+         * If user events are coalesced using TT_SetUserEventCoalescing()
+         * then this event is posted once per changed user when the
+         * coalescing window expires. This event then also replaces
+         * #CLIENTEVENT_CMD_USER_UPDATE.
+         *
          * Attribute values in #TTMessage:
-         * - #TTMessage.nSource 0
+         * - #TTMessage.nSource 0 or a #UserChanges mask if user
+         *   events are coalesced.
          * - #TTMessage.ttType #__USER.
          * - #TTMessage.user Placed in union of #TTMessage.
          *
-         * @see TT_SetUserStoppedTalkingDelay */
+         * @see TT_SetUserStoppedTalkingDelay
+         * @see TT_SetUserEventCoalescing */
         CLIENTEVENT_USER_STATECHANGE = CLIENTEVENT_NONE + 500,
         /** 
          * @brief A new video frame from a video capture device 
@@ -4218,6 +4368,36 @@ extern "C" {
      * @see TT_CloseTeamTalk */
     TEAMTALKDLL_API TTInstance* TT_InitTeamTalkPoll(void);
 
+    /**
+     * @brief Let client instances share a fixed number of threads.
+     *
+     * By default every client instance has its own thread for network
+     * and timer events plus threads for encoding recordings and
+     * decoding audio. An application hosting hundreds of client
+     * instances, e.g. a bot or a load test, can instead make the
+     * instances share a pool of threads.
+     *
+     * Only client instances created after this call are affected.
+     * Existing client instances keep the threads they were created
+     * with.
+     *
+     * Client instances running on the same event loop thread are
+     * handled one at a time, so a slow event handler delays the
+     * other instances. When a client instance's event queue is full
+     * its events are dropped instead of pausing the event loop.
+     *
+     * Recording memory limit set by TT_SetRecordingMemoryLimit() is
+     * shared by all the client instances.
+     *
+     * @param nEventLoopThreads Number of threads handling network and
+     * timer events. 0 means each client instance has its own thread
+     * (default).
+     * @param nWorkerThreads Number of threads for mixing and encoding
+     * recordings. 0 means half the number of CPU cores (max 4).
+     * @return FALSE if a parameter is negative. */
+    TEAMTALKDLL_API TTBOOL TT_SetSharedEventLoop(IN INT32 nEventLoopThreads,
+                                                 IN INT32 nWorkerThreads);
+
     /** 
      * @brief Close the TeamTalk client instance and release its
      * resources.
@@ -4246,6 +4426,29 @@ extern "C" {
                                          OUT TTMessage* pMsg,
                                          IN const INT32* pnWaitMs);
 
+    /**
+     * @brief Poll for several events in the client instance.
+     *
+     * Same as TT_GetMessage() except that all events which are
+     * queued, up to @c pnCount, are retrieved in one call. This is
+     * faster when a client instance receives many events, e.g. user
+     * state changes on a busy server.
+     *
+     * @param lpTTInstance Pointer to client instance created by
+     * #TT_InitTeamTalk.
+     * @param pMsgs Array of TTMessage which will hold the events in
+     * the order they occured.
+     * @param pnCount Pointer to number of elements in @c pMsgs. On
+     * return holds the number of events retrieved.
+     * @param nWaitMSec The amount of time to wait if there are no
+     * events. -1 means block until the next event occurs.
+     * @return Returns TRUE if one or more events were retrieved.
+     * @see TT_GetMessage */
+    TEAMTALKDLL_API TTBOOL TT_GetMessages(IN TTInstance* lpTTInstance,
+                                          OUT TTMessage* pMsgs,
+                                          IN OUT INT32* pnCount,
+                                          IN INT32 nWaitMSec);
+
     /**
      * @brief Cause client instance event thread to schedule an update
      * event.
@@ -4359,6 +4562,16 @@ extern "C" {
      * TT_CloseSoundoutputDevice() and TT_CloseSoundDuplexDevices(). */
     TEAMTALKDLL_API TTBOOL TT_RestartSoundSystem(void);
 
+    /**
+     * @brief Select the resampler used by all client instances.
+     *
+     * Only applies to sound devices and streams which are started
+     * after this call.
+     *
+     * @param nResamplerType The resampler to use.
+     * @return FALSE if @c nResamplerType is invalid. */
+    TEAMTALKDLL_API TTBOOL TT_SetResamplerType(IN ResamplerType nResamplerType);
+
     /**
      * @brief Perform a record and playback test of specified sound
      * devices along with an audio configuration.
@@ -4635,6 +4848,34 @@ extern "C" {
      * @see TT_InitSoundOutputDevice */
     TEAMTALKDLL_API TTBOOL TT_CloseSoundOutputDevice(IN TTInstance* lpTTInstance);
 
+    /**
+     * @brief Mix the audio of all users into a single output stream.
+     *
+     * By default every user's voice and media file stream is played
+     * in its own output stream on the sound output device. With many
+     * users talking at the same time this means one sound device
+     * stream (and on some sound systems one thread) per user.
+     *
+     * In mixer mode all users are decoded and mixed by the callback of
+     * a single output stream, i.e. the same shared output stream which
+     * is used when #TT_SOUNDDEVICE_ID_SHARED_FLAG is passed to
+     * TT_InitSoundOutputDevice(). Volume, mute and stereo settings
+     * still apply per user. Use TT_InitSoundOutputSharedDevice() to
+     * change the frame size (latency) of the mixer stream.
+     *
+     * Mixer mode does not apply to sound devices running in duplex
+     * mode since these already use a single output stream.
+     *
+     * The mixer mode can be changed while the sound output device is
+     * active.
+     *
+     * @param lpTTInstance Pointer to client instance created by 
+     * #TT_InitTeamTalk.
+     * @param bEnable TRUE to enable mixer mode.
+     * @see TT_InitSoundOutputDevice */
+    TEAMTALKDLL_API TTBOOL TT_EnableSoundOutputMixer(IN TTInstance* lpTTInstance,
+                                                     IN TTBOOL bEnable);
+
     /**
      * @brief Shut down sound devices running in duplex mode.
      *
@@ -5137,6 +5378,10 @@ extern "C" {
      * Use TT_SetUserMediaStorageDir() to store users' audio streams
      * in separate files.
      *
+     * The muxer records the audio as it is played, so silence from
+     * users whose #OpusCodec has @c bDTX enabled is recorded as
+     * comfort noise unless #SUBSCRIBE_VOICE_DTX is subscribed.
+     *
      * @param lpTTInstance Pointer to client instance created by
      * #TT_InitTeamTalk.
      * @param lpAudioCodec The audio codec which should be used as
@@ -5175,6 +5420,9 @@ extern "C" {
      * Only #STREAMTYPE_VOICE is stored into the audio file, not
      * #STREAMTYPE_MEDIAFILE_AUDIO.
      *
+     * Like TT_StartRecordingMuxedAudioFile() silence from users with
+     * Opus DTX is recorded as comfort noise.
+     *
      * @param lpTTInstance Pointer to client instance created by
      * #TT_InitTeamTalk.
      * @param nChannelID The recording will contain the conversations
@@ -5206,6 +5454,9 @@ extern "C" {
      * TT_StartRecordingMuxedAudioFile() is mutually exclusive with
      * TT_StartRecordingMuxedStreams().
      *
+     * #STREAMTYPE_VOICE from users with Opus DTX is recorded with
+     * comfort noise during silence, see #SUBSCRIBE_VOICE_DTX.
+     *
      * Use TT_StopRecordingMuxedAudioFile() to stop the recording.
      *
      * @param lpTTInstance Pointer to client instance created by
@@ -5255,6 +5506,26 @@ extern "C" {
      * @see TT_StopRecordingMuxedAudioFile() */
     TEAMTALKDLL_API TTBOOL TT_StopRecordingMuxedAudioFileEx(IN TTInstance* lpTTInstance,
                                                             IN INT32 nChannelID);
+
+    /**
+     * @brief Limit the memory used for audio waiting to be written to
+     * recordings.
+     *
+     * Recordings started by TT_StartRecordingMuxedAudioFile() and
+     * TT_SetUserMediaStorageDir() are encoded by worker threads. If
+     * the workers cannot keep up, e.g. when recording many users at
+     * the same time, the audio waiting to be encoded is limited to @c
+     * nMaxBytes. When the limit is reached the client instance stalls
+     * the recording until the workers have caught up. Default is 64
+     * MB.
+     *
+     * @param lpTTInstance Pointer to client instance created by
+     * #TT_InitTeamTalk.
+     * @param nMaxBytes Maximum number of bytes waiting to be encoded.
+     * @see TT_StartRecordingMuxedAudioFile()
+     * @see TT_SetUserMediaStorageDir() */
+    TEAMTALKDLL_API TTBOOL TT_SetRecordingMemoryLimit(IN TTInstance* lpTTInstance,
+                                                      IN INT32 nMaxBytes);
     
     /** 
      * @brief Start transmitting from video capture device.
@@ -5421,6 +5692,31 @@ extern "C" {
     TEAMTALKDLL_API VideoFrame* TT_AcquireUserVideoCaptureFrame(IN TTInstance* lpTTInstance,
                                                                 IN INT32 nUserID);
 
+    /** @brief Extract a user's video capture frame in a specific
+     * image format.
+     *
+     * Same as TT_AcquireUserVideoCaptureFrame() except the image
+     * format of @a frameBuffer can be specified. With #FOURCC_I420
+     * the decoder's output is returned without RGB conversion so
+     * the application can do its own conversion, e.g. on the GPU.
+     * The Y plane (@a nWidth * @a nHeight bytes) is followed by the U
+     * and V planes (each (@a nWidth+1)/2 * (@a nHeight+1)/2 bytes)
+     * without any padding.
+     *
+     * Video frames are recycled by the client instance so release
+     * them as soon as possible using TT_ReleaseUserVideoCaptureFrame().
+     *
+     * @param lpTTInstance Pointer to client instance created by
+     * #TT_InitTeamTalk. 
+     * @param nUserID The user's ID. 0 for local user. The local
+     * user's video frames are only available as #FOURCC_RGB32.
+     * @param nFourCC Either #FOURCC_RGB32 or #FOURCC_I420.
+     * @return Returns NULL if no video frame could be acquired.
+     * @see TT_ReleaseUserVideoCaptureFrame */
+    TEAMTALKDLL_API VideoFrame* TT_AcquireUserVideoCaptureFrameEx(IN TTInstance* lpTTInstance,
+                                                                  IN INT32 nUserID,
+                                                                  IN FourCC nFourCC);
+
     /** @brief Delete a user's video frame, acquired through
      * TT_AcquireUserVideoCaptureFrame(), so its allocated resources can be
      * released.
@@ -5884,6 +6180,9 @@ extern "C" {
      *
      * It's only possible to send the mouse cursor position if there's
      * a desktop session which is currently active.
+     *
+     * Frequent position updates are coalesced so only the latest
+     * position is sent every 25 msec.
      * 
      * User rights required:
      * - #USERRIGHT_TRANSMIT_DESKTOP
@@ -5919,7 +6218,10 @@ extern "C" {
      * @param lpDesktopInputs An array of #DesktopInput structs which
      * should be transmitted to the user. Internally in the client
      * instance each user ID has an internal queue which can contain a
-     * maximum of 100 #DesktopInput structs.
+     * maximum of 100 #DesktopInput structs. #DesktopInput structs
+     * which are queued while waiting for the remote user's
+     * acknowledgement are merged into a single packet where
+     * consecutive mouse moves are reduced to the latest position.
      * @param nDesktopInputCount Must be less or equal to #TT_DESKTOPINPUT_MAX.
      * @return FALSE If user doesn't exist or if desktop input queue is full or
      * if @c nUserID doesn't subscribe to desktop input. */
@@ -6123,6 +6425,11 @@ extern "C" {
      * The #CLIENTEVENT_CON_MAX_PAYLOAD_UPDATED event is posted when
      * the query has finished.
      *
+     * The client also queries the maximum payload to the server
+     * automatically after connecting and at regular intervals
+     * thereafter. #CLIENTEVENT_CON_MAX_PAYLOAD_UPDATED is only posted
+     * for automatic queries if the maximum payload changes.
+     *
      * @param lpTTInstance Pointer to client instance created by
      * #TT_InitTeamTalk. 
      * @param nUserID The ID of the user to query or 0 for querying 
@@ -6163,6 +6470,62 @@ extern "C" {
      * @see TT_GetClientStatistics() */
     TEAMTALKDLL_API TTBOOL TT_GetClientKeepAlive(IN TTInstance* lpTTInstance,
                                                  OUT ClientKeepAlive* lpClientKeepAlive);
+
+    /**
+     * @brief Merge user events within a time window.
+     *
+     * In a channel with many users the events
+     * #CLIENTEVENT_USER_STATECHANGE and #CLIENTEVENT_CMD_USER_UPDATE
+     * can occur several times per second for each user, e.g. due to
+     * users starting and stopping talking.
+     *
+     * With coalescing enabled the client instance instead collects
+     * the changes for each user and posts a single
+     * #CLIENTEVENT_USER_STATECHANGE per changed user when @c
+     * nWindowMSec has elapsed. The #TTMessage's @a nSource then
+     * contains the #UserChanges which have occured and @a user is
+     * the user's current state. #CLIENTEVENT_CMD_USER_UPDATE is not
+     * posted while coalescing is enabled.
+     *
+     * By default coalescing is disabled.
+     *
+     * @param lpTTInstance Pointer to client instance created by
+     * #TT_InitTeamTalk.
+     * @param nWindowMSec Time window in msec, e.g. 50. Zero disables
+     * coalescing and posts the pending changes.
+     * @return FALSE if @c nWindowMSec is negative. */
+    TEAMTALKDLL_API TTBOOL TT_SetUserEventCoalescing(IN TTInstance* lpTTInstance,
+                                                     IN INT32 nWindowMSec);
+
+    /**
+     * @brief Trace the latency of voice from capture to playout.
+     *
+     * Clocks of sender, server and receiver are not synchronized so
+     * each stage is measured by the host where it occurs:
+     *
+     * - The sender's #ClientStatistics contains the time from voice
+     *   was captured until encoded and until sent.
+     * - The server's #ServerStatistics contains the time from a voice
+     *   packet was received until forwarded.
+     * - The receiver's #UserStatistics contains the time from a
+     *   voice packet was received until it left the jitter buffer and
+     *   until it was played.
+     *
+     * The network delay between the hosts is not traced. It can be
+     * estimated as half of @c nUdpPingTimeMs in #ClientStatistics.
+     *
+     * The latency is reported as percentiles of all voice packets
+     * since tracing was enabled. By default tracing is disabled.
+     *
+     * @param lpTTInstance Pointer to client instance created by
+     * #TT_InitTeamTalk.
+     * @param bEnable Enable/disable tracing. Both reset the latency
+     * statistics.
+     * @see TT_GetClientStatistics()
+     * @see TT_GetUserStatistics()
+     * @see TT_DoQueryServerStats() */
+    TEAMTALKDLL_API TTBOOL TT_EnableLatencyTracing(IN TTInstance* lpTTInstance,
+                                                   IN TTBOOL bEnable);
     
     /** @} */
 
@@ -7513,6 +7876,11 @@ extern "C" {
      * To store audio of users not in current channel of the client
      * instance check out the section @ref spying.
      *
+     * If the user's #OpusCodec has @c bDTX enabled the server only
+     * forwards the first of the user's silent packets, so the rest of
+     * the silence is stored as lost audio. Call TT_DoSubscribe() with
+     * #SUBSCRIBE_VOICE_DTX to store every silent packet.
+     *
      * @param lpTTInstance Pointer to client instance created by
      * #TT_InitTeamTalk.
      * @param nUserID The ID of the #User which should store audio to